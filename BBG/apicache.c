@@ -0,0 +1,149 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file apicache.c
+* @brief What the BBG knows of the TIVA's relay states and sensor ID, for read-only API calls
+*
+* Records are matched by their log_msg.def index, so the answers to
+* status and ID requests count whether they came back for a client or
+* were logged on the TIVA's own account. A failed ID read says nothing.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "apicache.h"
+#include "include/log_wire.h"
+
+static uint64_t now_us(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+static void set(apicache_t *cache, uint16_t opcode, uint32_t value, uint64_t now)
+{
+	cache->entry[opcode].value = value;
+	cache->entry[opcode].at = now;
+	cache->stats.updates++;
+}
+
+static void forget(apicache_t *cache, uint16_t opcode)
+{
+	if(cache->entry[opcode].at)
+		cache->stats.invalidations++;
+	cache->entry[opcode].at = 0;
+}
+
+
+void apicache_init(apicache_t *cache, uint32_t max_age_ms)
+{
+	memset(cache, 0, sizeof(*cache));
+	pthread_mutex_init(&cache->lock, NULL);
+	cache->max_age_ms = max_age_ms;
+}
+
+bool apicache_get(apicache_t *cache, uint16_t opcode, uint32_t *value)
+{
+	apicache_entry_t *entry;
+	bool hit = false;
+
+	if(opcode != API_OP_RELAY0_STATUS && opcode != API_OP_RELAY1_STATUS && opcode != API_OP_SENSOR_ID)
+		return false;
+
+	pthread_mutex_lock(&cache->lock);
+	entry = &cache->entry[opcode];
+	if(entry->at && now_us() - entry->at <= (uint64_t)cache->max_age_ms * 1000)
+	{
+		*value = entry->value;
+		hit = true;
+		cache->stats.hits++;
+	}
+	else
+		cache->stats.misses++;
+	pthread_mutex_unlock(&cache->lock);
+	return hit;
+}
+
+void apicache_record(apicache_t *cache, uint16_t msg, uint32_t value)
+{
+	uint64_t now = now_us();
+
+	pthread_mutex_lock(&cache->lock);
+	switch(msg)
+	{
+		/* commands applied / relays switched / state, one per relay task wake up */
+		case LOG_MSG_RELAY_CYCLE:
+			set(cache, API_OP_RELAY0_STATUS, value & 0x01 ? 1 : 0, now);
+			set(cache, API_OP_RELAY1_STATUS, value & 0x02 ? 1 : 0, now);
+			break;
+		case LOG_MSG_STATUS_RELAY0_ON:
+		case LOG_MSG_STATUS_RELAY0_TURNED_OFF:
+			set(cache, API_OP_RELAY0_STATUS, value, now);
+			break;
+		case LOG_MSG_STATUS_RELAY1_ON:
+		case LOG_MSG_STATUS_RELAY1_TURNED_OFF:
+			set(cache, API_OP_RELAY1_STATUS, value, now);
+			break;
+		case LOG_MSG_READING_ID_SUCCESS:
+			set(cache, API_OP_SENSOR_ID, value, now);
+			break;
+		/* a relay command was taken, the relay task switches after its
+		 * debounce and dwell and logs the state then */
+		case LOG_MSG_RELAY0_TURNED_ON:
+		case LOG_MSG_RELAY0_TURNED_OFF:
+			forget(cache, API_OP_RELAY0_STATUS);
+			break;
+		case LOG_MSG_RELAY1_TURNED_ON:
+		case LOG_MSG_RELAY1_TURNED_OFF:
+			forget(cache, API_OP_RELAY1_STATUS);
+			break;
+		case LOG_MSG_BOTH_RELAYS_TURNED_ON:
+		case LOG_MSG_BOTH_RELAYS_TURNED_OFF:
+			forget(cache, API_OP_RELAY0_STATUS);
+			forget(cache, API_OP_RELAY1_STATUS);
+			break;
+		/* the TIVA has restarted, its relays with it */
+		case LOG_MSG_GESTURE_APPLICATION:
+			memset(cache->entry, 0, sizeof(cache->entry));
+			cache->stats.invalidations++;
+			break;
+		default:
+			break;
+	}
+	pthread_mutex_unlock(&cache->lock);
+}
+
+void apicache_invalidate(apicache_t *cache)
+{
+	pthread_mutex_lock(&cache->lock);
+	memset(cache->entry, 0, sizeof(cache->entry));
+	cache->stats.invalidations++;
+	pthread_mutex_unlock(&cache->lock);
+}
+
+void apicache_forget(apicache_t *cache, uint16_t opcode)
+{
+	if(opcode > API_OP_MAX)
+		return;
+	pthread_mutex_lock(&cache->lock);
+	forget(cache, opcode);
+	pthread_mutex_unlock(&cache->lock);
+}
+
+void apicache_get_stats(apicache_t *cache, apicache_stats_t *stats)
+{
+	pthread_mutex_lock(&cache->lock);
+	*stats = cache->stats;
+	pthread_mutex_unlock(&cache->lock);
+}
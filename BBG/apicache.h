@@ -0,0 +1,70 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file apicache.h
+* @brief What the BBG knows of the TIVA's relay states and sensor ID, for read-only API calls
+*
+* The model is kept from the records the communication thread already
+* receives: the relay task logs the relay state every time it switches,
+* and the answers to status and ID requests carry the value read. An entry
+* older than the maximum age is not used, so a change whose record was
+* lost is only believed for that long; lost frames and a TIVA restart
+* drop the whole model at once.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef _APICACHE_H
+#define _APICACHE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "socket.h"
+
+#define APICACHE_MAX_AGE_MS     (5000)
+
+typedef struct apicache_entry
+{
+	uint32_t value;
+	uint64_t at;            /* us, 0 when nothing is known */
+}apicache_entry_t;
+
+typedef struct apicache_stats
+{
+	uint64_t hits;
+	uint64_t misses;        /* unknown or too old, asked the TIVA */
+	uint64_t updates;       /* entries set from TIVA records */
+	uint64_t invalidations;
+}apicache_stats_t;
+
+typedef struct apicache
+{
+	pthread_mutex_t lock;   /* the communication thread writes, the server thread reads */
+	apicache_entry_t entry[API_OP_MAX + 1];
+	uint32_t max_age_ms;
+	apicache_stats_t stats;
+}apicache_t;
+
+void apicache_init(apicache_t *cache, uint32_t max_age_ms);
+
+/* true when opcode can be answered from the model, in *value */
+bool apicache_get(apicache_t *cache, uint16_t opcode, uint32_t *value);
+
+/* a record from the TIVA, msg is its log_msg.def index */
+void apicache_record(apicache_t *cache, uint16_t msg, uint32_t value);
+
+/* forget everything, the records may have missed a change */
+void apicache_invalidate(apicache_t *cache);
+
+/* forget opcode's answer, a change to it is on its way */
+void apicache_forget(apicache_t *cache, uint16_t opcode);
+
+void apicache_get_stats(apicache_t *cache, apicache_stats_t *stats);
+
+#endif
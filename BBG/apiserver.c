@@ -0,0 +1,913 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file apiserver.c
+* @brief Client API server: persistent, pipelined connections multiplexed on one epoll thread
+*
+* Replies are gathered in each connection's output buffer during a poll
+* round and written with one send per connection at the end of it. A
+* connection is read only for as many requests as its pipeline has room
+* for, so its output buffer always has room for their replies. The poll
+* wait is cut short by the earliest deadline; the backlog is in deadline
+* order, so only its head and the window need looking at.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "apiserver.h"
+
+/* what follows a request, by its opcode */
+typedef union api_body
+{
+	api_batch_t batch;
+	api_subscribe_t filter;
+}api_body_t;
+
+/* epoll tags besides the connection slots */
+#define TAG_LISTEN      (APISERVER_MAX_CONNS)
+#define TAG_EVENT       (APISERVER_MAX_CONNS + 1)
+
+#define REQUEST_SIZE    (sizeof(api_request_t))
+#define REPLY_SIZE      (sizeof(api_reply_t))
+#define MAX_REQUEST_SIZE (REQUEST_SIZE + sizeof(api_body_t))
+#define EVENT_SIZE      (sizeof(uint32_t) + sizeof(Logger_t))    /* api_event_t on the wire */
+#define POLL_EVENTS     (64)
+
+
+static uint64_t now_us(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+/* requests read from the connection whose replies have not gone out */
+static uint32_t owed(const api_conn_t *c)
+{
+	return c->waiting + (c->out_len + REPLY_SIZE - 1) / REPLY_SIZE;
+}
+
+static void mark_dirty(apiserver_t *s, uint16_t i)
+{
+	if(!s->conns[i].dirty)
+	{
+		s->conns[i].dirty = 1;
+		s->dirty[s->ndirty++] = i;
+	}
+}
+
+/* drops one reference to a published record */
+static void release(api_event_buf_t *buf)
+{
+	if(--buf->refs == 0)
+		free(buf);
+}
+
+static void sub_end(apiserver_t *s, uint16_t i)
+{
+	api_sub_t *sub = s->conns[i].sub;
+	uint32_t k;
+
+	for(k = 0; k < sub->count; k++)
+		release(sub->queue[(sub->head + k) % APISERVER_SUB_QUEUE].buf);
+	free(sub);
+	s->conns[i].sub = NULL;
+	for(k = 0; s->subs[k] != i; k++)
+		;
+	s->subs[k] = s->subs[--s->nsubs];
+	s->stats.subscribers--;
+}
+
+static void conn_close(apiserver_t *s, uint16_t i)
+{
+	api_conn_t *c = &s->conns[i];
+
+	if(c->sub)
+		sub_end(s, i);
+	epoll_ctl(s->epoll_fd, EPOLL_CTL_DEL, c->fd, NULL);
+	close(c->fd);
+	c->fd = -1;
+	c->gen++;
+	s->stats.closed++;
+	s->stats.connections--;
+}
+
+/* a batch reply carries its results, zero unless the TIVA answered */
+static void conn_reply(apiserver_t *s, uint16_t i, uint32_t gen, uint32_t id, uint16_t opcode,
+		       int32_t status, uint32_t value, const api_result_t *result)
+{
+	api_conn_t *c = &s->conns[i];
+	api_reply_t reply;
+	api_batch_reply_t results;
+
+	if(status != API_OK)
+		s->stats.errors++;
+	/* the client has gone, or the slot belongs to another one now */
+	if(c->fd < 0 || c->gen != gen)
+		return;
+
+	reply.id = id;
+	reply.status = status;
+	reply.value = value;
+	memcpy(c->out + c->out_len, &reply, REPLY_SIZE);
+	c->out_len += REPLY_SIZE;
+	if(opcode == API_OP_BATCH)
+	{
+		memset(&results, 0, sizeof(results));
+		if(result && value <= API_BATCH_MAX)
+			memcpy(results.result, result, value * sizeof(result[0]));
+		memcpy(c->out + c->out_len, &results, sizeof(results));
+		c->out_len += sizeof(results);
+	}
+	c->waiting--;
+	mark_dirty(s, i);
+}
+
+static void record_latency(apiserver_hist_t *hist, uint64_t us)
+{
+	int bucket = 0;
+
+	while(bucket < APISERVER_HIST_BUCKETS - 1 && us >> (bucket + 1))
+		bucket++;
+	hist->count[bucket]++;
+	hist->total_us += us;
+	if(us > hist->max_us)
+		hist->max_us = us;
+}
+
+/* 1 to API_BATCH_MAX commands the TIVA knows, the relay ones with an
+ * on or off argument */
+static int batch_valid(const api_batch_t *batch)
+{
+	uint32_t k;
+	uint16_t op;
+
+	if(!batch->count || batch->count > API_BATCH_MAX)
+		return 0;
+	for(k = 0; k < batch->count; k++)
+	{
+		op = batch->cmd[k].opcode;
+		if(!op || op >= API_OP_BATCH)
+			return 0;
+		if((op == API_OP_RELAY0_SET || op == API_OP_RELAY1_SET) && batch->cmd[k].arg > 1)
+			return 0;
+	}
+	return 1;
+}
+
+/* drops the cached status of the relays a request switches, until the
+ * relay task reports them again */
+static void forget_relays(apiserver_t *s, uint16_t opcode, const api_batch_t *batch)
+{
+	uint32_t k, n = 1;
+	uint16_t op;
+
+	if(opcode == API_OP_BATCH)
+		n = batch->count;
+	for(k = 0; k < n; k++)
+	{
+		op = opcode == API_OP_BATCH ? batch->cmd[k].opcode : opcode;
+		if(op == API_OP_RELAYS_ON || op == API_OP_RELAYS_OFF || op == API_OP_RELAY0_SET)
+			apicache_forget(s->cache, API_OP_RELAY0_STATUS);
+		if(op == API_OP_RELAYS_ON || op == API_OP_RELAYS_OFF || op == API_OP_RELAY1_SET)
+			apicache_forget(s->cache, API_OP_RELAY1_STATUS);
+	}
+}
+
+/* bytes following a request */
+static size_t body_size(uint16_t opcode)
+{
+	if(opcode == API_OP_BATCH)
+		return sizeof(api_batch_t);
+	if(opcode == API_OP_SUBSCRIBE)
+		return sizeof(api_subscribe_t);
+	return 0;
+}
+
+/* turns the connection into a stream of records passing filter */
+static void subscribe(apiserver_t *s, uint16_t i, const api_request_t *req, const api_subscribe_t *filter)
+{
+	api_conn_t *c = &s->conns[i];
+
+	/* the records would be mixed in with the replies still to come */
+	if(req->flags || c->waiting != 1 || !(c->sub = calloc(1, sizeof(api_sub_t))))
+	{
+		conn_reply(s, i, c->gen, req->id, req->opcode, req->flags ? API_EINVAL : API_EBUSY, 0, NULL);
+		return;
+	}
+	c->sub->filter = *filter;
+	s->subs[s->nsubs++] = i;
+	s->stats.subscribers++;
+	conn_reply(s, i, c->gen, req->id, req->opcode, API_OK, 0, NULL);
+}
+
+/* queues a request for the TIVA, or answers it at once from the cache
+ * or when it cannot go; body follows an API_OP_BATCH or API_OP_SUBSCRIBE
+ * request */
+static void submit(apiserver_t *s, uint16_t i, const api_request_t *req, const void *body)
+{
+	api_conn_t *c = &s->conns[i];
+	const api_batch_t *batch = body;
+	api_pending_t *p;
+	uint64_t start = now_us();
+	uint32_t value;
+
+	if(req->opcode == API_OP_SUBSCRIBE)
+	{
+		subscribe(s, i, req, body);
+		return;
+	}
+
+	/* the relay set commands need the argument only a batch carries */
+	if(!req->opcode || req->opcode > API_OP_MAX || (req->flags & ~API_FLAG_REFRESH) ||
+	   req->opcode == API_OP_RELAY0_SET || req->opcode == API_OP_RELAY1_SET ||
+	   (req->opcode == API_OP_BATCH && !batch_valid(batch)))
+	{
+		conn_reply(s, i, c->gen, req->id, req->opcode, API_EINVAL, 0, NULL);
+		return;
+	}
+	if(s->cache)
+		forget_relays(s, req->opcode, batch);
+	if(s->cache && !(req->flags & API_FLAG_REFRESH) && apicache_get(s->cache, req->opcode, &value))
+	{
+		s->stats.cached++;
+		record_latency(&s->cache_hist[req->opcode], now_us() - start);
+		conn_reply(s, i, c->gen, req->id, req->opcode, API_OK, value, NULL);
+		return;
+	}
+	if(s->count == APISERVER_BACKLOG)
+	{
+		conn_reply(s, i, c->gen, req->id, req->opcode, API_EBUSY, 0, NULL);
+		return;
+	}
+
+	p = &s->backlog[(s->head + s->count++) % APISERVER_BACKLOG];
+	p->corr = s->next_corr;
+	s->next_corr = (s->next_corr + 1) & APISERVER_CORR_MASK;
+	if(!s->next_corr)
+		s->next_corr = 1;
+	p->id = req->id;
+	p->opcode = req->opcode;
+	p->conn = i;
+	p->gen = c->gen;
+	p->start = start;
+	p->deadline = p->start + (uint64_t)s->timeout_ms * 1000;
+	if(req->opcode == API_OP_BATCH)
+		p->batch = *batch;
+	if(s->count > s->stats.backlog_high)
+		s->stats.backlog_high = s->count;
+}
+
+static void timed_out(apiserver_t *s, api_pending_t *p)
+{
+	s->stats.timeouts++;
+	s->hist[p->opcode].timeouts++;
+	conn_reply(s, p->conn, p->gen, p->id, p->opcode, API_ETIMEDOUT, 0, NULL);
+}
+
+/* fails what is past its deadline, on the link or still waiting for it */
+static void expire(apiserver_t *s, uint64_t now)
+{
+	api_pending_t *p;
+	int k;
+
+	for(k = 0; k < APISERVER_WINDOW && s->ninflight; k++)
+	{
+		p = &s->inflight[k];
+		if(p->corr && p->deadline <= now)
+		{
+			timed_out(s, p);
+			p->corr = 0;
+			s->ninflight--;
+		}
+	}
+	while(s->count && s->backlog[s->head].deadline <= now)
+	{
+		timed_out(s, &s->backlog[s->head]);
+		s->head = (s->head + 1) % APISERVER_BACKLOG;
+		s->count--;
+	}
+}
+
+/* ms until the earliest deadline, capped at timeout_ms */
+static int next_deadline(apiserver_t *s, int timeout_ms)
+{
+	uint64_t first = UINT64_MAX, now;
+	int k;
+
+	for(k = 0; k < APISERVER_WINDOW && s->ninflight; k++)
+		if(s->inflight[k].corr && s->inflight[k].deadline < first)
+			first = s->inflight[k].deadline;
+	if(s->count && s->backlog[s->head].deadline < first)
+		first = s->backlog[s->head].deadline;
+	if(first == UINT64_MAX)
+		return timeout_ms;
+
+	now = now_us();
+	if(first <= now)
+		return 0;
+	if(timeout_ms >= 0 && (first - now + 999) / 1000 > (uint64_t)timeout_ms)
+		return timeout_ms;
+	return (first - now + 999) / 1000;
+}
+
+/* puts requests on the link while the window has room */
+static void pump(apiserver_t *s)
+{
+	api_pending_t *p;
+	int k;
+
+	while(s->ninflight < APISERVER_WINDOW && s->count)
+	{
+		p = &s->backlog[s->head];
+		s->head = (s->head + 1) % APISERVER_BACKLOG;
+		s->count--;
+		if(s->link(p->corr, p->opcode, p->opcode == API_OP_BATCH ? &p->batch : NULL, s->link_arg))
+		{
+			conn_reply(s, p->conn, p->gen, p->id, p->opcode, API_EIO, 0, NULL);
+			continue;
+		}
+		for(k = 0; s->inflight[k].corr; k++)
+			;
+		s->inflight[k] = *p;
+		s->ninflight++;
+	}
+}
+
+static void accept_all(apiserver_t *s)
+{
+	struct epoll_event ev;
+	api_conn_t *c;
+	int fd, option = 1;
+	uint16_t i;
+
+	while((fd = accept4(s->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+	{
+		for(i = 0; i < APISERVER_MAX_CONNS && s->conns[i].fd >= 0; i++)
+			;
+		if(i == APISERVER_MAX_CONNS)
+		{
+			close(fd);
+			s->stats.refused++;
+			continue;
+		}
+
+		/* replies are small and already batched per round */
+		setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		if(epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, fd, &ev))
+		{
+			close(fd);
+			continue;
+		}
+		c = &s->conns[i];
+		c->fd = fd;
+		c->events = EPOLLIN;
+		c->eof = 0;
+		c->waiting = 0;
+		c->in_len = 0;
+		c->out_len = 0;
+		s->stats.accepted++;
+		s->stats.connections++;
+	}
+}
+
+static void conn_read(apiserver_t *s, uint16_t i)
+{
+	api_conn_t *c = &s->conns[i];
+	api_request_t req;
+	api_body_t body;
+	size_t room, off, size;
+	ssize_t n;
+
+	if(c->eof || owed(c) >= APISERVER_PIPELINE)
+		return;
+
+	/* no more than the pipeline has room for, the rest waits in the kernel;
+	 * what is left over is at most one request, and one whose header is
+	 * in may always have the rest of its body. A subscriber's are thrown
+	 * away, the read is only there to see it close. */
+	room = (APISERVER_PIPELINE - owed(c)) * REQUEST_SIZE;
+	room = room > c->in_len ? room - c->in_len : 0;
+	if(c->in_len >= REQUEST_SIZE && room < MAX_REQUEST_SIZE - c->in_len)
+		room = MAX_REQUEST_SIZE - c->in_len;
+	if(c->sub)
+		room = sizeof(c->in) - c->in_len;
+	n = recv(c->fd, c->in + c->in_len, room, 0);
+	if(n == 0)
+	{
+		c->eof = 1;
+		mark_dirty(s, i);
+		return;
+	}
+	if(n < 0)
+	{
+		if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+			conn_close(s, i);
+		return;
+	}
+
+	c->in_len += n;
+	for(off = 0; !c->sub && c->in_len - off >= REQUEST_SIZE; off += size)
+	{
+		memcpy(&req, c->in + off, REQUEST_SIZE);
+		size = REQUEST_SIZE + body_size(req.opcode);
+		if(c->in_len - off < size)
+			break;
+		memcpy(&body, c->in + off + REQUEST_SIZE, size - REQUEST_SIZE);
+		c->waiting++;
+		s->stats.requests++;
+		submit(s, i, &req, &body);
+	}
+	if(c->sub)
+		off = c->in_len;
+	memmove(c->in, c->in + off, c->in_len - off);
+	c->in_len -= off;
+	mark_dirty(s, i);
+}
+
+/* takes the answers the communication thread handed over */
+static void take_answers(apiserver_t *s)
+{
+	api_answer_t answers[APISERVER_REPLIES];
+	api_pending_t *p;
+	uint32_t count, k, w;
+	uint64_t rung, now;
+
+	if(read(s->event_fd, &rung, sizeof(rung)) < 0)
+		return;
+
+	pthread_mutex_lock(&s->lock);
+	count = s->answer_count;
+	memcpy(answers, s->answers, count * sizeof(answers[0]));
+	s->answer_count = 0;
+	pthread_mutex_unlock(&s->lock);
+
+	now = now_us();
+	for(k = 0; k < count; k++)
+	{
+		p = NULL;
+		for(w = 0; answers[k].corr && w < APISERVER_WINDOW; w++)
+		{
+			if(s->inflight[w].corr == answers[k].corr)
+			{
+				p = &s->inflight[w];
+				break;
+			}
+		}
+		if(!p || answers[k].batch != (p->opcode == API_OP_BATCH))
+		{
+			s->stats.unmatched++;
+			continue;
+		}
+		s->stats.replies++;
+		record_latency(&s->hist[p->opcode], now - p->start);
+		conn_reply(s, p->conn, p->gen, p->id, p->opcode, answers[k].status, answers[k].value, answers[k].result);
+		p->corr = 0;
+		s->ninflight--;
+	}
+}
+
+static int sub_match(const api_subscribe_t *filter, const api_event_buf_t *buf)
+{
+	if(filter->sources && (buf->log.log_source >= 32 || !(filter->sources & 1u << buf->log.log_source)))
+		return 0;
+	if(filter->levels && (buf->log.log_level >= 32 || !(filter->levels & 1u << buf->log.log_level)))
+		return 0;
+	return (buf->events & filter->events) == filter->events;
+}
+
+/* hands the published records to the subscribers they pass, a reference each */
+static void take_events(apiserver_t *s)
+{
+	api_event_buf_t *events[APISERVER_EVENTS], *buf;
+	api_sub_t *sub;
+	api_sub_slot_t *slot;
+	uint32_t count, k, n;
+
+	pthread_mutex_lock(&s->lock);
+	count = s->event_count;
+	memcpy(events, s->events, count * sizeof(events[0]));
+	s->event_count = 0;
+	pthread_mutex_unlock(&s->lock);
+
+	for(k = 0; k < count; k++)
+	{
+		buf = events[k];
+		s->stats.published++;
+		for(n = 0; n < s->nsubs; n++)
+		{
+			sub = s->conns[s->subs[n]].sub;
+			if(!sub_match(&sub->filter, buf))
+				continue;
+			if(sub->count == APISERVER_SUB_QUEUE)
+			{
+				sub->dropped++;
+				s->stats.sub_drops++;
+				continue;
+			}
+			slot = &sub->queue[(sub->head + sub->count++) % APISERVER_SUB_QUEUE];
+			slot->buf = buf;
+			slot->dropped = sub->dropped;
+			buf->refs++;
+			mark_dirty(s, s->subs[n]);
+		}
+		/* the publisher's */
+		release(buf);
+	}
+}
+
+/* sends what a subscriber has queued in one call: each record's dropped
+ * count from its slot, the record itself from the shared buffer */
+static int sub_send(api_conn_t *c)
+{
+	api_sub_t *sub = c->sub;
+	api_sub_slot_t *slot;
+	struct iovec iov[2 * APISERVER_SUB_QUEUE];
+	struct msghdr msg;
+	uint32_t k, niov = 0, first = 0;
+	size_t skip = sub->off, sent;
+	ssize_t n;
+
+	if(!sub->count)
+		return 0;
+	for(k = 0; k < sub->count; k++)
+	{
+		slot = &sub->queue[(sub->head + k) % APISERVER_SUB_QUEUE];
+		iov[niov].iov_base = &slot->dropped;
+		iov[niov++].iov_len = sizeof(slot->dropped);
+		iov[niov].iov_base = &slot->buf->log;
+		iov[niov++].iov_len = sizeof(Logger_t);
+	}
+	/* the head record may have gone out in part */
+	while(skip >= iov[first].iov_len)
+		skip -= iov[first++].iov_len;
+	iov[first].iov_base = (uint8_t *)iov[first].iov_base + skip;
+	iov[first].iov_len -= skip;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = &iov[first];
+	msg.msg_iovlen = niov - first;
+	if((n = sendmsg(c->fd, &msg, MSG_NOSIGNAL)) < 0)
+		return -1;
+
+	for(sent = sub->off + n; sub->count && sent >= EVENT_SIZE; sent -= EVENT_SIZE)
+	{
+		release(sub->queue[sub->head].buf);
+		sub->head = (sub->head + 1) % APISERVER_SUB_QUEUE;
+		sub->count--;
+	}
+	sub->off = sent;
+	return 0;
+}
+
+/* writes out what the round produced and sets what epoll watches for */
+static void flush_dirty(apiserver_t *s)
+{
+	struct epoll_event ev;
+	api_conn_t *c;
+	uint32_t k, events;
+	uint16_t i;
+	ssize_t n;
+
+	for(k = 0; k < s->ndirty; k++)
+	{
+		i = s->dirty[k];
+		c = &s->conns[i];
+		c->dirty = 0;
+		if(c->fd < 0)
+			continue;
+
+		while(c->out_len)
+		{
+			n = send(c->fd, c->out, c->out_len, MSG_NOSIGNAL);
+			if(n < 0)
+				break;
+			memmove(c->out, c->out + n, c->out_len - n);
+			c->out_len -= n;
+		}
+		if(c->out_len && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			conn_close(s, i);
+			continue;
+		}
+		/* records after the subscribe reply */
+		if(!c->out_len && c->sub && sub_send(c) < 0 &&
+		   errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+		{
+			conn_close(s, i);
+			continue;
+		}
+
+		if(c->eof && !owed(c))
+		{
+			conn_close(s, i);
+			continue;
+		}
+		events = 0;
+		if(!c->eof && owed(c) < APISERVER_PIPELINE)
+			events |= EPOLLIN;
+		else if(!c->eof && (c->events & EPOLLIN))
+			s->stats.stalls++;
+		if(c->out_len || (c->sub && c->sub->count))
+			events |= EPOLLOUT;
+		if(events != c->events)
+		{
+			ev.events = events;
+			ev.data.u32 = i;
+			epoll_ctl(s->epoll_fd, EPOLL_CTL_MOD, c->fd, &ev);
+			c->events = events;
+		}
+	}
+	s->ndirty = 0;
+}
+
+
+int apiserver_init(apiserver_t *s, uint16_t port, apiserver_link_t link, void *arg)
+{
+	struct sockaddr_in address;
+	struct epoll_event ev;
+	int option = 1, err;
+	uint16_t i;
+
+	memset(s, 0, sizeof(*s));
+	s->listen_fd = s->epoll_fd = s->event_fd = -1;
+	s->link = link;
+	s->link_arg = arg;
+	s->next_corr = 1;
+	s->timeout_ms = APISERVER_TIMEOUT_MS;
+	pthread_mutex_init(&s->lock, NULL);
+
+	s->conns = calloc(APISERVER_MAX_CONNS, sizeof(api_conn_t));
+	s->backlog = calloc(APISERVER_BACKLOG, sizeof(api_pending_t));
+	if(!s->conns || !s->backlog)
+	{
+		errno = ENOMEM;
+		goto fail;
+	}
+	for(i = 0; i < APISERVER_MAX_CONNS; i++)
+		s->conns[i].fd = -1;
+
+	if((s->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0)
+		goto fail;
+	if(setsockopt(s->listen_fd, SOL_SOCKET, SO_REUSEADDR, &option, sizeof(option)))
+		goto fail;
+
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = INADDR_ANY;
+	address.sin_port = htons(port);
+	if(bind(s->listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0)
+		goto fail;
+	if(listen(s->listen_fd, SOMAXCONN) < 0)
+		goto fail;
+
+	if((s->epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+		goto fail;
+	if((s->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0)
+		goto fail;
+
+	ev.events = EPOLLIN;
+	ev.data.u32 = TAG_LISTEN;
+	if(epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->listen_fd, &ev))
+		goto fail;
+	ev.data.u32 = TAG_EVENT;
+	if(epoll_ctl(s->epoll_fd, EPOLL_CTL_ADD, s->event_fd, &ev))
+		goto fail;
+	return 0;
+
+fail:
+	err = errno;
+	apiserver_close(s);
+	errno = err;
+	return -1;
+}
+
+uint16_t apiserver_port(apiserver_t *s)
+{
+	struct sockaddr_in address;
+	socklen_t len = sizeof(address);
+
+	if(getsockname(s->listen_fd, (struct sockaddr *)&address, &len))
+		return 0;
+	return ntohs(address.sin_port);
+}
+
+void apiserver_set_timeout(apiserver_t *s, uint32_t ms)
+{
+	s->timeout_ms = ms;
+}
+
+void apiserver_set_cache(apiserver_t *s, apicache_t *cache)
+{
+	s->cache = cache;
+}
+
+int apiserver_poll(apiserver_t *s, int timeout_ms)
+{
+	struct epoll_event events[POLL_EVENTS];
+	api_conn_t *c;
+	uint32_t tag;
+	int n, k;
+
+	n = epoll_wait(s->epoll_fd, events, POLL_EVENTS, next_deadline(s, timeout_ms));
+	if(n < 0)
+		return errno == EINTR ? 0 : -1;
+
+	for(k = 0; k < n; k++)
+	{
+		tag = events[k].data.u32;
+		if(tag == TAG_LISTEN)
+		{
+			accept_all(s);
+			continue;
+		}
+		if(tag == TAG_EVENT)
+		{
+			take_answers(s);
+			take_events(s);
+			continue;
+		}
+
+		c = &s->conns[tag];
+		if(c->fd < 0)
+			continue;
+		if(events[k].events & EPOLLERR)
+		{
+			conn_close(s, tag);
+			continue;
+		}
+		if(events[k].events & EPOLLIN)
+			conn_read(s, tag);
+		if(c->fd >= 0 && (events[k].events & (EPOLLOUT | EPOLLHUP)))
+		{
+			/* a hangup while reads are held back still needs the replies out */
+			if(events[k].events & EPOLLHUP)
+				c->eof = 1;
+			mark_dirty(s, tag);
+		}
+	}
+
+	expire(s, now_us());
+	pump(s);
+	flush_dirty(s);
+	return n;
+}
+
+static void answer(apiserver_t *s, uint32_t corr, int32_t status, uint32_t value, const api_result_t *result)
+{
+	uint64_t one = 1;
+
+	pthread_mutex_lock(&s->lock);
+	if(s->answer_count < APISERVER_REPLIES)
+	{
+		s->answers[s->answer_count].corr = corr;
+		s->answers[s->answer_count].status = status;
+		s->answers[s->answer_count].value = value;
+		s->answers[s->answer_count].batch = result != NULL;
+		if(result)
+			memcpy(s->answers[s->answer_count].result, result, value * sizeof(result[0]));
+		s->answer_count++;
+	}
+	else
+		s->overruns++;
+	pthread_mutex_unlock(&s->lock);
+
+	write(s->event_fd, &one, sizeof(one));
+}
+
+void apiserver_reply(apiserver_t *s, uint32_t corr, int32_t status, uint32_t value)
+{
+	answer(s, corr, status, value, NULL);
+}
+
+void apiserver_reply_batch(apiserver_t *s, uint32_t corr, const api_result_t *result, uint32_t count)
+{
+	answer(s, corr, API_OK, count > API_BATCH_MAX ? API_BATCH_MAX : count, result);
+}
+
+void apiserver_publish(apiserver_t *s, const Logger_t *log, uint32_t events)
+{
+	api_event_buf_t *buf;
+	uint64_t one = 1;
+
+	if(!s->nsubs || !(buf = malloc(sizeof(*buf))))
+		return;
+	buf->refs = 1;
+	buf->events = events;
+	buf->log = *log;
+
+	pthread_mutex_lock(&s->lock);
+	if(s->event_count < APISERVER_EVENTS)
+		s->events[s->event_count++] = buf;
+	else
+	{
+		s->event_overruns++;
+		free(buf);
+		buf = NULL;
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	if(buf)
+		write(s->event_fd, &one, sizeof(one));
+}
+
+void apiserver_get_stats(apiserver_t *s, apiserver_stats_t *stats)
+{
+	*stats = s->stats;
+	pthread_mutex_lock(&s->lock);
+	stats->overruns = s->overruns;
+	stats->event_overruns = s->event_overruns;
+	pthread_mutex_unlock(&s->lock);
+}
+
+/* latency below which a share of the counts fall, from the bucket tops */
+static uint64_t hist_percentile(const apiserver_hist_t *hist, uint32_t total, uint32_t per100)
+{
+	uint64_t seen = 0;
+	int bucket;
+
+	for(bucket = 0; bucket < APISERVER_HIST_BUCKETS; bucket++)
+	{
+		seen += hist->count[bucket];
+		if(seen * 100 >= (uint64_t)total * per100)
+			break;
+	}
+	return (2ull << bucket) < hist->max_us ? 2ull << bucket : hist->max_us;
+}
+
+static void report_hist(FILE *fp, int op, const char *by, const apiserver_hist_t *hist)
+{
+	uint32_t total;
+	int bucket;
+
+	for(total = 0, bucket = 0; bucket < APISERVER_HIST_BUCKETS; bucket++)
+		total += hist->count[bucket];
+	if(!total && !hist->timeouts)
+		return;
+	fprintf(fp, "API: opcode %2d %-5s %8u answered %6u timed out  mean %8.2f ms  p50 < %8.2f ms"
+			"  p99 < %8.2f ms  max %8.2f ms\n", op, by, total, hist->timeouts,
+			total ? hist->total_us / 1000.0 / total : 0,
+			total ? hist_percentile(hist, total, 50) / 1000.0 : 0,
+			total ? hist_percentile(hist, total, 99) / 1000.0 : 0, hist->max_us / 1000.0);
+}
+
+void apiserver_report(apiserver_t *s, FILE *fp)
+{
+	int op;
+
+	for(op = 1; op <= API_OP_MAX; op++)
+	{
+		report_hist(fp, op, "tiva", &s->hist[op]);
+		report_hist(fp, op, "cache", &s->cache_hist[op]);
+	}
+	if(s->stats.published)
+		fprintf(fp, "API: %u subscribers  %llu records published  %llu lost to full subscriber queues\n",
+				s->stats.subscribers, (unsigned long long)s->stats.published,
+				(unsigned long long)s->stats.sub_drops);
+}
+
+void apiserver_close(apiserver_t *s)
+{
+	uint16_t i;
+
+	if(s->conns)
+	{
+		for(i = 0; i < APISERVER_MAX_CONNS; i++)
+			if(s->conns[i].fd >= 0)
+				conn_close(s, i);
+		free(s->conns);
+		s->conns = NULL;
+	}
+	free(s->backlog);
+	s->backlog = NULL;
+	while(s->event_count)
+		free(s->events[--s->event_count]);
+	if(s->listen_fd >= 0)
+		close(s->listen_fd);
+	if(s->epoll_fd >= 0)
+		close(s->epoll_fd);
+	if(s->event_fd >= 0)
+		close(s->event_fd);
+	s->listen_fd = s->epoll_fd = s->event_fd = -1;
+}
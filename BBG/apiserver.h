@@ -0,0 +1,217 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file apiserver.h
+* @brief Client API server: persistent, pipelined connections multiplexed on one epoll thread
+*
+* Clients keep their connection open and may send up to APISERVER_PIPELINE
+* requests before reading the replies. A connection with that many
+* unanswered is not read until replies go out, so a client that stops
+* reading only holds itself back. Each request gets a correlation ID and
+* waits in a FIFO for the TIVA link, which carries up to APISERVER_WINDOW
+* at once; the TIVA echoes the ID, and the communication thread hands the
+* answer over to complete that request. A request not answered by its
+* deadline fails with API_ETIMEDOUT; if the answer turns up later it is
+* counted as unmatched, the command itself may still have been carried out.
+* With a cache set, status and ID reads it can answer never reach the
+* TIVA; API_FLAG_REFRESH makes them. A batch goes to the TIVA as one
+* request and comes back as one answer with a result per command.
+*
+* Records published by the communication thread are copied once into a
+* reference counted buffer; every subscriber it passes queues a pointer
+* to it, and it is freed when the last one has sent it. A subscriber
+* with APISERVER_SUB_QUEUE records unsent loses the next ones.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef _APISERVER_H
+#define _APISERVER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "socket.h"
+#include "apicache.h"
+
+#define APISERVER_MAX_CONNS     (256)
+#define APISERVER_PIPELINE      (32)      /* unanswered requests per connection */
+#define APISERVER_BACKLOG       (1024)    /* requests waiting for the TIVA */
+#define APISERVER_REPLIES       (64)      /* TIVA answers not yet taken by the server thread */
+#define APISERVER_WINDOW        (8)       /* requests on the TIVA link at once */
+#define APISERVER_TIMEOUT_MS    (500)     /* from the request being read to its answer */
+#define APISERVER_HIST_BUCKETS  (24)      /* bucket n counts latencies of 2^n to 2^(n+1) us */
+#define APISERVER_CORR_MASK     (0xFFFF)  /* the link carries 16 bit IDs */
+#define APISERVER_SUB_QUEUE     (64)      /* records waiting to go to one subscriber */
+#define APISERVER_EVENTS        (256)     /* published records not yet taken by the server thread */
+
+/* writes one request to the TIVA, 0 when it went out; batch is NULL but
+ * for API_OP_BATCH. The answer is handed back to apiserver_reply(), or
+ * apiserver_reply_batch(), with the same corr */
+typedef int (*apiserver_link_t)(uint32_t corr, uint8_t opcode, const api_batch_t *batch, void *arg);
+
+typedef struct api_pending
+{
+	uint32_t corr;          /* correlation ID */
+	uint32_t id;            /* the client's request id */
+	uint16_t opcode;
+	uint16_t conn;
+	uint32_t gen;           /* of the connection slot when the request was read */
+	uint64_t start;         /* us, when it was read */
+	uint64_t deadline;      /* us */
+	api_batch_t batch;      /* API_OP_BATCH only */
+}api_pending_t;
+
+typedef struct api_answer
+{
+	uint32_t corr;
+	int32_t status;         /* API_OK or API_EFAILED, API_OK for a batch */
+	uint32_t value;         /* the result count of a batch */
+	uint8_t batch;          /* from apiserver_reply_batch() */
+	api_result_t result[API_BATCH_MAX];
+}api_answer_t;
+
+/* one published record, shared by the subscribers it passes */
+typedef struct api_event_buf
+{
+	uint32_t refs;          /* server thread only once published */
+	uint32_t events;        /* API_EVENT_* */
+	Logger_t log;
+}api_event_buf_t;
+
+typedef struct api_sub_slot
+{
+	api_event_buf_t *buf;
+	uint32_t dropped;       /* sent ahead of it, api_event_t.dropped */
+}api_sub_slot_t;
+
+typedef struct api_sub
+{
+	api_subscribe_t filter;
+	api_sub_slot_t queue[APISERVER_SUB_QUEUE];
+	uint32_t head;
+	uint32_t count;
+	uint32_t off;           /* bytes of the head record sent */
+	uint32_t dropped;
+}api_sub_t;
+
+typedef struct api_conn
+{
+	int fd;                 /* -1 when the slot is free */
+	uint32_t gen;           /* bumped on close, late replies for the old client are dropped */
+	uint32_t events;        /* what epoll watches for */
+	uint8_t eof;            /* client shut down its side, close once answered */
+	uint8_t dirty;          /* has output or interest to update this round */
+	uint16_t waiting;       /* requests read and not answered yet */
+	api_sub_t *sub;         /* NULL unless subscribed */
+	size_t in_len;
+	size_t out_len;
+	uint8_t in[APISERVER_PIPELINE * sizeof(api_request_t)];
+	uint8_t out[APISERVER_PIPELINE * (sizeof(api_reply_t) + sizeof(api_batch_reply_t))];
+}api_conn_t;
+
+/* latency of the answered requests of one opcode */
+typedef struct apiserver_hist
+{
+	uint32_t count[APISERVER_HIST_BUCKETS];
+	uint32_t timeouts;
+	uint32_t max_us;
+	uint64_t total_us;
+}apiserver_hist_t;
+
+typedef struct apiserver_stats
+{
+	uint64_t accepted;
+	uint64_t refused;       /* no free connection slot */
+	uint64_t closed;
+	uint64_t requests;
+	uint64_t replies;       /* answered by the TIVA */
+	uint64_t cached;        /* answered from the cache */
+	uint64_t errors;        /* answered with an error status */
+	uint64_t timeouts;
+	uint64_t unmatched;     /* TIVA answers with no request in flight, late ones too,
+				 * or a batch answer to a single request and back */
+	uint64_t stalls;        /* reads held back by a full pipeline */
+	uint64_t overruns;      /* TIVA answers lost before the server thread took them */
+	uint64_t published;     /* records taken for subscribers */
+	uint64_t sub_drops;     /* records lost to a full subscriber queue */
+	uint64_t event_overruns; /* records lost before the server thread took them */
+	uint32_t connections;
+	uint32_t subscribers;
+	uint32_t backlog_high;
+}apiserver_stats_t;
+
+typedef struct apiserver
+{
+	int listen_fd;
+	int epoll_fd;
+	int event_fd;           /* the communication thread's doorbell */
+	apiserver_link_t link;
+	void *link_arg;
+	api_conn_t *conns;
+	uint16_t dirty[APISERVER_MAX_CONNS];
+	uint32_t ndirty;
+	uint16_t subs[APISERVER_MAX_CONNS];
+	volatile uint32_t nsubs;        /* read without the lock by publishers */
+
+	/* requests waiting for the TIVA, and the ones on the link; a free
+	 * inflight slot has corr 0 */
+	api_pending_t *backlog;
+	uint32_t head;
+	uint32_t count;
+	api_pending_t inflight[APISERVER_WINDOW];
+	uint32_t ninflight;
+	uint32_t next_corr;
+	uint32_t timeout_ms;
+	apicache_t *cache;      /* NULL when every request goes to the TIVA */
+
+	/* answers from the communication thread */
+	pthread_mutex_t lock;
+	api_answer_t answers[APISERVER_REPLIES];
+	uint32_t answer_count;
+	uint64_t overruns;
+	api_event_buf_t *events[APISERVER_EVENTS];
+	uint32_t event_count;
+	uint64_t event_overruns;
+
+	apiserver_stats_t stats;
+	apiserver_hist_t hist[API_OP_MAX + 1];
+	apiserver_hist_t cache_hist[API_OP_MAX + 1];
+}apiserver_t;
+
+/* listens on port, 0 picks a free one; -1 with errno set on failure */
+int apiserver_init(apiserver_t *s, uint16_t port, apiserver_link_t link, void *arg);
+
+uint16_t apiserver_port(apiserver_t *s);
+
+void apiserver_set_timeout(apiserver_t *s, uint32_t ms);
+
+/* answer read-only requests from cache, NULL to stop */
+void apiserver_set_cache(apiserver_t *s, apicache_t *cache);
+
+/* handles what is ready within timeout_ms, -1 when epoll failed */
+int apiserver_poll(apiserver_t *s, int timeout_ms);
+
+/* the TIVA's answer to request corr, 0 when it answered nothing sent;
+ * status API_EFAILED when it could not carry the request out; any thread */
+void apiserver_reply(apiserver_t *s, uint32_t corr, int32_t status, uint32_t value);
+
+/* the TIVA's results for batch corr, in command order; any thread */
+void apiserver_reply_batch(apiserver_t *s, uint32_t corr, const api_result_t *result, uint32_t count);
+
+/* a record for the subscribers, events the API_EVENT_* it is; any thread,
+ * nothing is copied while there are none */
+void apiserver_publish(apiserver_t *s, const Logger_t *log, uint32_t events);
+
+void apiserver_get_stats(apiserver_t *s, apiserver_stats_t *stats);
+
+/* latency percentiles per opcode, from the server thread */
+void apiserver_report(apiserver_t *s, FILE *fp);
+
+void apiserver_close(apiserver_t *s);
+
+#endif
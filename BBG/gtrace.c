@@ -0,0 +1,98 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gtrace.c
+* @brief Writes gesture FIFO captures from the TIVA to trace files
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "gtrace.h"
+
+/* same order as the DIR_ enum in gesture_sensor.h */
+static const char *dir_names[] = { "NONE", "LEFT", "RIGHT", "UP", "DOWN", "NEAR", "FAR" };
+
+const char *gtrace_dir_name(uint8_t dir)
+{
+	if(dir < sizeof(dir_names) / sizeof(dir_names[0]))
+		return dir_names[dir];
+	return "ERROR";
+}
+
+void gtrace_init(gtrace_t *trace, const char *dir)
+{
+	memset(trace, 0, sizeof(*trace));
+	trace->dir = dir;
+	trace->session = (long)time(NULL);
+}
+
+static void finish(gtrace_t *trace, const char *note)
+{
+	fprintf(trace->fp, "%s\n", note);
+	fclose(trace->fp);
+	trace->fp = NULL;
+}
+
+void gtrace_frame(gtrace_t *trace, const gesture_trace_t *rec)
+{
+	char path[GTRACE_PATH_MAX];
+	const uint8_t *set;
+	uint8_t i;
+
+	if(rec->flags & GESTURE_TRACE_START)
+	{
+		if(trace->fp)
+		{
+			trace->incomplete++;
+			finish(trace, "# incomplete");
+		}
+		snprintf(path, sizeof(path), "%s/g%ld_%04u.trace", trace->dir, trace->session, trace->gestures + trace->incomplete);
+		if(!(trace->fp = fopen(path, "w")))
+		{
+			perror("gesture trace");
+			return;
+		}
+		trace->id = rec->id;
+		trace->t0 = rec->tick;
+		fprintf(trace->fp, "# gesture %u captured from TIVA\n# u d l r tick\n", rec->id);
+	}
+
+	/* capture started mid gesture, or the start frame was lost */
+	if(!trace->fp)
+		return;
+	if(rec->id != trace->id)
+	{
+		trace->incomplete++;
+		finish(trace, "# incomplete");
+		return;
+	}
+
+	for(i = 0, set = rec->data; i < rec->count; i++, set += 4)
+		fprintf(trace->fp, "%u %u %u %u %u\n", set[0], set[1], set[2], set[3], rec->tick - trace->t0);
+	trace->datasets += rec->count;
+
+	if(rec->flags & GESTURE_TRACE_END)
+	{
+		fprintf(trace->fp, "# decided %s\n", gtrace_dir_name(rec->result));
+		fclose(trace->fp);
+		trace->fp = NULL;
+		trace->gestures++;
+	}
+}
+
+void gtrace_close(gtrace_t *trace)
+{
+	if(trace->fp)
+	{
+		trace->incomplete++;
+		finish(trace, "# incomplete");
+	}
+}
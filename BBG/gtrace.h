@@ -0,0 +1,51 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gtrace.h
+* @brief Writes gesture FIFO captures from the TIVA to trace files
+*
+* Every captured gesture becomes one text file in the trace directory,
+* one "u d l r tick" line per dataset, tick in ms from the first burst.
+* Datasets read in the same burst share a tick. The TIVA's decision is
+* recorded as "# decided"; add an "# expect" line to label the trace for
+* gesture_replay.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef _GTRACE_H
+#define _GTRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "include/gesture_trace.h"
+
+#define GTRACE_PATH_MAX         (256)
+
+typedef struct gtrace
+{
+	const char *dir;
+	FILE *fp;                 /* trace being written, NULL between gestures */
+	uint8_t id;               /* TIVA gesture id of fp */
+	uint32_t t0;              /* tick of its first burst */
+	long session;             /* start time, keeps file names unique across runs */
+	uint32_t gestures;        /* traces completed */
+	uint32_t datasets;
+	uint32_t incomplete;      /* traces cut short by a lost or missing frame */
+}gtrace_t;
+
+void gtrace_init(gtrace_t *trace, const char *dir);
+
+/* handles one decoded FRAME_TYPE_GESTURE_TRACE payload */
+void gtrace_frame(gtrace_t *trace, const gesture_trace_t *rec);
+
+void gtrace_close(gtrace_t *trace);
+
+/* DIR_* name, as in gesture_sensor.h */
+const char *gtrace_dir_name(uint8_t dir);
+
+#endif
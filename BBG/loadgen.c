@@ -0,0 +1,595 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file loadgen.c
+* @brief Load generator for the client API server: requests/s and p50/p99 latency per client count
+*
+* Opens the given number of connections and keeps depth requests in
+* flight on each until the request count is reached, then reports the
+* throughput and latency percentiles. -k reconnects for every request, the
+* way the old one-shot server had to be used.
+*
+* -s runs an apiserver in this process with a simulated TIVA that answers
+* after -l microseconds, one request at a time as the UART link does; the
+* default models a 57600 baud round trip: the request byte, the TIVA task
+* wake up, and the compact log record coming back. -d n loses
+* every nth answer, to see the server's timeouts (-t ms) at work; the
+* per-opcode latency report is printed at the end.
+*
+* The simulated TIVA's answers feed a response cache as the real ones do
+* in tiva_record, so after the first read of each value the status reads
+* are answered by the BBG; -m ms sets its maximum age, -m 0 turns it off,
+* and -f sends API_FLAG_REFRESH to measure the uncached path.
+*
+* -b n sends every request as a batch of n status reads, one round trip
+* on the link for all of them; the simulated TIVA adds the time each
+* further command and its result take on the wire. Compare with -f.
+*
+* -e n subscribes n more connections to every record before the runs, and
+* -w one that never reads; the simulated TIVA publishes a record for each
+* answer, as tiva_record does. What the readers received and were told
+* they lost is printed at the end, the stalled one only costs drops.
+*
+* loadgen [-s] [-l tiva_us] [-d n] [-t ms] [-m cache_ms] [-f] [-b n] [-e n] [-w] [-c clients,...] [-p depth]
+*         [-n requests] [-k] [host]
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include "socket.h"
+#include "apiserver.h"
+#include "apicache.h"
+#include "include/log_wire.h"
+#include "include/api_wire.h"
+
+#define DEFAULT_TIVA_US     (3000)
+#define UART_BYTE_US        (174)      /* 10 bits at 57600 baud */
+#define MAX_CLIENTS         (APISERVER_MAX_CONNS)
+
+typedef struct client
+{
+	int fd;
+	size_t in_len;
+	uint8_t in[APISERVER_PIPELINE * (sizeof(api_reply_t) + sizeof(api_batch_reply_t))];
+}client_t;
+
+/* a request on its way to the simulated TIVA */
+typedef struct tiva_req
+{
+	uint32_t corr;
+	uint8_t opcode;
+	api_batch_t batch;      /* API_OP_BATCH only */
+}tiva_req_t;
+
+static apiserver_t server;
+static volatile int server_end;
+static int tiva_pipe[2];
+static uint32_t tiva_us = DEFAULT_TIVA_US;
+static uint32_t tiva_drop;          /* lose every nth answer, 0 for none */
+static apicache_t cache;
+static uint16_t req_flags;          /* -f: API_FLAG_REFRESH */
+static uint32_t batch_size;         /* -b: commands per request, 0 for single requests */
+
+/* -e and -w subscribers */
+typedef struct watcher
+{
+	int fd;
+	size_t in_len;
+	uint8_t in[64 * sizeof(api_event_t)];
+	uint64_t received;
+	uint32_t dropped;       /* as the last record said */
+}watcher_t;
+
+static watcher_t watchers[MAX_CLIENTS];
+static int nwatch, stalled_fd = -1;
+static volatile int watch_end;
+
+static client_t clients[MAX_CLIENTS];
+static uint64_t *sent_at;           /* ns, by request id */
+static uint32_t *latency;           /* us, in completion order */
+static uint32_t next_id, completed, errors;
+
+static uint64_t now_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000000000ull + t.tv_nsec;
+}
+
+/* what the TIVA would answer: relay states, sensor ID 0xAB, or done */
+static uint32_t tiva_value(uint8_t opcode)
+{
+	switch(opcode)
+	{
+		case API_OP_RELAY0_STATUS:
+		case API_OP_RELAY1_STATUS:
+			return 0;
+		case API_OP_SENSOR_ID:
+			return 0xAB;
+		default:
+			return 1;
+	}
+}
+
+/* the record the TIVA answers a read with, for the cache */
+static uint16_t tiva_msg(uint8_t opcode)
+{
+	switch(opcode)
+	{
+		case API_OP_RELAY0_STATUS:
+			return LOG_MSG_STATUS_RELAY0_TURNED_OFF;
+		case API_OP_RELAY1_STATUS:
+			return LOG_MSG_STATUS_RELAY1_TURNED_OFF;
+		case API_OP_SENSOR_ID:
+			return LOG_MSG_READING_ID_SUCCESS;
+		default:
+			return LOG_MSG_NO_RESPONSE;
+	}
+}
+
+/* the record the answer is logged with, for the subscribers */
+static void tiva_publish(uint8_t opcode)
+{
+	Logger_t log;
+
+	memset(&log, 0, sizeof(log));
+	log.value = tiva_value(opcode);
+	log.timestamp = time(NULL);
+	log.log_level = LOG_LEVEL_INFO;
+	log.log_source = LOG_SOURCE_TIVA_CLIENT;
+	snprintf(log.message, MSG_SIZE, "%s", log_wire_text(tiva_msg(opcode)));
+	apiserver_publish(&server, &log, 0);
+}
+
+static int tiva_link(uint32_t corr, uint8_t opcode, const api_batch_t *batch, void *arg)
+{
+	tiva_req_t req = { .corr = corr, .opcode = opcode };
+
+	(void)arg;
+	if(batch)
+		req.batch = *batch;
+	return write(tiva_pipe[1], &req, sizeof(req)) == sizeof(req) ? 0 : -1;
+}
+
+/* answers each request in turn, as vbbgReceive does */
+static void* tiva(void *arg)
+{
+	tiva_req_t req;
+	api_result_t result[API_BATCH_MAX];
+	uint32_t answered = 0, k;
+
+	(void)arg;
+	while(read(tiva_pipe[0], &req, sizeof(req)) == sizeof(req))
+	{
+		if(tiva_us)
+			usleep(tiva_us + (req.opcode == API_OP_BATCH ? (req.batch.count - 1) *
+				(API_WIRE_CMD_SIZE + API_WIRE_RESULT_SIZE) * UART_BYTE_US : 0));
+		if(tiva_drop && ++answered % tiva_drop == 0)
+			continue;
+		tiva_publish(req.opcode);
+		if(req.opcode != API_OP_BATCH)
+		{
+			apicache_record(&cache, tiva_msg(req.opcode), tiva_value(req.opcode));
+			apiserver_reply(&server, req.corr, API_OK, tiva_value(req.opcode));
+			continue;
+		}
+		/* the whole batch in the one round trip */
+		for(k = 0; k < req.batch.count; k++)
+		{
+			apicache_record(&cache, tiva_msg(req.batch.cmd[k].opcode), tiva_value(req.batch.cmd[k].opcode));
+			result[k].status = API_OK;
+			result[k].value = tiva_value(req.batch.cmd[k].opcode);
+		}
+		apiserver_reply_batch(&server, req.corr, result, req.batch.count);
+	}
+	return NULL;
+}
+
+static void* serve(void *arg)
+{
+	(void)arg;
+	while(!server_end)
+		apiserver_poll(&server, 100);
+	return NULL;
+}
+
+static int client_connect(struct sockaddr_in *address)
+{
+	int fd, option = 1;
+
+	if((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+		return -1;
+	if(connect(fd, (struct sockaddr *)address, sizeof(*address)) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(option));
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+	return fd;
+}
+
+static int client_send(client_t *c, uint32_t total)
+{
+	struct
+	{
+		api_request_t req;
+		api_batch_t batch;
+	}__attribute__((packed)) msg;
+	size_t size = sizeof(msg.req);
+	uint32_t k;
+
+	if(next_id == total)
+		return 0;
+	/* status reads only, they have no effect on the house */
+	msg.req.id = next_id;
+	msg.req.opcode = API_OP_RELAY0_STATUS + next_id % 3;
+	msg.req.flags = req_flags;
+	if(batch_size)
+	{
+		msg.req.opcode = API_OP_BATCH;
+		memset(&msg.batch, 0, sizeof(msg.batch));
+		msg.batch.count = batch_size;
+		for(k = 0; k < batch_size; k++)
+			msg.batch.cmd[k].opcode = API_OP_RELAY0_STATUS + k % 3;
+		size = sizeof(msg);
+	}
+	sent_at[next_id++] = now_ns();
+	if(send(c->fd, &msg, size, MSG_NOSIGNAL) != (ssize_t)size)
+		return -1;
+	return 0;
+}
+
+/* a blocking connection subscribed to every record */
+static int subscribe(struct sockaddr_in *address)
+{
+	struct
+	{
+		api_request_t req;
+		api_subscribe_t filter;
+	}msg;
+	api_reply_t reply;
+	int fd;
+
+	if((fd = socket(AF_INET, SOCK_STREAM, 0)) < 0)
+		return -1;
+	memset(&msg, 0, sizeof(msg));
+	msg.req.opcode = API_OP_SUBSCRIBE;
+	if(connect(fd, (struct sockaddr *)address, sizeof(*address)) < 0 ||
+	   send(fd, &msg, sizeof(msg), MSG_NOSIGNAL) != sizeof(msg) ||
+	   recv(fd, &reply, sizeof(reply), MSG_WAITALL) != sizeof(reply) || reply.status != API_OK)
+	{
+		close(fd);
+		return -1;
+	}
+	return fd;
+}
+
+static void* watch(void *arg)
+{
+	struct epoll_event ev, events[64];
+	api_event_t event;
+	watcher_t *w;
+	int epfd, n, k, i;
+	size_t off;
+	ssize_t got;
+
+	(void)arg;
+	epfd = epoll_create1(0);
+	for(i = 0; i < nwatch; i++)
+	{
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		epoll_ctl(epfd, EPOLL_CTL_ADD, watchers[i].fd, &ev);
+	}
+	while(!watch_end)
+	{
+		n = epoll_wait(epfd, events, 64, 100);
+		for(k = 0; k < n; k++)
+		{
+			w = &watchers[events[k].data.u32];
+			got = recv(w->fd, w->in + w->in_len, sizeof(w->in) - w->in_len, 0);
+			if(got <= 0)
+				continue;
+			w->in_len += got;
+			for(off = 0; w->in_len - off >= sizeof(event); off += sizeof(event))
+			{
+				memcpy(&event, w->in + off, sizeof(event));
+				w->received++;
+				w->dropped = event.dropped;
+			}
+			memmove(w->in, w->in + off, w->in_len - off);
+			w->in_len -= off;
+		}
+	}
+	close(epfd);
+	return NULL;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* one run: requests spread over nclients connections, depth in flight on each */
+static int run(struct sockaddr_in *address, int nclients, int depth, uint32_t total, int reconnect)
+{
+	struct epoll_event ev, events[64];
+	api_reply_t reply;
+	client_t *c;
+	uint64_t start, elapsed;
+	int epfd, n, k, i, d;
+	size_t off, size = sizeof(reply) + (batch_size ? sizeof(api_batch_reply_t) : 0);
+	ssize_t got;
+
+	next_id = completed = errors = 0;
+	if((epfd = epoll_create1(0)) < 0)
+		return -1;
+	start = now_ns();
+	for(i = 0; i < nclients; i++)
+	{
+		c = &clients[i];
+		memset(c, 0, sizeof(*c));
+		if((c->fd = client_connect(address)) < 0)
+		{
+			perror("connect");
+			return -1;
+		}
+		ev.events = EPOLLIN;
+		ev.data.u32 = i;
+		epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+	}
+	for(d = 0; d < (reconnect ? 1 : depth); d++)
+		for(i = 0; i < nclients; i++)
+			if(client_send(&clients[i], total))
+				return -1;
+
+	while(completed < total)
+	{
+		n = epoll_wait(epfd, events, 64, 5000);
+		if(n <= 0)
+		{
+			printf("no reply for 5 s, %u of %u answered\n", completed, total);
+			return -1;
+		}
+		for(k = 0; k < n; k++)
+		{
+			c = &clients[events[k].data.u32];
+			got = recv(c->fd, c->in + c->in_len, sizeof(c->in) - c->in_len, 0);
+			if(got <= 0)
+			{
+				if(got < 0 && errno == EAGAIN)
+					continue;
+				printf("server closed the connection\n");
+				return -1;
+			}
+			c->in_len += got;
+			for(off = 0; c->in_len - off >= size; off += size)
+			{
+				memcpy(&reply, c->in + off, sizeof(reply));
+				if(reply.status != API_OK || reply.id >= total)
+					errors++;
+				else
+					latency[completed - errors] = (now_ns() - sent_at[reply.id]) / 1000;
+				completed++;
+				if(!reconnect && client_send(c, total))
+					return -1;
+			}
+			memmove(c->in, c->in + off, c->in_len - off);
+			c->in_len -= off;
+
+			if(reconnect && off)
+			{
+				/* the old client: a new connection for every request */
+				epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, NULL);
+				close(c->fd);
+				c->fd = -1;
+				if(next_id == total)
+					continue;
+				if((c->fd = client_connect(address)) < 0)
+					return -1;
+				ev.events = EPOLLIN;
+				ev.data.u32 = c - clients;
+				epoll_ctl(epfd, EPOLL_CTL_ADD, c->fd, &ev);
+				if(client_send(c, total))
+					return -1;
+			}
+		}
+	}
+	elapsed = now_ns() - start;
+
+	for(i = 0; i < nclients; i++)
+		if(clients[i].fd >= 0)
+			close(clients[i].fd);
+	close(epfd);
+
+	/* error replies carry no latency */
+	n = completed - errors;
+	qsort(latency, n, sizeof(latency[0]), cmp_u32);
+	printf("%3d client%s depth %2d%s  %6u requests %9.0f req/s %9.0f cmd/s  p50 %8.2f ms  p99 %8.2f ms  errors %u\n",
+		nclients, nclients > 1 ? "s" : " ", reconnect ? 1 : depth, reconnect ? " reconnect" : "",
+		total, total * 1e9 / elapsed, total * 1e9 / elapsed * (batch_size ? batch_size : 1),
+		n ? latency[n / 2] / 1000.0 : 0,
+		n ? latency[(uint64_t)n * 99 / 100] / 1000.0 : 0, errors);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	struct sockaddr_in address;
+	apiserver_stats_t stats;
+	pthread_t server_thread, tiva_thread;
+	char levels[64] = "1,10,100", *level;
+	uint32_t total = 1000;
+	uint32_t timeout_ms = APISERVER_TIMEOUT_MS;
+	uint32_t cache_ms = APICACHE_MAX_AGE_MS;
+	apicache_stats_t cache_stats;
+	pthread_t watch_thread;
+	uint64_t least = UINT64_MAX, most = 0, lost = 0;
+	int stall = 0, i;
+	int opt, sim = 0, depth = 4, reconnect = 0, nclients, failed = 0;
+
+	while((opt = getopt(argc, argv, "sl:d:t:m:fb:e:wc:p:n:k")) != -1)
+	{
+		switch(opt)
+		{
+			case 's': sim = 1;
+				break;
+			case 'l': tiva_us = strtoul(optarg, NULL, 0);
+				break;
+			case 'd': tiva_drop = strtoul(optarg, NULL, 0);
+				break;
+			case 't': timeout_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'm': cache_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'f': req_flags = API_FLAG_REFRESH;
+				break;
+			case 'b': batch_size = strtoul(optarg, NULL, 0);
+				if(batch_size > API_BATCH_MAX)
+					batch_size = API_BATCH_MAX;
+				break;
+			case 'e': nwatch = strtoul(optarg, NULL, 0);
+				if(nwatch > MAX_CLIENTS / 2)
+					nwatch = MAX_CLIENTS / 2;
+				break;
+			case 'w': stall = 1;
+				break;
+			case 'c': snprintf(levels, sizeof(levels), "%s", optarg);
+				break;
+			case 'p': depth = strtoul(optarg, NULL, 0);
+				break;
+			case 'n': total = strtoul(optarg, NULL, 0);
+				break;
+			case 'k': reconnect = 1;
+				break;
+			default:
+				printf("Usage: %s [-s] [-l tiva_us] [-d n] [-t ms] [-m cache_ms] [-f] [-b n] [-e n] [-w] [-c clients,...] [-p depth]"
+					" [-n requests] [-k] [host]\n",
+					argv[0]);
+				return -1;
+		}
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(PORT);
+	if(inet_pton(AF_INET, optind < argc ? argv[optind] : "127.0.0.1", &address.sin_addr) <= 0)
+	{
+		printf("Addr error\n");
+		return -1;
+	}
+
+	if(sim)
+	{
+		if(pipe(tiva_pipe) || apiserver_init(&server, 0, tiva_link, NULL))
+		{
+			perror("API server: ");
+			return -1;
+		}
+		apiserver_set_timeout(&server, timeout_ms);
+		apicache_init(&cache, cache_ms);
+		if(cache_ms)
+			apiserver_set_cache(&server, &cache);
+		address.sin_port = htons(apiserver_port(&server));
+		pthread_create(&tiva_thread, NULL, tiva, NULL);
+		pthread_create(&server_thread, NULL, serve, NULL);
+		printf("simulated TIVA answering in %u us\n", tiva_us);
+	}
+
+	for(i = 0; i < nwatch; i++)
+	{
+		if((watchers[i].fd = subscribe(&address)) < 0)
+		{
+			printf("subscribe failed\n");
+			return -1;
+		}
+	}
+	if(stall && (stalled_fd = subscribe(&address)) < 0)
+	{
+		printf("subscribe failed\n");
+		return -1;
+	}
+	if(nwatch)
+		pthread_create(&watch_thread, NULL, watch, NULL);
+
+	sent_at = calloc(total, sizeof(sent_at[0]));
+	latency = calloc(total, sizeof(latency[0]));
+	if(!sent_at || !latency)
+		return -1;
+
+	for(level = strtok(levels, ","); level; level = strtok(NULL, ","))
+	{
+		nclients = atoi(level);
+		if(nclients < 1 || nclients > MAX_CLIENTS)
+			continue;
+		if(run(&address, nclients, depth, total, reconnect))
+		{
+			failed = 1;
+			break;
+		}
+	}
+
+	if(nwatch)
+	{
+		/* the last records are still on their way */
+		usleep(200000);
+		watch_end = 1;
+		pthread_join(watch_thread, NULL);
+		for(i = 0; i < nwatch; i++)
+		{
+			least = watchers[i].received < least ? watchers[i].received : least;
+			most = watchers[i].received > most ? watchers[i].received : most;
+			lost += watchers[i].dropped;
+			close(watchers[i].fd);
+		}
+		printf("subscribers: %d reading, %llu to %llu records each, %llu lost\n", nwatch,
+			(unsigned long long)least, (unsigned long long)most, (unsigned long long)lost);
+	}
+
+	if(sim)
+	{
+		server_end = 1;
+		pthread_join(server_thread, NULL);
+		apiserver_get_stats(&server, &stats);
+		printf("server: %llu connections %llu requests %llu replies %llu cached %llu errors %llu timeouts %llu unmatched "
+			"%llu stalls, backlog high water %u\n",
+			(unsigned long long)stats.accepted, (unsigned long long)stats.requests,
+			(unsigned long long)stats.replies, (unsigned long long)stats.cached,
+			(unsigned long long)stats.errors,
+			(unsigned long long)stats.timeouts, (unsigned long long)stats.unmatched,
+			(unsigned long long)stats.stalls, stats.backlog_high);
+		apicache_get_stats(&cache, &cache_stats);
+		printf("cache: %llu hits %llu misses %llu updates\n",
+			(unsigned long long)cache_stats.hits, (unsigned long long)cache_stats.misses,
+			(unsigned long long)cache_stats.updates);
+		apiserver_report(&server, stdout);
+		if(stalled_fd >= 0)
+			close(stalled_fd);
+		close(tiva_pipe[1]);
+		pthread_join(tiva_thread, NULL);
+		apiserver_close(&server);
+	}
+	return failed;
+}
@@ -1,4 +1,3 @@
-
 /*******************************************************************************************************
 *
 * UNIVERSITY OF COLORADO BOULDER
@@ -19,33 +18,30 @@
 #include <time.h>
 #include <pthread.h>
 #include "log.h"
+#include "logring.h"
 #include <errno.h>
 #include <string.h>
 
+/* in-process path from every producer thread to the logger thread */
+logring_t log_ring;
+
+
+void log_record(const Logger_t *log)
+{
+	/* never blocks the caller unless the ring runs with LOGRING_BLOCK */
+	logring_push(&log_ring, log);
+}
 
 void LOG(uint32_t loglevel, uint32_t log_source, char *msg, uint32_t value,uint32_t timestamp)
 {
-	//sem_wait(log_lock);
-        pthread_mutex_lock(&log_lock);
         Logger_t logging;
-	printf("5");
+
+        memset(&logging, 0, sizeof(Logger_t));
         logging.timestamp=timestamp;
-        printf("6");
 	logging.log_level = loglevel;
         logging.log_source = log_source;
 	    logging.value = value;
-        memcpy(logging.message, msg, MSG_SIZE);
-
-        
-	printf("7\n");
-       if((mq_send(log_q, &logging, sizeof(Logger_t),0))==-1)
-        {
-                printf("cant send message to process1 and returned %d\n", errno);
-        }
-	 
-      	
-	printf("8");
-       pthread_mutex_unlock(&log_lock);
-
-	//sem_post(log_lock);
+        strncpy(logging.message, msg, MSG_SIZE);
+
+        log_record(&logging);
 }
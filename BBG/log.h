@@ -24,12 +24,10 @@
 #include <mqueue.h>
 
 
-mqd_t log_q;
-extern pthread_mutex_t log_lock;
+/* only opened with -q, mirrors the log stream for other processes */
+extern mqd_t log_q;
 
 #define LOG_QUEUE "/logqueu1"
-#define SOCKET_QUEUE "/socketqueu1"
-#define SOCK_REPLY_QUEUE "/sockqueue2"
 #define HB_QUEUE_COMM "/heartbeat1"
 #define HB_QUEUE_SOCKET "/heartbeat2"
 #define HB_QUEUE_LOG "/heartbeat3"
@@ -46,6 +44,7 @@ extern pthread_mutex_t log_lock;
 #define LOG_SOURCE_LOGGER   (0xc)
 #define LOG_SOURCE_SERVER   (0xe)
 #define LOG_SOURCE_DECISION (0xf)
+#define LOG_SOURCE_TIVA_CLIENT (0x12)  /* the TIVA's answers to API calls */
 
 #define HB_COMM_VAL 0x01
 #define HB_SOCK_VAL 0x02
@@ -66,4 +65,7 @@ typedef struct log
 
 void LOG(uint32_t loglevel, uint32_t log_source, char *msg, uint32_t value,uint32_t timestamp);
 
+/* hands a complete record to the logger thread */
+void log_record(const Logger_t *log);
+
 #endif
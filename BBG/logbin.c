@@ -0,0 +1,251 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logbin.c
+* @brief Binary log file format: encoding, block index and windowed reader
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "logbin.h"
+
+
+static void put32(uint8_t *buf, uint32_t val)
+{
+	buf[0] = val;
+	buf[1] = val >> 8;
+	buf[2] = val >> 16;
+	buf[3] = val >> 24;
+}
+
+static uint32_t get32(const uint8_t *buf)
+{
+	return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+		((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+void logbin_encode_header(uint8_t *buf, const char *magic, uint16_t record_size,
+		uint32_t interval, uint32_t created)
+{
+	memcpy(buf, magic, 4);
+	buf[4] = LOGBIN_VERSION & 0xff;
+	buf[5] = LOGBIN_VERSION >> 8;
+	buf[6] = record_size & 0xff;
+	buf[7] = record_size >> 8;
+	put32(buf + 8, interval);
+	put32(buf + 12, created);
+}
+
+int logbin_decode_header(const uint8_t *buf, const char *magic, uint16_t min_size,
+		logbin_header_t *header)
+{
+	memcpy(header->magic, buf, 4);
+	header->version = buf[4] | (buf[5] << 8);
+	header->record_size = buf[6] | (buf[7] << 8);
+	header->index_interval = get32(buf + 8);
+	header->created = get32(buf + 12);
+
+	if(memcmp(header->magic, magic, 4))
+		return -1;
+	/* newer writers may only append fields to a record, never reorder them */
+	if(header->record_size < min_size)
+		return -1;
+	if(header->index_interval == 0)
+		return -1;
+	return 0;
+}
+
+void logbin_encode_record(uint8_t *buf, const Logger_t *log)
+{
+	put32(buf, log->timestamp);
+	put32(buf + 4, log->log_level);
+	put32(buf + 8, log->log_source);
+	put32(buf + 12, log->value);
+	memcpy(buf + 16, log->message, MSG_SIZE);
+}
+
+void logbin_decode_record(const uint8_t *buf, Logger_t *log)
+{
+	log->timestamp = get32(buf);
+	log->log_level = get32(buf + 4);
+	log->log_source = get32(buf + 8);
+	log->value = get32(buf + 12);
+	memcpy(log->message, buf + 16, MSG_SIZE);
+}
+
+void logbin_encode_index(uint8_t *buf, const logbin_index_t *entry)
+{
+	put32(buf, entry->first_record);
+	put32(buf + 4, entry->min_timestamp);
+	put32(buf + 8, entry->max_timestamp);
+}
+
+void logbin_decode_index(const uint8_t *buf, logbin_index_t *entry)
+{
+	entry->first_record = get32(buf);
+	entry->min_timestamp = get32(buf + 4);
+	entry->max_timestamp = get32(buf + 8);
+}
+
+void logbin_block_init(logbin_block_t *block, uint32_t interval)
+{
+	memset(block, 0, sizeof(*block));
+	block->interval = interval ? interval : LOGBIN_INDEX_INTERVAL;
+}
+
+int logbin_block_add(logbin_block_t *block, uint32_t timestamp, logbin_index_t *done)
+{
+	uint32_t pos = block->records % block->interval;
+
+	if(pos == 0)
+	{
+		block->entry.first_record = block->records;
+		block->entry.min_timestamp = timestamp;
+		block->entry.max_timestamp = timestamp;
+	}
+	else
+	{
+		if(timestamp < block->entry.min_timestamp)
+			block->entry.min_timestamp = timestamp;
+		if(timestamp > block->entry.max_timestamp)
+			block->entry.max_timestamp = timestamp;
+	}
+	block->records++;
+
+	if(pos == block->interval - 1)
+	{
+		*done = block->entry;
+		return 1;
+	}
+	return 0;
+}
+
+void logbin_block_rewind(logbin_block_t *block, uint32_t count)
+{
+	uint32_t pos = block->records % block->interval;
+
+	if(count > block->records)
+		count = block->records;
+	block->records -= count;
+	block->entry.first_record = block->records - (block->records % block->interval);
+
+	/* back inside an earlier block: its bounds are gone, keep it always visible */
+	if(count > pos)
+	{
+		block->entry.min_timestamp = 0;
+		block->entry.max_timestamp = UINT32_MAX;
+	}
+}
+
+int logbin_block_partial(const logbin_block_t *block, logbin_index_t *done)
+{
+	if(block->records % block->interval == 0)
+		return 0;
+	*done = block->entry;
+	return 1;
+}
+
+/* visit records [first, first+count) of an open data file, count < 0 means to EOF */
+static long scan_range(FILE *fp, const logbin_header_t *header, uint32_t first, long count,
+		uint32_t start, uint32_t end, logbin_visit_t fn, void *arg)
+{
+	uint8_t buf[LOGBIN_RECORD_SIZE];
+	Logger_t log;
+	long visited = 0;
+
+	if(fseek(fp, LOGBIN_HEADER_SIZE + (long)first * header->record_size, SEEK_SET))
+		return -1;
+
+	while(count < 0 || visited < count)
+	{
+		if(fread(buf, LOGBIN_RECORD_SIZE, 1, fp) != 1)
+			break;
+		/* skip any trailing fields a newer writer appended */
+		if(header->record_size > LOGBIN_RECORD_SIZE)
+			fseek(fp, header->record_size - LOGBIN_RECORD_SIZE, SEEK_CUR);
+		visited++;
+
+		logbin_decode_record(buf, &log);
+		if(log.timestamp >= start && log.timestamp <= end)
+			fn(&log, arg);
+	}
+	return visited;
+}
+
+long logbin_scan(const char *filename, uint32_t start, uint32_t end,
+		logbin_visit_t fn, void *arg)
+{
+	uint8_t buf[LOGBIN_HEADER_SIZE];
+	logbin_header_t header, idx_header;
+	logbin_index_t entry;
+	char *idx_name;
+	FILE *fp, *idx;
+	uint32_t next = 0;
+	long visited = 0, ret;
+
+	if(!(fp = fopen(filename, "rb")))
+		return -1;
+
+	if(fread(buf, sizeof(buf), 1, fp) != 1 ||
+	   logbin_decode_header(buf, LOGBIN_MAGIC, LOGBIN_RECORD_SIZE, &header))
+	{
+		fclose(fp);
+		return -1;
+	}
+
+	idx_name = malloc(strlen(filename) + sizeof(LOGBIN_INDEX_SUFFIX));
+	if(!idx_name)
+	{
+		fclose(fp);
+		return -1;
+	}
+	strcpy(idx_name, filename);
+	strcat(idx_name, LOGBIN_INDEX_SUFFIX);
+	idx = fopen(idx_name, "rb");
+	free(idx_name);
+
+	if(idx && (fread(buf, sizeof(buf), 1, idx) != 1 ||
+		   logbin_decode_header(buf, LOGBIN_INDEX_MAGIC, LOGBIN_INDEX_SIZE, &idx_header) ||
+		   idx_header.index_interval != header.index_interval))
+	{
+		fclose(idx);
+		idx = NULL;
+	}
+
+	if(idx)
+	{
+		uint8_t ibuf[LOGBIN_INDEX_SIZE];
+
+		while(fread(ibuf, sizeof(ibuf), 1, idx) == 1)
+		{
+			logbin_decode_index(ibuf, &entry);
+			next = entry.first_record + header.index_interval;
+			if(entry.max_timestamp < start || entry.min_timestamp > end)
+				continue;
+
+			ret = scan_range(fp, &header, entry.first_record,
+					header.index_interval, start, end, fn, arg);
+			if(ret < 0)
+				break;
+			visited += ret;
+		}
+		fclose(idx);
+	}
+
+	/* records past the last index entry (logger still running or killed) */
+	ret = scan_range(fp, &header, next, -1, start, end, fn, arg);
+	if(ret > 0)
+		visited += ret;
+
+	fclose(fp);
+	return visited;
+}
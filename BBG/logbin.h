@@ -0,0 +1,98 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logbin.h
+* @brief Binary log file format: fixed width records plus a sparse time index
+*
+* Data file  : logbin_header_t followed by LOGBIN_RECORD_SIZE byte records
+* Index file : <data file>.idx, logbin_header_t followed by one
+*              logbin_index_t per LOGBIN_INDEX_INTERVAL records
+*
+* All fields are little endian. Timestamps from the TIVA (RTC seconds) and
+* the BBG (epoch seconds) are mixed in one file, so each index entry keeps
+* the min and max timestamp of its block and a reader skips whole blocks
+* that cannot overlap the requested window.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef _LOGBIN_H
+#define _LOGBIN_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "log.h"
+
+#define LOGBIN_MAGIC            "GLOG"
+#define LOGBIN_INDEX_MAGIC      "GIDX"
+#define LOGBIN_VERSION          (1)
+#define LOGBIN_HEADER_SIZE      (16)
+/* timestamp, level, source, value, message */
+#define LOGBIN_RECORD_SIZE      (4*4 + MSG_SIZE)
+#define LOGBIN_INDEX_SIZE       (12)
+#define LOGBIN_INDEX_INTERVAL   (256)
+#define LOGBIN_INDEX_SUFFIX     ".idx"
+
+typedef struct logbin_header
+{
+	char magic[4];
+	uint16_t version;
+	uint16_t record_size;
+	uint32_t index_interval;
+	uint32_t created;         /* epoch seconds */
+}logbin_header_t;
+
+typedef struct logbin_index
+{
+	uint32_t first_record;    /* record number of the first record in the block */
+	uint32_t min_timestamp;
+	uint32_t max_timestamp;
+}logbin_index_t;
+
+/* in-progress block while writing */
+typedef struct logbin_block
+{
+	logbin_index_t entry;
+	uint32_t records;         /* records written so far */
+	uint32_t interval;
+}logbin_block_t;
+
+/* header encode/decode, buf is LOGBIN_HEADER_SIZE bytes */
+void logbin_encode_header(uint8_t *buf, const char *magic, uint16_t record_size,
+		uint32_t interval, uint32_t created);
+int logbin_decode_header(const uint8_t *buf, const char *magic, uint16_t min_size,
+		logbin_header_t *header);
+
+/* record encode/decode, buf is LOGBIN_RECORD_SIZE bytes */
+void logbin_encode_record(uint8_t *buf, const Logger_t *log);
+void logbin_decode_record(const uint8_t *buf, Logger_t *log);
+
+/* index entry encode/decode, buf is LOGBIN_INDEX_SIZE bytes */
+void logbin_encode_index(uint8_t *buf, const logbin_index_t *entry);
+void logbin_decode_index(const uint8_t *buf, logbin_index_t *entry);
+
+/*
+ * Account one record to the current block. Returns 1 when the block is
+ * complete and *done holds the index entry to write out.
+ */
+void logbin_block_init(logbin_block_t *block, uint32_t interval);
+int logbin_block_add(logbin_block_t *block, uint32_t timestamp, logbin_index_t *done);
+/* forget the last count records after they failed to reach the file */
+void logbin_block_rewind(logbin_block_t *block, uint32_t count);
+/* returns 1 and the partial block's entry if it holds any record */
+int logbin_block_partial(const logbin_block_t *block, logbin_index_t *done);
+
+/*
+ * Reader: calls fn for every record with start <= timestamp <= end,
+ * using the index to skip blocks. Falls back to a full scan when the
+ * index file is missing. Returns records visited or -1 on error.
+ */
+typedef void (*logbin_visit_t)(const Logger_t *log, void *arg);
+long logbin_scan(const char *filename, uint32_t start, uint32_t end,
+		logbin_visit_t fn, void *arg);
+
+#endif
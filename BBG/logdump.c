@@ -0,0 +1,78 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logdump.c
+* @brief Converts a binary log file back to the TSV layout written by the logger
+*
+* Usage: logdump [-s start] [-e end] log.bin > log.txt
+* start/end limit the output to a timestamp window; the .idx file next to
+* the data file is used to skip blocks outside it.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "logbin.h"
+#include "logsink.h"
+
+
+static void print_record(const Logger_t *log, void *arg)
+{
+	char line[LOGSINK_LINE_MAX];
+	int len = logsink_format_tsv(line, sizeof(line), log);
+
+	fwrite(line, 1, len, (FILE *)arg);
+}
+
+/********************************************************************************************************
+*
+* @name main
+* @brief dump a binary log as TSV
+*
+* @param -s first timestamp, -e last timestamp, binary log file name
+*
+* @return zero on success, 1 if the file is not a readable binary log
+*
+********************************************************************************************************/
+int main(int argc, char *argv[])
+{
+	uint32_t start = 0, end = UINT32_MAX;
+	long visited;
+	int opt;
+
+	while((opt = getopt(argc, argv, "s:e:")) != -1)
+	{
+		switch(opt)
+		{
+			case 's': start = strtoul(optarg, NULL, 0);
+				break;
+			case 'e': end = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				fprintf(stderr, "Usage: %s [-s start] [-e end] logfile\n", argv[0]);
+				return 1;
+		}
+	}
+	if(optind >= argc)
+	{
+		fprintf(stderr, "Usage: %s [-s start] [-e end] logfile\n", argv[0]);
+		return 1;
+	}
+
+	fputs(LOGSINK_HEADER, stdout);
+	if((visited = logbin_scan(argv[optind], start, end, print_record, stdout)) < 0)
+	{
+		fprintf(stderr, "%s: not a binary log file\n", argv[optind]);
+		return 1;
+	}
+	fprintf(stderr, "%ld records scanned\n", visited);
+	return 0;
+}
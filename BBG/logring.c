@@ -0,0 +1,228 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logring.c
+* @brief Lock-free multi-producer ring of Logger_t slots feeding the logger thread
+*
+* Each slot carries a sequence number. A slot at position pos is free for
+* a producer when seq == pos and holds a record for the consumer when
+* seq == pos + 1; consuming it sets seq to pos + capacity for the next lap.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include "logring.h"
+
+/* producer slot of the calling thread, 0 until logring_register */
+static __thread int producer_id;
+
+
+int logring_init(logring_t *ring, size_t capacity, uint8_t policy)
+{
+	size_t size = 2, i;
+
+	while(size < capacity)
+		size <<= 1;
+
+	memset(ring, 0, sizeof(*ring));
+	if(!(ring->slots = calloc(size, sizeof(logring_slot_t))))
+		return -1;
+	for(i = 0; i < size; i++)
+		atomic_init(&ring->slots[i].seq, i);
+
+	ring->mask = size - 1;
+	ring->policy = policy;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->sleeping, 0);
+	atomic_init(&ring->producers, 1);
+	ring->producer[0].name = "other";
+
+	if(sem_init(&ring->doorbell, 0, 0))
+	{
+		free(ring->slots);
+		ring->slots = NULL;
+		return -1;
+	}
+	return 0;
+}
+
+void logring_destroy(logring_t *ring)
+{
+	sem_destroy(&ring->doorbell);
+	free(ring->slots);
+	ring->slots = NULL;
+}
+
+int logring_register(logring_t *ring, const char *name)
+{
+	int id = atomic_fetch_add(&ring->producers, 1);
+
+	if(id >= LOGRING_MAX_PRODUCERS)
+	{
+		atomic_fetch_sub(&ring->producers, 1);
+		return -1;
+	}
+	ring->producer[id].name = name;
+	producer_id = id;
+	return id;
+}
+
+/* one non-blocking attempt at each end of the ring */
+static int try_push(logring_t *ring, const Logger_t *log)
+{
+	size_t pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	logring_slot_t *slot;
+	intptr_t diff;
+
+	for(;;)
+	{
+		slot = &ring->slots[pos & ring->mask];
+		diff = (intptr_t)atomic_load_explicit(&slot->seq, memory_order_acquire) - (intptr_t)pos;
+		if(diff == 0)
+		{
+			if(atomic_compare_exchange_weak_explicit(&ring->head, &pos, pos + 1,
+						memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if(diff < 0)
+			return -1;      /* full */
+		else
+			pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	}
+
+	slot->log = *log;
+	atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+	return 0;
+}
+
+static int try_pop(logring_t *ring, Logger_t *log)
+{
+	size_t pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	logring_slot_t *slot;
+	intptr_t diff;
+
+	for(;;)
+	{
+		slot = &ring->slots[pos & ring->mask];
+		diff = (intptr_t)atomic_load_explicit(&slot->seq, memory_order_acquire) - (intptr_t)(pos + 1);
+		if(diff == 0)
+		{
+			/* producers dropping the oldest record also pop, so this is a CAS */
+			if(atomic_compare_exchange_weak_explicit(&ring->tail, &pos, pos + 1,
+						memory_order_relaxed, memory_order_relaxed))
+				break;
+		}
+		else if(diff < 0)
+			return -1;      /* empty */
+		else
+			pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	}
+
+	if(log)
+		*log = slot->log;
+	atomic_store_explicit(&slot->seq, pos + ring->mask + 1, memory_order_release);
+	return 0;
+}
+
+int logring_push(logring_t *ring, const Logger_t *log)
+{
+	logring_producer_t *producer = &ring->producer[producer_id];
+	struct timespec backoff = {0, 100000};
+	int ret;
+
+	while((ret = try_push(ring, log)) < 0)
+	{
+		if(ring->policy == LOGRING_DROP_NEWEST)
+			break;
+		if(ring->policy == LOGRING_DROP_OLDEST)
+		{
+			if(try_pop(ring, NULL) == 0)
+				atomic_fetch_add_explicit(&producer->dropped, 1, memory_order_relaxed);
+			continue;
+		}
+		/* LOGRING_BLOCK: full is the rare path, so a short sleep is enough */
+		nanosleep(&backoff, NULL);
+	}
+
+	if(ret < 0)
+	{
+		atomic_fetch_add_explicit(&producer->dropped, 1, memory_order_relaxed);
+		return -1;
+	}
+	atomic_fetch_add_explicit(&producer->pushed, 1, memory_order_relaxed);
+
+	/* ring the doorbell only when the logger actually went to sleep */
+	atomic_thread_fence(memory_order_seq_cst);
+	if(atomic_load_explicit(&ring->sleeping, memory_order_relaxed) &&
+	   atomic_exchange(&ring->sleeping, 0))
+		sem_post(&ring->doorbell);
+	return 0;
+}
+
+int logring_pop(logring_t *ring, Logger_t *log)
+{
+	return try_pop(ring, log);
+}
+
+void logring_wait(logring_t *ring, uint32_t timeout_ms)
+{
+	size_t pos;
+	struct timespec deadline;
+
+	atomic_store(&ring->sleeping, 1);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	/* re-check after announcing: a push may have raced with us */
+	pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	if((intptr_t)atomic_load_explicit(&ring->slots[pos & ring->mask].seq,
+				memory_order_acquire) - (intptr_t)(pos + 1) >= 0)
+	{
+		atomic_store(&ring->sleeping, 0);
+		return;
+	}
+
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (timeout_ms % 1000) * 1000000;
+	if(deadline.tv_nsec >= 1000000000)
+	{
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+	while(sem_timedwait(&ring->doorbell, &deadline) == -1 && errno == EINTR)
+		;
+	atomic_store(&ring->sleeping, 0);
+}
+
+void logring_report(logring_t *ring, FILE *fp)
+{
+	uint64_t total = 0;
+	int i, count = atomic_load(&ring->producers);
+
+	if(count > LOGRING_MAX_PRODUCERS)
+		count = LOGRING_MAX_PRODUCERS;
+	for(i = 0; i < count; i++)
+		total += atomic_load_explicit(&ring->producer[i].dropped, memory_order_relaxed);
+	if(total == ring->reported_drops)
+		return;
+	ring->reported_drops = total;
+
+	fprintf(fp, "LOGRING: %llu records dropped\n", (unsigned long long)total);
+	for(i = 0; i < count; i++)
+		fprintf(fp, "LOGRING:   %-8s pushed %llu dropped %llu\n", ring->producer[i].name,
+				(unsigned long long)atomic_load(&ring->producer[i].pushed),
+				(unsigned long long)atomic_load(&ring->producer[i].dropped));
+}
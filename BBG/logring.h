@@ -0,0 +1,90 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logring.h
+* @brief Lock-free multi-producer ring of Logger_t slots feeding the logger thread
+*
+* Bounded queue with a sequence number per slot: producers claim a slot
+* with one compare-and-swap on the head, the logger thread consumes from
+* the tail. No kernel call is made on the producer side unless the logger
+* is asleep waiting for records.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef _LOGRING_H
+#define _LOGRING_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <semaphore.h>
+#include "log.h"
+
+#define LOGRING_CAPACITY        (256)     /* rounded up to a power of two */
+#define LOGRING_MAX_PRODUCERS   (8)
+#define LOGRING_CACHE_LINE      (64)
+
+/* what a producer does when the ring is full */
+#define LOGRING_DROP_NEWEST     (0)       /* discard the record being logged */
+#define LOGRING_DROP_OLDEST     (1)       /* discard the oldest queued record */
+#define LOGRING_BLOCK           (2)       /* wait for the logger to make room */
+
+typedef struct logring_slot
+{
+	atomic_size_t seq;
+	Logger_t log;
+}logring_slot_t;
+
+typedef struct logring_producer
+{
+	const char *name;
+	atomic_uint_fast64_t pushed;
+	atomic_uint_fast64_t dropped;
+}logring_producer_t;
+
+typedef struct logring
+{
+	logring_slot_t *slots;
+	size_t mask;
+	uint8_t policy;
+
+	_Alignas(LOGRING_CACHE_LINE) atomic_size_t head;   /* next slot to fill */
+	_Alignas(LOGRING_CACHE_LINE) atomic_size_t tail;   /* next slot to drain */
+
+	_Alignas(LOGRING_CACHE_LINE) atomic_int sleeping;  /* logger waits on doorbell */
+	sem_t doorbell;
+
+	atomic_int producers;
+	logring_producer_t producer[LOGRING_MAX_PRODUCERS];
+	uint64_t reported_drops;
+}logring_t;
+
+/* allocates capacity slots (power of two), returns 0 or -1 */
+int logring_init(logring_t *ring, size_t capacity, uint8_t policy);
+void logring_destroy(logring_t *ring);
+
+/*
+ * names the calling thread for the per-producer counters. Threads that
+ * never register are accounted to producer 0 ("other").
+ */
+int logring_register(logring_t *ring, const char *name);
+
+/* queues a copy of log, returns 0 or -1 if the record was dropped */
+int logring_push(logring_t *ring, const Logger_t *log);
+
+/* consumer side: takes one record, returns 0 or -1 if the ring is empty */
+int logring_pop(logring_t *ring, Logger_t *log);
+
+/* consumer side: sleeps until a record is pushed or timeout_ms expires */
+void logring_wait(logring_t *ring, uint32_t timeout_ms);
+
+/* prints the per-producer counters if any drop happened since the last call */
+void logring_report(logring_t *ring, FILE *fp);
+
+#endif
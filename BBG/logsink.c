@@ -0,0 +1,342 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logsink.c
+* @brief Batched log file writer used by the logger thread
+*
+* The log file is opened once and kept open. Records are formatted into
+* per-record line buffers and handed to the kernel in one writev when the
+* flush policy (record count, byte count or age) says so. In durable mode
+* the file is fsynced on a timer instead of after every write.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#include <stdlib.h>
+#include "logsink.h"
+
+
+static uint32_t elapsed_ms(const struct timespec *from, const struct timespec *to)
+{
+	int64_t ms = (int64_t)(to->tv_sec - from->tv_sec) * 1000 +
+			(to->tv_nsec - from->tv_nsec) / 1000000;
+	return (ms < 0) ? 0 : (uint32_t)ms;
+}
+
+static uint32_t remaining_ms(uint32_t period, const struct timespec *since, const struct timespec *now)
+{
+	uint32_t spent = elapsed_ms(since, now);
+	return (spent >= period) ? 0 : period - spent;
+}
+
+/* write the whole iovec array, restarting after short writes and EINTR */
+static int writev_all(int fd, struct iovec *iov, int count)
+{
+	while(count > 0)
+	{
+		ssize_t done = writev(fd, iov, count);
+		if(done < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		while(count > 0 && (size_t)done >= iov->iov_len)
+		{
+			done -= iov->iov_len;
+			iov++;
+			count--;
+		}
+		if(count > 0)
+		{
+			iov->iov_base = (char *)iov->iov_base + done;
+			iov->iov_len -= done;
+		}
+	}
+	return 0;
+}
+
+/* write a buffer, restarting after short writes and EINTR */
+static int write_all(int fd, const void *buf, size_t len)
+{
+	struct iovec iov = { (void *)buf, len };
+	return writev_all(fd, &iov, 1);
+}
+
+/* binary format: create the index file next to the data file */
+static int open_index(logsink_t *sink, const char *filename)
+{
+	uint8_t header[LOGBIN_HEADER_SIZE];
+	char *name = malloc(strlen(filename) + sizeof(LOGBIN_INDEX_SUFFIX));
+
+	if(!name)
+		return -1;
+	strcpy(name, filename);
+	strcat(name, LOGBIN_INDEX_SUFFIX);
+	sink->idx_fd = open(name, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666);
+	free(name);
+	if(sink->idx_fd < 0)
+		return -1;
+
+	logbin_encode_header(header, LOGBIN_INDEX_MAGIC, LOGBIN_INDEX_SIZE,
+			sink->config.index_interval, time(NULL));
+	return write_all(sink->idx_fd, header, sizeof(header));
+}
+
+/* index entries go out after the data they describe */
+static int flush_index(logsink_t *sink)
+{
+	uint8_t buf[LOGSINK_MAX_BATCH][LOGBIN_INDEX_SIZE];
+	uint32_t i;
+
+	if(sink->idx_pending == 0)
+		return 0;
+	for(i = 0; i < sink->idx_pending; i++)
+		logbin_encode_index(buf[i], &sink->idx[i]);
+	sink->idx_pending = 0;
+	return write_all(sink->idx_fd, buf, i * LOGBIN_INDEX_SIZE);
+}
+
+int logsink_format_tsv(char *line, size_t size, const Logger_t *log)
+{
+	int len = snprintf(line, size, "%d\t\t%d\t\t%d\t\t%d\t%.*s\n",
+			(int)log->timestamp, (int)log->log_level, (int)log->log_source, (int)log->value,
+			(int)strnlen(log->message, MSG_SIZE), log->message);
+
+	if(len >= (int)size)
+		len = size - 1;
+	return len;
+}
+
+void logsink_default_config(logsink_config_t *config)
+{
+	config->flush_records = LOGSINK_FLUSH_RECORDS;
+	config->flush_bytes = LOGSINK_FLUSH_BYTES;
+	config->flush_ms = LOGSINK_FLUSH_MS;
+	config->fsync_ms = LOGSINK_FSYNC_MS;
+	config->report_ms = LOGSINK_REPORT_MS;
+	config->format = LOGSINK_FORMAT_TSV;
+	config->index_interval = LOGBIN_INDEX_INTERVAL;
+}
+
+int logsink_open(logsink_t *sink, const char *filename, const logsink_config_t *config)
+{
+	uint8_t header[LOGBIN_HEADER_SIZE];
+	int ret;
+
+	memset(sink, 0, sizeof(*sink));
+	sink->idx_fd = -1;
+	if(config)
+		sink->config = *config;
+	else
+		logsink_default_config(&sink->config);
+
+	if(sink->config.flush_records == 0 || sink->config.flush_records > LOGSINK_MAX_BATCH)
+		sink->config.flush_records = LOGSINK_MAX_BATCH;
+	if(sink->config.index_interval == 0)
+		sink->config.index_interval = LOGBIN_INDEX_INTERVAL;
+	logbin_block_init(&sink->block, sink->config.index_interval);
+
+	if((sink->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0666)) < 0)
+	{
+		perror("LOGSINK open: ");
+		return -1;
+	}
+
+	if(sink->config.format == LOGSINK_FORMAT_BIN)
+	{
+		logbin_encode_header(header, LOGBIN_MAGIC, LOGBIN_RECORD_SIZE,
+				sink->config.index_interval, time(NULL));
+		ret = write_all(sink->fd, header, sizeof(header));
+		if(ret == 0)
+			ret = open_index(sink, filename);
+	}
+	else
+		ret = write_all(sink->fd, LOGSINK_HEADER, strlen(LOGSINK_HEADER));
+
+	if(ret < 0)
+	{
+		perror("LOGSINK header: ");
+		close(sink->fd);
+		if(sink->idx_fd >= 0)
+			close(sink->idx_fd);
+		sink->fd = -1;
+		sink->idx_fd = -1;
+		return -1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &sink->last_fsync);
+	sink->last_report = sink->last_fsync;
+	return 0;
+}
+
+int logsink_append(logsink_t *sink, const Logger_t *log)
+{
+	char *line = sink->line[sink->pending];
+	int len;
+
+	if(sink->config.format == LOGSINK_FORMAT_BIN)
+	{
+		logbin_encode_record((uint8_t *)line, log);
+		len = LOGBIN_RECORD_SIZE;
+		if(logbin_block_add(&sink->block, log->timestamp, &sink->idx[sink->idx_pending]))
+			sink->idx_pending++;
+	}
+	else if((len = logsink_format_tsv(line, LOGSINK_LINE_MAX, log)) < 0)
+		return -1;
+
+	if(sink->pending == 0)
+		clock_gettime(CLOCK_MONOTONIC, &sink->first_pending);
+
+	sink->iov[sink->pending].iov_base = line;
+	sink->iov[sink->pending].iov_len = len;
+	sink->pending++;
+	sink->pending_bytes += len;
+
+	if(sink->pending >= sink->config.flush_records ||
+	   (sink->config.flush_bytes && sink->pending_bytes >= sink->config.flush_bytes))
+		return logsink_flush(sink);
+
+	return 0;
+}
+
+int logsink_flush(logsink_t *sink)
+{
+	if(sink->pending == 0 || sink->fd < 0)
+		return 0;
+
+	if(writev_all(sink->fd, sink->iov, sink->pending) < 0)
+	{
+		perror("LOGSINK writev: ");
+		/* drop the batch so the slots can be reused */
+		if(sink->config.format == LOGSINK_FORMAT_BIN)
+			logbin_block_rewind(&sink->block, sink->pending);
+		sink->stats.dropped += sink->pending;
+		sink->pending = 0;
+		sink->pending_bytes = 0;
+		sink->idx_pending = 0;
+		return -1;
+	}
+	if(flush_index(sink) < 0)
+		perror("LOGSINK index: ");
+
+	sink->stats.records += sink->pending;
+	sink->stats.bytes += sink->pending_bytes;
+	sink->stats.writes++;
+	sink->pending = 0;
+	sink->pending_bytes = 0;
+	sink->dirty = 1;
+	return 0;
+}
+
+int logsink_poll(logsink_t *sink)
+{
+	struct timespec now;
+	int ret = 0;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if(sink->pending && sink->config.flush_ms &&
+	   elapsed_ms(&sink->first_pending, &now) >= sink->config.flush_ms)
+		ret = logsink_flush(sink);
+
+	/* durable mode: bound the window of unsynced data by the fsync period */
+	if(sink->config.fsync_ms && elapsed_ms(&sink->last_fsync, &now) >= sink->config.fsync_ms)
+	{
+		ret |= logsink_flush(sink);
+		if(sink->dirty)
+		{
+			if(fsync(sink->fd) < 0)
+			{
+				perror("LOGSINK fsync: ");
+				ret = -1;
+			}
+			sink->stats.fsyncs++;
+			sink->dirty = 0;
+		}
+		sink->last_fsync = now;
+	}
+
+	if(sink->config.report_ms && elapsed_ms(&sink->last_report, &now) >= sink->config.report_ms)
+	{
+		double secs = elapsed_ms(&sink->last_report, &now) / 1000.0;
+
+		sink->stats.records_per_sec = (sink->stats.records - sink->report_records) / secs;
+		sink->stats.bytes_per_sec = (sink->stats.bytes - sink->report_bytes) / secs;
+		sink->report_records = sink->stats.records;
+		sink->report_bytes = sink->stats.bytes;
+		sink->last_report = now;
+
+		printf("LOGSINK: %.1f records/sec %.1f bytes/sec (%llu writes, %llu fsyncs)\n",
+				sink->stats.records_per_sec, sink->stats.bytes_per_sec,
+				(unsigned long long)sink->stats.writes,
+				(unsigned long long)sink->stats.fsyncs);
+	}
+
+	return ret;
+}
+
+uint32_t logsink_timeout_ms(const logsink_t *sink)
+{
+	struct timespec now;
+	uint32_t timeout = 1000;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	if(sink->pending && sink->config.flush_ms)
+	{
+		uint32_t left = remaining_ms(sink->config.flush_ms, &sink->first_pending, &now);
+		if(left < timeout)
+			timeout = left;
+	}
+	if(sink->config.fsync_ms)
+	{
+		uint32_t left = remaining_ms(sink->config.fsync_ms, &sink->last_fsync, &now);
+		if(left < timeout)
+			timeout = left;
+	}
+	if(sink->config.report_ms)
+	{
+		uint32_t left = remaining_ms(sink->config.report_ms, &sink->last_report, &now);
+		if(left < timeout)
+			timeout = left;
+	}
+	return timeout;
+}
+
+void logsink_close(logsink_t *sink)
+{
+	if(sink->fd < 0)
+		return;
+
+	logsink_flush(sink);
+	if(sink->idx_fd >= 0)
+	{
+		/* the last, partial block still gets an index entry */
+		if(logbin_block_partial(&sink->block, &sink->idx[0]))
+		{
+			sink->idx_pending = 1;
+			flush_index(sink);
+		}
+		if(sink->config.fsync_ms)
+			fsync(sink->idx_fd);
+		close(sink->idx_fd);
+		sink->idx_fd = -1;
+	}
+	if(sink->config.fsync_ms && sink->dirty)
+		fsync(sink->fd);
+	close(sink->fd);
+	sink->fd = -1;
+}
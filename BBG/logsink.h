@@ -0,0 +1,112 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file logsink.h
+* @brief Batched log file writer used by the logger thread
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef _LOGSINK_H
+#define _LOGSINK_H
+
+#include <stdint.h>
+#include <sys/uio.h>
+#include <time.h>
+#include "log.h"
+#include "logbin.h"
+
+/* maximum records held before a forced writev (must stay below IOV_MAX) */
+#define LOGSINK_MAX_BATCH       (256)
+/* longest formatted line: four 32 bit numbers, tabs and the message */
+#define LOGSINK_LINE_MAX        (4*11 + 8 + MSG_SIZE + 2)
+
+/* default flush policy */
+#define LOGSINK_FLUSH_RECORDS   (64)
+#define LOGSINK_FLUSH_BYTES     (4096)
+#define LOGSINK_FLUSH_MS        (200)
+#define LOGSINK_FSYNC_MS        (0)       /* durable mode off */
+#define LOGSINK_REPORT_MS       (10000)
+
+/* column header of the TSV format */
+#define LOGSINK_HEADER          "Timestamp\tLOG_LEVEL\tLOG_SOURCE\tValue\tMessage\r\n"
+
+/* file formats */
+#define LOGSINK_FORMAT_TSV      (0)
+#define LOGSINK_FORMAT_BIN      (1)
+
+typedef struct logsink_config
+{
+	uint32_t flush_records;   /* flush once this many records are pending, 0 for LOGSINK_MAX_BATCH */
+	uint32_t flush_bytes;     /* flush once this many bytes are pending, 0 disables */
+	uint32_t flush_ms;        /* flush pending records older than this, 0 disables */
+	uint32_t fsync_ms;        /* durable mode: fsync period in ms, 0 disables */
+	uint32_t report_ms;       /* throughput report period in ms, 0 disables */
+	uint8_t format;           /* LOGSINK_FORMAT_TSV or LOGSINK_FORMAT_BIN */
+	uint32_t index_interval;  /* binary format: records per index entry */
+}logsink_config_t;
+
+typedef struct logsink_stats
+{
+	uint64_t records;         /* records written since open */
+	uint64_t bytes;           /* bytes written since open */
+	uint64_t writes;          /* writev calls */
+	uint64_t fsyncs;          /* fsync calls */
+	uint64_t dropped;         /* records lost to write errors */
+	double records_per_sec;   /* rate over the last report period */
+	double bytes_per_sec;
+}logsink_stats_t;
+
+typedef struct logsink
+{
+	int fd;
+	int idx_fd;               /* binary format index file */
+	logsink_config_t config;
+	struct iovec iov[LOGSINK_MAX_BATCH];
+	char line[LOGSINK_MAX_BATCH][LOGSINK_LINE_MAX];
+	uint32_t pending;         /* records waiting in iov */
+	uint32_t pending_bytes;
+	logbin_block_t block;     /* binary format: block being indexed */
+	logbin_index_t idx[LOGSINK_MAX_BATCH];
+	uint32_t idx_pending;     /* index entries waiting for their records to be flushed */
+	struct timespec first_pending;
+	struct timespec last_fsync;
+	uint8_t dirty;            /* written but not yet fsynced */
+	logsink_stats_t stats;
+	struct timespec last_report;
+	uint64_t report_records;
+	uint64_t report_bytes;
+}logsink_t;
+
+/* fills config with the LOGSINK_* defaults */
+void logsink_default_config(logsink_config_t *config);
+
+/* formats one record as a TSV line, returns its length */
+int logsink_format_tsv(char *line, size_t size, const Logger_t *log);
+
+/*
+ * opens (truncates) filename and writes the column header, or the binary
+ * file header and <filename>.idx for LOGSINK_FORMAT_BIN. Returns 0 or -1.
+ */
+int logsink_open(logsink_t *sink, const char *filename, const logsink_config_t *config);
+
+/* queues one record, flushing if the record or byte limit is reached */
+int logsink_append(logsink_t *sink, const Logger_t *log);
+
+/* applies the time based parts of the policy: flush age, fsync timer, report */
+int logsink_poll(logsink_t *sink);
+
+/* writes every pending record with a single writev */
+int logsink_flush(logsink_t *sink);
+
+/* milliseconds the logger may block before logsink_poll has work to do */
+uint32_t logsink_timeout_ms(const logsink_t *sink);
+
+/* flushes, fsyncs in durable mode and closes the file */
+void logsink_close(logsink_t *sink);
+
+#endif
@@ -28,28 +28,49 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <time.h>
+#include <poll.h>
 #include "socket.h"
+#include "apiserver.h"
+#include "apicache.h"
 #include "usrled.h"
+#include "logsink.h"
+#include "logring.h"
+#include "include/link_frame.h"
+#include "include/log_wire.h"
+#include "include/api_wire.h"
+#include "include/gesture_trace.h"
+#include "gtrace.h"
 
 
-FILE *fp_log;
-mqd_t socket_q,sock_ans_q;
+mqd_t log_q = (mqd_t)-1;
 mqd_t hb_comm_q,hb_sock_q,hb_log_q;
 
 static void* communication(void *arg);
 static void* logger(void *arg);
 static void* socket_cli(void *arg);
+static int tiva_request(uint32_t corr, uint8_t opcode, const api_batch_t *batch, void *arg);
+static int tiva_send(uint16_t id, uint8_t opcode);
 static void* decision(void *arg);
 
 pthread_t comm_thread,logger_thread,socket_thread,decision_thread;
 
-pthread_mutex_t log_lock=PTHREAD_MUTEX_INITIALIZER;
 pthread_mutex_t uart_lock=PTHREAD_MUTEX_INITIALIZER;
 
+#define TIVA_HEARTBEAT_MS	(1000)	/* BBG heartbeat to the TIVA */
+
 
 
 int client_call;
 char *filename ;
+static char *trace_dir;            /* -g: gesture capture directory */
+static gtrace_t gesture_trace;
+static apiserver_t api_server;
+static uint32_t api_timeout_ms = APISERVER_TIMEOUT_MS;
+static apicache_t api_cache;       /* relay states and sensor ID as the TIVA last reported */
+static uint32_t api_cache_ms = APICACHE_MAX_AGE_MS;
+static uint8_t tiva_seq;           /* frames to the TIVA, under uart_lock */
+logsink_config_t sink_config;
+extern logring_t log_ring;
 /* file descriptor for uart device*/
 int file;
 sig_atomic_t logger_end,comm_thread_end,socket_end, decision_end, kill_process;
@@ -63,26 +84,20 @@ void signal_handler()
 	socket_end = 1;
 	decision_end  =1;
 	kill_process =1;
-	if(!fp_log)
-	{
-		fflush(fp_log);
-        fclose(fp_log);
-		fp_log = NULL;
-	}
 	close(file);
 	
-	mq_close(log_q);
-	mq_unlink(LOG_QUEUE);
-
-	mq_close(socket_q);
-	mq_unlink(SOCKET_QUEUE);
-
-	mq_close(sock_ans_q);
-	mq_unlink(SOCK_REPLY_QUEUE);
+	if(log_q != (mqd_t)-1)
+	{
+		mq_close(log_q);
+		mq_unlink(LOG_QUEUE);
+	}
 
 	pthread_cancel(comm_thread);
 	pthread_join(comm_thread, NULL);
+	if(trace_dir)
+		gtrace_close(&gesture_trace);
 	
+	/* the logger's cleanup handler flushes and closes the log file */
 	pthread_cancel(logger_thread);
 	pthread_join(logger_thread, NULL);
 
@@ -99,8 +114,61 @@ int  main(int argc, char *argv[]){
 
 	//uart_init();
 	int count =0 ;
+	int opt;
 	char *str1 = "gautham";
-	filename = argv[1];
+	size_t ring_capacity = LOGRING_CAPACITY;
+	uint8_t ring_policy = LOGRING_DROP_OLDEST;
+	uint8_t mirror_q = 0;
+
+	/* log file flush policy: -r records, -b bytes, -t ms, -d fsync period ms
+	 * log file format: -f tsv|bin, -i records per index entry (bin only)
+	 * log ring: -c capacity, -o newest|oldest|block overflow policy,
+	 * -q also publish records on the LOG_QUEUE mqueue for other processes
+	 * gesture capture: -g directory for the trace files
+	 * client API: -a ms before an unanswered request fails */
+	logsink_default_config(&sink_config);
+	while((opt = getopt(argc, argv, "r:b:t:d:f:i:c:o:qg:a:m:")) != -1)
+	{
+		switch(opt)
+		{
+			case 'r': sink_config.flush_records = strtoul(optarg, NULL, 0);
+				break;
+			case 'b': sink_config.flush_bytes = strtoul(optarg, NULL, 0);
+				break;
+			case 't': sink_config.flush_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'd': sink_config.fsync_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'f': sink_config.format = strcmp(optarg, "bin") ? LOGSINK_FORMAT_TSV : LOGSINK_FORMAT_BIN;
+				break;
+			case 'i': sink_config.index_interval = strtoul(optarg, NULL, 0);
+				break;
+			case 'c': ring_capacity = strtoul(optarg, NULL, 0);
+				break;
+			case 'o':
+				if(!strcmp(optarg, "newest"))
+					ring_policy = LOGRING_DROP_NEWEST;
+				else if(!strcmp(optarg, "block"))
+					ring_policy = LOGRING_BLOCK;
+				else
+					ring_policy = LOGRING_DROP_OLDEST;
+				break;
+			case 'q': mirror_q = 1;
+				break;
+			case 'g': trace_dir = optarg;
+				break;
+			case 'a': api_timeout_ms = strtoul(optarg, NULL, 0);
+				break;
+			case 'm': api_cache_ms = strtoul(optarg, NULL, 0);
+				break;
+			default:
+				printf("Usage: %s [-r records] [-b bytes] [-t ms] [-d fsync_ms] [-f tsv|bin] [-i interval]"
+						" [-c capacity] [-o newest|oldest|block] [-q] [-g tracedir] [-a api_timeout_ms] [-m cache_ms]"
+						" logfile\n", argv[0]);
+				return -1;
+		}
+	}
+	filename = argv[optind];
 
 	uart_init();
 
@@ -113,43 +181,46 @@ int  main(int argc, char *argv[]){
 	/* message quque for logging*/
 	kill_process = 0;
 
-	if(!argv[1])
+	if(!filename)
 	{
 		printf("No Filename entered \n");
 		return -1;
 	}
 
+	if(trace_dir)
+		gtrace_init(&gesture_trace, trace_dir);
+
+	if(logring_init(&log_ring, ring_capacity, ring_policy))
+	{
+		printf("Could not create log ring\n");
+		exit(1);
+	}
+	logring_register(&log_ring, "main");
+
 	struct mq_attr attr_log;
 	attr_log.mq_maxmsg = 5;
     attr_log.mq_msgsize = sizeof(Logger_t);
 
 	mq_unlink(LOG_QUEUE);
-	mq_unlink(SOCKET_QUEUE);
-	mq_unlink(SOCK_REPLY_QUEUE);
 
-	if((log_q = mq_open(LOG_QUEUE, O_RDWR | O_CREAT, 0666, &attr_log))==-1)
+	/* the logger thread mirrors into it without blocking, full means dropped */
+	if(mirror_q && (log_q = mq_open(LOG_QUEUE, O_RDWR | O_CREAT | O_NONBLOCK, 0666, &attr_log))==-1)
     	{
             perror("LOG QUEUE: ");
             exit(1);
    	 }
 
-    struct mq_attr attr;
-    attr.mq_maxmsg = 5;
-    attr.mq_msgsize = sizeof(int);
-    
-    
-    if((socket_q = mq_open(SOCKET_QUEUE, O_RDWR | O_CREAT | O_NONBLOCK, 0666, &attr))==-1)
-    {
-                perror("Socket QUEUE: ");
-                exit(1);
-    }
-
-	
-    if((sock_ans_q = mq_open(SOCK_REPLY_QUEUE, O_RDWR | O_CREAT, 0666, &attr))==-1)
-    {
-                perror("Socket_Reply QUEUE: ");
-                exit(1);
-    } 
+	/* before the communication thread can hand it answers */
+	if(apiserver_init(&api_server, PORT, tiva_request, NULL))
+	{
+		perror("API server: ");
+		exit(1);
+	}
+	apiserver_set_timeout(&api_server, api_timeout_ms);
+	/* -m 0 sends every read to the TIVA */
+	apicache_init(&api_cache, api_cache_ms);
+	if(api_cache_ms)
+		apiserver_set_cache(&api_server, &api_cache);
 
 	if(pthread_create(&comm_thread,NULL,communication,(void*)NULL))
 	{
@@ -232,92 +303,156 @@ int  main(int argc, char *argv[]){
 
 }
 
+/* the results of a batch: logged one record each, as the commands
+ * would have been alone, and handed to the API server together */
+static void tiva_batch_reply(const frame_t *frame)
+{
+	api_wire_request_t req;
+	api_wire_result_t wire[API_WIRE_BATCH_MAX];
+	api_result_t result[API_BATCH_MAX];
+	Logger_t log;
+	const char *text;
+	uint8_t count, k;
+
+	if(!api_wire_decode_batch_reply(frame->payload,frame->len,&req,wire,&count))
+	{
+		printf("LINK: bad batch reply len %d\n",frame->len);
+		return;
+	}
+	for(k = 0; k < count; k++)
+	{
+		memset(&log,0,sizeof(log));
+		log.value = wire[k].value;
+		log.log_level = wire[k].ok ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR;
+		log.log_source = LOG_SOURCE_TIVA_CLIENT;
+		if((text = log_wire_text(wire[k].msg)))
+			strncpy(log.message,text,MSG_SIZE);
+		else
+			snprintf(log.message,MSG_SIZE,"[TIVA] message %u",wire[k].msg);
+		log_record(&log);
+		apiserver_publish(&api_server,&log,0);
+		apicache_record(&api_cache,wire[k].msg,wire[k].value);
+
+		result[k].status = wire[k].ok ? API_OK : API_EFAILED;
+		result[k].value = wire[k].value;
+	}
+	if(req.id)
+		apiserver_reply_batch(&api_server,req.id,result,count);
+}
+
+/* handles one record received from TIVA */
+static void tiva_record(const frame_t *frame, void *arg)
+{
+	Logger_t log;
+	log_wire_t rec;
+	api_wire_request_t req = { 0 };
+	const char *text;
+	gesture_trace_t trace;
+	uint32_t events = 0;
+
+	/* gesture capture goes to its own files, not the log */
+	if(frame->type == FRAME_TYPE_GESTURE_TRACE)
+	{
+		if(trace_dir && gesture_trace_decode(frame->payload,frame->len,&trace))
+			gtrace_frame(&gesture_trace,&trace);
+		return;
+	}
+	if(frame->type == FRAME_TYPE_API_BATCH_REPLY)
+	{
+		tiva_batch_reply(frame);
+		return;
+	}
+
+	if(frame->type == FRAME_TYPE_LOG && frame->len == sizeof(Logger_t))
+		memcpy(&log,frame->payload,sizeof(log));
+	else if((frame->type == FRAME_TYPE_LOG_COMPACT && log_wire_decode(frame->payload,frame->len,&rec)) ||
+		(frame->type == FRAME_TYPE_API_REPLY && api_wire_decode_reply(frame->payload,frame->len,&req,&rec)))
+	{
+		/* expand to the full record the logger and clients expect */
+		memset(&log,0,sizeof(log));
+		log.value = rec.value;
+		log.timestamp = rec.timestamp;
+		log.log_level = rec.log_level;
+		log.log_source = rec.log_source;
+		if((text = log_wire_text(rec.msg)))
+			strncpy(log.message,text,MSG_SIZE);
+		else
+			snprintf(log.message,MSG_SIZE,"[TIVA] message %u",rec.msg);
+		/* relay switches and status reads keep the API cache current */
+		apicache_record(&api_cache,rec.msg,rec.value);
+		/* commands applied / relays switched / state */
+		if(rec.msg == LOG_MSG_RELAY_CYCLE && (rec.value >> 8 & 0xFF))
+			events |= API_EVENT_RELAY;
+	}
+	else
+	{
+		printf("LINK: unexpected frame type %d len %d\n",frame->type,frame->len);
+		return;
+	}
+
+	log_record(&log);
+	apiserver_publish(&api_server,&log,events);
+
+	/* only a reply frame answers a request, other client records are the TIVA's own */
+	if(req.id)
+		apiserver_reply(&api_server,req.id,log.log_level == LOG_LEVEL_ERROR ? API_EFAILED : API_OK,log.value);
+
+	if(log.log_level == LOG_LEVEL_ERROR)
+		identification_led();
+}
+
+static uint64_t now_ms(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
 static void* communication(void *arg){
 	
 	int count=0;
 	comm_thread_end = 0;
-	uint8_t val_hb = 1;
-	char recv;
-	int info=0,i;
-	uint8_t val;
-	uint32_t client_call= 0;
-	struct timespec tm;
-	uint32_t reply;
-	uint8_t  tiva_hb,val_from_tiva,proceed=1;
-	uint32_t checksum_rec=0;
-	Logger_t log,log_send;
+	uint8_t recv[FRAME_MAX_SIZE];
+	uint32_t errors,reported=0;
+	frame_parser_t parser;
+	struct pollfd pfd = { .fd = file, .events = POLLIN };
+	uint64_t now,hb_due = 0;
 	
+	logring_register(&log_ring, "comm");
 	LOG(LOG_LEVEL_INIT,LOG_SOURCE_COMM,"BBG_COMMUNICAION_Task Initialised",NULL,NULL);
-	memset(&log,'\0',sizeof(Logger_t));
+	frame_parser_init(&parser);
 	while(!comm_thread_end)
 	{
 		
 		hb_comm =1;
 		
-		if(proceed == 1)
-		{	
-			printf("blocked\n");
-			count = read(file,&log,sizeof(log));
-
-			//if(count ==0)
-			//	proceed =0;
-			printf("first read%d\n",count);
-			printf("nnn");
-			//checksum_rec = log.timestamp ^ log.log_level ^ log.log_source ;
-			//checksum_rec ^= log.log_level;
-			//checksum_rec ^= log.log_source;
-			/*
-			for(i= 0; i<MSG_SIZE;i++) 
-				checksum_rec ^= log.message[i];
-			*/
-
-			//if (checksum_rec == log.checksum)
-			//	printf("Perfect Checksum\n");	
-
-			//printf(" made : %d \n",checksum_rec);
-		       //printf("original : %d \n", log.checksum);
-			printf("tiva log Heartbeat %d\n",log.log_level);
-			if(log.log_level == LOG_LEVEL_HEARTBEAT || log.log_level == LOG_LEVEL_INIT ||  log.log_level==LOG_LEVEL_INFO )
-			{
-				tiva_hb = 0x4d;
-				usleep(1000);
-				pthread_mutex_lock(&uart_lock);
-				count = write(file,&tiva_hb,sizeof(tiva_hb));
-				pthread_mutex_unlock(&uart_lock);
-				printf("hi\n");
-				tiva_hb = 0;
-			}
-
-
-			if((mq_send(log_q, &log, sizeof(log),0))==-1)
-	        {
-	            printf("cant send message to process1 and returned %d\n", errno);
-	        } 
-
-
-	        /* sending vaue to client of conecton requests using message queue*/
-			client_call = log.log_source;
-			if(client_call == 18){
-
-				printf("Vallll %d",log.value);
-				reply = log.value;
-				printf("reply : %d\n",reply);
-				printf("valueee\n\n\n");
-
-				if((mq_send(sock_ans_q,&reply,sizeof(reply),0))==-1)
-				{
-					printf("Cannot write client call answer\n");
-				}
-			}
-			
-			
-			if(log.log_level == LOG_LEVEL_ERROR)
-				identification_led();
-		
+		/* the TIVA stops sending after 5 s without a frame from the BBG */
+		now = now_ms();
+		if(now >= hb_due)
+		{
+			tiva_send(0,API_OP_HEARTBEAT);
+			hb_due = now + TIVA_HEARTBEAT_MS;
+		}
+		if(poll(&pfd,1,(int)(hb_due - now)) <= 0)
+			continue;
+		/* read whatever arrived, the parser keeps partial frames */
+		count = read(file,recv,sizeof(recv));
+		if(count <= 0)
+			continue;
+		frame_parser_feed(&parser,recv,count,tiva_record,NULL);
+
+		errors = parser.stats.crc_errors + parser.stats.len_errors + parser.stats.lost;
+		if(errors != reported)
+		{
+			reported = errors;
+			/* a lost record may have been a relay switching */
+			apicache_invalidate(&api_cache);
+			printf("LINK: frames %u crc errors %u len errors %u lost %u skipped %u bytes\n",
+				parser.stats.frames,parser.stats.crc_errors,parser.stats.len_errors,
+				parser.stats.lost,parser.stats.bytes_skipped);
+			LOG(LOG_LEVEL_ERROR,LOG_SOURCE_COMM,"UART link errors",errors,0);
 		}
-		//sleep(1);
-
-		
 	}
 
 	//close(file);
@@ -325,31 +460,28 @@ static void* communication(void *arg){
 }
 
 
+static void logger_cleanup(void *arg)
+{
+	logsink_close((logsink_t *)arg);
+}
+
 static void* logger(void *arg){	
 
-	//char *filename = argv[1];
+	static logsink_t sink;
 	Logger_t log;
 	uint8_t val_hb = 3;
 	struct timespec tm1;
-	fp_log = fopen(filename, "wb");
 
 	logger_end =0 ;
 	
-	if(!fp_log)
+	if(logsink_open(&sink, filename, &sink_config) < 0)
 	{
 		printf("File can't be opened\n");
                 exit(1);
 	}  
+	pthread_cleanup_push(logger_cleanup, &sink);
 
-	fprintf(fp_log, "Timestamp\t");
-    fprintf(fp_log, "LOG_LEVEL\t");
-    fprintf(fp_log, "LOG_SOURCE\t");
-    fprintf(fp_log, "Value\t");
-    fprintf(fp_log, "Message\r\n");
-    fflush(fp_log);
-    fclose(fp_log);
-    fp_log = NULL;
-
+	logring_register(&log_ring, "logger");
     LOG(LOG_LEVEL_INIT,LOG_SOURCE_LOGGER,"BBG_Logger_Task Initialised",NULL,NULL);
     while(!logger_end)
     {
@@ -357,157 +489,113 @@ static void* logger(void *arg){
 
     	hb_logger =1;
 
-    	fp_log = fopen(filename, "a");
-        	if(!fp_log)
-                	exit(1);
-		
-		if((mq_receive(log_q, &log, sizeof(Logger_t), 0))==-1)
+		/* block until a record arrives or the flush policy has a deadline */
+		if(logring_pop(&log_ring, &log) == -1)
 		{
-			printf("Din't receive message from commn thread and returned %d\n", errno);
-			exit(1);
+			logring_wait(&log_ring, logsink_timeout_ms(&sink));
+			if(logring_pop(&log_ring, &log) == -1)
+			{
+				logsink_poll(&sink);
+				continue;
+			}
 		}
-		
-		
-		if(log.timestamp == NULL)
-			log.timestamp = tm1.tv_sec;
-		 fprintf(fp_log, "%d\t\t",log.timestamp);
-        	fprintf(fp_log, "%d\t\t",log.log_level);
-        	fprintf(fp_log, "%d\t\t", log.log_source);	
-        	fprintf(fp_log, "%d\t",log.value);
-        	fprintf(fp_log, "%s\n", log.message);
-		
-			fflush(fp_log);
-			fclose(fp_log);
-			fp_log = NULL;
-
 
+		/* drain everything already queued into the same batch */
+		clock_gettime(CLOCK_REALTIME, &tm1);
+		do
+		{
+			if(log.timestamp == 0)
+				log.timestamp = tm1.tv_sec;
+			logsink_append(&sink, &log);
+			if(log_q != (mqd_t)-1)
+				mq_send(log_q, (char *)&log, sizeof(log), 0);
+		}while(logring_pop(&log_ring, &log) != -1);
+
+		logsink_poll(&sink);
+		logring_report(&log_ring, stdout);
     }
 
+	pthread_cleanup_pop(1);
 }
 
 
-static void* socket_cli(void *arg)
+/* one frame to the TIVA */
+static int tiva_write(uint8_t type, const uint8_t *payload, uint8_t len)
 {
-	int sock;
-	socket_end = 0;
-	uint8_t val_hb = 2;
-	struct sockaddr_in address;
-	int len = sizeof(address);
-	int count =0,option =1;
-	uint32_t request,info,reply;
-	uint8_t val;
-	LOG(LOG_LEVEL_INIT,LOG_SOURCE_SERVER,"BBG_Server_Task Initialised",NULL,NULL);
-	int server,read_sock;
+	uint8_t frame[FRAME_MAX_SIZE];
+	uint16_t size;
+	int count;
+
+	pthread_mutex_lock(&uart_lock);
+	size = frame_encode(frame,type,tiva_seq++,payload,len);
+	count = write(file,frame,size);
+	pthread_mutex_unlock(&uart_lock);
+	return size && count == size ? 0 : -1;
+}
 
-	if((server = socket(AF_INET, SOCK_STREAM, 0))==0)
-	{
-		printf("server creation failed");
-		exit(1);
-	} 
+/* one request frame to the TIVA, id 0 wants no reply */
+static int tiva_send(uint16_t id, uint8_t opcode)
+{
+	api_wire_request_t req = { id, opcode };
+	uint8_t payload[API_WIRE_REQUEST_SIZE];
 
-	/* set socket options */
-	if(setsockopt(server, SOL_SOCKET, SO_REUSEADDR | SO_REUSEPORT, &option, sizeof(option)))
-	{
-		printf("Can't set socket");
-		exit(1);
-	}
+	return tiva_write(FRAME_TYPE_API_REQUEST,payload,api_wire_encode_request(payload,&req));
+}
 
-	address.sin_family = AF_INET;
-	address.sin_addr.s_addr = INADDR_ANY;
-	address.sin_port = htons(PORT);
-	
-	/* bind the socket to port mentioned */
-	if((bind(server, (struct sockaddr *)&address, sizeof(address)))<0)
-	{
-		printf("Port binding failed");
-		exit(NULL);
-	}
+/* sends an API request to the TIVA, the reply frame echoes corr; a batch
+ * goes as one frame */
+static int tiva_request(uint32_t corr, uint8_t opcode, const api_batch_t *batch, void *arg)
+{
+	api_wire_batch_t wire;
+	uint8_t payload[API_WIRE_BATCH_MAX_SIZE];
+	uint32_t k;
+
+	if(!batch)
+		return tiva_send(corr,opcode);
 
-	if(listen(server, 3) < 0)
+	wire.req.id = corr;
+	wire.req.opcode = opcode;
+	wire.count = batch->count;
+	for(k = 0; k < batch->count && k < API_WIRE_BATCH_MAX; k++)
 	{
-			//LOG(LOG_LEVEL_ERROR, SOCK_TASK, "Can't listen", NULL);i
-			perror("Listen: \n");
+		wire.cmd[k].opcode = batch->cmd[k].opcode;
+		wire.cmd[k].arg = batch->cmd[k].arg;
 	}
+	return tiva_write(FRAME_TYPE_API_BATCH,payload,api_wire_encode_batch(payload,&wire));
+}
 
+static void* socket_cli(void *arg)
+{
+	apiserver_stats_t stats;
+	uint64_t reported = 0;
+	time_t last_report = time(NULL);
 
+	socket_end = 0;
+	logring_register(&log_ring, "server");
 	LOG(LOG_LEVEL_INIT,LOG_SOURCE_SERVER,"BBG_Server_Task Initialised",NULL,NULL);
 	while(!socket_end)
 	{
-		
-
 		hb_socket=1;
 
-		sock = accept(server, (struct sockaddr *)&address, (socklen_t *)&len);
-		if(sock < 0)
+		if(apiserver_poll(&api_server, 1000) < 0)
+			perror("API server: ");
+
+		apiserver_get_stats(&api_server, &stats);
+		if(stats.unmatched + stats.overruns != reported)
 		{
-			//LOG(ERROR, SOCK_TASK, "Can't accept connection", NULL);
-			perror("Accept: \n");
+			reported = stats.unmatched + stats.overruns;
+			LOG(LOG_LEVEL_ERROR,LOG_SOURCE_SERVER,"Unmatched TIVA answers",reported,0);
 		}
-		
-		
-		read_sock = read(sock, &request, sizeof(request));
-
-		printf("Client Value %d\n",request);
 
-		switch(request)
-					{
-
-						case 1 : val = 0x01;
-						 	break;
-						case 2 : val = 0x02;
-							break;
-						case 3: val = 0x03;
-					       		break;
-						case 4 : val = 0x04;
-					 		break;
-						case 5 : val = 0x05;
-							break;
-						case 6 : val = 0x06;
-							break;
-						case 7 : val = 0x07;
-							break;
-						case 8 : val = 0x08;
-				       			break;
-						default: ;
-				 	}
-
-
-		printf("val set conf : %d", val);
-		pthread_mutex_lock(&uart_lock);
-
-		count = write(file,&val,sizeof(val));
-		//printf("count : %d",count);
-
-		pthread_mutex_unlock(&uart_lock);
-
-
-
-
-/*
-		if((mq_send(socket_q, &info, sizeof(info),0))== -1)
-        {
-            printf("cant send message to comm thread and returned %d\n", errno);
-      	 }
-
-*/
-
-       	if((mq_receive(sock_ans_q, &reply, sizeof(reply), 0))==-1)
+		/* latency per opcode once a minute */
+		if(time(NULL) - last_report >= 60)
 		{
-			printf("Din't receive message from commn thread and returned %d\n", errno);
-			exit(1);
+			last_report = time(NULL);
+			apiserver_report(&api_server, stdout);
 		}
-
-		printf("mq_rec socket %d",reply);
-		if(reply>0)
-			reply = 1;
-
-		send(sock,&reply,sizeof(reply),0);
-		printf("reply to client %d\n\n\n\n",reply);
-
-
-		//usleep(1000);
-		close(sock);
 	}
+	apiserver_close(&api_server);
 }
 
 
+
@@ -23,51 +23,254 @@
 
 /* define port number */
 
+/* scene file commands: one per line, "relay0 on", "gain-up", # comments */
+typedef struct scene_cmd
+{
+	const char *name;
+	uint16_t opcode;
+	uint8_t on_off;         /* takes on or off */
+}scene_cmd_t;
+
+static const scene_cmd_t scene_cmds[] =
+{
+	{ "relay0-status",  API_OP_RELAY0_STATUS,   0 },
+	{ "relay1-status",  API_OP_RELAY1_STATUS,   0 },
+	{ "sensor-id",      API_OP_SENSOR_ID,       0 },
+	{ "sensor-enable",  API_OP_SENSOR_ENABLE,   0 },
+	{ "sensor-disable", API_OP_SENSOR_DISABLE,  0 },
+	{ "gain-up",        API_OP_GAIN_UP,         0 },
+	{ "relays-on",      API_OP_RELAYS_ON,       0 },
+	{ "relays-off",     API_OP_RELAYS_OFF,      0 },
+	{ "trace-start",    API_OP_TRACE_START,     0 },
+	{ "trace-stop",     API_OP_TRACE_STOP,      0 },
+	{ "relay0",         API_OP_RELAY0_SET,      1 },
+	{ "relay1",         API_OP_RELAY1_SET,      1 },
+};
+
+#define SCENE_CMDS (sizeof(scene_cmds) / sizeof(scene_cmds[0]))
+
+static const char *scene_name(uint16_t opcode)
+{
+	uint32_t k;
+
+	for(k = 0; k < SCENE_CMDS; k++)
+		if(scene_cmds[k].opcode == opcode)
+			return scene_cmds[k].name;
+	return "?";
+}
+
+/* reads a scene file into batch, -1 after printing what is wrong with it */
+static int scene_load(const char *path, api_batch_t *batch)
+{
+	char line[128], name[32], arg[8];
+	FILE *fp;
+	int lineno = 0, fields;
+	uint32_t k;
+
+	if(!(fp = fopen(path, "r")))
+	{
+		perror(path);
+		return -1;
+	}
+	memset(batch, 0, sizeof(*batch));
+	while(fgets(line, sizeof(line), fp))
+	{
+		lineno++;
+		if(strchr(line, '#'))
+			*strchr(line, '#') = '\0';
+		if((fields = sscanf(line, "%31s %7s", name, arg)) < 1)
+			continue;
+		for(k = 0; k < SCENE_CMDS && strcmp(scene_cmds[k].name, name); k++)
+			;
+		if(k == SCENE_CMDS || (fields == 2) != scene_cmds[k].on_off ||
+		   (fields == 2 && strcmp(arg, "on") && strcmp(arg, "off")))
+		{
+			printf("%s:%d: unknown command %s\n", path, lineno, name);
+			fclose(fp);
+			return -1;
+		}
+		if(batch->count == API_BATCH_MAX)
+		{
+			printf("%s:%d: more than %d commands\n", path, lineno, API_BATCH_MAX);
+			fclose(fp);
+			return -1;
+		}
+		batch->cmd[batch->count].opcode = scene_cmds[k].opcode;
+		batch->cmd[batch->count].arg = fields == 2 && !strcmp(arg, "on");
+		batch->count++;
+	}
+	fclose(fp);
+	if(!batch->count)
+	{
+		printf("%s: no commands\n", path);
+		return -1;
+	}
+	return 0;
+}
+
+/* sends a scene as one batch request and prints each command's result */
+static int scene_run(int client, const char *path, uint32_t id, uint16_t flags)
+{
+	struct
+	{
+		api_request_t req;
+		api_batch_t batch;
+	}msg;
+	api_reply_t reply;
+	api_batch_reply_t results;
+	uint32_t k;
+
+	if(scene_load(path, &msg.batch))
+		return -1;
+	msg.req.id = id;
+	msg.req.opcode = API_OP_BATCH;
+	msg.req.flags = flags;
+	send(client, &msg, sizeof(msg), 0);
+
+	if(recv(client, &reply, sizeof(reply), MSG_WAITALL) != sizeof(reply) ||
+	   recv(client, &results, sizeof(results), MSG_WAITALL) != sizeof(results))
+	{
+		printf("Server closed the connection\n");
+		return -1;
+	}
+	if(reply.status != API_OK)
+	{
+		printf("Scene %s failed: %s\n", path, reply.status == API_EINVAL ? "rejected" :
+			reply.status == API_EBUSY ? "server busy" : "TIVA not reachable");
+		return -1;
+	}
+	printf("Scene %s\n", path);
+	for(k = 0; k < reply.value && k < API_BATCH_MAX; k++)
+		printf("  %-14s %s %u\n", scene_name(msg.batch.cmd[k].opcode),
+			results.result[k].status == API_OK ? "done  " : "failed", results.result[k].value);
+	return 0;
+}
+
+/* subscribes with filter, all, relay or error, and prints records until the server closes */
+static int watch(int client, const char *filter, uint32_t id)
+{
+	struct
+	{
+		api_request_t req;
+		api_subscribe_t filter;
+	}msg;
+	api_reply_t reply;
+	api_event_t event;
+	uint32_t dropped = 0;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.req.id = id;
+	msg.req.opcode = API_OP_SUBSCRIBE;
+	if(!strcmp(filter, "relay"))
+		msg.filter.events = API_EVENT_RELAY;
+	else if(!strcmp(filter, "error"))
+		msg.filter.levels = 1u << LOG_LEVEL_ERROR;
+	else if(strcmp(filter, "all"))
+	{
+		printf("Unknown filter %s, all, relay or error\n", filter);
+		return -1;
+	}
+	send(client, &msg, sizeof(msg), 0);
+	if(recv(client, &reply, sizeof(reply), MSG_WAITALL) != sizeof(reply) || reply.status != API_OK)
+	{
+		printf("Subscribe failed\n");
+		return -1;
+	}
+
+	while(recv(client, &event, sizeof(event), MSG_WAITALL) == sizeof(event))
+	{
+		if(event.dropped != dropped)
+		{
+			printf("(%u records lost)\n", event.dropped - dropped);
+			dropped = event.dropped;
+		}
+		printf("%u level %u source %u %.*s %u\n", event.log.timestamp, event.log.log_level,
+			event.log.log_source, MSG_SIZE, event.log.message, event.log.value);
+		fflush(stdout);
+	}
+	return 0;
+}
+
 /********************************************************************************************************
 *
 * @name main
 * @brief main function
 *
-* Opens a socket and binds it to port. connects to server and sends data.
-* log the incoming data from server
+* Connects to the server once and sends one request per menu choice on
+* the same connection, then logs the reply. With -f the status and ID
+* reads always go to the TIVA instead of the BBG's cached answer. Scene
+* files given on the command line are each sent as one batch instead,
+* and the client exits when they are done. -e prints the records from the
+* TIVA as they arrive: all, relay switches, or errors.
 *
-* @param None
+* @param [-f] [-e all|relay|error] [scene ...]
 *
 * @return zero on successful execution, otherwise error code
 *
 ********************************************************************************************************/
 
-int main()
+int main(int argc, char *argv[])
 {
 
     int client, sock, read_sock;
 	int repeat=0;
     struct sockaddr_in address;
     int len = sizeof(address);
-    uint32_t opt, recv;
+    uint32_t opt, value, id = 0;
+	api_request_t request;
+	api_reply_t reply;
+	uint16_t flags = 0;
+	int arg, scenes = 0, failed = 0;
+	const char *filter = NULL;
 
 	/* open socket */
-	while(!repeat)
-	{	
-        if((client = socket(AF_INET, SOCK_STREAM, 0))<0)
-        {
-                printf("Client creation failed\n");
-                exit(0);
-        }
-	
-		address.sin_family = AF_INET;
-		address.sin_port = htons(PORT);
-	
-		/* converts IP address to proper format */
-		if((inet_pton(AF_INET, "127.0.0.1", &address.sin_addr))<=0)
+    if((client = socket(AF_INET, SOCK_STREAM, 0))<0)
+    {
+            printf("Client creation failed\n");
+            exit(0);
+    }
+
+	address.sin_family = AF_INET;
+	address.sin_port = htons(PORT);
+
+	/* converts IP address to proper format */
+	if((inet_pton(AF_INET, "127.0.0.1", &address.sin_addr))<=0)
+	{
+		printf("Addr error\n");
+	}
+
+	if((connect(client, (struct sockaddr *)&address, sizeof(address)))<0)
+	{
+		perror("connect:");
+		exit(1);
+	}
+
+	for(arg = 1; arg < argc; arg++)
+	{
+		if(!strcmp(argv[arg], "-f"))
+			flags = API_FLAG_REFRESH;
+		else if(!strcmp(argv[arg], "-e") && arg + 1 < argc)
+			filter = argv[++arg];
+	}
+	for(arg = 1; arg < argc; arg++)
+	{
+		if(!strcmp(argv[arg], "-e"))
+			arg++;
+		else if(strcmp(argv[arg], "-f"))
 		{
-			printf("Addr error\n");
+			scenes++;
+			failed |= scene_run(client, argv[arg], ++id, flags) != 0;
 		}
-	
-		if((connect(client, (struct sockaddr *)&address, sizeof(address)))<0)
-			perror("connect:");
-		
-		
+	}
+	/* the connection only streams records once subscribed */
+	if(filter)
+		failed |= watch(client, filter, ++id) != 0;
+	if(scenes || filter)
+		repeat = 1;
+
+	/* the connection stays open for every request */
+	while(!repeat)
+	{	
 
 		printf("Choose Any option\n");
 		printf("1. Read Relay 1 status \n");
@@ -78,68 +281,76 @@ int main()
 		printf("6. Increase Gain of Input\n");
 		printf("7. Perform Gesture of turning on both devices \n");
 		printf("8. Perform Gesture of turning off both devices \n");
+		printf("9. Start gesture capture\n");
+		printf("10. Stop gesture capture\n");
 		
-		scanf("%d", &opt);
-			
+		if(scanf("%d", &opt) != 1)
+			break;
+
+		request.id = ++id;
+		request.opcode = opt;
+		request.flags = flags;
+		send(client, &request, sizeof(request), 0);
 
-		send(client, &opt, sizeof(opt), 0);
-			
-		read(client, &recv, sizeof(recv));
+		if(recv(client, &reply, sizeof(reply), MSG_WAITALL) != sizeof(reply))
+		{
+			printf("Server closed the connection\n");
+			break;
+		}
+		if(reply.status != API_OK)
+		{
+			printf("Request %d failed: %s\n", opt, reply.status == API_EINVAL ? "unknown option" :
+				reply.status == API_EBUSY ? "server busy" :
+				reply.status == API_EFAILED ? "TIVA could not do it" : "TIVA not reachable");
+			continue;
+		}
+		value = reply.value;
 	
 		if(opt==1){
-			if(recv == 0)
+			if(value == 0)
 				printf("RELAY 1 is switched OFF\n"); 
 			else
 				printf("RELAY 1 is switched ON\n"); 
 		}
 		else if(opt ==2){
-			if(recv == 0)
+			if(value == 0)
 				printf("RELAY 2 is switched OFF\n"); 
 			else
 				printf("RELAY 2 is switched ON\n"); 
 		}
 
 		else if(opt ==3)
-			printf("Gesture Sensor ID : %d \n",recv);
+			printf("Gesture Sensor ID : %d \n",value);
 		
-		else if(opt ==4){
-			if(recv == 0)
-				printf("Gesture Sensor Enable Failed\n"); 
-			else
-				printf("Gesture Sensor Enable Done\n"); 
-		}
-		else if(opt ==5){
-			if(recv == 0)
-				printf("Gesture Sensor disable failed\n"); 
-			else
-				printf("Gesture Sensor Disable done\n"); 
-		}
-
-		else if(opt ==6){
-			if(recv == 0)
-				printf("Increase Gain : Not performed\n"); 
-			else
-				printf("Increase Gain : Performed\n"); 
-		}	
+		/* failures come back as API_EFAILED, the gesture task applies these later */
+		else if(opt ==4)
+			printf("Gesture Sensor Enable queued\n");
+		else if(opt ==5)
+			printf("Gesture Sensor Disable queued\n");
+		else if(opt ==6)
+			printf("Increase Gain : queued\n");
 
 		else if(opt ==7){
-			if(recv == 0)
+			if(value == 0)
 				printf("Both Sensors not turned ON\n"); 
 			else
 				printf("Both Sensors turned ON\n"); 
 		}				
 
 		else if(opt ==8){
-			if(recv == 0)
+			if(value == 0)
 				printf("Both Sensors not turned OFF\n"); 
 			else
 				printf("Both Sensors turned OFF\n"); 
 		}
-			
 
-		close(client);
+		else if(opt ==9)
+			printf("Gesture capture %s\n", value ? "started" : "not started");
+
+		else if(opt ==10)
+			printf("Gesture capture %s\n", value ? "stopped" : "not stopped");
 	}
-	//close(client);
 	shutdown(client, 2);
-	return 0;
+	close(client);
+	return failed;
 }
\ No newline at end of file
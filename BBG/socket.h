@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <mqueue.h>
+#include "log.h"
 
 #define PORT 5000
 
@@ -15,5 +16,103 @@
 #define RELAY 1
 #define GESTURE_SENSOR 2
 
+/* API opcodes, the byte sent on to the TIVA */
+#define API_OP_RELAY0_STATUS    (1)
+#define API_OP_RELAY1_STATUS    (2)
+#define API_OP_SENSOR_ID        (3)       /* in a batch, arg the sensor, 0 first */
+#define API_OP_SENSOR_ENABLE    (4)       /* in a batch, arg the sensor, 0 first; answered once queued */
+#define API_OP_SENSOR_DISABLE   (5)       /* in a batch, arg the sensor, 0 first; answered once queued */
+#define API_OP_GAIN_UP          (6)       /* in a batch, arg the sensor, 0 first; answered once queued */
+#define API_OP_RELAYS_ON        (7)
+#define API_OP_RELAYS_OFF       (8)
+#define API_OP_TRACE_START      (9)
+#define API_OP_TRACE_STOP       (10)
+#define API_OP_RELAY0_SET       (11)      /* in a batch, arg 1 on, 0 off */
+#define API_OP_RELAY1_SET       (12)      /* in a batch, arg 1 on, 0 off */
+#define API_OP_BATCH            (13)      /* followed by an api_batch_t */
+#define API_OP_SUBSCRIBE        (14)      /* followed by an api_subscribe_t */
+#define API_OP_MAX              (14)
+
+#define API_BATCH_MAX           (8)       /* commands in one batch */
+
+/* request flags */
+#define API_FLAG_REFRESH        (0x0001)  /* read from the TIVA even when the BBG knows the answer */
+
+/* subscription events */
+#define API_EVENT_RELAY         (0x0001)  /* a relay switched */
+
+/* reply status */
+#define API_OK                  (0)
+#define API_EINVAL              (-1)      /* unknown opcode */
+#define API_EBUSY               (-2)      /* too many requests waiting for the TIVA */
+#define API_EIO                 (-3)      /* could not write to the TIVA */
+#define API_ETIMEDOUT           (-4)      /* no answer from the TIVA in time */
+#define API_EFAILED             (-5)      /* the TIVA could not carry it out */
+
+/* A connection stays open for any number of requests, and a client may
+ * send several before reading the replies. Replies come back in the
+ * order the TIVA answers, the id tells them apart. Host byte order. */
+typedef struct api_request
+{
+	uint32_t id;            /* chosen by the client, echoed in the reply */
+	uint16_t opcode;        /* API_OP_* */
+	uint16_t flags;         /* API_FLAG_* */
+}api_request_t;
+
+typedef struct api_reply
+{
+	uint32_t id;
+	int32_t status;         /* API_OK or API_E* */
+	uint32_t value;         /* the TIVA's answer when status is API_OK */
+}api_reply_t;
+
+/* An API_OP_BATCH request is followed by the commands, which the TIVA
+ * runs one after the other before it reads anything else, queueing their
+ * relay switches together. Its reply is always followed by the results,
+ * in command order: value is the count, and the results are zero when
+ * status is not API_OK. */
+typedef struct api_cmd
+{
+	uint16_t opcode;        /* API_OP_*, not API_OP_BATCH */
+	uint16_t arg;
+}api_cmd_t;
+
+typedef struct api_batch
+{
+	uint32_t count;         /* 1 to API_BATCH_MAX */
+	api_cmd_t cmd[API_BATCH_MAX];
+}api_batch_t;
+
+typedef struct api_result
+{
+	int32_t status;         /* API_OK or API_EFAILED */
+	uint32_t value;
+}api_result_t;
+
+typedef struct api_batch_reply
+{
+	api_result_t result[API_BATCH_MAX];
+}api_batch_reply_t;
+
+/* An API_OP_SUBSCRIBE request, on a connection with nothing else
+ * outstanding, is followed by the filter. Its reply is followed by an
+ * api_event_t for every record from the TIVA that passes, until the
+ * client closes the connection; it takes no more requests. A record
+ * passes when the bits of its source and level are set, 0 passing any,
+ * and it is all of the events asked for. A subscriber that does not
+ * keep up loses records, dropped counts them. */
+typedef struct api_subscribe
+{
+	uint32_t sources;       /* bit n for log_source n */
+	uint32_t levels;        /* bit n for log_level n */
+	uint32_t events;        /* API_EVENT_* */
+}api_subscribe_t;
+
+typedef struct api_event
+{
+	uint32_t dropped;       /* records lost to this subscriber so far */
+	Logger_t log;
+}api_event_t;
+
 
 #endif
@@ -0,0 +1,221 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file freertos_sim.c
+* @brief Host stand-ins for the FreeRTOS calls made by the TIVA drivers
+*
+* Notification wake-ups are never reported as a context switch, so the
+* CCS portYIELD_FROM_ISR macro never touches the NVIC on the host.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "freertos_sim.h"
+
+static bool running;
+static void (*blockHook)(void);
+static TickType_t ticks;
+static uint32_t notifyValue;
+static bool notifyPending;
+static int nesting, held;
+static void *tls[FREERTOS_SIM_TASKS];
+static unsigned task;
+
+/* semaphores and mutexes, a mutex starts given */
+typedef struct
+{
+	int count;
+	bool mutex;
+}sim_sem_t;
+
+static sim_sem_t sems[32];
+static int semCount;
+static void *waitingOn;
+
+void freertos_sim_set_running(bool on)
+{
+	running = on;
+	notifyValue = 0;
+	notifyPending = false;
+}
+
+void freertos_sim_set_block_hook(void (*hook)(void))
+{
+	blockHook = hook;
+}
+
+uint32_t freertos_sim_ticks(void)
+{
+	return ticks;
+}
+
+void freertos_sim_advance(uint32_t n)
+{
+	ticks += n;
+}
+
+void *freertos_sim_waiting_on(void)
+{
+	return waitingOn;
+}
+
+/* let the test deliver what the task is waiting for */
+static void block(void *obj)
+{
+	if(!blockHook)
+		return;
+	waitingOn = obj;
+	blockHook();
+	waitingOn = NULL;
+}
+
+int freertos_sim_critical_nesting(void)
+{
+	return nesting;
+}
+
+int freertos_sim_mutexes_held(void)
+{
+	return held;
+}
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+	return running ? taskSCHEDULER_RUNNING : taskSCHEDULER_NOT_STARTED;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+	return (TaskHandle_t)&notifyValue;
+}
+
+void freertos_sim_set_task(unsigned n)
+{
+	task = n % FREERTOS_SIM_TASKS;
+}
+
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t xTaskToSet, BaseType_t xIndex, void *pvValue)
+{
+	tls[task] = pvValue;
+}
+
+void *pvTaskGetThreadLocalStoragePointer(TaskHandle_t xTaskToQuery, BaseType_t xIndex)
+{
+	return tls[task];
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+	return ticks;
+}
+
+void vPortEnterCritical(void)
+{
+	nesting++;
+}
+
+void vPortExitCritical(void)
+{
+	nesting--;
+}
+
+static QueueHandle_t semCreate(int count, bool mutex)
+{
+	if(semCount == sizeof(sems) / sizeof(sems[0]))
+		return NULL;
+	sems[semCount].count = count;
+	sems[semCount].mutex = mutex;
+	return (QueueHandle_t)&sems[semCount++];
+}
+
+QueueHandle_t xQueueCreateMutex(const uint8_t ucQueueType)
+{
+	return semCreate(1, true);
+}
+
+QueueHandle_t xQueueGenericCreate(const UBaseType_t uxQueueLength, const UBaseType_t uxItemSize,
+				  const uint8_t ucQueueType)
+{
+	return semCreate(0, false);
+}
+
+BaseType_t xQueueSemaphoreTake(QueueHandle_t xQueue, TickType_t xTicksToWait)
+{
+	sim_sem_t *sem = (sim_sem_t *)xQueue;
+
+	/* a taken mutex would deadlock the only task */
+	if(!sem->count && !sem->mutex)
+		block(sem);
+	if(!sem->count)
+	{
+		if(!sem->mutex)
+			ticks += xTicksToWait;
+		return pdFALSE;
+	}
+	sem->count--;
+	if(sem->mutex)
+		held++;
+	return pdTRUE;
+}
+
+BaseType_t xQueueGenericSend(QueueHandle_t xQueue, const void * const pvItemToQueue,
+			     TickType_t xTicksToWait, const BaseType_t xCopyPosition)
+{
+	sim_sem_t *sem = (sim_sem_t *)xQueue;
+
+	if(sem->count)
+		return pdFALSE;
+	sem->count = 1;
+	if(sem->mutex)
+		held--;
+	return pdTRUE;
+}
+
+BaseType_t xQueueGiveFromISR(QueueHandle_t xQueue, BaseType_t * const pxHigherPriorityTaskWoken)
+{
+	return xQueueGenericSend(xQueue, NULL, 0, 0);
+}
+
+BaseType_t xTaskGenericNotifyFromISR(TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction,
+				     uint32_t *pulPreviousNotificationValue, BaseType_t *pxHigherPriorityTaskWoken)
+{
+	if(pulPreviousNotificationValue)
+		*pulPreviousNotificationValue = notifyValue;
+	if(eAction == eSetBits)
+		notifyValue |= ulValue;
+	else if(eAction == eIncrement)
+		notifyValue++;
+	else if(eAction != eNoAction)
+		notifyValue = ulValue;
+	notifyPending = true;
+	return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t ulBitsToClearOnEntry, uint32_t ulBitsToClearOnExit,
+			   uint32_t *pulNotificationValue, TickType_t xTicksToWait)
+{
+	if(!notifyPending)
+	{
+		notifyValue &= ~ulBitsToClearOnEntry;
+		block(NULL);
+	}
+	if(!notifyPending)
+	{
+		ticks += xTicksToWait;
+		return pdFALSE;
+	}
+	if(pulNotificationValue)
+		*pulNotificationValue = notifyValue;
+	notifyValue &= ~ulBitsToClearOnExit;
+	notifyPending = false;
+	return pdTRUE;
+}
@@ -0,0 +1,49 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file freertos_sim.h
+* @brief Host stand-ins for the FreeRTOS calls made by the TIVA drivers
+*
+* One task, no preemption. A task that blocks runs the block hook first,
+* which is where a test delivers the interrupts the task waits for. If
+* nothing arrives the wait times out and the tick count moves on.
+* Semaphores hold at most one count, mutexes never block.
+*
+* Thread local storage has one slot per task number; a test switches the
+* calling "task" with freertos_sim_set_task() to run several driver
+* instances in turn.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef FREERTOS_SIM_H
+#define FREERTOS_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FREERTOS_SIM_TASKS      (4)
+
+/* drivers poll until this is set, as they do before vTaskStartScheduler */
+void freertos_sim_set_running(bool running);
+
+void freertos_sim_set_block_hook(void (*hook)(void));
+
+uint32_t freertos_sim_ticks(void);
+void freertos_sim_advance(uint32_t ticks);
+
+/* selects whose thread local storage pointer the driver sees */
+void freertos_sim_set_task(unsigned task);
+
+/* inside the block hook: the semaphore being taken, NULL for a notification */
+void *freertos_sim_waiting_on(void);
+
+/* critical section nesting and mutexes held, both 0 between driver calls */
+int freertos_sim_critical_nesting(void);
+int freertos_sim_mutexes_held(void);
+
+#endif
@@ -0,0 +1,220 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gesture_replay.c
+* @brief Runs gesture trace files through the TIVA gesture decoder on Linux
+*
+* gesture_sensor.c is compiled against the host I2C and FreeRTOS
+* simulators and each trace is fed through gestureAddData in the bursts it
+* was captured in (datasets sharing a tick), or four datasets at a time
+* for traces without ticks. For every trace it prints the final decision,
+* the early decision of the incremental classifier, how many times it
+* corrected that decision, and the label; with a
+* baseline it also flags traces whose decision changed.
+*
+* gesture_replay [-b baseline] [-w new_baseline] [-n repeat] trace...
+*
+* A baseline has one "trace DIR" line per trace. A trace whose decision
+* moved away from a correct baseline (or from any baseline, when the
+* trace has no "# expect" label) is a regression and the exit status is 1.
+*
+* gcc -O2 -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o gesture_replay gesture_replay.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c trace_file.c
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_stream.h"
+#include "trace_file.h"
+
+#define REPLAY_MAX_TRACES   (1024)
+
+typedef struct replay_trace
+{
+	trace_file_t file;
+	int result, early;
+	int corrections;        /* GSTREAM_CORRECTED after the early decision */
+}replay_trace_t;
+
+typedef struct baseline
+{
+	char name[TRACE_NAME_MAX];
+	int dir;
+}baseline_t;
+
+static replay_trace_t traces[REPLAY_MAX_TRACES];
+static baseline_t baseline[REPLAY_MAX_TRACES];
+static int baselineCount;
+static int earlyDir, earlyCorrections;
+
+static void early(int dir, int event)
+{
+	earlyDir = dir;
+	earlyCorrections += event == GSTREAM_CORRECTED;
+}
+
+static void run_trace(replay_trace_t *t)
+{
+	int b, first = 0;
+
+	earlyDir = DIR_NONE;
+	earlyCorrections = 0;
+	gestureBegin();
+	for(b = 0; b < t->file.bursts; b++)
+	{
+		gestureAddData(t->file.data[first], t->file.burst[b] * 4);
+		first += t->file.burst[b];
+	}
+	t->result = gestureFinish();
+	t->early = earlyDir;
+	t->corrections = earlyCorrections;
+}
+
+static int load_baseline(const char *path)
+{
+	char line[128], name[TRACE_NAME_MAX], word[16];
+	FILE *f;
+
+	if(!(f = fopen(path, "r")))
+	{
+		perror(path);
+		return -1;
+	}
+	while(fgets(line, sizeof(line), f) && baselineCount < REPLAY_MAX_TRACES)
+	{
+		if(line[0] == '#' || sscanf(line, "%63s %15s", name, word) != 2)
+			continue;
+		strcpy(baseline[baselineCount].name, name);
+		baseline[baselineCount++].dir = trace_dir(word);
+	}
+	fclose(f);
+	return 0;
+}
+
+static int baseline_dir(const char *name)
+{
+	int i;
+
+	for(i = 0; i < baselineCount; i++)
+		if(!strcmp(baseline[i].name, name))
+			return baseline[i].dir;
+	return -2;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *basePath = NULL, *outPath = NULL;
+	struct timespec start, end;
+	unsigned long datasets = 0;
+	int opt, i, r, repeat = 1000, count = 0;
+	int labelled = 0, correct = 0, earlyCorrect = 0, corrections = 0, regressions = 0, fixed = 0, base;
+	const char *status;
+	double secs;
+	FILE *out;
+
+	while((opt = getopt(argc, argv, "b:w:n:")) != -1)
+	{
+		switch(opt)
+		{
+			case 'b': basePath = optarg;
+				break;
+			case 'w': outPath = optarg;
+				break;
+			case 'n': repeat = atoi(optarg) > 0 ? atoi(optarg) : 1;
+				break;
+			default:
+				printf("Usage: %s [-b baseline] [-w new_baseline] [-n repeat] trace...\n", argv[0]);
+				return 2;
+		}
+	}
+	if(optind == argc)
+	{
+		printf("Usage: %s [-b baseline] [-w new_baseline] [-n repeat] trace...\n", argv[0]);
+		return 2;
+	}
+	if(basePath && load_baseline(basePath))
+		return 2;
+	for(i = optind; i < argc && count < REPLAY_MAX_TRACES; i++)
+		if(!trace_load(&traces[count].file, argv[i]))
+			datasets += traces[count++].file.count;
+
+	resetGestureParameters();
+	setGestureCallback(early);
+
+	/* the decoder only, timed over repeat passes of the corpus */
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(r = 0; r < repeat; r++)
+		for(i = 0; i < count; i++)
+			run_trace(&traces[i]);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+	printf("%-24s %5s %6s %7s %6s %6s %5s %8s  %s\n", "trace", "sets", "expect", "decided",
+	       "replay", "early", "fixes", "baseline", "status");
+	for(i = 0; i < count; i++)
+	{
+		replay_trace_t *t = &traces[i];
+
+		status = "";
+		base = baseline_dir(t->file.name);
+		corrections += t->corrections;
+		if(t->file.expect >= 0)
+		{
+			labelled++;
+			correct += t->result == t->file.expect;
+			earlyCorrect += t->early == t->file.expect;
+			status = t->result == t->file.expect ? "ok" : "WRONG";
+		}
+		if(base != -2 && base != t->result)
+		{
+			if(t->file.expect < 0 || base == t->file.expect)
+			{
+				regressions++;
+				status = "REGRESSION";
+			}
+			else if(t->result == t->file.expect)
+			{
+				fixed++;
+				status = "fixed";
+			}
+		}
+		printf("%-24s %5d %6s %7s %6s %6s %5d %8s  %s\n", t->file.name, t->file.count,
+		       trace_dir_name(t->file.expect), trace_dir_name(t->file.decided),
+		       trace_dir_name(t->result), trace_dir_name(t->early), t->corrections,
+		       base == -2 ? "-" : trace_dir_name(base), status);
+	}
+
+	printf("%d traces, %lu datasets, %d labelled: replay %d correct, early %d correct, %d corrections\n",
+	       count, datasets, labelled, correct, earlyCorrect, corrections);
+	printf("%d regressions, %d fixed against the baseline\n", regressions, fixed);
+	printf("%.0f datasets/s (%d passes in %.3f s)\n", secs > 0 ? datasets * repeat / secs : 0,
+	       repeat, secs);
+
+	if(outPath)
+	{
+		if(!(out = fopen(outPath, "w")))
+		{
+			perror(outPath);
+			return 2;
+		}
+		fprintf(out, "# gesture_replay baseline: trace decision\n");
+		for(i = 0; i < count; i++)
+			fprintf(out, "%s %s\n", traces[i].file.name, trace_dir_name(traces[i].result));
+		fclose(out);
+	}
+	return regressions ? 1 : 0;
+}
@@ -0,0 +1,511 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file i2c_sim.c
+* @brief Host simulation of the TM4C I2C master and the APDS-9960 gesture sensor
+*
+* I2CMasterControl decodes the MCS bits (RUN, START, STOP, ACK) the same
+* way the peripheral does and completes the transfer at once, so
+* I2CMasterBusy is always false. The sensor auto-increments its register
+* pointer; reading GFIFO_R pops a dataset and wraps back to GFIFO_U, as a
+* burst read of the FIFO does on the real part.
+*
+* Each controller (I2C0..I2C3, told apart by base address) keeps its own
+* transfer state, interrupt and bus statistics. Sensors are wired to a
+* controller directly or behind a PCA9548-style mux at 0x70, where a
+* single-byte write selects the channel.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/i2c.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/gpio.h"
+#include "driverlib/sysctl.h"
+#include "inc/hw_memmap.h"
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "i2c_sim.h"
+
+#define MCS_RUN         (0x01)
+#define MCS_START       (0x02)
+#define MCS_STOP        (0x04)
+#define MCS_ACK         (0x08)
+
+#define SENSOR_ID       (0xAB)
+#define SENSOR_GFOV     (0x02)      /* GSTATUS FIFO overflow */
+#define SENSOR_GFIFO_CLR (0x04)     /* GCONF4 FIFO clear */
+
+#define CONTROLLERS     (4)
+
+uint32_t g_ui32SysClock = 32000000;     /* SYSTEM_CLOCK in main.c */
+
+typedef struct
+{
+	uint32_t base;          /* controller it is wired to, 0 if none */
+	int8_t channel;         /* mux channel, I2C_NO_MUX when direct */
+	uint8_t regs[256];
+	uint8_t fifo[I2C_SIM_FIFO_DEPTH][4];
+	uint8_t fifo_head, fifo_count;
+	uint8_t reg_ptr;
+	bool absent;
+}sim_sensor_t;
+
+typedef struct
+{
+	uint8_t slave, tx_data, rx_data;
+	bool receive, ptr_pending, addr_nack;
+	int8_t mux;             /* selected mux channel */
+	sim_sensor_t *target;   /* addressed by the current transaction */
+	bool int_enabled, int_pending;
+	uint32_t error;
+	void (*handler)(void);
+	i2c_sim_stats_t stats;
+}sim_ctrl_t;
+
+static const uint32_t bases[CONTROLLERS] = { I2C0_BASE, I2C1_BASE, I2C2_BASE, I2C3_BASE };
+static sim_ctrl_t ctrls[CONTROLLERS];
+static sim_sensor_t sensors[I2C_SIM_SENSORS];
+static sim_sensor_t *sel = &sensors[0];
+static bool data_nack, hang;
+static i2c_sim_stats_t stats;           /* all controllers */
+
+static sim_ctrl_t *ctrl(uint32_t base)
+{
+	int i;
+
+	for(i = 1; i < CONTROLLERS; i++)
+	{
+		if(bases[i] == base)
+			return &ctrls[i];
+	}
+	return &ctrls[0];
+}
+
+static void sensor_reset(sim_sensor_t *s)
+{
+	memset(s->regs, 0, sizeof(s->regs));
+	s->regs[APDS9960_ID] = SENSOR_ID;
+	s->fifo_head = s->fifo_count = 0;
+	s->reg_ptr = 0;
+	s->absent = false;
+}
+
+void i2c_sim_reset(void)
+{
+	int i;
+
+	for(i = 0; i < I2C_SIM_SENSORS; i++)
+	{
+		sensor_reset(&sensors[i]);
+		sensors[i].base = i ? 0 : I2C0_BASE;
+		sensors[i].channel = I2C_NO_MUX;
+	}
+	sel = &sensors[0];
+	for(i = 0; i < CONTROLLERS; i++)
+	{
+		ctrls[i].addr_nack = ctrls[i].ptr_pending = false;
+		ctrls[i].int_pending = false;
+		ctrls[i].mux = I2C_NO_MUX;
+		ctrls[i].error = I2C_MASTER_ERR_NONE;
+		ctrls[i].handler = NULL;
+		memset(&ctrls[i].stats, 0, sizeof(ctrls[i].stats));
+	}
+	ctrls[0].handler = I2CIntHandler;
+	data_nack = hang = false;
+	memset(&stats, 0, sizeof(stats));
+}
+
+void i2c_sim_attach(unsigned sensor, uint32_t base, int8_t channel)
+{
+	sensors[sensor].base = base;
+	sensors[sensor].channel = channel;
+}
+
+void i2c_sim_select(unsigned sensor)
+{
+	sel = &sensors[sensor];
+}
+
+void i2c_sim_set_handler(uint32_t base, void (*handler)(void))
+{
+	ctrl(base)->handler = handler;
+}
+
+uint8_t i2c_sim_reg(uint8_t reg)
+{
+	return sel->regs[reg];
+}
+
+void i2c_sim_set_reg(uint8_t reg, uint8_t val)
+{
+	sel->regs[reg] = val;
+}
+
+void i2c_sim_fifo_push(const uint8_t dataset[4])
+{
+	if(sel->fifo_count == I2C_SIM_FIFO_DEPTH)
+	{
+		sel->regs[APDS9960_GSTATUS] |= SENSOR_GFOV;
+		return;
+	}
+	memcpy(sel->fifo[(sel->fifo_head + sel->fifo_count) % I2C_SIM_FIFO_DEPTH], dataset, 4);
+	sel->fifo_count++;
+}
+
+uint8_t i2c_sim_fifo_level(void)
+{
+	return sel->fifo_count;
+}
+
+void i2c_sim_get_stats(i2c_sim_stats_t *out)
+{
+	*out = stats;
+}
+
+void i2c_sim_get_bus_stats(uint32_t base, i2c_sim_stats_t *out)
+{
+	*out = ctrl(base)->stats;
+}
+
+void i2c_sim_clear_stats(void)
+{
+	int i;
+
+	memset(&stats, 0, sizeof(stats));
+	for(i = 0; i < CONTROLLERS; i++)
+		memset(&ctrls[i].stats, 0, sizeof(ctrls[i].stats));
+}
+
+void i2c_sim_nack_address(bool on)
+{
+	sel->absent = on;
+}
+
+void i2c_sim_nack_data(bool on)
+{
+	data_nack = on;
+}
+
+void i2c_sim_hang(bool on)
+{
+	hang = on;
+}
+
+bool i2c_sim_int_pending(void)
+{
+	int i;
+
+	for(i = 0; i < CONTROLLERS; i++)
+	{
+		if(ctrls[i].int_pending)
+			return true;
+	}
+	return false;
+}
+
+void i2c_sim_isr(void)
+{
+	sim_ctrl_t *c;
+
+	for(c = ctrls; c < ctrls + CONTROLLERS; c++)
+	{
+		while(c->int_enabled && c->int_pending && c->handler)
+			c->handler();
+	}
+}
+
+double i2c_sim_bus_us(const i2c_sim_stats_t *s)
+{
+	return s->scl_clocks * 1e6 / I2C_SIM_SCL_HZ;
+}
+
+uint64_t i2c_sim_cpu_cycles(const i2c_sim_stats_t *s, uint32_t sysclock)
+{
+	return s->scl_clocks * (uint64_t)sysclock / I2C_SIM_SCL_HZ;
+}
+
+/* the sensor answering slave on controller c, NULL for a NACK */
+static sim_sensor_t *sensor_at(sim_ctrl_t *c, uint32_t base, uint8_t slave)
+{
+	int i;
+
+	if(slave != SLAVE_ADDRESS)
+		return NULL;
+	for(i = 0; i < I2C_SIM_SENSORS; i++)
+	{
+		if(sensors[i].base == base && !sensors[i].absent &&
+		   (sensors[i].channel == I2C_NO_MUX || sensors[i].channel == c->mux))
+			return &sensors[i];
+	}
+	return NULL;
+}
+
+/* a mux answers 0x70 when some sensor on the controller sits behind it */
+static bool mux_at(uint32_t base)
+{
+	int i;
+
+	for(i = 0; i < I2C_SIM_SENSORS; i++)
+	{
+		if(sensors[i].base == base && sensors[i].channel != I2C_NO_MUX)
+			return true;
+	}
+	return false;
+}
+
+/* sensor side of one data byte */
+static uint8_t sensor_read(sim_sensor_t *s)
+{
+	uint8_t val;
+
+	switch(s->reg_ptr)
+	{
+		case APDS9960_GFLVL:
+			val = s->fifo_count;
+			break;
+		case APDS9960_GSTATUS:
+			val = (s->regs[APDS9960_GSTATUS] & SENSOR_GFOV) | (s->fifo_count ? APDS9960_GVALID : 0);
+			break;
+		case APDS9960_GFIFO_U:
+		case APDS9960_GFIFO_D:
+		case APDS9960_GFIFO_L:
+		case APDS9960_GFIFO_R:
+			val = s->fifo_count ? s->fifo[s->fifo_head][s->reg_ptr - APDS9960_GFIFO_U] : 0;
+			if(s->reg_ptr == APDS9960_GFIFO_R)
+			{
+				if(s->fifo_count)
+				{
+					s->fifo_head = (s->fifo_head + 1) % I2C_SIM_FIFO_DEPTH;
+					s->fifo_count--;
+				}
+				s->reg_ptr = APDS9960_GFIFO_U;
+				return val;
+			}
+			break;
+		default:
+			val = s->regs[s->reg_ptr];
+			break;
+	}
+	s->reg_ptr++;
+	return val;
+}
+
+static void sensor_write(sim_sensor_t *s, uint8_t val)
+{
+	if(s->reg_ptr == APDS9960_GCONF4 && (val & SENSOR_GFIFO_CLR))
+	{
+		s->fifo_head = s->fifo_count = 0;
+		s->regs[APDS9960_GSTATUS] &= ~SENSOR_GFOV;
+		val &= ~SENSOR_GFIFO_CLR;
+	}
+	/* ID, status and data registers are read only */
+	if(s->reg_ptr != APDS9960_ID && (s->reg_ptr < APDS9960_STATUS || s->reg_ptr > APDS9960_PDATA))
+		s->regs[s->reg_ptr] = val;
+	s->reg_ptr++;
+}
+
+/* counts on the controller and in the total */
+#define COUNT(c, field, n)      do { (c)->stats.field += (n); stats.field += (n); }while(0)
+
+/********************************************************************************************************
+*
+* driverlib I2C master
+*
+********************************************************************************************************/
+void I2CMasterSlaveAddrSet(uint32_t ui32Base, uint8_t ui8SlaveAddr, bool bReceive)
+{
+	sim_ctrl_t *c = ctrl(ui32Base);
+
+	c->slave = ui8SlaveAddr;
+	c->receive = bReceive;
+}
+
+void I2CMasterDataPut(uint32_t ui32Base, uint8_t ui8Data)
+{
+	ctrl(ui32Base)->tx_data = ui8Data;
+}
+
+uint32_t I2CMasterDataGet(uint32_t ui32Base)
+{
+	return ctrl(ui32Base)->rx_data;
+}
+
+void I2CMasterControl(uint32_t ui32Base, uint32_t ui32Cmd)
+{
+	sim_ctrl_t *c = ctrl(ui32Base);
+	bool mux;
+
+	/* a hung controller stays busy and never interrupts */
+	if(hang)
+		return;
+
+	mux = c->slave == I2C_MUX_ADDRESS && mux_at(ui32Base);
+	if(ui32Cmd & MCS_START)
+	{
+		COUNT(c, transactions, 1);
+		COUNT(c, bytes, 1);
+		COUNT(c, scl_clocks, 1 + 9);
+		c->error = I2C_MASTER_ERR_NONE;
+		c->target = mux ? NULL : sensor_at(c, ui32Base, c->slave);
+		c->addr_nack = !mux && !c->target;
+		c->ptr_pending = !c->receive && !mux;
+		if(c->addr_nack)
+		{
+			COUNT(c, nacks, 1);
+			c->error = I2C_MASTER_ERR_ADDR_ACK;
+		}
+	}
+
+	if((ui32Cmd & MCS_RUN) && !c->addr_nack)
+	{
+		COUNT(c, bytes, 1);
+		COUNT(c, scl_clocks, 9);
+		if(mux)
+		{
+			/* control register: one bit per channel */
+			for(c->mux = 0; c->mux < 8 && !(c->tx_data & 1 << c->mux); c->mux++);
+			if(c->mux == 8)
+				c->mux = I2C_NO_MUX;
+		}
+		else if(c->receive)
+		{
+			COUNT(c, reads, 1);
+			c->rx_data = sensor_read(c->target);
+		}
+		else if(c->ptr_pending)
+		{
+			c->target->reg_ptr = c->tx_data;
+			c->ptr_pending = false;
+		}
+		else if(data_nack)
+		{
+			COUNT(c, nacks, 1);
+			c->error = I2C_MASTER_ERR_DATA_ACK;
+		}
+		else
+		{
+			COUNT(c, writes, 1);
+			sensor_write(c->target, c->tx_data);
+		}
+	}
+
+	if(ui32Cmd & MCS_STOP)
+	{
+		COUNT(c, stops, 1);
+		COUNT(c, scl_clocks, 1);
+		c->addr_nack = false;
+	}
+	c->int_pending = c->int_enabled;
+}
+
+bool I2CMasterBusy(uint32_t ui32Base)
+{
+	return hang;
+}
+
+bool I2CMasterBusBusy(uint32_t ui32Base)
+{
+	return false;
+}
+
+uint32_t I2CMasterErr(uint32_t ui32Base)
+{
+	return ctrl(ui32Base)->error;
+}
+
+void I2CMasterIntEnable(uint32_t ui32Base)
+{
+	ctrl(ui32Base)->int_enabled = true;
+}
+
+void I2CMasterIntDisable(uint32_t ui32Base)
+{
+	ctrl(ui32Base)->int_enabled = false;
+}
+
+void I2CMasterIntClear(uint32_t ui32Base)
+{
+	ctrl(ui32Base)->int_pending = false;
+}
+
+bool I2CMasterIntStatus(uint32_t ui32Base, bool bMasked)
+{
+	sim_ctrl_t *c = ctrl(ui32Base);
+
+	return bMasked ? (c->int_enabled && c->int_pending) : c->int_pending;
+}
+
+void I2CMasterInitExpClk(uint32_t ui32Base, uint32_t ui32I2CClk, bool bFast)
+{
+}
+
+void I2CSlaveEnable(uint32_t ui32Base)
+{
+}
+
+void I2CSlaveInit(uint32_t ui32Base, uint8_t ui8SlaveAddr)
+{
+}
+
+void I2CSlaveDataPut(uint32_t ui32Base, uint8_t ui8Data)
+{
+}
+
+uint32_t I2CSlaveDataGet(uint32_t ui32Base)
+{
+	return 0;
+}
+
+/********************************************************************************************************
+*
+* driverlib interrupt controller, GPIO and SysCtl, nothing to do on the host
+*
+********************************************************************************************************/
+void IntEnable(uint32_t ui32Interrupt)
+{
+}
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+}
+
+void GPIOPinTypeI2C(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void GPIOPinTypeI2CSCL(uint32_t ui32Port, uint8_t ui8Pins)
+{
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+}
+
+void SysCtlPeripheralDisable(uint32_t ui32Peripheral)
+{
+}
+
+void SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+	return true;
+}
+
+void SysCtlDelay(uint32_t ui32Count)
+{
+}
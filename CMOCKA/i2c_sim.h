@@ -0,0 +1,88 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file i2c_sim.h
+* @brief Host simulation of the TM4C I2C master and the APDS-9960 gesture sensor
+*
+* i2c_sim.c provides the driverlib I2C, GPIO and SysCtl functions used by
+* the TIVA sources, so i2c_comm.c and gesture_sensor.c can be compiled and
+* tested on the host. The bus is timed in SCL clocks: start and stop are
+* one clock each, every byte with its acknowledge is nine.
+*
+* With the master interrupt enabled every command raises it;
+* i2c_sim_isr() runs each controller's handler for as long as one is
+* pending.
+*
+* Sensor 0 starts on I2C0 with no mux; i2c_sim_attach() wires up more.
+* The register, FIFO and address fault calls act on the sensor picked
+* by i2c_sim_select(), sensor 0 after a reset.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef I2C_SIM_H
+#define I2C_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define I2C_SIM_SCL_HZ          (400000)
+#define I2C_SIM_FIFO_DEPTH      (32)
+#define I2C_SIM_SENSORS         (4)
+
+typedef struct i2c_sim_stats
+{
+	uint32_t transactions;  /* START conditions, repeated starts included */
+	uint32_t stops;
+	uint32_t bytes;         /* address and data bytes on the wire */
+	uint32_t writes;        /* register writes seen by the sensor */
+	uint32_t reads;         /* register reads seen by the sensor */
+	uint32_t nacks;
+	uint64_t scl_clocks;
+}i2c_sim_stats_t;
+
+/* sensor power-on state: registers cleared, ID 0xAB, FIFO empty, stats
+ * cleared, no faults, only sensor 0 wired and I2CIntHandler serving I2C0.
+ * The master interrupts stay as the driver set them. */
+void i2c_sim_reset(void);
+
+/* wires a sensor to the controller at base, behind mux channel or
+ * I2C_NO_MUX; base 0 unplugs it */
+void i2c_sim_attach(unsigned sensor, uint32_t base, int8_t channel);
+void i2c_sim_select(unsigned sensor);
+
+/* interrupt handler i2c_sim_isr() runs for the controller at base */
+void i2c_sim_set_handler(uint32_t base, void (*handler)(void));
+
+uint8_t i2c_sim_reg(uint8_t reg);
+void i2c_sim_set_reg(uint8_t reg, uint8_t val);
+
+/* queues one U/D/L/R dataset in the gesture FIFO */
+void i2c_sim_fifo_push(const uint8_t dataset[4]);
+uint8_t i2c_sim_fifo_level(void);
+
+/* all controllers, or the one at base */
+void i2c_sim_get_stats(i2c_sim_stats_t *stats);
+void i2c_sim_get_bus_stats(uint32_t base, i2c_sim_stats_t *stats);
+void i2c_sim_clear_stats(void);
+
+/* faults: the sensor stops answering its address, NACKs written data,
+ * or the controller never finishes the next command */
+void i2c_sim_nack_address(bool on);
+void i2c_sim_nack_data(bool on);
+void i2c_sim_hang(bool on);
+
+bool i2c_sim_int_pending(void);
+void i2c_sim_isr(void);
+
+/* bus time of the recorded traffic */
+double i2c_sim_bus_us(const i2c_sim_stats_t *stats);
+
+/* CPU cycles spent waiting for that traffic at the given system clock */
+uint64_t i2c_sim_cpu_cycles(const i2c_sim_stats_t *stats, uint32_t sysclock);
+
+#endif
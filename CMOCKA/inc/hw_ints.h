@@ -0,0 +1,16 @@
+/*
+ * hw_ints.h
+ *
+ *  Host build stand-in for the TivaWare inc/hw_ints.h, which is not
+ *  part of this tree. Only the interrupts used by the code under test.
+ */
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define INT_I2C0                24          // I2C0
+#define INT_I2C1                53          // I2C1
+#define INT_I2C2                77          // I2C2
+#define INT_I2C3                78          // I2C3
+
+#endif // __HW_INTS_H__
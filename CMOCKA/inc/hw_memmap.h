@@ -0,0 +1,19 @@
+/*
+ * hw_memmap.h
+ *
+ *  Host build stand-in for the TivaWare inc/hw_memmap.h, which is not
+ *  part of this tree. Only the bases used by the code under test.
+ */
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+#define GPIO_PORTB_BASE         0x40059000
+#define GPIO_PORTL_BASE         0x40062000
+#define GPIO_PORTG_BASE         0x4005E000
+#define I2C0_BASE               0x40020000
+#define I2C1_BASE               0x40021000
+#define I2C2_BASE               0x40022000
+#define I2C3_BASE               0x40023000
+
+#endif // __HW_MEMMAP_H__
@@ -0,0 +1,54 @@
+/*
+ * portmacro.h
+ *
+ *  Host build stand-in for Source/portable/CCS/ARM_CM4F/portmacro.h,
+ *  whose yield and interrupt masking macros are Cortex-M4 assembly.
+ *  Types match the target, yields and interrupt masking do nothing and
+ *  critical sections call the stubs in freertos_sim.c.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		long
+#define portSHORT		short
+#define portSTACK_TYPE	uint32_t
+#define portBASE_TYPE	long
+
+typedef portSTACK_TYPE StackType_t;
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+
+typedef uint32_t TickType_t;
+#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+#define portTICK_TYPE_IS_ATOMIC 1
+
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+
+#define portYIELD()
+#define portEND_SWITCHING_ISR( xSwitchRequired ) ( void ) ( xSwitchRequired )
+#define portYIELD_FROM_ISR( x ) portEND_SWITCHING_ISR( x )
+
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION 0
+
+extern void vPortEnterCritical( void );
+extern void vPortExitCritical( void );
+
+#define portDISABLE_INTERRUPTS()
+#define portENABLE_INTERRUPTS()
+#define portENTER_CRITICAL()					vPortEnterCritical()
+#define portEXIT_CRITICAL()						vPortExitCritical()
+#define portSET_INTERRUPT_MASK_FROM_ISR()		0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR(x)	( void ) ( x )
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+
+#endif /* PORTMACRO_H */
@@ -0,0 +1,162 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_apds_regs.c
+* @brief APDS-9960 shadow registers: bus traffic of the getters, setters and batched sequences
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_apds_regs test_apds_regs.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "include/apds_regs.h"
+#include "i2c_sim.h"
+#include "freertos_sim.h"
+
+/* powered up sensor with the defaults written, scheduler running */
+static void start(void)
+{
+	i2c_sim_reset();
+	i2c_setup();
+	apds_reg_init(&gesture_sensor0.regs, &gesture_sensor0.dev);
+	freertos_sim_set_running(true);
+	freertos_sim_set_block_hook(i2c_sim_isr);
+	assert_true(sensor_init());
+	i2c_sim_clear_stats();
+}
+
+static uint32_t bus_transactions(void)
+{
+	i2c_sim_stats_t bus;
+
+	i2c_sim_get_stats(&bus);
+	return bus.stops;
+}
+
+void test_getters_from_shadow()
+{
+	start();
+	assert_int_equal(getGestureGain(), DEFAULT_GGAIN);
+	assert_int_equal(getGestureLEDDrive(), DEFAULT_GLDRIVE);
+	assert_int_equal(getGestureWaitTime(), DEFAULT_GWTIME);
+	assert_int_equal(getMode(), 0);
+	assert_int_equal(bus_transactions(), 0);
+
+	/* the sensor clears GMODE itself, so that one is read */
+	assert_int_equal(getGestureMode(), 0);
+	assert_int_equal(bus_transactions(), 1);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+}
+
+void test_setter_write_through()
+{
+	i2c_sim_stats_t bus;
+
+	start();
+	assert_true(setGestureGain(GGAIN_8X));
+	i2c_sim_get_stats(&bus);
+	assert_int_equal(bus.stops, 1);
+	assert_int_equal(bus.writes, 1);
+	assert_int_equal(bus.reads, 0);
+	assert_int_equal((i2c_sim_reg(APDS9960_GCONF2) >> 5) & 3, GGAIN_8X);
+	assert_int_equal(getGestureGain(), GGAIN_8X);
+
+	/* same value again, nothing to send */
+	assert_true(setGestureGain(GGAIN_8X));
+	assert_true(setLEDDrive(DEFAULT_LDRIVE));
+	assert_int_equal(bus_transactions(), 1);
+}
+
+void test_batch_coalesces()
+{
+	i2c_sim_stats_t bus;
+	apds_reg_stats_t stats;
+
+	start();
+	apds_reg_get_stats(&gesture_sensor0.regs, &stats);
+	assert_true(enableGestureSensor(false));
+	i2c_sim_get_stats(&bus);
+
+	/* WTIME, PPULSE, CONFIG2, GCONF4, GCONF2 and ENABLE once each, GCONF4 read once */
+	assert_int_equal(bus.writes, 6);
+	assert_int_equal(bus.reads, 1);
+	assert_int_equal(i2c_sim_reg(APDS9960_ENABLE), 0x4D);
+	assert_int_equal(i2c_sim_reg(APDS9960_GCONF4) & 0x03, 0x01);
+	assert_int_equal(i2c_sim_reg(APDS9960_WTIME), 0xFF);
+	assert_int_equal((i2c_sim_reg(APDS9960_CONFIG2) >> 4) & 3, LED_BOOST_300);
+	assert_int_equal((i2c_sim_reg(APDS9960_GCONF2) >> 5) & 3, GGAIN_2X);
+	printf("enableGestureSensor: %u transactions (18 with read-modify-write on the bus)\n",
+	       bus.stops);
+
+	i2c_sim_clear_stats();
+	assert_true(disableGestureSensor());
+	i2c_sim_get_stats(&bus);
+	assert_int_equal(bus.writes, 2);
+	assert_int_equal(i2c_sim_reg(APDS9960_ENABLE), 0x0D);
+	assert_int_equal(i2c_sim_reg(APDS9960_GCONF4) & 0x03, 0x00);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+	assert_int_equal(freertos_sim_critical_nesting(), 0);
+}
+
+void test_resync_after_reset()
+{
+	start();
+	assert_true(setGestureGain(GGAIN_8X));
+
+	/* the sensor lost power, the shadow still has the old settings */
+	i2c_sim_reset();
+	assert_int_equal(getGestureGain(), GGAIN_8X);
+	assert_true(apds_reg_resync(&gesture_sensor0.regs));
+	assert_int_equal(getGestureGain(), 0);
+	assert_int_equal(getMode(), 0);
+}
+
+void test_failed_write_rereads()
+{
+	apds_reg_stats_t before, after;
+
+	start();
+	i2c_sim_nack_data(true);
+	assert_false(setGestureGain(GGAIN_8X));
+	i2c_sim_nack_data(false);
+
+	/* the register state is unknown, the next getter goes to the bus */
+	apds_reg_get_stats(&gesture_sensor0.regs, &before);
+	assert_int_equal(getGestureGain(), DEFAULT_GGAIN);
+	apds_reg_get_stats(&gesture_sensor0.regs, &after);
+	assert_int_equal(after.busReads - before.busReads, 1);
+	assert_int_equal(after.hits, before.hits);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_getters_from_shadow),
+		cmocka_unit_test(test_setter_write_through),
+		cmocka_unit_test(test_batch_coalesces),
+		cmocka_unit_test(test_resync_after_reset),
+		cmocka_unit_test(test_failed_write_rereads),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
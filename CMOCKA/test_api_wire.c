@@ -0,0 +1,242 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_api_wire.c
+* @brief Client API request and reply frames between the BBG and the TIVA
+*
+* A window of request frames is fed to the parser in 16 byte reads, as
+* vbbgReceive takes them from the RX queue, and answered in a different
+* order; every reply must find its request by the echoed id. A batch
+* and its results make one frame each way.
+*
+* gcc -I../Gesture_sensor -o test_api_wire test_api_wire.c ../Gesture_sensor/src/api_wire.c
+*     ../Gesture_sensor/src/log_wire.c ../Gesture_sensor/src/link_frame.c
+*     ../Gesture_sensor/driverlib/sw_crc.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "logger.h"
+#include "include/api_wire.h"
+#include "include/link_frame.h"
+
+#define WINDOW          (8)
+#define RX_CHUNK        (16)
+
+static const uint16_t ids[] = {0, 1, 0xFF, 0x100, 0x7FFF, 0xFFFF};
+
+typedef struct tiva
+{
+	api_wire_request_t req[WINDOW + 1];
+	uint32_t count;
+}tiva_t;
+
+void test_roundtrip()
+{
+	uint8_t wire[API_WIRE_REPLY_MAX_SIZE], len;
+	api_wire_request_t req, out;
+	log_wire_t rec = {UINT32_MAX, UINT32_MAX, LOG_LEVEL_INFO, LOG_SOURCE_CLIENT, LOG_MSG_COUNT - 1};
+	log_wire_t got;
+	size_t i;
+
+	for(i = 0; i < sizeof(ids) / sizeof(ids[0]); i++)
+	{
+		req.id = ids[i];
+		req.opcode = API_OP_HEARTBEAT + i;
+		assert_int_equal(api_wire_encode_request(wire, &req), API_WIRE_REQUEST_SIZE);
+		memset(&out, 0xAA, sizeof(out));
+		assert_true(api_wire_decode_request(wire, API_WIRE_REQUEST_SIZE, &out));
+		assert_int_equal(out.id, req.id);
+		assert_int_equal(out.opcode, req.opcode);
+
+		/* the largest record still fits a reply */
+		len = api_wire_encode_reply(wire, &req, &rec);
+		assert_true(len > API_WIRE_REQUEST_SIZE && len <= API_WIRE_REPLY_MAX_SIZE);
+		memset(&out, 0xAA, sizeof(out));
+		assert_true(api_wire_decode_reply(wire, len, &out, &got));
+		assert_int_equal(out.id, req.id);
+		assert_int_equal(out.opcode, req.opcode);
+		assert_int_equal(got.value, rec.value);
+		assert_int_equal(got.log_source, LOG_SOURCE_CLIENT);
+		assert_int_equal(got.msg, rec.msg);
+	}
+}
+
+void test_malformed()
+{
+	uint8_t wire[API_WIRE_REPLY_MAX_SIZE + 1], len, i;
+	api_wire_request_t req = {0x1234, 3};
+	log_wire_t rec = {0xAB, 100, LOG_LEVEL_INFO, LOG_SOURCE_CLIENT, LOG_MSG_READING_ID_SUCCESS};
+
+	/* a request is exactly three bytes */
+	api_wire_encode_request(wire, &req);
+	assert_false(api_wire_decode_request(wire, API_WIRE_REQUEST_SIZE - 1, &req));
+	assert_false(api_wire_decode_request(wire, API_WIRE_REQUEST_SIZE + 1, &req));
+
+	len = api_wire_encode_reply(wire, &req, &rec);
+	for(i = 0; i < len; i++)
+		assert_false(api_wire_decode_reply(wire, i, &req, &rec));
+	wire[len] = 0;
+	assert_false(api_wire_decode_reply(wire, len + 1, &req, &rec));
+
+	/* a record without a compact code makes no reply */
+	rec.log_source = 0x20;
+	assert_int_equal(api_wire_encode_reply(wire, &req, &rec), 0);
+}
+
+static void tiva_request(const frame_t *frame, void *arg)
+{
+	tiva_t *tiva = arg;
+
+	assert_int_equal(frame->type, FRAME_TYPE_API_REQUEST);
+	assert_true(tiva->count <= WINDOW);
+	assert_true(api_wire_decode_request(frame->payload, frame->len, &tiva->req[tiva->count++]));
+}
+
+static void bbg_reply(const frame_t *frame, void *arg)
+{
+	uint8_t *answered = arg;
+	api_wire_request_t req;
+	log_wire_t rec;
+
+	assert_int_equal(frame->type, FRAME_TYPE_API_REPLY);
+	assert_true(api_wire_decode_reply(frame->payload, frame->len, &req, &rec));
+	/* the value is derived from the id, a crossed reply would not match */
+	assert_true(req.id >= 1 && req.id <= WINDOW);
+	assert_int_equal(rec.value, req.id * 3);
+	assert_int_equal(req.opcode, req.id % 10 + 1);
+	assert_false(answered[req.id]);
+	answered[req.id] = 1;
+}
+
+void test_window()
+{
+	uint8_t stream[(WINDOW + 1) * FRAME_MAX_SIZE], payload[API_WIRE_REPLY_MAX_SIZE];
+	uint8_t answered[WINDOW + 1] = {0};
+	size_t size = 0, off, chunk;
+	frame_parser_t parser;
+	api_wire_request_t req;
+	log_wire_t rec = {0, 0, LOG_LEVEL_INFO, LOG_SOURCE_CLIENT, LOG_MSG_STATUS_RELAY0_ON};
+	tiva_t tiva = {0};
+	uint32_t i;
+
+	/* a full window from the BBG with its heartbeat in the middle */
+	for(i = 1; i <= WINDOW; i++)
+	{
+		req.id = i;
+		req.opcode = i % 10 + 1;
+		size += frame_encode(&stream[size], FRAME_TYPE_API_REQUEST, i, payload,
+				     api_wire_encode_request(payload, &req));
+		if(i == WINDOW / 2)
+		{
+			req.id = 0;
+			req.opcode = API_OP_HEARTBEAT;
+			size += frame_encode(&stream[size], FRAME_TYPE_API_REQUEST, 100, payload,
+					     api_wire_encode_request(payload, &req));
+		}
+	}
+
+	frame_parser_init(&parser);
+	for(off = 0; off < size; off += chunk)
+	{
+		chunk = size - off < RX_CHUNK ? size - off : RX_CHUNK;
+		frame_parser_feed(&parser, &stream[off], chunk, tiva_request, &tiva);
+	}
+	assert_int_equal(tiva.count, WINDOW + 1);
+	assert_int_equal(tiva.req[WINDOW / 2].id, 0);
+	assert_int_equal(tiva.req[WINDOW / 2].opcode, API_OP_HEARTBEAT);
+
+	/* answered last first, the heartbeat not at all */
+	size = 0;
+	for(i = tiva.count; i-- > 0; )
+	{
+		if(!tiva.req[i].id)
+			continue;
+		rec.value = tiva.req[i].id * 3;
+		size += frame_encode(&stream[size], FRAME_TYPE_API_REPLY, i, payload,
+				     api_wire_encode_reply(payload, &tiva.req[i], &rec));
+	}
+	frame_parser_init(&parser);
+	frame_parser_feed(&parser, stream, size, bbg_reply, answered);
+	for(i = 1; i <= WINDOW; i++)
+		assert_true(answered[i]);
+}
+
+void test_batch()
+{
+	uint8_t wire[API_WIRE_BATCH_REPLY_MAX_SIZE + 1], frame[FRAME_MAX_SIZE], len, count, i;
+	api_wire_batch_t batch = { .req = { 0xBEEF, 13 }, .count = API_WIRE_BATCH_MAX }, out;
+	api_wire_result_t result[API_WIRE_BATCH_MAX], got[API_WIRE_BATCH_MAX];
+	api_wire_request_t req;
+
+	assert_true(API_WIRE_BATCH_MAX_SIZE <= FRAME_MAX_PAYLOAD);
+	assert_true(API_WIRE_BATCH_REPLY_MAX_SIZE <= FRAME_MAX_PAYLOAD);
+
+	for(i = 0; i < API_WIRE_BATCH_MAX; i++)
+	{
+		batch.cmd[i].opcode = i + 1;
+		batch.cmd[i].arg = i * 0x1111;
+		result[i].ok = i % 2;
+		result[i].msg = LOG_MSG_COUNT - 1 - i;
+		result[i].value = 0xFFFFFFFF - i;
+	}
+	len = api_wire_encode_batch(wire, &batch);
+	assert_int_equal(len, API_WIRE_BATCH_MAX_SIZE);
+	assert_true(frame_encode(frame, FRAME_TYPE_API_BATCH, 0, wire, len) > 0);
+	memset(&out, 0xAA, sizeof(out));
+	assert_true(api_wire_decode_batch(wire, len, &out));
+	assert_int_equal(out.req.id, 0xBEEF);
+	assert_int_equal(out.count, API_WIRE_BATCH_MAX);
+	for(i = 0; i < API_WIRE_BATCH_MAX; i++)
+	{
+		assert_int_equal(out.cmd[i].opcode, i + 1);
+		assert_int_equal(out.cmd[i].arg, i * 0x1111);
+	}
+	/* truncated, padded, or claiming more commands than it has */
+	assert_false(api_wire_decode_batch(wire, len - 1, &out));
+	assert_false(api_wire_decode_batch(wire, len + 1, &out));
+	wire[API_WIRE_REQUEST_SIZE] = API_WIRE_BATCH_MAX + 1;
+	assert_false(api_wire_decode_batch(wire, len, &out));
+	batch.count = 0;
+	assert_int_equal(api_wire_encode_batch(wire, &batch), 0);
+
+	len = api_wire_encode_batch_reply(wire, &batch.req, result, API_WIRE_BATCH_MAX);
+	assert_int_equal(len, API_WIRE_BATCH_REPLY_MAX_SIZE);
+	assert_true(api_wire_decode_batch_reply(wire, len, &req, got, &count));
+	assert_int_equal(req.id, 0xBEEF);
+	assert_int_equal(count, API_WIRE_BATCH_MAX);
+	for(i = 0; i < count; i++)
+	{
+		assert_int_equal(got[i].ok, result[i].ok);
+		assert_int_equal(got[i].msg, result[i].msg);
+		assert_int_equal(got[i].value, result[i].value);
+	}
+	for(i = 0; i < len; i++)
+		assert_false(api_wire_decode_batch_reply(wire, i, &req, got, &count));
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_roundtrip),
+		cmocka_unit_test(test_malformed),
+		cmocka_unit_test(test_window),
+		cmocka_unit_test(test_batch),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
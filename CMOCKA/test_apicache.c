@@ -0,0 +1,145 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_apicache.c
+* @brief BBG response cache for the read-only API calls
+*
+* gcc -I../Gesture_sensor -I../BBG -o test_apicache test_apicache.c ../BBG/apicache.c
+*     -lcmocka -lpthread
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "include/log_wire.h"
+#include "apicache.h"
+
+#define MAX_AGE_MS      (50)
+
+void test_records()
+{
+	apicache_t cache;
+	uint32_t value;
+
+	apicache_init(&cache, APICACHE_MAX_AGE_MS);
+	assert_false(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+
+	/* relay task: 1 command applied, both changed, relay1 on */
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 1 << 16 | 3 << 8 | 0x02);
+	assert_true(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_int_equal(value, 0);
+	assert_true(apicache_get(&cache, API_OP_RELAY1_STATUS, &value));
+	assert_int_equal(value, 1);
+	assert_false(apicache_get(&cache, API_OP_SENSOR_ID, &value));
+
+	/* a status answer overrides the switch record */
+	apicache_record(&cache, LOG_MSG_STATUS_RELAY0_ON, 1);
+	assert_true(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_int_equal(value, 1);
+
+	/* the ID only when it could be read */
+	apicache_record(&cache, LOG_MSG_READING_ID_FAILED, 0);
+	assert_false(apicache_get(&cache, API_OP_SENSOR_ID, &value));
+	apicache_record(&cache, LOG_MSG_READING_ID_SUCCESS, 0xAB);
+	assert_true(apicache_get(&cache, API_OP_SENSOR_ID, &value));
+	assert_int_equal(value, 0xAB);
+
+	/* commands always go to the TIVA */
+	apicache_record(&cache, LOG_MSG_BOTH_RELAYS_TURNED_ON, 1);
+	assert_false(apicache_get(&cache, API_OP_RELAYS_ON, &value));
+	assert_false(apicache_get(&cache, API_OP_SENSOR_ENABLE, &value));
+}
+
+void test_max_age()
+{
+	apicache_t cache;
+	uint32_t value;
+
+	apicache_init(&cache, MAX_AGE_MS);
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 0x01);
+	assert_true(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	usleep(MAX_AGE_MS * 2000);
+	assert_false(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+
+	/* every switch record starts it again */
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 0x00);
+	assert_true(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_int_equal(value, 0);
+}
+
+void test_invalidate()
+{
+	apicache_t cache;
+	apicache_stats_t stats;
+	uint32_t value;
+
+	apicache_init(&cache, APICACHE_MAX_AGE_MS);
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 0x03);
+	apicache_record(&cache, LOG_MSG_READING_ID_SUCCESS, 0xAB);
+	apicache_invalidate(&cache);
+	assert_false(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_false(apicache_get(&cache, API_OP_SENSOR_ID, &value));
+
+	/* the TIVA's start up record, its relays come up off */
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 0x03);
+	apicache_record(&cache, LOG_MSG_GESTURE_APPLICATION, 0);
+	assert_false(apicache_get(&cache, API_OP_RELAY1_STATUS, &value));
+
+	apicache_get_stats(&cache, &stats);
+	assert_int_equal(stats.hits, 0);
+	assert_int_equal(stats.misses, 3);
+	assert_int_equal(stats.updates, 5);
+	assert_int_equal(stats.invalidations, 2);
+}
+
+void test_relay_commands()
+{
+	apicache_t cache;
+	uint32_t value;
+
+	/* a relay command answered: the state is only known again once the
+	 * relay task has switched and said so */
+	apicache_init(&cache, APICACHE_MAX_AGE_MS);
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 0x00);
+	apicache_record(&cache, LOG_MSG_READING_ID_SUCCESS, 0xAB);
+	apicache_record(&cache, LOG_MSG_RELAY1_TURNED_ON, 1);
+	assert_true(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_false(apicache_get(&cache, API_OP_RELAY1_STATUS, &value));
+	apicache_record(&cache, LOG_MSG_BOTH_RELAYS_TURNED_ON, 1);
+	assert_false(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_true(apicache_get(&cache, API_OP_SENSOR_ID, &value));
+	apicache_record(&cache, LOG_MSG_RELAY_CYCLE, 2 << 16 | 3 << 8 | 0x03);
+	assert_true(apicache_get(&cache, API_OP_RELAY1_STATUS, &value));
+	assert_int_equal(value, 1);
+
+	/* and as the server queues one */
+	apicache_forget(&cache, API_OP_RELAY0_STATUS);
+	assert_false(apicache_get(&cache, API_OP_RELAY0_STATUS, &value));
+	assert_true(apicache_get(&cache, API_OP_RELAY1_STATUS, &value));
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_records),
+		cmocka_unit_test(test_max_age),
+		cmocka_unit_test(test_invalidate),
+		cmocka_unit_test(test_relay_commands),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_fmt.c
+* @brief Checks the console's heapless formatter against the C library snprintf
+*
+* gcc -I../Gesture_sensor -o test_fmt test_fmt.c ../Gesture_sensor/src/fmt.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits.h>
+#include "include/fmt.h"
+
+#define CHECK(...)							\
+	do								\
+	{								\
+		char expect[128], got[128];				\
+		int n = snprintf(expect, sizeof(expect), __VA_ARGS__);	\
+		assert_int_equal(fmt_snprintf(got, sizeof(got), __VA_ARGS__), n); \
+		assert_string_equal(got, expect);			\
+	}while(0)
+
+void test_integers()
+{
+	CHECK("%d", 0);
+	CHECK("%d %d", INT_MAX, INT_MIN);
+	CHECK("%i|%5d|%-5d|%05d", -42, -42, -42, -42);
+	CHECK("%u %u", 0u, UINT_MAX);
+	CHECK("%x %X %08x", 0xBEEFu, 0xBEEFu, 0x1Au);
+	CHECK("%ld %lu %lx", LONG_MIN, ULONG_MAX, 0xDEADBEEFUL);
+	CHECK("[%3u]", 12345u);
+}
+
+void test_strings()
+{
+	CHECK("%s", "UP\n\r");
+	CHECK("[%10s][%-10s]", "LEFT", "RIGHT");
+	CHECK("%c%c%3c", 'o', 'k', '!');
+	CHECK("100%% %s", "done");
+	CHECK("%u\t%u\t%u\t%s\t\n\r", 12u, 4u, 17u, "[TIVA] Heart beat from TIVA");
+}
+
+void test_truncation()
+{
+	char buf[8];
+
+	assert_int_equal(fmt_snprintf(buf, sizeof(buf), "%s", "No Gesture"), 10);
+	assert_string_equal(buf, "No Gest");
+	assert_int_equal(fmt_snprintf(buf, 1, "%d", 12345), 5);
+	assert_string_equal(buf, "");
+	assert_int_equal(fmt_snprintf(NULL, 0, "%x", 0xABCu), 3);
+
+	/* unknown conversions are copied, a trailing % is dropped */
+	assert_int_equal(fmt_snprintf(buf, sizeof(buf), "%q%"), 2);
+	assert_string_equal(buf, "%q");
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_integers),
+		cmocka_unit_test(test_strings),
+		cmocka_unit_test(test_truncation),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,206 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_frame.c
+* @brief Fuzz and replay tests for the TIVA - BBG link framing
+*
+* A stream of framed Logger_t records is corrupted (bit flips, dropped and
+* inserted bytes) and fed to the parser in random sized chunks, as read()
+* returns them on the BBG. Every frame that was not touched must come out.
+*
+* gcc -I../Gesture_sensor -o test_frame test_frame.c ../Gesture_sensor/src/link_frame.c
+*     ../Gesture_sensor/driverlib/sw_crc.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "include/link_frame.h"
+#include "logger.h"
+
+#define FRAMES          (20000)
+#define STREAM_SIZE     (FRAMES * FRAME_MAX_SIZE * 2)
+
+typedef struct replay
+{
+	uint32_t received;
+	uint32_t next;          /* value of the next intact record expected */
+	uint8_t *intact;        /* 1 for every record left untouched */
+	uint32_t intact_seen;
+}replay_t;
+
+static uint8_t stream[STREAM_SIZE];
+
+static void make_record(Logger_t *log, uint32_t i)
+{
+	memset(log, 0, sizeof(*log));
+	log->value = i;
+	log->timestamp = i * 3;
+	log->log_level = LOG_LEVEL_INFO;
+	log->log_source = LOG_SOURCE_GESTURE;
+	snprintf(log->msg, MSG_SIZE, "record %u", i);
+}
+
+static void check_record(const frame_t *frame, void *arg)
+{
+	replay_t *replay = arg;
+	Logger_t log, expect;
+
+	assert_int_equal(frame->type, FRAME_TYPE_LOG);
+	assert_int_equal(frame->len, sizeof(Logger_t));
+	memcpy(&log, frame->payload, sizeof(log));
+	make_record(&expect, log.value);
+	assert_memory_equal(&log, &expect, sizeof(log));
+
+	/* records come out in order and only once */
+	assert_true(log.value >= replay->next);
+	replay->next = log.value + 1;
+	if(replay->intact[log.value])
+		replay->intact_seen++;
+	replay->received++;
+}
+
+/* feeds len bytes in chunks of 1..max bytes */
+static void feed_chunks(frame_parser_t *parser, const uint8_t *data, size_t len,
+			size_t max, replay_t *replay)
+{
+	size_t chunk;
+
+	while(len)
+	{
+		chunk = 1 + rand() % max;
+		if(chunk > len)
+			chunk = len;
+		frame_parser_feed(parser, data, chunk, check_record, replay);
+		data += chunk;
+		len -= chunk;
+	}
+}
+
+void test_roundtrip()
+{
+	uint8_t frame[FRAME_MAX_SIZE], payload[FRAME_MAX_PAYLOAD];
+	frame_parser_t parser;
+	uint16_t size;
+	int i;
+
+	for(i = 0; i < FRAME_MAX_PAYLOAD; i++)
+		payload[i] = FRAME_SYNC0 ^ i;
+
+	size = frame_encode(frame, 7, 42, payload, FRAME_MAX_PAYLOAD);
+	assert_int_equal(size, FRAME_MAX_SIZE);
+	assert_int_equal(frame_encode(frame, 7, 42, payload, FRAME_MAX_PAYLOAD + 1), 0);
+
+	frame_parser_init(&parser);
+	assert_int_equal(frame_parser_feed(&parser, frame, size, NULL, NULL), 1);
+	assert_int_equal(parser.stats.frames, 1);
+	assert_int_equal(parser.stats.crc_errors, 0);
+
+	/* empty payload */
+	size = frame_encode(frame, 1, 43, NULL, 0);
+	assert_int_equal(size, FRAME_OVERHEAD);
+	assert_int_equal(frame_parser_feed(&parser, frame, size, NULL, NULL), 1);
+	assert_int_equal(parser.stats.lost, 0);
+}
+
+void test_corrupted_stream()
+{
+	static uint8_t intact[FRAMES];
+	uint8_t frame[FRAME_MAX_SIZE];
+	frame_parser_t parser;
+	replay_t replay;
+	Logger_t log;
+	size_t len = 0;
+	uint16_t size, pos;
+	uint32_t i, damaged = 0;
+	struct timespec start, end;
+	double secs;
+
+	srand(1234);
+	for(i = 0; i < FRAMES; i++)
+	{
+		make_record(&log, i);
+		size = frame_encode(frame, FRAME_TYPE_LOG, i, &log, sizeof(log));
+		intact[i] = 1;
+
+		switch(rand() % 16)
+		{
+			case 0:         /* bit flip */
+				pos = rand() % size;
+				frame[pos] ^= 1 << (rand() % 8);
+				intact[i] = 0;
+				break;
+			case 1:         /* byte lost */
+				pos = rand() % size;
+				memmove(&frame[pos], &frame[pos + 1], size - pos - 1);
+				size--;
+				intact[i] = 0;
+				break;
+			case 2:         /* line noise between frames, may contain sync bytes */
+				for(pos = rand() % 8; pos; pos--)
+					stream[len++] = (rand() & 1) ? FRAME_SYNC0 : rand();
+				break;
+		}
+		damaged += !intact[i];
+		memcpy(&stream[len], frame, size);
+		len += size;
+	}
+
+	memset(&replay, 0, sizeof(replay));
+	replay.intact = intact;
+	frame_parser_init(&parser);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	feed_chunks(&parser, stream, len, 64, &replay);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	assert_int_equal(replay.intact_seen, FRAMES - damaged);
+	assert_int_equal(parser.stats.frames, replay.received);
+	assert_true(parser.stats.crc_errors > 0);
+	assert_true(parser.stats.lost >= damaged - (replay.received - replay.intact_seen));
+
+	secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("frames %u (damaged %u) crc errors %u len errors %u lost %u skipped %u bytes\n",
+		parser.stats.frames, damaged, parser.stats.crc_errors, parser.stats.len_errors,
+		parser.stats.lost, parser.stats.bytes_skipped);
+	printf("%.0f frames/sec recovered, %.1f MB/sec\n",
+		parser.stats.frames / secs, len / secs / 1e6);
+}
+
+void test_garbage_only()
+{
+	frame_parser_t parser;
+	uint32_t i;
+
+	srand(99);
+	for(i = 0; i < STREAM_SIZE / 4; i++)
+		stream[i] = (i % 3) ? FRAME_SYNC0 : rand();
+	frame_parser_init(&parser);
+	frame_parser_feed(&parser, stream, STREAM_SIZE / 4, NULL, NULL);
+	assert_true(parser.count < FRAME_MAX_SIZE);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_roundtrip),
+		cmocka_unit_test(test_corrupted_stream),
+		cmocka_unit_test(test_garbage_only),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
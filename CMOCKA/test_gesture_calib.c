@@ -0,0 +1,274 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_gesture_calib.c
+* @brief Adaptive gesture calibration: unit checks and a detection rate simulation across lighting profiles
+*
+* The simulation plays the traces in traces/ as the hand's reflection and
+* puts a room around it: crosstalk from the cover, which scales with LED
+* drive and gain, ambient light leaking past the sensor's rejection,
+* which scales with gain, and noise. Channels saturate at 255. Each
+* profile runs swipes, which should decode to the trace's direction, and
+* idle stretches where crosstalk alone kept the engine in gesture mode,
+* which should decode to nothing. Both run once with the fixed settings
+* and once after gesture_calib has settled on the profile's PDATA and
+* CDATA readings.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_gesture_calib test_gesture_calib.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c ../Gesture_sensor/src/gesture_calib.c
+*     trace_file.c -lcmocka
+*
+* Run it from the CMOCKA directory.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_calib.h"
+#include "trace_file.h"
+
+#define INT_DATASETS    (4)     /* GFIFOTH in DEFAULT_GCONF1 */
+#define SWIPES          (600)
+#define IDLES           (600)
+#define IDLE_DATASETS   (32)
+
+typedef struct profile
+{
+	const char *name;
+	uint16_t ambient;       /* CDATA */
+	int crosstalk;          /* counts at GGAIN_2X, 100 mA */
+	int noise;              /* +- counts at GGAIN_2X */
+	int leak;               /* ambient counts at GGAIN_2X */
+}profile_t;
+
+static const profile_t profiles[] =
+{
+	{ "dark",           20,    4,  2,   0 },
+	{ "dark, covered",  20,    28, 10,  0 },
+	{ "office",         1500,  6,  3,   12 },
+	{ "window",         6000,  6,  4,   50 },
+	{ "sunlight",       20000, 6,  5,   220 },
+};
+
+static const char *names[] =
+{
+	"up_16", "up_24", "up_32", "down_16", "down_24", "down_32",
+	"left_16", "left_24", "left_32", "right_16", "right_24", "right_32",
+};
+
+static trace_file_t traces[12];
+static uint32_t seed = 2026;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+/* one channel as the sensor reports it, reflect in counts at GGAIN_2X and 100 mA */
+static uint8_t channel(const profile_t *p, const gesture_calib_setting_t *s, int reflect)
+{
+	int v, noise = (int)(rnd() % (2 * p->noise + 1)) - p->noise;
+
+	/* optics scale with the LED current, everything with the gain */
+	v = ((((reflect + p->crosstalk) >> s->ledDrive) + p->leak + noise) << s->gain) / 2;
+	return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+/* PDATA with no hand: PGAIN_4X and 100 mA */
+static uint8_t pdata(const profile_t *p)
+{
+	int v = 2 * (p->crosstalk + (int)(rnd() % (2 * p->noise + 1)) - p->noise);
+
+	return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+static int decode(uint8_t data[][4], int count)
+{
+	int i, n;
+
+	gestureBegin();
+	for(i = 0; i < count; i += n)
+	{
+		n = count - i < INT_DATASETS ? count - i : INT_DATASETS;
+		gestureAddData(data[i], n * 4);
+	}
+	return gestureFinish();
+}
+
+typedef struct result
+{
+	int hits, falses;
+}result_t;
+
+static void run(const profile_t *p, const gesture_calib_setting_t *s, result_t *res)
+{
+	uint8_t data[TRACE_MAX_SETS][4];
+	const trace_file_t *t;
+	int i, k, c, scale;
+
+	gesture_sensor0.tuning = s->tuning;
+	resetGestureParameters();
+	res->hits = res->falses = 0;
+	for(i = 0; i < SWIPES; i++)
+	{
+		/* hands at different heights */
+		t = &traces[rnd() % 12];
+		scale = 60 + rnd() % 61;
+		for(k = 0; k < t->count; k++)
+			for(c = 0; c < 4; c++)
+				data[k][c] = channel(p, s, t->data[k][c] * scale / 100);
+		res->hits += decode(data, t->count) == t->expect;
+	}
+	for(i = 0; i < IDLES; i++)
+	{
+		for(k = 0; k < IDLE_DATASETS; k++)
+			for(c = 0; c < 4; c++)
+				data[k][c] = channel(p, s, 0);
+		res->falses += decode(data, IDLE_DATASETS) != DIR_NONE;
+	}
+}
+
+static const gesture_calib_setting_t fixed =
+{
+	GGAIN_2X, DEFAULT_GLDRIVE,       /* as enableGestureSensor leaves it */
+	{ GESTURE_THRESHOLD_OUT, GESTURE_SENSITIVITY_1, GESTURE_SENSITIVITY_2 }
+};
+
+void test_hysteresis()
+{
+	gesture_calib_t c;
+	uint32_t changed;
+	int i;
+
+	/* a quiet office: 4X would put the leak over the noise limit, so only
+	 * the threshold moves, on the confirming sample, then it is steady */
+	gesture_calib_init(&c, &fixed);
+	for(i = 1; i < GCALIB_CONFIRM; i++)
+		assert_int_equal(gesture_calib_sample(&c, 1500, 8), 0);
+	assert_int_equal(gesture_calib_sample(&c, 1500, 8), GCALIB_THRESHOLD);
+	assert_int_equal(c.cur.gain, GGAIN_2X);
+	assert_int_equal(c.cur.tuning.thresholdOut, 28);
+	for(i = 0; i < 10; i++)
+		assert_int_equal(gesture_calib_sample(&c, 1500, 8), 0);
+
+	/* sunlight: capped at 1X and the bright sensitivity */
+	for(i = 1; i < GCALIB_CONFIRM; i++)
+		assert_int_equal(gesture_calib_sample(&c, 20000, 8), 0);
+	changed = gesture_calib_sample(&c, 20000, 8);
+	assert_int_equal(changed, GCALIB_GAIN | GCALIB_THRESHOLD | GCALIB_SENSITIVITY);
+	assert_int_equal(c.cur.gain, GGAIN_1X);
+	assert_int_equal(c.cur.tuning.sensitivity1, GCALIB_SENS1_BRIGHT);
+	for(i = 0; i < 20; i++)
+		gesture_calib_sample(&c, 20000, 8);
+	assert_int_equal(c.target.gain, GGAIN_1X);
+
+	/* a passing shadow does not bring the gain back up */
+	assert_int_equal(gesture_calib_sample(&c, 20, 8) & GCALIB_GAIN, 0);
+	for(i = 0; i < 2 * GCALIB_CONFIRM; i++)
+		assert_int_equal(gesture_calib_sample(&c, 20000, 8) & GCALIB_GAIN, 0);
+	assert_int_equal(c.cur.gain, GGAIN_1X);
+
+	/* back in the dark the gain climbs one step per change */
+	for(i = 0; i < 40 && c.cur.gain == GGAIN_1X; i++)
+		changed = gesture_calib_sample(&c, 20, 4);
+	assert_true(changed & GCALIB_GAIN);
+	assert_int_equal(c.cur.gain, GGAIN_2X);
+	for(i = 1; i < GCALIB_CONFIRM; i++)
+		assert_int_equal(gesture_calib_sample(&c, 20, 4), 0);
+	assert_true(gesture_calib_sample(&c, 20, 4) & GCALIB_GAIN);
+	assert_int_equal(c.cur.gain, GGAIN_4X);
+	assert_int_equal(c.cur.tuning.sensitivity1, GESTURE_SENSITIVITY_1);
+}
+
+void test_bounds()
+{
+	gesture_calib_t c;
+	int i, p;
+
+	/* anything the sensor can report stays within bounds */
+	for(p = 0; p <= 255; p += 5)
+	{
+		gesture_calib_init(&c, &fixed);
+		for(i = 0; i < 40; i++)
+		{
+			gesture_calib_sample(&c, rnd() & 0xFFFF, p);
+			assert_true(c.cur.gain <= GCALIB_GAIN_MAX);
+			assert_true(c.cur.ledDrive <= GCALIB_LED_MIN);
+			assert_true(c.cur.tuning.thresholdOut >= GESTURE_THRESHOLD_OUT);
+			assert_true(c.cur.tuning.thresholdOut <= GCALIB_THRESHOLD_MAX);
+		}
+	}
+
+	/* a noisy cover first takes the gain down, then the LED current */
+	gesture_calib_init(&c, &fixed);
+	for(i = 0; i < 10 * GCALIB_CONFIRM; i++)
+		gesture_calib_sample(&c, 20, 200);
+	assert_int_equal(c.cur.gain, GGAIN_1X);
+	assert_int_equal(c.cur.ledDrive, GCALIB_LED_MIN);
+	assert_int_equal(c.cur.tuning.thresholdOut, (200 >> (2 + GCALIB_LED_MIN)) + GCALIB_MARGIN);
+}
+
+void test_lighting_profiles()
+{
+	result_t before, after;
+	gesture_calib_t c;
+	unsigned int p;
+	int i;
+
+	for(i = 0; i < 12; i++)
+	{
+		assert_int_equal(trace_load_named(&traces[i], names[i]), 0);
+		assert_true(traces[i].expect > DIR_NONE);
+	}
+
+	printf("%-14s %-28s %-17s %-17s\n", "profile", "calibrated to", "fixed hit/false", "calibrated hit/false");
+	for(p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++)
+	{
+		run(&profiles[p], &fixed, &before);
+
+		gesture_calib_init(&c, &fixed);
+		for(i = 0; i < 10 * GCALIB_CONFIRM; i++)
+			gesture_calib_sample(&c, profiles[p].ambient, pdata(&profiles[p]));
+		run(&profiles[p], &c.cur, &after);
+
+		printf("%-14s gain %ux led %u thr %2u s %u/%u  %5.1f%% %5.1f%%     %5.1f%% %5.1f%%\n",
+		       profiles[p].name, 1 << c.cur.gain, 100 >> c.cur.ledDrive, c.cur.tuning.thresholdOut,
+		       c.cur.tuning.sensitivity1, c.cur.tuning.sensitivity2,
+		       100.0 * before.hits / SWIPES, 100.0 * before.falses / IDLES,
+		       100.0 * after.hits / SWIPES, 100.0 * after.falses / IDLES);
+
+		/* never worse, within the noise of the run */
+		assert_true(after.hits >= before.hits - SWIPES / 50);
+		assert_true(after.falses <= before.falses + IDLES / 50);
+	}
+	gesture_sensor0.tuning = fixed.tuning;
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_hysteresis),
+		cmocka_unit_test(test_bounds),
+		cmocka_unit_test(test_lighting_profiles),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,536 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_gesture_features.c
+* @brief One pass gesture feature kernel against the scalar processGestureData, with a benchmark
+*
+* reference_process is processGestureData as it was before the kernel,
+* word for word, on its own copy of the old four array data block. Both
+* run on the same random batches, from the same state, and every global
+* they touch has to come out the same.
+*
+* gcc -O2 -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_gesture_features test_gesture_features.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_features.h"
+
+#define BATCHES         (20000)
+#define BENCH_PASSES    (50)
+
+/* the data block before the sample ring */
+typedef struct soa_data
+{
+	uint8_t u_data[32];
+	uint8_t d_data[32];
+	uint8_t l_data[32];
+	uint8_t r_data[32];
+	uint8_t total_gestures;
+}soa_data_t;
+
+typedef struct batch
+{
+	soa_data_t soa;
+	uint32_t sample[32];
+}batch_t;
+
+typedef struct state
+{
+	int ud_delta, lr_delta, ud_count, lr_count, near_count, far_count, gstate;
+}state_t;
+
+static uint32_t seed = 2026;
+static soa_data_t ref_data;
+
+static uint32_t rnd(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+static bool reference_process()
+{
+    uint8_t u_first = 0;
+    uint8_t d_first = 0;
+    uint8_t l_first = 0;
+    uint8_t r_first = 0;
+    uint8_t u_last = 0;
+    uint8_t d_last = 0;
+    uint8_t l_last = 0;
+    uint8_t r_last = 0;
+    int ud_ratio_first;
+    int lr_ratio_first;
+    int ud_ratio_last;
+    int lr_ratio_last;
+    int ud_delta;
+    int lr_delta;
+    int i;
+
+    /* If we have less than 4 total gestures, that's not enough */
+    if( ref_data.total_gestures <= 4 )
+    {
+        return false;
+    }
+
+    /* Check to make sure our data isn't out of bounds */
+    if( (ref_data.total_gestures <= 32) && \
+        (ref_data.total_gestures > 0) )
+    {
+
+        /* Find the first value in U/D/L/R above the threshold */
+        for( i = 0; i < ref_data.total_gestures; i++ )
+        {
+            if( (ref_data.u_data[i] > GESTURE_THRESHOLD_OUT) &&
+                (ref_data.d_data[i] > GESTURE_THRESHOLD_OUT) &&
+                (ref_data.l_data[i] > GESTURE_THRESHOLD_OUT) &&
+                (ref_data.r_data[i] > GESTURE_THRESHOLD_OUT) )
+            {
+
+                u_first = ref_data.u_data[i];
+                d_first = ref_data.d_data[i];
+                l_first = ref_data.l_data[i];
+                r_first = ref_data.r_data[i];
+                break;
+            }
+        }
+
+        /* If one of the _first values is 0, then there is no good data */
+        if( (u_first == 0) || (d_first == 0) || \
+            (l_first == 0) || (r_first == 0) )
+        {
+
+            return false;
+        }
+        /* Find the last value in U/D/L/R above the threshold */
+        for( i = ref_data.total_gestures - 1; i >= 0; i-- )
+        {
+
+            if( (ref_data.u_data[i] > GESTURE_THRESHOLD_OUT) &&
+                (ref_data.d_data[i] > GESTURE_THRESHOLD_OUT) &&
+                (ref_data.l_data[i] > GESTURE_THRESHOLD_OUT) &&
+                (ref_data.r_data[i] > GESTURE_THRESHOLD_OUT) )
+            {
+
+                u_last = ref_data.u_data[i];
+                d_last = ref_data.d_data[i];
+                l_last = ref_data.l_data[i];
+                r_last = ref_data.r_data[i];
+                break;
+            }
+        }
+    }
+
+    /* Calculate the first vs. last ratio of up/down and left/right */
+    ud_ratio_first = ((u_first - d_first) * 100) / (u_first + d_first);
+    lr_ratio_first = ((l_first - r_first) * 100) / (l_first + r_first);
+    ud_ratio_last = ((u_last - d_last) * 100) / (u_last + d_last);
+    lr_ratio_last = ((l_last - r_last) * 100) / (l_last + r_last);
+
+    /* Determine the difference between the first and last ratios */
+    ud_delta = ud_ratio_last - ud_ratio_first;
+    lr_delta = lr_ratio_last - lr_ratio_first;
+
+    /* Accumulate the UD and LR delta values */
+    gesture_sensor0.ud_delta += ud_delta;
+    gesture_sensor0.lr_delta += lr_delta;
+
+    /* Determine U/D gesture */
+    if( gesture_sensor0.ud_delta >= GESTURE_SENSITIVITY_1 )
+    {
+        gesture_sensor0.ud_count = 1;
+    }
+    else if( gesture_sensor0.ud_delta <= -GESTURE_SENSITIVITY_1 )
+    {
+        gesture_sensor0.ud_count = -1;
+    }
+    else
+    {
+        gesture_sensor0.ud_count = 0;
+    }
+
+    /* Determine L/R gesture */
+    if( gesture_sensor0.lr_delta >= GESTURE_SENSITIVITY_1 )
+    {
+        gesture_sensor0.lr_count = 1;
+    }
+    else if( gesture_sensor0.lr_delta <= -GESTURE_SENSITIVITY_1 )
+    {
+        gesture_sensor0.lr_count = -1;
+    }
+    else
+    {
+        gesture_sensor0.lr_count = 0;
+    }
+
+    /* Determine Near/Far gesture */
+    if( (gesture_sensor0.ud_count == 0) && (gesture_sensor0.lr_count == 0) )
+    {
+        if( (abs(ud_delta) < GESTURE_SENSITIVITY_2) && \
+            (abs(lr_delta) < GESTURE_SENSITIVITY_2) )
+        {
+
+            if( (ud_delta == 0) && (lr_delta == 0) )
+            {
+                gesture_sensor0.near_count++;
+            }
+            else if( (ud_delta != 0) || (lr_delta != 0) )
+            {
+                gesture_sensor0.far_count++;
+            }
+
+            if( (gesture_sensor0.near_count >= 10) && (gesture_sensor0.far_count >= 2) )
+            {
+                if( (ud_delta == 0) && (lr_delta == 0) )
+                {
+                    gesture_sensor0.state = NEAR_STATE;
+                }
+                else if( (ud_delta != 0) && (lr_delta != 0) )
+                {
+                    gesture_sensor0.state = FAR_STATE;
+                }
+                return true;
+            }
+        }
+    }
+    else
+    {
+        if( (abs(ud_delta) < GESTURE_SENSITIVITY_2) && \
+            (abs(lr_delta) < GESTURE_SENSITIVITY_2) )
+        {
+
+            if( (ud_delta == 0) && (lr_delta == 0) )
+            {
+                gesture_sensor0.near_count++;
+            }
+
+            if( gesture_sensor0.near_count >= 10 )
+            {
+                gesture_sensor0.ud_count = 0;
+                gesture_sensor0.lr_count = 0;
+                gesture_sensor0.ud_delta = 0;
+                gesture_sensor0.lr_delta = 0;
+            }
+        }
+    }
+
+    return false;
+}
+
+static void save(state_t *s)
+{
+	s->ud_delta = gesture_sensor0.ud_delta;
+	s->lr_delta = gesture_sensor0.lr_delta;
+	s->ud_count = gesture_sensor0.ud_count;
+	s->lr_count = gesture_sensor0.lr_count;
+	s->near_count = gesture_sensor0.near_count;
+	s->far_count = gesture_sensor0.far_count;
+	s->gstate = gesture_sensor0.state;
+}
+
+static void restore(const state_t *s)
+{
+	gesture_sensor0.ud_delta = s->ud_delta;
+	gesture_sensor0.lr_delta = s->lr_delta;
+	gesture_sensor0.ud_count = s->ud_count;
+	gesture_sensor0.lr_count = s->lr_count;
+	gesture_sensor0.near_count = s->near_count;
+	gesture_sensor0.far_count = s->far_count;
+	gesture_sensor0.state = s->gstate;
+}
+
+/* datasets in at the ring's head, returns the index of the first */
+static uint32_t ring_write(const uint32_t *sample, uint32_t count)
+{
+	gesture_ring_t *ring = &gesture_sensor0.data.ring;
+	uint32_t n, first = ring->head;
+	uint8_t *dst;
+
+	while(count)
+	{
+		dst = gesture_ring_space(ring, count, &n);
+		memcpy(dst, sample, n * 4);
+		gesture_ring_commit(ring, n);
+		sample += n;
+		count -= n;
+	}
+	return first;
+}
+
+/* the batch as the only datasets processGestureData has not seen */
+static void load(const batch_t *b)
+{
+	ref_data = b->soa;
+	gesture_sensor0.data.next = ring_write(b->sample, b->soa.total_gestures);
+}
+
+static uint32_t pack(uint8_t u, uint8_t d, uint8_t l, uint8_t r)
+{
+	return u | d << 8 | l << 16 | (uint32_t)r << 24;
+}
+
+static void pack_batch(batch_t *b)
+{
+	int i;
+
+	for(i = 0; i < 32; i++)
+		b->sample[i] = pack(b->soa.u_data[i], b->soa.d_data[i],
+				    b->soa.l_data[i], b->soa.r_data[i]);
+}
+
+/* a random batch: dark, threshold edge, swipe-like or saturated datasets */
+static void random_batch(batch_t *b, int count)
+{
+	int i, c, kind, base = rnd() % 200;
+	uint8_t *ch[4] = { b->soa.u_data, b->soa.d_data,
+			   b->soa.l_data, b->soa.r_data };
+
+	b->soa.total_gestures = count;
+	for(i = 0; i < 32; i++)
+	{
+		kind = rnd() % 8;
+		for(c = 0; c < 4; c++)
+		{
+			if(kind == 0)
+				ch[c][i] = rnd() % 12;
+			else if(kind == 1)
+				ch[c][i] = 9 + rnd() % 4;
+			else if(kind == 2)
+				ch[c][i] = 255 - rnd() % 3;
+			else if(kind == 3)
+				ch[c][i] = base;        /* equal channels, near state */
+			else
+				ch[c][i] = rnd() % 256;
+		}
+	}
+	pack_batch(b);
+}
+
+/* the window over the datasets just written */
+static gesture_window_t window_of(const uint32_t *sample, uint32_t count)
+{
+	return gesture_ring_window(&gesture_sensor0.data.ring, ring_write(sample, count));
+}
+
+void test_ratio_exhaustive()
+{
+	int a, b;
+
+	for(a = GESTURE_THRESHOLD_OUT + 1; a < 256; a++)
+		for(b = GESTURE_THRESHOLD_OUT + 1; b < 256; b++)
+			assert_int_equal(gesture_ratio(a, b), ((a - b) * 100) / (a + b));
+}
+
+void test_features()
+{
+	gesture_features_t f;
+	gesture_window_t w;
+	uint32_t sample[32];
+	int i;
+
+	for(i = 0; i < 32; i++)
+		sample[i] = pack(100, 100, 100, 100);
+
+	/* a channel at exactly the threshold does not count */
+	sample[0] = pack(GESTURE_THRESHOLD_OUT, 100, 100, 100);
+	sample[9] = pack(100, GESTURE_THRESHOLD_OUT, 100, 100);
+	sample[1] = pack(100, 100, 60, 140);
+	sample[8] = pack(100, 100, 140, 60);
+
+	/* and the window may wrap the end of the ring */
+	gesture_sensor0.data.ring.head = GESTURE_RING_DEPTH - 3;
+	w = window_of(sample, 10);
+	assert_true(gesture_features(&w, GESTURE_THRESHOLD_OUT, &f));
+	assert_int_equal(f.first, 1);
+	assert_int_equal(f.last, 8);
+	assert_int_equal(f.lr_first, -40);
+	assert_int_equal(f.lr_last, 40);
+	assert_int_equal(f.lr_delta, 80);
+	assert_int_equal(f.ud_delta, 0);
+
+	/* datasets past the window are ignored */
+	w.count = 6;
+	assert_true(gesture_features(&w, GESTURE_THRESHOLD_OUT, &f));
+	assert_int_equal(f.last, 5);
+
+	/* nothing over the threshold */
+	for(i = 0; i < 32; i++)
+		sample[i] = pack(100, 100, 100, i & 1 ? 3 : GESTURE_THRESHOLD_OUT);
+	w = window_of(sample, 32);
+	assert_false(gesture_features(&w, GESTURE_THRESHOLD_OUT, &f));
+}
+
+/* bit exact against the old function, state carried between batches */
+void test_bit_exact()
+{
+	batch_t batch;
+	state_t start, ref, got;
+	bool refOk, gotOk;
+	int b, count, processed = 0;
+
+	resetGestureParameters();
+	for(b = 0; b < BATCHES; b++)
+	{
+		if(!(b % 64))
+			resetGestureParameters();
+		count = 1 + rnd() % 32;
+		random_batch(&batch, count);
+		load(&batch);
+		save(&start);
+		refOk = reference_process();
+		save(&ref);
+		restore(&start);
+		gotOk = processGestureData();
+		save(&got);
+		assert_int_equal(gotOk, refOk);
+		assert_memory_equal(&got, &ref, sizeof(ref));
+		processed += count > 4;
+	}
+	assert_true(processed > BATCHES / 2);
+}
+
+static double seconds(const struct timespec *a, const struct timespec *b)
+{
+	return (b->tv_sec - a->tv_sec) + (b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+/* one gesture over several FIFO reads: the accumulated deltas are the
+ * change from its first valid dataset to its last, ring wrap included */
+void test_multi_batch()
+{
+	uint8_t fifo[4 * 4], *set;
+	int i, first_ud = 0, first_lr = 0, last_ud = 0, last_lr = 0;
+	bool seen = false;
+
+	gesture_sensor0.data.ring.head = GESTURE_RING_DEPTH - 50;
+	resetGestureParameters();
+	gestureBegin();
+	for(i = 0; i < 160; i++)
+	{
+		/* L rises and R falls, U/D drifts slowly */
+		set = &fifo[4 * (i % 4)];
+		set[0] = 60 + i;
+		set[1] = 200 - i / 2;
+		set[2] = 40 + i;
+		set[3] = 220 - i + 2 * (i % 7);
+		if(i % 9 == 4)
+			set[3] = 5;         /* a dark dataset now and then */
+		else
+		{
+			if(!seen)
+			{
+				first_ud = gesture_ratio(set[0], set[1]);
+				first_lr = gesture_ratio(set[2], set[3]);
+				seen = true;
+			}
+			last_ud = gesture_ratio(set[0], set[1]);
+			last_lr = gesture_ratio(set[2], set[3]);
+		}
+		/* the FIFO interrupt every 4 datasets */
+		if(i % 4 == 3)
+			gestureAddData(fifo, sizeof(fifo));
+	}
+	assert_int_equal(gesture_sensor0.ud_delta, last_ud - first_ud);
+	assert_int_equal(gesture_sensor0.lr_delta, last_lr - first_lr);
+	assert_int_equal(gesture_sensor0.data.ring.head - gesture_sensor0.data.next, 1);
+	resetGestureParameters();
+}
+
+/* a swipe: the hand comes in and leaves over the batch, dark datasets at both ends */
+static void swipe_batch(batch_t *b)
+{
+	int i, edge = rnd() % 13, level;
+
+	b->soa.total_gestures = 32;
+	for(i = 0; i < 32; i++)
+	{
+		level = (i < edge || i >= 32 - edge) ? rnd() % 10 : 40 + rnd() % 200;
+		b->soa.u_data[i] = level;
+		b->soa.d_data[i] = level + rnd() % 10;
+		b->soa.l_data[i] = level + i;
+		b->soa.r_data[i] = level + 31 - i;
+	}
+	pack_batch(b);
+}
+
+/* both sides pay for copying the batch in: 128 bytes into the old
+ * arrays, 32 words into the ring at a slot that does not wrap */
+static void bench(const char *name, const batch_t *batches, int n)
+{
+	struct timespec t0, t1, t2;
+	volatile int sink = 0;
+	int p, b;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(p = 0; p < BENCH_PASSES; p++)
+		for(b = 0; b < n; b++)
+		{
+			resetGestureParameters();
+			ref_data = batches[b].soa;
+			sink += reference_process();
+		}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	for(p = 0; p < BENCH_PASSES; p++)
+		for(b = 0; b < n; b++)
+		{
+			gesture_sensor0.data.ring.head = (b * 32) & GESTURE_RING_MASK;
+			resetGestureParameters();
+			memcpy(&gesture_sensor0.data.ring.sample[gesture_sensor0.data.ring.head], batches[b].sample, 32 * 4);
+			gesture_ring_commit(&gesture_sensor0.data.ring, 32);
+			sink += processGestureData();
+		}
+	clock_gettime(CLOCK_MONOTONIC, &t2);
+
+	printf("%-8s scalar %6.1f ns, kernel %6.1f ns per 32 dataset batch\n", name,
+	       seconds(&t0, &t1) * 1e9 / (BENCH_PASSES * n), seconds(&t1, &t2) * 1e9 / (BENCH_PASSES * n));
+}
+
+void test_benchmark()
+{
+	static batch_t batches[256];
+	int b;
+
+	for(b = 0; b < 256; b++)
+		random_batch(&batches[b], 32);
+	bench("random", batches, 256);
+	for(b = 0; b < 256; b++)
+		swipe_batch(&batches[b]);
+	bench("swipe", batches, 256);
+
+	/* the host divides in hardware in a few cycles; on the M4 every
+	 * division and every byte compare and branch the kernel removes counts */
+	printf("per batch: 4 divisions -> 4 multiplies, one dataset per test -> four\n");
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_ratio_exhaustive),
+		cmocka_unit_test(test_features),
+		cmocka_unit_test(test_bit_exact),
+		cmocka_unit_test(test_multi_batch),
+		cmocka_unit_test(test_benchmark),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,349 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_gesture_grammar.c
+* @brief Gesture sequences: double swipe, U-turn and hold, on synthetic timelines and replayed traces
+*
+* The trace checks decode traces/ through gestureBegin, gestureAddData and
+* gestureFinish, four datasets per FIFO interrupt, and push the results
+* into the grammar with the time each gesture took and the gap between
+* them.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_gesture_grammar test_gesture_grammar.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c ../Gesture_sensor/src/gesture_grammar.c
+*     trace_file.c -lcmocka
+*
+* Run it from the CMOCKA directory.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_grammar.h"
+#include "trace_file.h"
+
+#define INT_DATASETS    (4)     /* GFIFOTH in DEFAULT_GCONF1 */
+#define DATASET_MS      (4)     /* GWTIME 2.8 ms plus the LED pulses */
+#define GAP             (600)
+#define HOLD            (1500)
+
+/* the firmware's table as GESTURE_PAIRS builds it */
+static const gesture_rule_t rules[] =
+{
+	{ GGRAMMAR_SWIPE,  DIR_UP,    0x01 },
+	{ GGRAMMAR_SWIPE,  DIR_LEFT,  0x02 },
+	{ GGRAMMAR_SWIPE,  DIR_DOWN,  0x04 },
+	{ GGRAMMAR_SWIPE,  DIR_RIGHT, 0x08 },
+	{ GGRAMMAR_SWIPE,  DIR_NEAR,  0x10 },
+	{ GGRAMMAR_SWIPE,  DIR_FAR,   0x20 },
+	{ GGRAMMAR_DOUBLE, DIR_UP,    0x10 },
+	{ GGRAMMAR_DOUBLE, DIR_DOWN,  0x20 },
+	{ GGRAMMAR_UTURN,  DIR_UP,    0x40 },
+	{ GGRAMMAR_UTURN,  DIR_LEFT,  0x80 },
+	{ GGRAMMAR_HOLD,   DIR_NEAR,  0x20 },
+};
+
+static const char *kindName[] = { "none", "swipe", "double", "U-turn", "hold" };
+
+static void init(gesture_grammar_t *g)
+{
+	gesture_grammar_init(g, rules, sizeof(rules) / sizeof(rules[0]), GAP, HOLD);
+}
+
+static void check(const gesture_token_t *t, int kind, int dir, uint32_t action)
+{
+	assert_int_equal(t->kind, kind);
+	assert_int_equal(t->dir, dir);
+	assert_int_equal(t->action, action);
+}
+
+void test_immediate()
+{
+	gesture_grammar_t g;
+	gesture_token_t t[2];
+
+	init(&g);
+	assert_false(gesture_grammar_immediate(&g, DIR_UP));
+	assert_false(gesture_grammar_immediate(&g, DIR_DOWN));
+	assert_false(gesture_grammar_immediate(&g, DIR_LEFT));
+	assert_true(gesture_grammar_immediate(&g, DIR_RIGHT));
+	assert_true(gesture_grammar_immediate(&g, DIR_NEAR));
+
+	/* comes straight out and nothing waits */
+	assert_int_equal(gesture_grammar_push(&g, DIR_RIGHT, 0, 100, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_RIGHT, 0x08);
+	assert_int_equal(gesture_grammar_wait(&g, 100), GGRAMMAR_NO_DEADLINE);
+	assert_int_equal(gesture_grammar_push(&g, DIR_RIGHT, 200, 300, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_RIGHT, 0x08);
+	assert_int_equal(gesture_grammar_push(&g, DIR_FAR, 400, 450, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_FAR, 0x20);
+
+	/* an empty gesture is not one */
+	assert_int_equal(gesture_grammar_push(&g, DIR_NONE, 500, 600, t), 0);
+}
+
+void test_pairs()
+{
+	gesture_grammar_t g;
+	gesture_token_t t[2];
+
+	init(&g);
+	assert_int_equal(gesture_grammar_push(&g, DIR_UP, 0, 100, t), 0);
+	assert_int_equal(gesture_grammar_wait(&g, 100), GAP + 1);
+	assert_int_equal(gesture_grammar_push(&g, DIR_UP, 100 + GAP, 800, t), 1);
+	check(&t[0], GGRAMMAR_DOUBLE, DIR_UP, 0x10);
+	assert_int_equal(gesture_grammar_wait(&g, 800), GGRAMMAR_NO_DEADLINE);
+
+	/* U-turns are named after the first swipe */
+	assert_int_equal(gesture_grammar_push(&g, DIR_LEFT, 1000, 1100, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_RIGHT, 1200, 1300, t), 1);
+	check(&t[0], GGRAMMAR_UTURN, DIR_LEFT, 0x80);
+
+	/* a pair without a rule is two swipes, the second one may wait in turn */
+	assert_int_equal(gesture_grammar_push(&g, DIR_DOWN, 2000, 2100, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_UP, 2200, 2300, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_DOWN, 0x04);
+	assert_int_equal(gesture_grammar_poll(&g, 2301 + GAP, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_UP, 0x01);
+	assert_int_equal(gesture_grammar_push(&g, DIR_LEFT, 2400, 2500, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_LEFT, 2600, 2700, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_LEFT, 0x02);
+	assert_int_equal(gesture_grammar_poll(&g, 2701 + GAP, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_LEFT, 0x02);
+
+	/* a noisy read in between does not break a pair */
+	assert_int_equal(gesture_grammar_push(&g, DIR_DOWN, 3000, 3100, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_NONE, 3200, 3250, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_DOWN, 3300, 3400, t), 1);
+	check(&t[0], GGRAMMAR_DOUBLE, DIR_DOWN, 0x20);
+}
+
+void test_timeouts()
+{
+	gesture_grammar_t g;
+	gesture_token_t t[2];
+
+	init(&g);
+
+	/* alone: out from poll once the gap has passed, not before */
+	assert_int_equal(gesture_grammar_push(&g, DIR_UP, 0, 100, t), 0);
+	assert_int_equal(gesture_grammar_poll(&g, 100 + GAP, t), 0);
+	assert_int_equal(gesture_grammar_poll(&g, 101 + GAP, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_UP, 0x01);
+	assert_int_equal(gesture_grammar_poll(&g, 2000, t), 0);
+
+	/* too late for a pair: the first comes out and the second waits */
+	assert_int_equal(gesture_grammar_push(&g, DIR_UP, 3000, 3100, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_UP, 3101 + GAP, 3800, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_UP, 0x01);
+	assert_int_equal(gesture_grammar_wait(&g, 3800), GAP + 1);
+
+	/* an unrelated gesture ends the wait, both come out */
+	assert_int_equal(gesture_grammar_push(&g, DIR_RIGHT, 3900, 4000, t), 2);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_UP, 0x01);
+	check(&t[1], GGRAMMAR_SWIPE, DIR_RIGHT, 0x08);
+
+	/* and the clock may wrap */
+	assert_int_equal(gesture_grammar_push(&g, DIR_LEFT, 0xFFFFFF00U, 0xFFFFFF80U, t), 0);
+	assert_int_equal(gesture_grammar_poll(&g, 0x100, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_RIGHT, 0x180, 0x200, t), 1);
+	check(&t[0], GGRAMMAR_UTURN, DIR_LEFT, 0x80);
+}
+
+void test_hold()
+{
+	gesture_grammar_t g;
+	gesture_token_t t[2];
+
+	init(&g);
+	assert_int_equal(gesture_grammar_push(&g, DIR_NEAR, 0, HOLD - 1, t), 1);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_NEAR, 0x10);
+	assert_int_equal(gesture_grammar_push(&g, DIR_NEAR, 5000, 5000 + HOLD, t), 1);
+	check(&t[0], GGRAMMAR_HOLD, DIR_NEAR, 0x20);
+
+	/* a hold after a waiting swipe ends the wait */
+	assert_int_equal(gesture_grammar_push(&g, DIR_DOWN, 9000, 9100, t), 0);
+	assert_int_equal(gesture_grammar_push(&g, DIR_NEAR, 9200, 9200 + 2 * HOLD, t), 2);
+	check(&t[0], GGRAMMAR_SWIPE, DIR_DOWN, 0x04);
+	check(&t[1], GGRAMMAR_HOLD, DIR_NEAR, 0x20);
+}
+
+/* random gestures and polls: every gesture comes out once, nothing waits
+ * longer than GAP and nothing overdue is left after a poll */
+void test_bounded()
+{
+	static const uint8_t dirs[] = { DIR_NONE, DIR_LEFT, DIR_RIGHT, DIR_UP, DIR_DOWN, DIR_NEAR, DIR_FAR };
+	gesture_grammar_t g;
+	gesture_token_t t[2];
+	uint32_t now = 0xFFF00000U, seed = 17, in = 0, out = 0;
+	int i, n, k;
+	uint8_t dir;
+
+	init(&g);
+	for(i = 0; i < 100000; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		now += (seed >> 8) % 900;
+		if((seed >> 20) & 1)
+		{
+			dir = dirs[(seed >> 12) % 7];
+			n = gesture_grammar_push(&g, dir, now, now + 50, t);
+			now += 50;
+			in += dir != DIR_NONE;
+		}
+		else
+		{
+			n = gesture_grammar_poll(&g, now, t);
+			assert_int_not_equal(gesture_grammar_wait(&g, now), 0);
+		}
+		for(k = 0; k < n; k++)
+			out += 1 + (t[k].kind == GGRAMMAR_DOUBLE || t[k].kind == GGRAMMAR_UTURN);
+		assert_true(gesture_grammar_wait(&g, now) == GGRAMMAR_NO_DEADLINE ||
+			    gesture_grammar_wait(&g, now) <= GAP + 1);
+	}
+	now += GAP + 1;
+	out += gesture_grammar_poll(&g, now, t);
+	assert_int_equal(out, in);
+}
+
+/* Decode a trace and push it as a gesture starting at *now */
+static int play(gesture_grammar_t *g, const char *name, uint32_t *now, gesture_token_t out[2])
+{
+	static trace_file_t t;
+	int i, n, dir;
+
+	assert_int_equal(trace_load_named(&t, name), 0);
+	gestureBegin();
+	for(i = 0; i < t.count; i += n)
+	{
+		n = t.count - i < INT_DATASETS ? t.count - i : INT_DATASETS;
+		gestureAddData(t.data[i], n * 4);
+	}
+	dir = gestureFinish();
+	n = gesture_grammar_push(g, dir, *now, *now + t.count * DATASET_MS, out);
+	*now += t.count * DATASET_MS;
+	return n;
+}
+
+typedef struct sequence
+{
+	const char *first, *second;
+	uint32_t gap;
+	int kind[2], dir[2];    /* tokens, GGRAMMAR_NONE when fewer */
+}sequence_t;
+
+void test_trace_sequences()
+{
+	static const sequence_t seq[] =
+	{
+		{ "up_24",    "up_16",    200,     { GGRAMMAR_DOUBLE, GGRAMMAR_NONE },  { DIR_UP, 0 } },
+		{ "down_32",  "down_24",  GAP,     { GGRAMMAR_DOUBLE, GGRAMMAR_NONE },  { DIR_DOWN, 0 } },
+		{ "left_32",  "right_24", 300,     { GGRAMMAR_UTURN, GGRAMMAR_NONE },   { DIR_LEFT, 0 } },
+		{ "up_16",    "down_16",  100,     { GGRAMMAR_UTURN, GGRAMMAR_NONE },   { DIR_UP, 0 } },
+		{ "right_16", "right_24", 100,     { GGRAMMAR_SWIPE, GGRAMMAR_SWIPE },  { DIR_RIGHT, DIR_RIGHT } },
+		{ "down_16",  "down_32",  GAP + 1, { GGRAMMAR_SWIPE, GGRAMMAR_SWIPE },  { DIR_DOWN, DIR_DOWN } },
+		{ "up_32",    "right_32", 100,     { GGRAMMAR_SWIPE, GGRAMMAR_SWIPE },  { DIR_UP, DIR_RIGHT } },
+		{ "down_24",  "up_24",    100,     { GGRAMMAR_SWIPE, GGRAMMAR_SWIPE },  { DIR_DOWN, DIR_UP } },
+	};
+	gesture_grammar_t g;
+	gesture_token_t t[4];
+	uint32_t now = 1000;
+	unsigned int s;
+	int n;
+
+	init(&g);
+	resetGestureParameters();
+	for(s = 0; s < sizeof(seq) / sizeof(seq[0]); s++)
+	{
+		n = play(&g, seq[s].first, &now, t);
+		now += seq[s].gap;
+		n += play(&g, seq[s].second, &now, &t[n]);
+		/* whatever still waits comes out after the gap */
+		now += GAP + 1;
+		n += gesture_grammar_poll(&g, now, &t[n]);
+		printf("%-8s %4u ms %-8s -> %s %s%s%s %s\n", seq[s].first, seq[s].gap, seq[s].second,
+		       kindName[t[0].kind], trace_dir_name(t[0].dir), n > 1 ? ", " : "",
+		       n > 1 ? kindName[t[1].kind] : "", n > 1 ? trace_dir_name(t[1].dir) : "");
+		assert_int_equal(n, seq[s].kind[1] == GGRAMMAR_NONE ? 1 : 2);
+		assert_int_equal(t[0].kind, seq[s].kind[0]);
+		assert_int_equal(t[0].dir, seq[s].dir[0]);
+		if(n == 2)
+		{
+			assert_int_equal(t[1].kind, seq[s].kind[1]);
+			assert_int_equal(t[1].dir, seq[s].dir[1]);
+		}
+		now += 1000;
+	}
+}
+
+/* The firmware's default table: every trace's swipe comes out when it is
+ * pushed, 0 ms after the gesture ended, and the early decision can act on
+ * all of them. The pair table keeps UP waiting for the whole gap. */
+void test_default_latency()
+{
+	static const char *traces[] =
+	{
+		"up_16", "up_24", "up_32", "down_16", "down_24", "down_32",
+		"left_16", "left_24", "left_32", "right_16", "right_24", "right_32",
+	};
+	static const uint8_t dirs[] = { DIR_LEFT, DIR_RIGHT, DIR_UP, DIR_DOWN, DIR_NEAR, DIR_FAR };
+	gesture_grammar_t g;
+	gesture_token_t t[2];
+	uint32_t now = 1000, end, latency;
+	unsigned k;
+
+	gesture_grammar_init(&g, gesture_grammar_rules, gesture_grammar_rule_count, GAP, HOLD);
+	for(k = 0; k < sizeof(dirs) / sizeof(dirs[0]); k++)
+		assert_true(gesture_grammar_immediate(&g, dirs[k]));
+
+	resetGestureParameters();
+	for(k = 0; k < sizeof(traces) / sizeof(traces[0]); k++)
+	{
+		assert_int_equal(play(&g, traces[k], &now, t), 1);
+		assert_int_equal(t[0].kind, GGRAMMAR_SWIPE);
+		assert_int_not_equal(t[0].action, 0);
+		assert_int_equal(gesture_grammar_wait(&g, now), GGRAMMAR_NO_DEADLINE);
+		now += 1000;
+	}
+
+	/* the same swipe behind a double rule */
+	init(&g);
+	assert_int_equal(play(&g, "up_24", &now, t), 0);
+	end = now;
+	latency = gesture_grammar_wait(&g, now);
+	assert_int_equal(gesture_grammar_poll(&g, end + latency, t), 1);
+	printf("up_24: default table 0 ms, pair table %u ms\n", latency);
+	assert_int_equal(latency, GAP + 1);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_immediate),
+		cmocka_unit_test(test_pairs),
+		cmocka_unit_test(test_timeouts),
+		cmocka_unit_test(test_hold),
+		cmocka_unit_test(test_bounded),
+		cmocka_unit_test(test_trace_sequences),
+		cmocka_unit_test(test_default_latency),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
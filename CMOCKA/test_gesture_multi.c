@@ -0,0 +1,280 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_gesture_multi.c
+* @brief Several gesture sensors on their own I2C controllers or behind a mux, with a throughput benchmark
+*
+* Each sensor is driven by its own "task": the test switches the thread
+* local storage slot with freertos_sim_set_task() and binds the sensor
+* there, as vGestureTask does for its room. The host runs one task at a
+* time, so the benchmark counts bus time per controller instead: on
+* separate controllers the FIFO reads overlap and the slowest bus sets the
+* pace, behind one mux every read shares the same wire.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_gesture_multi test_gesture_multi.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_ints.h"
+#include "driverlib/sysctl.h"
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "include/apds_regs.h"
+#include "i2c_sim.h"
+#include "freertos_sim.h"
+
+#define SENSORS         (4)
+#define BATCH_SETS      (8)
+#define FILL_TICKS      (8)
+#define ROUNDS          (8)     /* gestures per sensor in the benchmark */
+
+static i2c_bus_t bus2 = I2C_BUS_INIT(I2C2_BASE, SYSCTL_PERIPH_I2C2, INT_I2C2);
+static i2c_bus_t bus3 = I2C_BUS_INIT(I2C3_BASE, SYSCTL_PERIPH_I2C3, INT_I2C3);
+static i2c_bus_t * const buses[SENSORS] = { &i2c_bus0, &i2c_bus1, &bus2, &bus3 };
+
+static gesture_sensor_t sensor1, sensor2, sensor3;
+static gesture_sensor_t * const sensors[SENSORS] = { &gesture_sensor0, &sensor1, &sensor2, &sensor3 };
+
+static int cur;
+static int batchesLeft;
+
+static void I2C2Handler(void)
+{
+	i2c_bus_isr(&bus2);
+}
+
+static void I2C3Handler(void)
+{
+	i2c_bus_isr(&bus3);
+}
+
+/* even sensors see a left to right pass, odd ones right to left */
+static int expected(int sensor)
+{
+	return sensor & 1 ? DIR_LEFT : DIR_RIGHT;
+}
+
+static void push_batch(int sensor)
+{
+	uint8_t set[4], rise, fall;
+	int i;
+
+	for(i = 0; i < BATCH_SETS; i++)
+	{
+		rise = 50 + 100 * i / (BATCH_SETS - 1);
+		fall = 150 - 100 * i / (BATCH_SETS - 1);
+		set[0] = 100;
+		set[1] = 100;
+		set[2] = sensor & 1 ? fall : rise;
+		set[3] = sensor & 1 ? rise : fall;
+		i2c_sim_fifo_push(set);
+	}
+}
+
+/* the INT line of the sensor whose task is waiting */
+static void sensor_hook(void)
+{
+	BaseType_t woken = pdFALSE;
+
+	if(!freertos_sim_waiting_on())
+	{
+		i2c_sim_isr();
+		return;
+	}
+	if(!batchesLeft)
+		return;
+	batchesLeft--;
+	freertos_sim_advance(FILL_TICKS);
+	i2c_sim_select(cur);
+	push_batch(cur);
+	gesture_sensor_signal_from_isr(sensors[cur], &woken);
+}
+
+/* runs the next driver calls as sensor's gesture task */
+static void task(int sensor)
+{
+	cur = sensor;
+	freertos_sim_set_task(sensor);
+	i2c_sim_select(sensor);
+}
+
+/* n sensors, each on its own controller or all on I2C0 behind the mux */
+static void start(int n, bool muxed)
+{
+	int i;
+
+	i2c_sim_reset();
+	i2c_setup();
+	i2c_setup1();
+	i2c_bus_init(&bus2);
+	i2c_bus_init(&bus3);
+	i2c_sim_set_handler(I2C1_BASE, I2C1IntHandler);
+	i2c_sim_set_handler(I2C2_BASE, I2C2Handler);
+	i2c_sim_set_handler(I2C3_BASE, I2C3Handler);
+	for(i = 0; i < n; i++)
+	{
+		i2c_bus_t *bus = muxed ? &i2c_bus0 : buses[i];
+		int8_t channel = muxed ? i : I2C_NO_MUX;
+
+		i2c_sim_attach(i, bus->base, channel);
+		gesture_sensor_init(sensors[i], bus, channel);
+	}
+	freertos_sim_set_running(true);
+	freertos_sim_set_block_hook(sensor_hook);
+	batchesLeft = 0;
+	for(i = 0; i < n; i++)
+	{
+		task(i);
+		gesture_sensor_bind(sensors[i]);
+		assert_true(sensor_init());
+		assert_true(enableGestureSensor(true));
+	}
+}
+
+/* one two-batch swipe on sensor */
+static int gesture(int sensor)
+{
+	task(sensor);
+	push_batch(sensor);
+	batchesLeft = 1;
+	return readGesture();
+}
+
+void test_isolation()
+{
+	uint32_t t0, t1;
+
+	start(2, false);
+	t0 = freertos_sim_ticks();
+	assert_int_equal(gesture(0), DIR_RIGHT);
+	t1 = freertos_sim_ticks();
+	assert_int_equal(gesture(1), DIR_LEFT);
+	assert_int_equal(gesture_sensor0.endTick, t0 + FILL_TICKS);
+	assert_int_equal(sensor1.endTick, t1 + FILL_TICKS);
+
+	/* register writes go to the calling task's sensor only */
+	task(1);
+	assert_true(setGestureGain(GGAIN_8X));
+	assert_int_equal(i2c_sim_reg(APDS9960_GCONF2) >> 5 & 3, GGAIN_8X);
+	i2c_sim_select(0);
+	assert_int_not_equal(i2c_sim_reg(APDS9960_GCONF2) >> 5 & 3, GGAIN_8X);
+
+	/* so do the classifier thresholds */
+	sensor1.tuning.thresholdOut = 120;
+	assert_int_equal(gesture(1), DIR_NONE);
+	assert_int_equal(gesture(0), DIR_RIGHT);
+	assert_int_equal(i2c_sim_fifo_level(), 0);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+	assert_false(i2c_sim_int_pending());
+}
+
+void test_mux_select()
+{
+	i2c_sim_stats_t stats;
+	i2c_stats_t before, after;
+	uint8_t val;
+	int i;
+
+	start(3, true);
+	for(i = 0; i < 3; i++)
+		assert_int_equal(gesture(i), expected(i));
+	assert_int_equal(i2c_bus0.muxChannel, 2);
+
+	/* the mux is written only when the channel changes */
+	i2c_sim_clear_stats();
+	assert_true(i2c_dev_read(&sensor2.dev, APDS9960_ID, &val));
+	i2c_sim_get_stats(&stats);
+	assert_int_equal(stats.transactions, 2);
+	assert_true(i2c_dev_read(&gesture_sensor0.dev, APDS9960_ID, &val));
+	i2c_sim_get_stats(&stats);
+	assert_int_equal(stats.transactions, 5);
+	assert_int_equal(i2c_bus0.muxChannel, 0);
+
+	/* a failed select is forgotten, so the next transfer selects again */
+	i2c_bus_get_stats(&i2c_bus0, &before);
+	i2c_sim_attach(1, 0, I2C_NO_MUX);
+	i2c_sim_attach(2, 0, I2C_NO_MUX);
+	i2c_sim_attach(0, 0, I2C_NO_MUX);
+	assert_false(i2c_dev_read(&sensor1.dev, APDS9960_ID, &val));
+	assert_int_equal(i2c_bus0.muxChannel, I2C_NO_MUX);
+	i2c_bus_get_stats(&i2c_bus0, &after);
+	assert_int_equal(after.nacks - before.nacks, 1);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+}
+
+void test_throughput()
+{
+	i2c_sim_stats_t stats;
+	double own[SENSORS + 1], muxed[SENSORS + 1], us;
+	int n, i, r, topo;
+
+	for(topo = 0; topo < 2; topo++)
+	{
+		for(n = 1; n <= SENSORS; n++)
+		{
+			start(n, topo);
+			i2c_sim_clear_stats();
+			for(r = 0; r < ROUNDS; r++)
+			{
+				/* rooms take turns, as hands in different rooms do */
+				for(i = 0; i < n; i++)
+					assert_int_equal(gesture(i), expected(i));
+			}
+
+			/* busy time of the busiest controller */
+			us = 0;
+			for(i = 0; i < n; i++)
+			{
+				i2c_sim_get_bus_stats(buses[i]->base, &stats);
+				if(i2c_sim_bus_us(&stats) > us)
+					us = i2c_sim_bus_us(&stats);
+			}
+			(topo ? muxed : own)[n] = ROUNDS * n * 1e6 / us;
+			i2c_sim_get_stats(&stats);
+			printf("%d sensor%s %-16s %4u transactions %6llu SCL %8.1f us on the busiest bus "
+			       "%7.0f gestures/s\n", n, n > 1 ? "s" : " ",
+			       topo ? "behind one mux" : "own controllers", stats.transactions,
+			       (unsigned long long)stats.scl_clocks, us, (topo ? muxed : own)[n]);
+		}
+	}
+
+	for(n = 2; n <= SENSORS; n++)
+	{
+		/* overlapped buses scale with the sensor count, a shared one does not */
+		assert_true(own[n] > 0.9 * n * own[1]);
+		assert_true(muxed[n] < own[1]);
+		assert_true(own[n] > 0.9 * n * muxed[n]);
+	}
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_isolation),
+		cmocka_unit_test(test_mux_select),
+		cmocka_unit_test(test_throughput),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,258 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_gesture_stream.c
+* @brief Incremental gesture classifier, unit checks and FIFO trace replay
+*
+* Each trace in traces/ is replayed through readGesture on the host I2C
+* and FreeRTOS simulators, four datasets per FIFO interrupt as GCONF1
+* sets it. The early decision from the callback and the final result are
+* both checked against the trace's "# expect" line, and the time to each
+* is reported from the first FIFO interrupt.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_gesture_stream test_gesture_stream.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c trace_file.c -lcmocka
+*
+* Run it from the CMOCKA directory.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "include/gesture_stream.h"
+#include "include/apds_regs.h"
+#include "i2c_sim.h"
+#include "freertos_sim.h"
+#include "trace_file.h"
+
+#define INT_DATASETS    (4)     /* GFIFOTH in DEFAULT_GCONF1 */
+#define DATASET_TICKS   (4)     /* GWTIME 2.8 ms plus the LED pulses */
+
+static const char *traces[] =
+{
+	"up_16", "up_24", "up_32",
+	"down_16", "down_24", "down_32",
+	"left_16", "left_24", "left_32",
+	"right_16", "right_24", "right_32",
+};
+
+/* plain swipe along one axis, ratios go from -swing to +swing */
+static void swipe(gesture_stream_t *s, int axis, int swing, int n, int *decidedAt)
+{
+	uint8_t set[4];
+	int i, ratio;
+
+	for(i = 0; i < n; i++)
+	{
+		ratio = -swing + 2 * swing * i / (n - 1);
+		set[0] = set[1] = set[2] = set[3] = 100;
+		set[axis] = 100 + ratio;
+		set[axis + 1] = 100 - ratio;
+		if(gesture_stream_push(s, set) == GSTREAM_DECIDED)
+			*decidedAt = i + 1;
+	}
+}
+
+void test_directions()
+{
+	gesture_stream_t s;
+	int at;
+
+	/* (u - d) rising is a DOWN swipe, (l - r) rising is RIGHT */
+	gesture_stream_reset(&s, &gesture_sensor0.tuning);
+	swipe(&s, 0, 60, 12, &at);
+	assert_int_equal(s.dir, DIR_DOWN);
+	gesture_stream_reset(&s, &gesture_sensor0.tuning);
+	swipe(&s, 0, -60, 12, &at);
+	assert_int_equal(s.dir, DIR_UP);
+	gesture_stream_reset(&s, &gesture_sensor0.tuning);
+	swipe(&s, 2, 60, 12, &at);
+	assert_int_equal(s.dir, DIR_RIGHT);
+	gesture_stream_reset(&s, &gesture_sensor0.tuning);
+	swipe(&s, 2, -60, 12, &at);
+	assert_int_equal(s.dir, DIR_LEFT);
+
+	/* decided before the swipe is over, and never changed */
+	assert_true(at < 12);
+	assert_int_equal(s.decidedAt, at);
+	assert_int_equal(s.corrections, 0);
+}
+
+void test_threshold_and_hold()
+{
+	gesture_stream_t s;
+	uint8_t dark[4] = { 5, 200, 200, 200 };
+	uint8_t first[4] = { 100, 100, 70, 130 };
+	uint8_t moved[4] = { 100, 100, 130, 70 };
+
+	gesture_stream_reset(&s, &gesture_sensor0.tuning);
+
+	/* datasets with any channel at or under GESTURE_THRESHOLD_OUT are skipped */
+	assert_int_equal(gesture_stream_push(&s, dark), GSTREAM_NONE);
+	assert_int_equal(s.valid, 0);
+	assert_int_equal(gesture_stream_push(&s, first), GSTREAM_NONE);
+
+	/* one dataset past the sensitivity is not enough */
+	assert_int_equal(gesture_stream_push(&s, moved), GSTREAM_NONE);
+	assert_int_equal(gesture_stream_push(&s, dark), GSTREAM_NONE);
+	assert_int_equal(gesture_stream_push(&s, moved), GSTREAM_DECIDED);
+	assert_int_equal(s.dir, DIR_RIGHT);
+	assert_int_equal(s.decidedAt, 5);
+	assert_int_equal(s.samples, 5);
+	assert_int_equal(s.valid, 3);
+}
+
+void test_correction()
+{
+	gesture_stream_t s;
+	uint8_t first[4] = { 100, 100, 70, 130 };
+	uint8_t right[4] = { 100, 100, 130, 70 };
+	uint8_t down[4] = { 180, 20, 100, 100 };
+	int i;
+
+	gesture_stream_reset(&s, &gesture_sensor0.tuning);
+	gesture_stream_push(&s, first);
+	gesture_stream_push(&s, right);
+	assert_int_equal(gesture_stream_push(&s, right), GSTREAM_DECIDED);
+
+	/* the hand turns: U/D moves much further than L/R did */
+	assert_int_equal(gesture_stream_push(&s, down), GSTREAM_NONE);
+	assert_int_equal(gesture_stream_push(&s, down), GSTREAM_CORRECTED);
+	assert_int_equal(s.dir, DIR_DOWN);
+	assert_int_equal(s.corrections, 1);
+	for(i = 0; i < 4; i++)
+		assert_int_equal(gesture_stream_push(&s, down), GSTREAM_NONE);
+}
+
+/*******************************************************************************************************
+*
+* trace replay through readGesture
+*
+********************************************************************************************************/
+static const trace_file_t *playing;
+static int next;
+static int earlyDir, earlyEvents;
+static uint32_t earlyTick;
+
+static void sensor_hook(void)
+{
+	BaseType_t woken = pdFALSE;
+	int n;
+
+	if(!freertos_sim_waiting_on())
+	{
+		i2c_sim_isr();
+		return;
+	}
+	if(!playing || next == playing->count)
+		return;
+
+	/* the sensor only interrupts once the FIFO reaches the threshold,
+	 * a shorter tail is found after the pause */
+	n = playing->count - next;
+	if(n > INT_DATASETS)
+		n = INT_DATASETS;
+	freertos_sim_advance(n * DATASET_TICKS);
+	for(; n; n--)
+		i2c_sim_fifo_push(playing->data[next++]);
+	if(i2c_sim_fifo_level() >= INT_DATASETS)
+		gestureSignalFromISR(&woken);
+}
+
+/* the first call of a gesture is its decision, any later one a correction */
+static void early(int dir, int event)
+{
+	assert_int_equal(event, earlyEvents ? GSTREAM_CORRECTED : GSTREAM_DECIDED);
+	if(!earlyEvents++)
+		earlyTick = freertos_sim_ticks();
+	earlyDir = dir;
+}
+
+static void start(void)
+{
+	i2c_sim_reset();
+	i2c_setup();
+	apds_reg_init(&gesture_sensor0.regs, &gesture_sensor0.dev);
+	freertos_sim_set_running(true);
+	freertos_sim_set_block_hook(sensor_hook);
+	playing = NULL;
+	assert_true(sensor_init());
+	assert_true(enableGestureSensor(true));
+	setGestureCallback(early);
+}
+
+void test_trace_replay()
+{
+	static trace_file_t t;
+	uint32_t t0, earlySum = 0, finalSum = 0;
+	int dir, earlyOk = 0, finalOk = 0, decided = 0;
+	unsigned int i, n = sizeof(traces) / sizeof(traces[0]);
+
+	start();
+	printf("trace      expect  early  ticks  final  ticks\n");
+	for(i = 0; i < n; i++)
+	{
+		assert_int_equal(trace_load_named(&t, traces[i]), 0);
+		assert_true(t.expect > DIR_NONE);
+		playing = &t;
+		earlyDir = DIR_NONE;
+		earlyEvents = 0;
+
+		/* the first interrupt */
+		freertos_sim_advance(INT_DATASETS * DATASET_TICKS);
+		for(next = 0; next < INT_DATASETS; next++)
+			i2c_sim_fifo_push(t.data[next]);
+		t0 = freertos_sim_ticks();
+		dir = readGesture();
+		assert_int_equal(i2c_sim_fifo_level(), 0);
+
+		printf("%-10s %-6s  %-6s %5u  %-6s %5u\n", t.name, trace_dir_name(t.expect),
+		       trace_dir_name(earlyDir), earlyEvents ? earlyTick - t0 : 0, trace_dir_name(dir), freertos_sim_ticks() - t0);
+		earlyOk += earlyDir == t.expect;
+		finalOk += dir == t.expect;
+		if(earlyEvents)
+		{
+			decided++;
+			earlySum += earlyTick - t0;
+		}
+		finalSum += freertos_sim_ticks() - t0;
+	}
+	printf("accuracy early %d/%u final %d/%u, mean ticks to decision early %u final %u\n",
+	       earlyOk, n, finalOk, n, decided ? earlySum / decided : 0, finalSum / n);
+
+	/* every trace decided early, correctly, and well before the end */
+	assert_int_equal(earlyOk, n);
+	assert_int_equal(decided, n);
+	assert_true(2 * earlySum < finalSum);
+	setGestureCallback(NULL);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_directions),
+		cmocka_unit_test(test_threshold_and_hold),
+		cmocka_unit_test(test_correction),
+		cmocka_unit_test(test_trace_replay),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,169 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_gesture_trace.c
+* @brief Gesture capture frames from TIVA to BBG trace files
+*
+* gcc -I../Gesture_sensor -I../BBG -o test_gesture_trace test_gesture_trace.c
+*     ../Gesture_sensor/src/gesture_trace.c ../BBG/gtrace.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "include/gesture_trace.h"
+#include "gtrace.h"
+
+#define TRACE_DIR       "/tmp"
+
+static uint8_t sets[GESTURE_TRACE_MAX_SETS * 4];
+
+static void fill(void)
+{
+	unsigned int i;
+
+	for(i = 0; i < sizeof(sets); i++)
+		sets[i] = i;
+}
+
+void test_round_trip()
+{
+	uint8_t payload[FRAME_MAX_PAYLOAD];
+	gesture_trace_t rec, out;
+
+	fill();
+	rec.flags = GESTURE_TRACE_START;
+	rec.id = 200;
+	rec.result = 0;
+	rec.tick = 0x12345678;
+	rec.count = GESTURE_TRACE_MAX_SETS;
+	rec.data = sets;
+	assert_int_equal(gesture_trace_encode(payload, &rec), GESTURE_TRACE_HEADER + 4 * GESTURE_TRACE_MAX_SETS);
+	assert_true(GESTURE_TRACE_HEADER + 4 * GESTURE_TRACE_MAX_SETS <= FRAME_MAX_PAYLOAD);
+
+	assert_true(gesture_trace_decode(payload, GESTURE_TRACE_HEADER + 4 * GESTURE_TRACE_MAX_SETS, &out));
+	assert_int_equal(out.flags, GESTURE_TRACE_START);
+	assert_int_equal(out.id, 200);
+	assert_int_equal(out.tick, 0x12345678);
+	assert_int_equal(out.count, GESTURE_TRACE_MAX_SETS);
+	assert_memory_equal(out.data, sets, sizeof(sets));
+
+	/* too many datasets, or a partial one */
+	rec.count = GESTURE_TRACE_MAX_SETS + 1;
+	assert_int_equal(gesture_trace_encode(payload, &rec), 0);
+	assert_false(gesture_trace_decode(payload, GESTURE_TRACE_HEADER + 3, &out));
+	assert_false(gesture_trace_decode(payload, GESTURE_TRACE_HEADER - 1, &out));
+
+	/* the end frame carries no datasets */
+	rec.flags = GESTURE_TRACE_END;
+	rec.result = 3;
+	rec.count = 0;
+	rec.data = NULL;
+	assert_int_equal(gesture_trace_encode(payload, &rec), GESTURE_TRACE_HEADER);
+	assert_true(gesture_trace_decode(payload, GESTURE_TRACE_HEADER, &out));
+	assert_int_equal(out.count, 0);
+	assert_int_equal(out.result, 3);
+}
+
+static void frame(gtrace_t *t, uint8_t flags, uint8_t id, uint32_t tick, uint8_t count, uint8_t result)
+{
+	gesture_trace_t rec;
+
+	rec.flags = flags;
+	rec.id = id;
+	rec.result = result;
+	rec.tick = tick;
+	rec.count = count;
+	rec.data = sets;
+	gtrace_frame(t, &rec);
+}
+
+static void read_back(const gtrace_t *t, unsigned int n, char *text, size_t size)
+{
+	char path[GTRACE_PATH_MAX];
+	FILE *f;
+	size_t len;
+
+	snprintf(path, sizeof(path), "%s/g%ld_%04u.trace", t->dir, t->session, n);
+	f = fopen(path, "r");
+	assert_non_null(f);
+	len = fread(text, 1, size - 1, f);
+	text[len] = '\0';
+	fclose(f);
+	unlink(path);
+}
+
+void test_trace_file()
+{
+	gtrace_t t;
+	char text[512];
+
+	fill();
+	gtrace_init(&t, TRACE_DIR);
+
+	/* data before a start frame is not a trace */
+	frame(&t, 0, 7, 100, 2, 0);
+	assert_null(t.fp);
+
+	frame(&t, GESTURE_TRACE_START, 8, 1000, 2, 0);
+	frame(&t, 0, 8, 1016, 1, 0);
+	frame(&t, GESTURE_TRACE_END, 8, 1050, 0, 2);
+	assert_null(t.fp);
+	assert_int_equal(t.gestures, 1);
+	assert_int_equal(t.datasets, 3);
+
+	read_back(&t, 0, text, sizeof(text));
+	assert_string_equal(text, "# gesture 8 captured from TIVA\n# u d l r tick\n"
+				  "0 1 2 3 0\n4 5 6 7 0\n0 1 2 3 16\n# decided RIGHT\n");
+}
+
+void test_incomplete()
+{
+	gtrace_t t;
+	char text[512];
+
+	fill();
+	gtrace_init(&t, TRACE_DIR);
+
+	/* the end frame was lost, the next start closes the trace */
+	frame(&t, GESTURE_TRACE_START, 1, 0, 1, 0);
+	frame(&t, GESTURE_TRACE_START, 2, 40, 1, 0);
+	assert_int_equal(t.incomplete, 1);
+
+	/* a frame from another gesture closes it too */
+	frame(&t, 0, 3, 60, 1, 0);
+	assert_int_equal(t.incomplete, 2);
+	gtrace_close(&t);
+	assert_int_equal(t.incomplete, 2);
+	assert_int_equal(t.gestures, 0);
+
+	read_back(&t, 0, text, sizeof(text));
+	assert_non_null(strstr(text, "0 1 2 3 0\n# incomplete\n"));
+	read_back(&t, 1, text, sizeof(text));
+	assert_non_null(strstr(text, "# incomplete\n"));
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_round_trip),
+		cmocka_unit_test(test_trace_file),
+		cmocka_unit_test(test_incomplete),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,182 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_i2c_async.c
+* @brief Interrupt driven I2C transactions, NACK and timeout handling on the host I2C simulator
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_i2c_async test_i2c_async.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "i2c_sim.h"
+#include "freertos_sim.h"
+
+static i2c_stats_t before;
+
+/* sensor powered up, driver set up and the scheduler running */
+static void start(bool running)
+{
+	i2c_sim_reset();
+	i2c_setup();
+	freertos_sim_set_running(running);
+	freertos_sim_set_block_hook(i2c_sim_isr);
+	i2c_get_stats(&before);
+}
+
+static void check_released(void)
+{
+	assert_int_equal(freertos_sim_critical_nesting(), 0);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+	assert_false(i2c_sim_int_pending());
+}
+
+void test_interrupt_transfers()
+{
+	uint8_t val, data[16], set[4] = { 1, 2, 3, 4 };
+	uint32_t ticks;
+	i2c_stats_t after;
+	i2c_sim_stats_t bus;
+
+	start(true);
+	ticks = freertos_sim_ticks();
+	assert_true(i2c_write(APDS9960_GCONF1, 0x5A));
+	assert_int_equal(i2c_sim_reg(APDS9960_GCONF1), 0x5A);
+	assert_true(i2c_read(APDS9960_GCONF1, &val));
+	assert_int_equal(val, 0x5A);
+	assert_true(i2c_readID());
+
+	i2c_sim_fifo_push(set);
+	i2c_sim_fifo_push(set);
+	i2c_sim_fifo_push(set);
+	i2c_sim_fifo_push(set);
+	assert_int_equal(ReadDataBlock(APDS9960_GFIFO_U, data, 16), 16);
+	assert_memory_equal(data + 12, set, 4);
+	assert_int_equal(i2c_sim_fifo_level(), 0);
+	check_released();
+
+	/* every transaction completed from the interrupt, nothing timed out */
+	assert_int_equal(freertos_sim_ticks(), ticks);
+	i2c_get_stats(&after);
+	assert_int_equal(after.transactions - before.transactions, 4);
+	assert_int_equal(after.nacks, before.nacks);
+	assert_int_equal(after.timeouts, before.timeouts);
+	i2c_sim_get_stats(&bus);
+	assert_int_equal(bus.stops, 4);
+	assert_int_equal(bus.nacks, 0);
+}
+
+void test_nack()
+{
+	uint8_t val = 0x77;
+	i2c_stats_t after;
+	i2c_sim_stats_t bus;
+
+	start(true);
+	i2c_sim_set_reg(APDS9960_GCONF1, 0x11);
+
+	/* no sensor: address NACK, the transaction ends with a stop */
+	i2c_sim_nack_address(true);
+	assert_false(i2c_read(APDS9960_GCONF1, &val));
+	assert_false(i2c_readID());
+	assert_int_equal(ReadDataBlock(APDS9960_GFIFO_U, &val, 1), -1);
+	assert_int_equal(val, 0x77);
+	i2c_sim_get_stats(&bus);
+	assert_int_equal(bus.stops, 3);
+	i2c_sim_nack_address(false);
+
+	/* data byte refused, the register keeps its value */
+	i2c_sim_nack_data(true);
+	assert_false(i2c_write(APDS9960_GCONF1, 0x22));
+	assert_int_equal(i2c_sim_reg(APDS9960_GCONF1), 0x11);
+	i2c_sim_nack_data(false);
+	check_released();
+
+	i2c_get_stats(&after);
+	assert_int_equal(after.nacks - before.nacks, 4);
+	assert_int_equal(after.timeouts, before.timeouts);
+
+	/* the bus is usable again */
+	assert_true(i2c_read(APDS9960_GCONF1, &val));
+	assert_int_equal(val, 0x11);
+}
+
+void test_timeout()
+{
+	uint8_t val;
+	uint32_t ticks;
+	i2c_stats_t after;
+
+	start(true);
+	ticks = freertos_sim_ticks();
+	i2c_sim_hang(true);
+	assert_false(i2c_read(APDS9960_GCONF1, &val));
+	assert_true(freertos_sim_ticks() - ticks >= pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+	i2c_sim_hang(false);
+	check_released();
+
+	i2c_get_stats(&after);
+	assert_int_equal(after.timeouts - before.timeouts, 1);
+	assert_int_equal(after.transactions - before.transactions, 1);
+
+	ticks = freertos_sim_ticks();
+	assert_true(i2c_readID());
+	assert_int_equal(freertos_sim_ticks(), ticks);
+}
+
+void test_polled_before_scheduler()
+{
+	uint8_t data[8];
+	uint32_t ticks;
+	i2c_stats_t after;
+
+	start(false);
+	ticks = freertos_sim_ticks();
+	assert_true(i2c_readID());
+	i2c_sim_set_reg(APDS9960_GCONF1, 0x33);
+	i2c_sim_set_reg(APDS9960_GCONF2, 0x44);
+	assert_int_equal(ReadDataBlock(APDS9960_GCONF1, data, 2), 2);
+	assert_int_equal(data[0], 0x33);
+	assert_int_equal(data[1], 0x44);
+
+	i2c_sim_hang(true);
+	assert_false(i2c_readID());
+	i2c_sim_hang(false);
+
+	/* nothing blocked, the interrupt did not run the transactions */
+	assert_int_equal(freertos_sim_ticks(), ticks);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+	i2c_get_stats(&after);
+	assert_int_equal(after.transactions - before.transactions, 3);
+	assert_int_equal(after.timeouts - before.timeouts, 1);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_interrupt_transfers),
+		cmocka_unit_test(test_nack),
+		cmocka_unit_test(test_timeout),
+		cmocka_unit_test(test_polled_before_scheduler),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
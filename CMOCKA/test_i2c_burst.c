@@ -0,0 +1,152 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_i2c_burst.c
+* @brief Gesture FIFO burst read on the host I2C simulator, with a bus cycle benchmark
+*
+* The per-byte baseline is the transaction pattern ReadDataBlock used to
+* issue: a register write and a single receive for each of 0xFC..0xFF.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_i2c_burst test_i2c_burst.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "i2c_sim.h"
+
+static void fill_fifo(uint8_t datasets)
+{
+	uint8_t set[4], i;
+
+	for(i = 0; i < datasets; i++)
+	{
+		set[0] = i;
+		set[1] = 0x40 + i;
+		set[2] = 0x80 + i;
+		set[3] = 0xC0 + i;
+		i2c_sim_fifo_push(set);
+	}
+}
+
+static void check_datasets(const uint8_t *data, uint8_t datasets)
+{
+	uint8_t i;
+
+	for(i = 0; i < datasets; i++)
+	{
+		assert_int_equal(data[4 * i + 0], i);
+		assert_int_equal(data[4 * i + 1], 0x40 + i);
+		assert_int_equal(data[4 * i + 2], 0x80 + i);
+		assert_int_equal(data[4 * i + 3], 0xC0 + i);
+	}
+}
+
+/* what ReadDataBlock did before: two transactions per byte */
+static int read_per_byte(uint8_t *val, unsigned int len)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+	{
+		if(!i2c_read(APDS9960_GFIFO_U + (i & 3), &val[i]))
+			return -1;
+	}
+	return len;
+}
+
+void test_burst_fifo()
+{
+	uint8_t data[128];
+	i2c_sim_stats_t stats;
+
+	i2c_sim_reset();
+	fill_fifo(32);
+	assert_int_equal(ReadDataBlock(APDS9960_GFIFO_U, data, 128), 128);
+	check_datasets(data, 32);
+	assert_int_equal(i2c_sim_fifo_level(), 0);
+
+	/* register write, repeated start, 128 bytes, one stop */
+	i2c_sim_get_stats(&stats);
+	assert_int_equal(stats.transactions, 2);
+	assert_int_equal(stats.stops, 1);
+	assert_int_equal(stats.reads, 128);
+}
+
+void test_burst_lengths()
+{
+	uint8_t data[8];
+
+	i2c_sim_reset();
+	i2c_sim_set_reg(APDS9960_GCONF1, 0x11);
+	i2c_sim_set_reg(APDS9960_GCONF2, 0x22);
+	assert_int_equal(ReadDataBlock(APDS9960_GCONF1, data, 1), 1);
+	assert_int_equal(data[0], 0x11);
+	assert_int_equal(ReadDataBlock(APDS9960_GCONF1, data, 2), 2);
+	assert_int_equal(data[1], 0x22);
+	assert_int_equal(ReadDataBlock(APDS9960_GCONF1, data, 0), 0);
+
+	/* a partial FIFO read leaves the rest in the sensor */
+	fill_fifo(3);
+	assert_int_equal(ReadDataBlock(APDS9960_GFIFO_U, data, 8), 8);
+	check_datasets(data, 2);
+	assert_int_equal(i2c_sim_fifo_level(), 1);
+}
+
+void test_benchmark()
+{
+	uint8_t data[128];
+	i2c_sim_stats_t old, burst;
+	uint32_t level;
+
+	for(level = 4; level <= 32; level *= 2)
+	{
+		i2c_sim_reset();
+		fill_fifo(level);
+		assert_int_equal(read_per_byte(data, level * 4), level * 4);
+		check_datasets(data, level);
+		i2c_sim_get_stats(&old);
+
+		i2c_sim_reset();
+		fill_fifo(level);
+		assert_int_equal(ReadDataBlock(APDS9960_GFIFO_U, data, level * 4), level * 4);
+		check_datasets(data, level);
+		i2c_sim_get_stats(&burst);
+
+		assert_true(old.scl_clocks > 3 * burst.scl_clocks);
+		printf("fifo_level %2u: per-byte %4u transactions %5llu SCL %7.1f us %8llu cycles | "
+		       "burst %u transactions %4llu SCL %6.1f us %7llu cycles\n", level,
+		       old.transactions, (unsigned long long)old.scl_clocks, i2c_sim_bus_us(&old),
+		       (unsigned long long)i2c_sim_cpu_cycles(&old, g_ui32SysClock),
+		       burst.transactions, (unsigned long long)burst.scl_clocks, i2c_sim_bus_us(&burst),
+		       (unsigned long long)i2c_sim_cpu_cycles(&burst, g_ui32SysClock));
+	}
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_burst_fifo),
+		cmocka_unit_test(test_burst_lengths),
+		cmocka_unit_test(test_benchmark),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
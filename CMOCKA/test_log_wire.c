@@ -0,0 +1,175 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_log_wire.c
+* @brief Tests and link throughput benchmark for the compact log encoding
+*
+* The benchmark frames the same record mix in the old raw Logger_t format
+* and in the compact format, and reports how many records/sec each one
+* fits through the 57600 baud link (10 bits per byte on the wire).
+*
+* gcc -I../Gesture_sensor -o test_log_wire test_log_wire.c ../Gesture_sensor/src/log_wire.c
+*     ../Gesture_sensor/src/link_frame.c ../Gesture_sensor/driverlib/sw_crc.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "logger.h"
+#include "include/log_wire.h"
+#include "include/link_frame.h"
+
+#define LINK_BYTES_PER_SEC  (57600 / 10)
+#define RECORDS             (200000)
+
+static const uint32_t edges[] = {0, 1, 127, 128, 16383, 16384, 2097151, 2097152,
+				 268435455, 268435456, UINT32_MAX};
+
+void test_roundtrip()
+{
+	uint8_t wire[LOG_WIRE_MAX_SIZE], len;
+	log_wire_t rec, out;
+	size_t i, j;
+
+	for(i = 0; i < sizeof(edges) / sizeof(edges[0]); i++)
+	{
+		for(j = 0; j < LOG_MSG_COUNT; j++)
+		{
+			rec.value = edges[i];
+			rec.timestamp = edges[sizeof(edges) / sizeof(edges[0]) - 1 - i];
+			rec.log_level = LOG_LEVEL_HEARTBEAT;
+			rec.log_source = (j & 1) ? LOG_SOURCE_CLIENT : LOG_SOURCE_GESTURE;
+			rec.msg = j;
+
+			len = log_wire_encode(wire, &rec);
+			assert_true(len >= 4 && len <= LOG_WIRE_MAX_SIZE);
+			memset(&out, 0xAA, sizeof(out));
+			assert_true(log_wire_decode(wire, len, &out));
+			assert_int_equal(out.value, rec.value);
+			assert_int_equal(out.timestamp, rec.timestamp);
+			assert_int_equal(out.log_level, rec.log_level);
+			assert_int_equal(out.log_source, rec.log_source);
+			assert_int_equal(out.msg, rec.msg);
+			assert_non_null(log_wire_text(out.msg));
+		}
+	}
+	assert_string_equal(log_wire_text(LOG_MSG_HEART_BEAT_FROM_TIVA), "[TIVA] Heart beat from TIVA");
+	assert_null(log_wire_text(LOG_MSG_COUNT));
+}
+
+void test_malformed()
+{
+	uint8_t wire[LOG_WIRE_MAX_SIZE + 1], len, i;
+	log_wire_t rec = {UINT32_MAX, 12345, LOG_LEVEL_INFO, LOG_SOURCE_RELAY, LOG_MSG_CREATED_TASKS};
+
+	/* levels and sources without a compact code */
+	rec.log_level = 0x1;
+	assert_int_equal(log_wire_encode(wire, &rec), 0);
+	rec.log_level = LOG_LEVEL_INFO;
+	rec.log_source = 0x20;
+	assert_int_equal(log_wire_encode(wire, &rec), 0);
+	rec.log_source = LOG_SOURCE_RELAY;
+
+	len = log_wire_encode(wire, &rec);
+	for(i = 0; i < len; i++)
+		assert_false(log_wire_decode(wire, i, &rec));
+	wire[len] = 0;
+	assert_false(log_wire_decode(wire, len + 1, &rec));
+
+	/* varint running past 32 bits */
+	memset(wire, 0xFF, sizeof(wire));
+	assert_false(log_wire_decode(wire, sizeof(wire), &rec));
+}
+
+/* one record of the mix the TIVA sends: mostly heartbeats and relay status */
+static void make_record(log_wire_t *rec, uint32_t i)
+{
+	rec->timestamp = 1000 + i / 4;
+	rec->log_level = (i % 4) ? LOG_LEVEL_INFO : LOG_LEVEL_HEARTBEAT;
+	rec->log_source = (i % 4) ? LOG_SOURCE_RELAY : LOG_SOURCE_COMM;
+	rec->msg = (i % 4) ? (i % LOG_MSG_COUNT) : LOG_MSG_HEART_BEAT_FROM_TIVA;
+	rec->value = (i % 8 == 1) ? 0xAB : 0;
+}
+
+static void count_frame(const frame_t *frame, void *arg)
+{
+	log_wire_t rec;
+
+	if(frame->type == FRAME_TYPE_LOG_COMPACT)
+		assert_true(log_wire_decode(frame->payload, frame->len, &rec));
+	(*(uint32_t *)arg)++;
+}
+
+void test_throughput()
+{
+	static uint8_t stream[RECORDS * (sizeof(Logger_t) + FRAME_OVERHEAD)];
+	uint8_t wire[LOG_WIRE_MAX_SIZE];
+	size_t raw_bytes = 0, wire_bytes = 0;
+	frame_parser_t parser;
+	struct timespec start, end;
+	log_wire_t rec;
+	Logger_t log;
+	uint32_t i, frames = 0;
+	double secs, raw_rate, wire_rate;
+
+	for(i = 0; i < RECORDS; i++)
+	{
+		make_record(&rec, i);
+		memset(&log, 0, sizeof(log));
+		log.value = rec.value;
+		log.timestamp = rec.timestamp;
+		log.log_level = rec.log_level;
+		log.log_source = rec.log_source;
+		strncpy(log.msg, log_wire_text(rec.msg), MSG_SIZE);
+		raw_bytes += frame_encode(&stream[raw_bytes], FRAME_TYPE_LOG, i, &log, sizeof(log));
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for(i = 0; i < RECORDS; i++)
+	{
+		make_record(&rec, i);
+		wire_bytes += frame_encode(&stream[wire_bytes], FRAME_TYPE_LOG_COMPACT, i,
+					   wire, log_wire_encode(wire, &rec));
+	}
+	frame_parser_init(&parser);
+	frame_parser_feed(&parser, stream, wire_bytes, count_frame, &frames);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	assert_int_equal(frames, RECORDS);
+	assert_int_equal(parser.stats.crc_errors, 0);
+
+	raw_rate = (double)LINK_BYTES_PER_SEC * RECORDS / raw_bytes;
+	wire_rate = (double)LINK_BYTES_PER_SEC * RECORDS / wire_bytes;
+	assert_true(wire_rate > 3 * raw_rate);
+
+	secs = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("Logger_t frames: %.1f bytes/record, %.0f records/sec at 57600 baud\n",
+		(double)raw_bytes / RECORDS, raw_rate);
+	printf("compact frames:  %.1f bytes/record, %.0f records/sec at 57600 baud\n",
+		(double)wire_bytes / RECORDS, wire_rate);
+	printf("compact encode+frame+parse+decode: %.0f records/sec on host\n", RECORDS / secs);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_roundtrip),
+		cmocka_unit_test(test_malformed),
+		cmocka_unit_test(test_throughput),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,154 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_read_gesture.c
+* @brief Interrupt driven readGesture on the host I2C and FreeRTOS simulators
+*
+* The block hook plays the sensor: while the task waits for the FIFO it
+* moves the clock on by one fill time, queues the next batch and raises
+* the INT line the way PortAIntHandler does.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_read_gesture test_read_gesture.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "include/apds_regs.h"
+#include "i2c_sim.h"
+#include "freertos_sim.h"
+
+#define BATCH_SETS      (8)
+#define FILL_TICKS      (8)     /* time for the sensor to collect one batch */
+
+static int batchesLeft;
+static uint32_t signals;
+
+/* one left to right pass: L falls behind R */
+static void push_batch(void)
+{
+	uint8_t set[4];
+	int i;
+
+	for(i = 0; i < BATCH_SETS; i++)
+	{
+		set[0] = 100;
+		set[1] = 100;
+		set[2] = 50 + 100 * i / (BATCH_SETS - 1);
+		set[3] = 150 - 100 * i / (BATCH_SETS - 1);
+		i2c_sim_fifo_push(set);
+	}
+}
+
+static void sensor_hook(void)
+{
+	BaseType_t woken = pdFALSE;
+
+	if(!freertos_sim_waiting_on())
+	{
+		i2c_sim_isr();
+		return;
+	}
+	if(!batchesLeft)
+		return;
+	batchesLeft--;
+	freertos_sim_advance(FILL_TICKS);
+	push_batch();
+	signals++;
+	gestureSignalFromISR(&woken);
+}
+
+static void start(int batches)
+{
+	i2c_sim_reset();
+	i2c_setup();
+	apds_reg_init(&gesture_sensor0.regs, &gesture_sensor0.dev);
+	freertos_sim_set_running(true);
+	freertos_sim_set_block_hook(sensor_hook);
+	batchesLeft = 0;
+	assert_true(sensor_init());
+	assert_true(enableGestureSensor(true));
+	batchesLeft = batches;
+	signals = 0;
+}
+
+void test_swipe_right()
+{
+	uint32_t t0;
+
+	start(2);
+	push_batch();
+	t0 = freertos_sim_ticks();
+	assert_int_equal(readGesture(), DIR_RIGHT);
+
+	/* two fills, then one pause to see the hand has gone */
+	assert_int_equal(signals, 2);
+	assert_int_equal(gesture_sensor0.endTick, t0 + 2 * FILL_TICKS);
+	assert_int_equal(freertos_sim_ticks(), t0 + 2 * FILL_TICKS + pdMS_TO_TICKS(FIFO_PAUSE_TIME));
+	assert_int_equal(i2c_sim_fifo_level(), 0);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+}
+
+void test_no_gesture()
+{
+	i2c_sim_stats_t stats;
+	uint32_t t0;
+
+	start(0);
+	t0 = freertos_sim_ticks();
+	assert_int_equal(readGesture(), DIR_NONE);
+	assert_int_equal(freertos_sim_ticks(), t0);
+
+	/* the task sleeps out its idle period without polling the sensor */
+	i2c_sim_clear_stats();
+	assert_false(gestureWaitFifo(500));
+	assert_int_equal(freertos_sim_ticks(), t0 + pdMS_TO_TICKS(500));
+	i2c_sim_get_stats(&stats);
+	assert_int_equal(stats.transactions, 0);
+}
+
+void test_signal_latched()
+{
+	i2c_sim_stats_t stats;
+	BaseType_t woken = pdFALSE;
+
+	start(0);
+	i2c_sim_clear_stats();
+
+	/* an INT that fires before the task waits is not lost */
+	gestureSignalFromISR(&woken);
+	assert_true(gestureWaitFifo(0));
+	assert_false(gestureWaitFifo(0));
+	i2c_sim_get_stats(&stats);
+	assert_int_equal(stats.transactions, 0);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_swipe_right),
+		cmocka_unit_test(test_no_gesture),
+		cmocka_unit_test(test_signal_latched),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,205 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_relay_queue.c
+* @brief Relay command ordering, coalescing, debounce and contact dwell
+*
+* gcc -I../Gesture_sensor -o test_relay_queue test_relay_queue.c
+*     ../Gesture_sensor/src/relay_queue.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/relay_queue.h"
+
+static relay_queue_t q;
+static relay_cycle_t cycle;
+
+void test_ordered()
+{
+	relay_queue_stats_t stats;
+
+	/* two gestures before the relay task runs, eSetBits made this 0x03 */
+	relay_queue_init(&q, 0);
+	assert_true(relay_queue_push(&q, RELAY0_ON, 0));
+	assert_true(relay_queue_push(&q, RELAY1_ON, 10));
+	assert_int_equal(relay_queue_run(&q, 20, &cycle), 0x03);
+	assert_int_equal(cycle.applied, 2);
+	assert_int_equal(cycle.state, 0x03);
+	assert_int_equal(cycle.wait, RELAY_IDLE);
+
+	/* the order holds: off then a toggle leaves relay 0 on */
+	relay_queue_init(&q, 0x03);
+	assert_true(relay_queue_push(&q, RELAYS_OFF, 0));
+	assert_true(relay_queue_push(&q, RELAY0_TOGGLE, 500));
+	relay_queue_run(&q, 500, &cycle);
+	assert_int_equal(cycle.state, 0x00);
+	assert_int_equal(cycle.applied, 1);
+	relay_queue_run(&q, 500 + RELAY_DWELL_MS, &cycle);
+	assert_int_equal(cycle.state, 0x01);
+
+	/* nothing to switch still takes the command off the queue */
+	assert_true(relay_queue_push(&q, RELAY0_ON, 2000));
+	assert_int_equal(relay_queue_run(&q, 2000, &cycle), 0);
+	assert_int_equal(cycle.applied, 1);
+	relay_queue_get_stats(&q, &stats);
+	assert_int_equal(stats.queued, 3);
+	assert_int_equal(stats.applied, 3);
+	assert_int_equal(stats.switches, 3);
+	assert_int_equal(stats.depth, 0);
+}
+
+void test_coalesce()
+{
+	relay_queue_stats_t stats;
+
+	/* the same command twice */
+	relay_queue_init(&q, 0);
+	assert_true(relay_queue_push(&q, RELAY0_ON, 0));
+	assert_true(relay_queue_push(&q, RELAY0_ON, 100));
+	assert_int_equal(q.count, 1);
+
+	/* on then off, the later one wins */
+	assert_true(relay_queue_push(&q, RELAY0_OFF, 200));
+	assert_int_equal(q.count, 1);
+	assert_int_equal(relay_queue_run(&q, 200, &cycle), 0);
+	assert_int_equal(cycle.state, 0x00);
+
+	/* two toggles cancel, the relay never moves */
+	assert_true(relay_queue_push(&q, RELAY1_TOGGLE, 1000));
+	assert_true(relay_queue_push(&q, RELAY1_TOGGLE, 1100));
+	assert_int_equal(q.count, 0);
+	assert_int_equal(relay_queue_run(&q, 1400, &cycle), 0);
+
+	/* outside the debounce window both count */
+	assert_true(relay_queue_push(&q, RELAY1_TOGGLE, 2000));
+	assert_true(relay_queue_push(&q, RELAY1_TOGGLE, 2000 + RELAY_DEBOUNCE_MS));
+	assert_int_equal(q.count, 2);
+
+	/* different relays are not merged */
+	relay_queue_init(&q, 0);
+	assert_true(relay_queue_push(&q, RELAY0_ON, 0));
+	assert_true(relay_queue_push(&q, RELAY1_OFF, 10));
+	assert_true(relay_queue_push(&q, RELAYS_OFF, 20));
+	assert_int_equal(q.count, 3);
+	relay_queue_get_stats(&q, &stats);
+	assert_int_equal(stats.coalesced, 0);
+	assert_int_equal(stats.depth, 3);
+}
+
+void test_debounce_dwell()
+{
+	relay_queue_stats_t stats;
+
+	/* a toggle waits out the debounce window */
+	relay_queue_init(&q, 0);
+	assert_true(relay_queue_push(&q, RELAY0_TOGGLE, 0));
+	assert_int_equal(relay_queue_run(&q, 0, &cycle), 0);
+	assert_int_equal(cycle.wait, RELAY_DEBOUNCE_MS);
+	assert_int_equal(relay_queue_run(&q, RELAY_DEBOUNCE_MS, &cycle), 0x01);
+
+	/* switching back waits for the dwell, and holds what is behind it */
+	assert_true(relay_queue_push(&q, RELAY0_OFF, 400));
+	assert_true(relay_queue_push(&q, RELAY1_ON, 410));
+	assert_int_equal(relay_queue_run(&q, 410, &cycle), 0);
+	assert_int_equal(cycle.wait, RELAY_DEBOUNCE_MS + RELAY_DWELL_MS - 410);
+	assert_int_equal(cycle.state, 0x01);
+	assert_int_equal(relay_queue_run(&q, RELAY_DEBOUNCE_MS + RELAY_DWELL_MS, &cycle), 0x03);
+	assert_int_equal(cycle.state, 0x02);
+	assert_int_equal(cycle.applied, 2);
+
+	/* two commands for one relay in the same run */
+	assert_true(relay_queue_push(&q, RELAY1_OFF, 5000));
+	assert_true(relay_queue_push(&q, RELAYS_ON, 5000 + RELAY_DEBOUNCE_MS));
+	assert_int_equal(relay_queue_run(&q, 5400, &cycle), 0x02);
+	assert_int_equal(cycle.wait, RELAY_DWELL_MS);
+	assert_int_equal(relay_queue_run(&q, 5400 + RELAY_DWELL_MS, &cycle), 0x03);
+
+	relay_queue_get_stats(&q, &stats);
+	assert_int_equal(stats.deferred, 3);
+	assert_int_equal(stats.switches, 6);
+}
+
+void test_dropped()
+{
+	relay_queue_stats_t stats;
+	int i;
+
+	relay_queue_init(&q, 0);
+	/* merged values and no action are not commands */
+	assert_false(relay_queue_push(&q, RELAY0_ON | RELAY0_OFF, 0));
+	assert_false(relay_queue_push(&q, 0, 0));
+	for(i = 0; i < RELAY_QUEUE_DEPTH; i++)
+		assert_true(relay_queue_push(&q, i & 1 ? RELAY0_OFF : RELAY1_ON, i * RELAY_DEBOUNCE_MS));
+	assert_false(relay_queue_push(&q, RELAYS_OFF, i * RELAY_DEBOUNCE_MS));
+
+	relay_queue_get_stats(&q, &stats);
+	assert_int_equal(stats.dropped, 3);
+	assert_int_equal(stats.depth, RELAY_QUEUE_DEPTH);
+	assert_int_equal(stats.highWater, RELAY_QUEUE_DEPTH);
+
+	/* times wrap around */
+	relay_queue_init(&q, 0);
+	assert_true(relay_queue_push(&q, RELAY0_ON, 0xFFFFFF00));
+	assert_int_equal(relay_queue_run(&q, 0xFFFFFF00, &cycle), 0x01);
+	assert_true(relay_queue_push(&q, RELAY0_OFF, 0xFFFFFFF0));
+	relay_queue_run(&q, 0x10, &cycle);
+	assert_int_equal(cycle.wait, RELAY_DWELL_MS - 0x110);
+}
+
+void test_gesture_origin()
+{
+	/* client commands carry no gesture time */
+	relay_queue_init(&q, 0);
+	assert_true(relay_queue_push(&q, RELAYS_ON, 100));
+	relay_queue_run(&q, 100, &cycle);
+	assert_int_equal(cycle.applied, 1);
+	assert_int_equal(cycle.gestures, 0);
+
+	/* a run reports the latest gesture it applied */
+	assert_true(relay_queue_push_gesture(&q, RELAY0_OFF, 1150, 1200));
+	assert_true(relay_queue_push(&q, RELAY1_OFF, 1500));
+	assert_true(relay_queue_push_gesture(&q, RELAY0_ON, 1780, 1800));
+	relay_queue_run(&q, 2000, &cycle);
+	assert_int_equal(cycle.applied, 2);
+	assert_int_equal(cycle.gestures, 1);
+	assert_int_equal(cycle.gestureEnd, 1150);
+	relay_queue_run(&q, 2000 + RELAY_DWELL_MS, &cycle);
+	assert_int_equal(cycle.applied, 1);
+	assert_int_equal(cycle.gestures, 1);
+	assert_int_equal(cycle.gestureEnd, 1780);
+
+	/* a client command replacing a gesture's one is the client's */
+	assert_true(relay_queue_push_gesture(&q, RELAY1_ON, 3050, 3100));
+	assert_true(relay_queue_push(&q, RELAY1_OFF, 3200));
+	relay_queue_run(&q, 4000, &cycle);
+	assert_int_equal(cycle.applied, 1);
+	assert_int_equal(cycle.gestures, 0);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_ordered),
+		cmocka_unit_test(test_coalesce),
+		cmocka_unit_test(test_debounce_dwell),
+		cmocka_unit_test(test_dropped),
+		cmocka_unit_test(test_gesture_origin),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,189 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file test_sensor_init.c
+* @brief Table driven sensor_init on the host I2C simulator, against the per-register sequence
+*
+* The per-register baseline is the call sequence sensor_init used to make,
+* one read-modify-write transaction pair per setter.
+*
+* gcc -DPART_TM4C1294NCPDT -I. -I../Gesture_sensor -I../Gesture_sensor/Source/include
+*     -Iport -o test_sensor_init test_sensor_init.c i2c_sim.c freertos_sim.c
+*     ../Gesture_sensor/src/i2c_comm.c ../Gesture_sensor/src/apds_regs.c
+*     ../Gesture_sensor/src/gesture_sensor.c ../Gesture_sensor/src/gesture_stream.c
+*     ../Gesture_sensor/src/gesture_features.c -lcmocka
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdarg.h>
+#include <setjmp.h>
+#include <cmocka.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "include/apds_regs.h"
+#include "i2c_sim.h"
+#include "freertos_sim.h"
+
+static void start(void)
+{
+	i2c_sim_reset();
+	i2c_setup();
+	apds_reg_init(&gesture_sensor0.regs, &gesture_sensor0.dev);
+	freertos_sim_set_running(true);
+	freertos_sim_set_block_hook(i2c_sim_isr);
+}
+
+static void field(uint8_t reg, uint8_t mask, uint8_t bits)
+{
+	uint8_t val;
+
+	assert_true(i2c_read(reg, &val));
+	assert_true(i2c_write(reg, (val & ~mask) | bits));
+}
+
+/* what sensor_init did before */
+static void init_per_register(void)
+{
+	uint8_t id;
+
+	assert_true(i2c_read(APDS9960_ID, &id));
+	field(APDS9960_ENABLE, 0xFF, 0x00);
+	assert_true(i2c_write(APDS9960_ATIME, DEFAULT_ATIME));
+	assert_true(i2c_write(APDS9960_WTIME, DEFAULT_WTIME));
+	assert_true(i2c_write(APDS9960_PPULSE, DEFAULT_PROX_PPULSE));
+	assert_true(i2c_write(APDS9960_POFFSET_UR, DEFAULT_POFFSET_UR));
+	assert_true(i2c_write(APDS9960_POFFSET_DL, DEFAULT_POFFSET_DL));
+	assert_true(i2c_write(APDS9960_CONFIG1, DEFAULT_CONFIG1));
+	field(APDS9960_CONTROL, 0xC0, DEFAULT_LDRIVE << 6);
+	field(APDS9960_CONTROL, 0x0C, DEFAULT_PGAIN << 2);
+	field(APDS9960_CONTROL, 0x03, DEFAULT_AGAIN);
+	assert_true(i2c_write(APDS9960_PILT, DEFAULT_PILT));
+	assert_true(i2c_write(APDS9960_PIHT, DEFAULT_PIHT));
+	assert_true(i2c_write(APDS9960_AILTL, DEFAULT_AILT & 0xFF));
+	assert_true(i2c_write(APDS9960_AILTH, DEFAULT_AILT >> 8));
+	assert_true(i2c_write(APDS9960_AIHTL, DEFAULT_AIHT & 0xFF));
+	assert_true(i2c_write(APDS9960_AIHTH, DEFAULT_AIHT >> 8));
+	assert_true(i2c_write(APDS9960_PERS, DEFAULT_PERS));
+	assert_true(i2c_write(APDS9960_CONFIG2, DEFAULT_CONFIG2));
+	assert_true(i2c_write(APDS9960_CONFIG3, DEFAULT_CONFIG3));
+	assert_true(i2c_write(APDS9960_GPENTH, DEFAULT_GPENTH));
+	assert_true(i2c_write(APDS9960_GEXTH, DEFAULT_GEXTH));
+	assert_true(i2c_write(APDS9960_GCONF1, DEFAULT_GCONF1));
+	field(APDS9960_GCONF2, 0x60, DEFAULT_GGAIN << 5);
+	field(APDS9960_GCONF2, 0x18, DEFAULT_GLDRIVE << 3);
+	field(APDS9960_GCONF2, 0x07, DEFAULT_GWTIME);
+	assert_true(i2c_write(APDS9960_GOFFSET_U, DEFAULT_GOFFSET));
+	assert_true(i2c_write(APDS9960_GOFFSET_D, DEFAULT_GOFFSET));
+	assert_true(i2c_write(APDS9960_GOFFSET_L, DEFAULT_GOFFSET));
+	assert_true(i2c_write(APDS9960_GOFFSET_R, DEFAULT_GOFFSET));
+	assert_true(i2c_write(APDS9960_GPULSE, DEFAULT_GPULSE));
+	assert_true(i2c_write(APDS9960_GCONF3, DEFAULT_GCONF3));
+	field(APDS9960_GCONF4, 0x02, DEFAULT_GIEN << 1);
+}
+
+static void snapshot(uint8_t *regs)
+{
+	int i;
+
+	for(i = 0; i < APDS_REG_COUNT; i++)
+		regs[i] = i2c_sim_reg(APDS_REG_FIRST + i);
+}
+
+void test_same_configuration()
+{
+	uint8_t old[APDS_REG_COUNT], table[APDS_REG_COUNT];
+	i2c_sim_stats_t bus;
+
+	start();
+	init_per_register();
+	snapshot(old);
+
+	start();
+	assert_true(sensor_init());
+	snapshot(table);
+	assert_memory_equal(table, old, APDS_REG_COUNT);
+
+	/* the read-back filled the shadow */
+	i2c_sim_clear_stats();
+	assert_int_equal(getGestureGain(), DEFAULT_GGAIN);
+	assert_int_equal(getMode(), 0);
+	assert_true(setProximityGain(DEFAULT_PGAIN));
+	i2c_sim_get_stats(&bus);
+	assert_int_equal(bus.stops, 0);
+}
+
+void test_bus_traffic()
+{
+	i2c_sim_stats_t old, table;
+
+	start();
+	init_per_register();
+	i2c_sim_get_stats(&old);
+
+	start();
+	assert_true(sensor_init());
+	i2c_sim_get_stats(&table);
+
+	/* ID read, six burst writes, one read-back */
+	assert_int_equal(table.stops, 1 + 6 + 1);
+	assert_int_equal(table.writes, 28);
+	assert_int_equal(table.reads, 1 + APDS_REG_COUNT);
+	assert_true(i2c_sim_bus_us(&table) < 2200.0);
+	assert_true(3 * table.scl_clocks < 2 * old.scl_clocks);
+	printf("sensor_init per register: %2u transactions %4llu SCL %7.1f us\n",
+	       old.stops, (unsigned long long)old.scl_clocks, i2c_sim_bus_us(&old));
+	printf("sensor_init table:        %2u transactions %4llu SCL %7.1f us\n",
+	       table.stops, (unsigned long long)table.scl_clocks, i2c_sim_bus_us(&table));
+}
+
+void test_failures()
+{
+	apds_reg_stats_t before, after;
+	static const apds_reg_val_t unsorted[] =
+	{
+		{ APDS9960_GCONF1, 0x40 },
+		{ APDS9960_ATIME,  0x10 },
+	};
+	static const apds_reg_val_t id[] = { { APDS9960_ID, 0x00 } };
+
+	/* sensor refuses the data bytes */
+	start();
+	i2c_sim_nack_data(true);
+	assert_false(sensor_init());
+	i2c_sim_nack_data(false);
+	assert_int_equal(freertos_sim_mutexes_held(), 0);
+
+	/* tables have to be sorted and inside the shadowed range */
+	start();
+	assert_false(apds_reg_apply(&gesture_sensor0.regs, unsorted, 2));
+
+	/* the read-back sees a value the sensor did not keep */
+	start();
+	apds_reg_get_stats(&gesture_sensor0.regs, &before);
+	assert_false(apds_reg_apply(&gesture_sensor0.regs, id, 1));
+	apds_reg_get_stats(&gesture_sensor0.regs, &after);
+	assert_int_equal(after.mismatches - before.mismatches, 1);
+}
+
+int main()
+{
+
+	const struct CMUnitTest tests[] =
+	{
+		cmocka_unit_test(test_same_configuration),
+		cmocka_unit_test(test_bus_traffic),
+		cmocka_unit_test(test_failures),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+
+}
@@ -0,0 +1,99 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file trace_file.c
+* @brief Reads the gesture FIFO trace files in traces/ for the tests and gesture_replay
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include "include/gesture_sensor.h"
+#include "trace_file.h"
+
+static const char *dirName[] = { "NONE", "LEFT", "RIGHT", "UP", "DOWN", "NEAR", "FAR" };
+
+int trace_dir(const char *name)
+{
+	int i;
+
+	for(i = 0; i < DIR_ALL; i++)
+		if(!strcmp(name, dirName[i]))
+			return i;
+	return -1;
+}
+
+const char *trace_dir_name(int dir)
+{
+	if(dir >= 0 && dir < DIR_ALL)
+		return dirName[dir];
+	return dir < 0 ? "-" : "ERROR";
+}
+
+int trace_load(trace_file_t *t, const char *path)
+{
+	char line[128], word[16];
+	const char *base;
+	unsigned int v[5], lastTick = 0;
+	int n, run = 0;
+	FILE *f;
+
+	if(!(f = fopen(path, "r")))
+	{
+		perror(path);
+		return -1;
+	}
+	base = strrchr(path, '/');
+	snprintf(t->name, sizeof(t->name), "%s", base ? base + 1 : path);
+	if(strrchr(t->name, '.'))
+		*strrchr(t->name, '.') = '\0';
+	t->expect = t->decided = -1;
+	t->count = t->bursts = 0;
+
+	while(fgets(line, sizeof(line), f))
+	{
+		if(line[0] == '#')
+		{
+			if(sscanf(line, "# expect %15s", word) == 1)
+				t->expect = trace_dir(word);
+			else if(sscanf(line, "# decided %15s", word) == 1)
+				t->decided = trace_dir(word);
+			continue;
+		}
+		n = sscanf(line, "%u %u %u %u %u", &v[0], &v[1], &v[2], &v[3], &v[4]);
+		if(n < 4)
+			continue;
+		if(t->count == TRACE_MAX_SETS)
+		{
+			fprintf(stderr, "%s: more than %d datasets\n", path, TRACE_MAX_SETS);
+			break;
+		}
+
+		/* a new burst at each tick change, or every GFIFOTH datasets */
+		if(run && (n == 5 ? v[4] != lastTick : run == TRACE_INT_SETS))
+		{
+			t->burst[t->bursts++] = run;
+			run = 0;
+		}
+		lastTick = v[4];
+		memcpy(t->data[t->count++], (uint8_t []){ v[0], v[1], v[2], v[3] }, 4);
+		run++;
+	}
+	if(run)
+		t->burst[t->bursts++] = run;
+	fclose(f);
+	return 0;
+}
+
+int trace_load_named(trace_file_t *t, const char *name)
+{
+	char path[TRACE_NAME_MAX + 16];
+
+	snprintf(path, sizeof(path), "traces/%s.trace", name);
+	return trace_load(t, path);
+}
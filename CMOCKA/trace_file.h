@@ -0,0 +1,51 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file trace_file.h
+* @brief Reads the gesture FIFO trace files in traces/ for the tests and gesture_replay
+*
+* A trace has one "u d l r" line per dataset, with the tick it was read
+* at as an optional fifth column, and "# expect DIR" and "# decided DIR"
+* comment lines for its label and the TIVA's decision at capture. The
+* datasets are split into the bursts they were captured in, datasets
+* sharing a tick, or TRACE_INT_SETS at a time without ticks.
+*
+* @author Kiran Hegde and Gautham
+* @date  10/16/2026
+* @tools vim editor
+*
+********************************************************************************************************/
+
+#ifndef TRACE_FILE_H
+#define TRACE_FILE_H
+
+#include <stdint.h>
+
+#define TRACE_MAX_SETS      (1024)
+#define TRACE_INT_SETS      (4)     /* GFIFOTH in DEFAULT_GCONF1 */
+#define TRACE_NAME_MAX      (64)
+
+typedef struct trace_file
+{
+	char name[TRACE_NAME_MAX];      /* file name without directory or extension */
+	int expect;                     /* -1 when not labelled */
+	int decided;                    /* TIVA decision at capture, -1 if none */
+	int count;
+	uint8_t data[TRACE_MAX_SETS][4];
+	int bursts;
+	int burst[TRACE_MAX_SETS];      /* datasets per burst */
+}trace_file_t;
+
+/* 0 when read, -1 after reporting why not */
+int trace_load(trace_file_t *t, const char *path);
+
+/* traces/name.trace, run from the CMOCKA directory */
+int trace_load_named(trace_file_t *t, const char *name);
+
+/* DIR_ from its name, -1 when there is none */
+int trace_dir(const char *name);
+
+const char *trace_dir_name(int dir);
+
+#endif
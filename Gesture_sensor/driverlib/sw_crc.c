@@ -271,7 +271,7 @@ Crc8CCITT(uint8_t ui8Crc, const uint8_t *pui8Data, uint32_t ui32Count)
     // If the data buffer is not 16 bit-aligned, then perform a single step of
     // the CRC to make it 16 bit-aligned.
     //
-    if((uint32_t)pui8Data & 1)
+    if((uintptr_t)pui8Data & 1)
     {
         //
         // Perform the CRC on this input byte.
@@ -289,7 +289,7 @@ Crc8CCITT(uint8_t ui8Crc, const uint8_t *pui8Data, uint32_t ui32Count)
     // If the data buffer is not word-aligned and there are at least two bytes
     // of data left, then perform two steps of the CRC to make it word-aligned.
     //
-    if(((uint32_t)pui8Data & 2) && (ui32Count > 1))
+    if(((uintptr_t)pui8Data & 2) && (ui32Count > 1))
     {
         //
         // Read the next 16 bits.
@@ -416,7 +416,7 @@ Crc16(uint16_t ui16Crc, const uint8_t *pui8Data, uint32_t ui32Count)
     // If the data buffer is not 16 bit-aligned, then perform a single step of
     // the CRC to make it 16 bit-aligned.
     //
-    if((uint32_t)pui8Data & 1)
+    if((uintptr_t)pui8Data & 1)
     {
         //
         // Perform the CRC on this input byte.
@@ -434,7 +434,7 @@ Crc16(uint16_t ui16Crc, const uint8_t *pui8Data, uint32_t ui32Count)
     // If the data buffer is not word-aligned and there are at least two bytes
     // of data left, then perform two steps of the CRC to make it word-aligned.
     //
-    if(((uint32_t)pui8Data & 2) && (ui32Count > 1))
+    if(((uintptr_t)pui8Data & 2) && (ui32Count > 1))
     {
         //
         // Read the next 16 bits.
@@ -659,7 +659,7 @@ Crc32(uint32_t ui32Crc, const uint8_t *pui8Data, uint32_t ui32Count)
     // If the data buffer is not 16 bit-aligned, then perform a single step
     // of the CRC to make it 16 bit-aligned.
     //
-    if((uint32_t)pui8Data & 1)
+    if((uintptr_t)pui8Data & 1)
     {
         //
         // Perform the CRC on this input byte.
@@ -677,7 +677,7 @@ Crc32(uint32_t ui32Crc, const uint8_t *pui8Data, uint32_t ui32Count)
     // If the data buffer is not word-aligned and there are at least two bytes
     // of data left, then perform two steps of the CRC to make it word-aligned.
     //
-    if(((uint32_t)pui8Data & 2) && (ui32Count > 1))
+    if(((uintptr_t)pui8Data & 2) && (ui32Count > 1))
     {
         //
         // Read the next int16_t.
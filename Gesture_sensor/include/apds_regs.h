@@ -0,0 +1,91 @@
+/*
+ * apds_regs.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Write-through shadow of the APDS-9960 configuration registers,
+ *  ENABLE (0x80) to GCONF4 (0xAB). Reads of a cached register are served
+ *  from RAM and writes of an unchanged value never reach the bus. Between
+ *  apds_reg_begin and apds_reg_commit writes only update the shadow, and
+ *  commit sends each changed register once, in the order they were first
+ *  changed. Status, data and FIFO registers always go to the bus.
+ *
+ *  GCONF4 is cached but re-read before use outside a batch: the sensor
+ *  clears GMODE and GFIFO_CLR on its own.
+ *
+ *  apds_reg_apply loads a whole configuration table: each run of adjacent
+ *  registers is one auto-increment burst write, and one burst read of the
+ *  cached range checks the result and refills the shadow.
+ *
+ *  Each sensor has its own shadow and mutex in an apds_regs_t, bound to
+ *  the sensor's I2C device by apds_reg_init.
+ */
+
+#ifndef INCLUDE_APDS_REGS_H_
+#define INCLUDE_APDS_REGS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "include/i2c_comm.h"
+
+#define APDS_REG_FIRST          (0x80)  /* ENABLE */
+#define APDS_REG_LAST           (0xAB)  /* GCONF4 */
+#define APDS_REG_COUNT          (APDS_REG_LAST - APDS_REG_FIRST + 1)
+
+typedef struct apds_reg_stats
+{
+    uint32_t hits;          /* reads served from the shadow */
+    uint32_t busReads;
+    uint32_t busWrites;
+    uint32_t skipped;       /* writes of the value the register already had */
+    uint32_t coalesced;     /* batched writes merged into a pending one */
+    uint32_t mismatches;    /* table values the read-back did not match */
+}apds_reg_stats_t;
+
+typedef struct apds_reg_val
+{
+    uint8_t reg;
+    uint8_t val;
+}apds_reg_val_t;
+
+typedef struct apds_regs
+{
+    const i2c_dev_t *dev;
+    uint8_t shadow[APDS_REG_COUNT];
+    uint64_t valid;             /* shadow matches the sensor */
+    uint64_t fresh;             /* live registers read during this batch */
+    uint64_t dirty;             /* changed in this batch, not written yet */
+    uint8_t order[APDS_REG_COUNT];
+    uint8_t dirtyCount;
+    bool batching, batchLocked;
+    SemaphoreHandle_t sem;
+    TaskHandle_t owner;
+    apds_reg_stats_t stats;
+}apds_regs_t;
+
+/* Called once after the device's bus is set up, before the sensor is used */
+void apds_reg_init(apds_regs_t *r, const i2c_dev_t *dev);
+
+/* Reload the shadow from the sensor, after power up or a sensor reset */
+bool apds_reg_resync(apds_regs_t *r);
+
+/* Write a table sorted by register address and read it back,
+ * false on a bus error or when the sensor does not hold the table */
+bool apds_reg_apply(apds_regs_t *r, const apds_reg_val_t *table, uint32_t count);
+
+bool apds_reg_read(apds_regs_t *r, uint8_t reg, uint8_t *val);
+bool apds_reg_write(apds_regs_t *r, uint8_t reg, uint8_t val);
+
+/* Replace the bits in mask with those of bits */
+bool apds_reg_update(apds_regs_t *r, uint8_t reg, uint8_t mask, uint8_t bits);
+
+void apds_reg_begin(apds_regs_t *r);
+bool apds_reg_commit(apds_regs_t *r);
+
+void apds_reg_get_stats(apds_regs_t *r, apds_reg_stats_t *stats);
+
+#endif /* INCLUDE_APDS_REGS_H_ */
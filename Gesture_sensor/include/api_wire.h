@@ -0,0 +1,96 @@
+/*
+ * api_wire.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Client API requests from the BBG and the TIVA's answers, in link
+ *  frames both ways:
+ *
+ *  FRAME_TYPE_API_REQUEST  | id lo | id hi | opcode |
+ *  FRAME_TYPE_API_REPLY    | id lo | id hi | opcode | log_wire record |
+ *
+ *  The reply echoes the request id and carries the record the TIVA logs
+ *  for the call, so the BBG logs it as before and gives its value to the
+ *  request with that id; several requests can be on the link at once.
+ *  Id 0 wants no reply, the BBG heartbeat goes that way. A command the
+ *  TIVA could not carry out is answered with a LOG_LEVEL_ERROR record.
+ *
+ *  A batch carries several commands in one frame, each with an argument,
+ *  and its reply the result of each in the same order:
+ *
+ *  FRAME_TYPE_API_BATCH        | id lo | id hi | opcode | n | n x | opcode | arg lo | arg hi |
+ *  FRAME_TYPE_API_BATCH_REPLY  | id lo | id hi | opcode | n | n x | ok | msg lo | msg hi | value, 4 lo first |
+ *
+ *  msg is the log_msg.def record the TIVA would have answered the command
+ *  alone with, the BBG logs one per result.
+ */
+
+#ifndef INCLUDE_API_WIRE_H_
+#define INCLUDE_API_WIRE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/log_wire.h"
+
+#define API_OP_HEARTBEAT        (0x4D)
+
+#define API_WIRE_REQUEST_SIZE   (3)
+#define API_WIRE_REPLY_MAX_SIZE (API_WIRE_REQUEST_SIZE + LOG_WIRE_MAX_SIZE)
+#define API_WIRE_BATCH_MAX      (8)
+#define API_WIRE_CMD_SIZE       (3)
+#define API_WIRE_RESULT_SIZE    (7)
+#define API_WIRE_BATCH_MAX_SIZE (API_WIRE_REQUEST_SIZE + 1 + API_WIRE_BATCH_MAX * API_WIRE_CMD_SIZE)
+#define API_WIRE_BATCH_REPLY_MAX_SIZE (API_WIRE_REQUEST_SIZE + 1 + API_WIRE_BATCH_MAX * API_WIRE_RESULT_SIZE)
+
+typedef struct api_wire_request
+{
+    uint16_t id;
+    uint8_t opcode;
+} api_wire_request_t;
+
+typedef struct api_wire_cmd
+{
+    uint8_t opcode;
+    uint16_t arg;
+} api_wire_cmd_t;
+
+typedef struct api_wire_batch
+{
+    api_wire_request_t req;
+    uint8_t count;
+    api_wire_cmd_t cmd[API_WIRE_BATCH_MAX];
+} api_wire_batch_t;
+
+typedef struct api_wire_result
+{
+    bool ok;
+    uint16_t msg;               /* log_msg_t */
+    uint32_t value;
+} api_wire_result_t;
+
+/* Returns the encoded size */
+uint8_t api_wire_encode_request(uint8_t *out, const api_wire_request_t *req);
+
+bool api_wire_decode_request(const uint8_t *in, uint8_t len, api_wire_request_t *req);
+
+/* Returns the encoded size, or 0 if the record has no compact encoding */
+uint8_t api_wire_encode_reply(uint8_t *out, const api_wire_request_t *req, const log_wire_t *rec);
+
+/* Returns false on a truncated or malformed reply */
+bool api_wire_decode_reply(const uint8_t *in, uint8_t len, api_wire_request_t *req, log_wire_t *rec);
+
+/* Returns the encoded size, or 0 for an empty or oversized batch */
+uint8_t api_wire_encode_batch(uint8_t *out, const api_wire_batch_t *batch);
+
+bool api_wire_decode_batch(const uint8_t *in, uint8_t len, api_wire_batch_t *batch);
+
+/* Returns the encoded size, or 0 for more results than a batch holds */
+uint8_t api_wire_encode_batch_reply(uint8_t *out, const api_wire_request_t *req,
+                                    const api_wire_result_t *result, uint8_t count);
+
+/* result holds API_WIRE_BATCH_MAX; false on a truncated or malformed reply */
+bool api_wire_decode_batch_reply(const uint8_t *in, uint8_t len, api_wire_request_t *req,
+                                 api_wire_result_t *result, uint8_t *count);
+
+#endif /* INCLUDE_API_WIRE_H_ */
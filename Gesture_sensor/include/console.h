@@ -0,0 +1,62 @@
+/*
+ * console.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Deferred debug console on UART0. Callers copy their text into a ring
+ *  buffer and return; the UART0 TX interrupt drains it. A message that
+ *  does not fit is dropped whole and counted.
+ *
+ *  Define CONSOLE_DISABLE in the project's predefined symbols to remove
+ *  the console, its buffer and every formatted string from the image.
+ */
+
+#ifndef INCLUDE_CONSOLE_H_
+#define INCLUDE_CONSOLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CONSOLE_BUFFER_SIZE     (1024)  /* power of two */
+#define CONSOLE_LINE_MAX        (96)    /* longest ConsolePrintf output */
+
+typedef struct console_stats
+{
+    uint32_t bytes;
+    uint32_t dropped;       /* messages that did not fit */
+    uint32_t highWater;     /* most bytes ever buffered */
+} console_stats_t;
+
+#ifndef CONSOLE_DISABLE
+
+/* Called from ConfigureUART_terminal once UART0 is set up */
+void ConsoleInit(void);
+bool ConsoleWrite(const char *ptr, uint32_t len);
+bool ConsolePrintf(const char *fmt, ...);
+void ConsoleGetStats(console_stats_t *stats);
+void ConsoleIntHandler(void);
+
+#else
+
+#define ConsoleInit()
+#define ConsoleGetStats(stats)
+
+/* functions rather than (true), so a call on its own is not a statement
+ * with no effect */
+static inline bool ConsoleWrite(const char *ptr, uint32_t len)
+{
+    (void)ptr;
+    (void)len;
+    return true;
+}
+
+static inline bool ConsolePrintf(const char *fmt, ...)
+{
+    (void)fmt;
+    return true;
+}
+
+#endif
+
+#endif /* INCLUDE_CONSOLE_H_ */
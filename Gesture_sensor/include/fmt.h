@@ -0,0 +1,22 @@
+/*
+ * fmt.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Small printf formatter for the console: no heap, no floating point.
+ *  Supports %d %i %u %x %X %c %s %p %% with optional '-', '0', width and
+ *  the 'l' length modifier.
+ */
+
+#ifndef INCLUDE_FMT_H_
+#define INCLUDE_FMT_H_
+
+#include <stdarg.h>
+#include <stddef.h>
+
+/* Same contract as vsnprintf: returns the length the full output would have */
+int fmt_vsnprintf(char *out, size_t size, const char *fmt, va_list args);
+int fmt_snprintf(char *out, size_t size, const char *fmt, ...);
+
+#endif /* INCLUDE_FMT_H_ */
@@ -0,0 +1,95 @@
+/*
+ * gesture_calib.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Gesture gain, LED drive and classifier thresholds from the room the
+ *  sensor is in. The gesture task samples the ambient light (CDATA) and
+ *  the proximity baseline (PDATA, no hand over the sensor) every
+ *  GCALIB_PERIOD_MS and passes them in here. Both are averaged, and the
+ *  average deviation of PDATA is kept as its noise.
+ *
+ *  The proximity engine runs at a fixed PGAIN_4X and 100 mA, so PDATA
+ *  measures crosstalk and noise independently of the gesture settings:
+ *  in gesture counts it is (pdata * ggain) >> (2 + gldrive). Ambient light
+ *  the sensor does not reject adds about CDATA / GCALIB_AMBIENT_PER_COUNT
+ *  at GGAIN_2X. Their sum, with twice the noise, is the floor the gesture
+ *  channels sit on with no hand. From it a target is worked out:
+ *
+ *      gain        the highest, up to GCALIB_GAIN_MAX, that keeps the floor
+ *                  under GCALIB_NOISE_MAX; capped lower in bright light,
+ *                  where a hand saturates the channels
+ *      LED drive   stepped down only when crosstalk alone is too much at
+ *                  GGAIN_1X
+ *      threshold   the floor plus GCALIB_MARGIN, rounded up to
+ *                  GCALIB_THRESHOLD_STEP, so the room alone never counts
+ *                  as a hand; from GESTURE_THRESHOLD_OUT up to
+ *                  GCALIB_THRESHOLD_MAX
+ *      sensitivity less swing needed in bright light, where the ambient
+ *                  floor flattens the ratios; a tighter near/far window
+ *                  when the floor is noisy
+ *
+ *  The target has to differ from the current setting GCALIB_CONFIRM
+ *  samples in a row before anything changes, and gain and LED drive then
+ *  move one step towards the latest one.
+ *  No FreeRTOS or driverlib calls, so it can be simulated on the host.
+ */
+
+#ifndef INCLUDE_GESTURE_CALIB_H_
+#define INCLUDE_GESTURE_CALIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/gesture_sensor.h"
+
+#define GCALIB_PERIOD_MS        (10000)
+#define GCALIB_CONFIRM          (3)
+#define GCALIB_GAIN_MAX         GGAIN_4X
+#define GCALIB_LED_MIN          LED_DRIVE_25MA      /* lowest current */
+#define GCALIB_NOISE_MAX        (24)    /* gesture counts */
+#define GCALIB_NOISE_HIGH       (8)     /* near/far window tightens above */
+#define GCALIB_MARGIN           (8)
+#define GCALIB_THRESHOLD_STEP   (4)
+#define GCALIB_THRESHOLD_MAX    (120)   /* under 0x80, gesture_features */
+#define GCALIB_AMBIENT_PER_COUNT (100)  /* CDATA per gesture count at GGAIN_2X */
+#define GCALIB_BRIGHT           (4000)  /* CDATA, DEFAULT_ATIME and AGAIN */
+#define GCALIB_VERY_BRIGHT      (16000)
+#define GCALIB_AVERAGE_SHIFT    (2)     /* each sample moves the averages by 1/4 */
+#define GCALIB_SENS1_BRIGHT     (35)
+#define GCALIB_SENS2_NOISY      (12)
+
+/* what changed, from gesture_calib_sample */
+#define GCALIB_GAIN             (0x01)
+#define GCALIB_LED_DRIVE        (0x02)
+#define GCALIB_THRESHOLD        (0x04)
+#define GCALIB_SENSITIVITY      (0x08)
+
+typedef struct gesture_calib_setting
+{
+    uint8_t gain;               /* GGAIN_ */
+    uint8_t ledDrive;           /* LED_DRIVE_ */
+    gesture_tuning_t tuning;
+}gesture_calib_setting_t;
+
+typedef struct gesture_calib
+{
+    gesture_calib_setting_t cur;
+    gesture_calib_setting_t target;
+    uint8_t agree;              /* samples in a row off the current setting */
+    uint32_t samples;
+    uint32_t ambient;           /* averages, x16 */
+    uint32_t proximity;
+    uint32_t deviation;         /* of proximity */
+}gesture_calib_t;
+
+void gesture_calib_init(gesture_calib_t *c, const gesture_calib_setting_t *start);
+
+/* The setting for the averages in c */
+void gesture_calib_target(const gesture_calib_t *c, gesture_calib_setting_t *target);
+
+/* Take one sample. Returns the GCALIB_ bits of what changed in c->cur,
+ * 0 while the target is unconfirmed or already reached. */
+uint32_t gesture_calib_sample(gesture_calib_t *c, uint16_t ambient, uint8_t proximity);
+
+#endif /* INCLUDE_GESTURE_CALIB_H_ */
@@ -0,0 +1,40 @@
+/*
+ * gesture_features.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  The feature extraction step of processGestureData: the first and last
+ *  dataset in a window with every channel over the sensor's thresholdOut,
+ *  their U/D and L/R ratios (x100, truncated like C division) and the
+ *  last minus first deltas.
+ *
+ *  The four channels of a packed dataset are compared at once, with the
+ *  Cortex-M4 USUB8/SEL instructions on the target and a portable bit
+ *  trick elsewhere; both give the same lanes. The ratios multiply by a 32
+ *  bit reciprocal of U+D or L+R from a table instead of dividing, exact
+ *  for every sum two channels over the threshold can have.
+ */
+
+#ifndef INCLUDE_GESTURE_FEATURES_H_
+#define INCLUDE_GESTURE_FEATURES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/gesture_ring.h"
+
+typedef struct gesture_features
+{
+    int32_t first, last;            /* offsets in the window */
+    int16_t ud_first, lr_first;
+    int16_t ud_last, lr_last;
+    int16_t ud_delta, lr_delta;
+} gesture_features_t;
+
+/* false when no dataset of the window is over the threshold on all channels */
+bool gesture_features(const gesture_window_t *w, uint8_t threshold, gesture_features_t *f);
+
+/* ((a - b) * 100) / (a + b) for a, b over GESTURE_THRESHOLD_OUT */
+int16_t gesture_ratio(uint8_t a, uint8_t b);
+
+#endif /* INCLUDE_GESTURE_FEATURES_H_ */
@@ -0,0 +1,99 @@
+/*
+ * gesture_grammar.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Gesture sequences on top of the single gestures readGesture decodes:
+ *
+ *      swipe       one swipe with nothing after it within gapMs
+ *      double      the same swipe twice, the second one starting within
+ *                  gapMs of the end of the first
+ *      U-turn      a swipe and the opposite one within gapMs, named after
+ *                  the first
+ *      hold        a NEAR gesture lasting holdMs or longer
+ *
+ *  NEAR and FAR pass through as they are. A rule table maps each sequence
+ *  to an action, the relay notification bits in main.c. A swipe only waits
+ *  for a second one when the table has a double or U-turn rule starting
+ *  with it, the rest come out as soon as they are pushed. Only a pair the
+ *  table has a rule for is one token, DOWN then UP with just a double rule
+ *  for DOWN is two swipes. A waiting swipe comes out at most gapMs after
+ *  it ended, from push or poll.
+ *
+ *  gesture_grammar_rules is the firmware's table. Every swipe in it acts
+ *  as soon as it is decoded, early from the FIFO where it can; the double
+ *  and U-turn rules are only in it when GESTURE_PAIRS is defined, at the
+ *  cost of GGRAMMAR_GAP_MS on the swipes they start with.
+ *
+ *  Times are milliseconds from any free running clock, wrap safe. No
+ *  FreeRTOS or driverlib calls, so traces can be replayed on the host.
+ */
+
+#ifndef INCLUDE_GESTURE_GRAMMAR_H_
+#define INCLUDE_GESTURE_GRAMMAR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GGRAMMAR_GAP_MS         (600)   /* second swipe of a pair has to start by then */
+#define GGRAMMAR_HOLD_MS        (1500)
+#define GGRAMMAR_NO_DEADLINE    (0xFFFFFFFFU)
+
+enum
+{
+    GGRAMMAR_NONE,
+    GGRAMMAR_SWIPE,         /* dir is any DIR_ the decoder returns */
+    GGRAMMAR_DOUBLE,
+    GGRAMMAR_UTURN,
+    GGRAMMAR_HOLD
+};
+
+typedef struct gesture_rule
+{
+    uint8_t kind;           /* GGRAMMAR_ */
+    uint8_t dir;            /* DIR_, the first swipe of a pair */
+    uint32_t action;
+}gesture_rule_t;
+
+typedef struct gesture_token
+{
+    uint8_t kind;
+    uint8_t dir;
+    uint32_t action;        /* 0 when no rule matches */
+}gesture_token_t;
+
+extern const gesture_rule_t gesture_grammar_rules[];
+extern const uint8_t gesture_grammar_rule_count;
+
+typedef struct gesture_grammar
+{
+    const gesture_rule_t *rules;
+    uint8_t ruleCount;
+    uint8_t pending;        /* swipe waiting for a second one, DIR_NONE if not */
+    uint32_t gapMs, holdMs;
+    uint32_t deadline;      /* when the pending swipe comes out alone */
+}gesture_grammar_t;
+
+void gesture_grammar_init(gesture_grammar_t *g, const gesture_rule_t *rules, uint8_t ruleCount,
+                          uint32_t gapMs, uint32_t holdMs);
+
+/* The token for one sequence, its action from the rule table */
+void gesture_grammar_token(const gesture_grammar_t *g, uint8_t kind, uint8_t dir, gesture_token_t *out);
+
+/* true when a swipe in dir never waits, so it can be acted on early */
+bool gesture_grammar_immediate(const gesture_grammar_t *g, uint8_t dir);
+
+/* One decoded gesture from startMs to endMs. Returns the number of
+ * tokens written to out, up to two: a pending swipe this one does not
+ * pair with, then this one unless it is now pending. */
+int gesture_grammar_push(gesture_grammar_t *g, uint8_t dir, uint32_t startMs, uint32_t endMs,
+                         gesture_token_t out[2]);
+
+/* Emits the pending swipe once its deadline has passed, returns 0 or 1 */
+int gesture_grammar_poll(gesture_grammar_t *g, uint32_t nowMs, gesture_token_t *out);
+
+/* ms from nowMs until poll has something, GGRAMMAR_NO_DEADLINE if nothing waits */
+uint32_t gesture_grammar_wait(const gesture_grammar_t *g, uint32_t nowMs);
+
+#endif /* INCLUDE_GESTURE_GRAMMAR_H_ */
@@ -0,0 +1,85 @@
+/*
+ * gesture_ring.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Ring of gesture datasets, one word each. The FIFO is burst read straight
+ *  into the free space at the head, so a word holds U, D, L and R in
+ *  ascending byte addresses: u | d << 8 | l << 16 | r << 24 on the little
+ *  endian M4. Indexes are free running sample counts; only the storage
+ *  wraps, so a gesture longer than one FIFO read stays one sequence until
+ *  it is GESTURE_RING_DEPTH datasets long.
+ *
+ *  The classifier reads through a window, a run of datasets in the ring.
+ */
+
+#ifndef INCLUDE_GESTURE_RING_H_
+#define INCLUDE_GESTURE_RING_H_
+
+#include <stdint.h>
+
+#ifndef GESTURE_RING_DEPTH
+#define GESTURE_RING_DEPTH      (128)       /* datasets, power of two */
+#endif
+
+#if (GESTURE_RING_DEPTH & (GESTURE_RING_DEPTH - 1)) || GESTURE_RING_DEPTH < 32
+#error "GESTURE_RING_DEPTH must be a power of two, at least the FIFO depth"
+#endif
+
+#define GESTURE_RING_MASK       (GESTURE_RING_DEPTH - 1)
+
+#define GESTURE_U(s)            ((uint8_t)(s))
+#define GESTURE_D(s)            ((uint8_t)((s) >> 8))
+#define GESTURE_L(s)            ((uint8_t)((s) >> 16))
+#define GESTURE_R(s)            ((uint8_t)((s) >> 24))
+
+typedef struct gesture_ring
+{
+    uint32_t sample[GESTURE_RING_DEPTH];
+    uint32_t head;                  /* datasets written */
+} gesture_ring_t;
+
+typedef struct gesture_window
+{
+    const uint32_t *sample;         /* the ring's storage */
+    uint32_t first;                 /* ring index of the first dataset */
+    uint32_t count;
+} gesture_window_t;
+
+/* Contiguous free space at the head for up to want datasets, *n gets how many fit */
+static inline uint8_t *gesture_ring_space(gesture_ring_t *ring, uint32_t want, uint32_t *n)
+{
+    uint32_t pos = ring->head & GESTURE_RING_MASK;
+
+    *n = GESTURE_RING_DEPTH - pos < want ? GESTURE_RING_DEPTH - pos : want;
+    return (uint8_t *)&ring->sample[pos];
+}
+
+/* n datasets were written at the head */
+static inline void gesture_ring_commit(gesture_ring_t *ring, uint32_t n)
+{
+    ring->head += n;
+}
+
+/* datasets first to the head, the newest GESTURE_RING_DEPTH at most */
+static inline gesture_window_t gesture_ring_window(const gesture_ring_t *ring, uint32_t first)
+{
+    gesture_window_t w;
+
+    if( ring->head - first > GESTURE_RING_DEPTH )
+    {
+        first = ring->head - GESTURE_RING_DEPTH;
+    }
+    w.sample = ring->sample;
+    w.first = first;
+    w.count = ring->head - first;
+    return w;
+}
+
+static inline uint32_t gesture_window_at(const gesture_window_t *w, uint32_t i)
+{
+    return w->sample[(w->first + i) & GESTURE_RING_MASK];
+}
+
+#endif /* INCLUDE_GESTURE_RING_H_ */
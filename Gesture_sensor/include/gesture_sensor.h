@@ -10,6 +10,12 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "include/gesture_ring.h"
+#include "include/gesture_stream.h"
+#include "include/i2c_comm.h"
+#include "include/apds_regs.h"
 
 
 #define GESTURE_EN (0x1<<6)
@@ -33,7 +39,7 @@
 #define APDS9960_ID_2           0x9C
 
 /* Misc parameters */
-#define FIFO_PAUSE_TIME         30      // Wait period (ms) between FIFO reads
+#define FIFO_PAUSE_TIME         30      // Longest wait (ms) for the next FIFO fill
 
 /* APDS-9960 register addresses */
 #define APDS9960_ENABLE         0x80
@@ -181,25 +187,20 @@
 
 typedef struct gesture_data_type
 {
-    uint8_t u_data[32];
-    uint8_t d_data[32];
-    uint8_t l_data[32];
-    uint8_t r_data[32];
-    uint8_t index;
-    uint8_t total_gestures;
+    gesture_ring_t ring;        /* every dataset read from the FIFO */
+    uint32_t next;              /* first dataset processGestureData has to look at */
     uint8_t in_threshold;
     uint8_t out_threshold;
 } gesture_data_type;
 
-gesture_data_type gesture_data_;
-int gesture_ud_delta_;
-int gesture_lr_delta_;
-int gesture_ud_count_;
-int gesture_lr_count_;
-int gesture_near_count_;
-int gesture_far_count_;
-int gesture_state_;
-int gesture_motion_;
+/* The gesture parameters the classifier runs with, GESTURE_THRESHOLD_OUT
+ * and GESTURE_SENSITIVITY_1/2 until gesture_calib moves them */
+typedef struct gesture_tuning
+{
+    uint8_t thresholdOut;       /* not below GESTURE_THRESHOLD_OUT */
+    uint8_t sensitivity1;
+    uint8_t sensitivity2;
+} gesture_tuning_t;
 
 enum
 {
@@ -234,6 +235,11 @@ bool setGestureEnterThresh(uint8_t threshold);
 bool setGestureExitThresh(uint8_t threshold);
 bool setGestureLEDDrive(uint8_t drive);
 bool setGestureWaitTime(uint8_t time);
+uint8_t getGestureWaitTime();
+uint8_t getGestureGain();
+uint8_t getGestureLEDDrive();
+uint8_t getGestureMode();
+uint8_t getGestureIntEnable();
 bool sensor_init();
 void resetGestureParameters();
 bool setLEDBoost(uint8_t boost);
@@ -249,6 +255,73 @@ bool decodeGesture();
 int readGesture();
 void handleGesture();
 bool disableGestureSensor();
+void gestureSignalFromISR(BaseType_t *woken);
+
+/* Called from readGesture with a direction the incremental classifier
+ * has decided (GSTREAM_DECIDED) or changed (GSTREAM_CORRECTED) while the
+ * gesture is still in progress. readGesture still returns the final
+ * result once the hand has gone. */
+typedef void (*gesture_cb_t)(int dir, int event);
+void setGestureCallback(gesture_cb_t cb);
+
+/* Datasets read before the current gesture was decided, 0 if not yet */
+uint32_t gestureDecidedAt(void);
+
+/* Called from readGesture with every FIFO burst and the tick it was read at */
+typedef void (*gesture_trace_fn_t)(const uint8_t *data, int bytes, TickType_t tick);
+void setGestureTrace(gesture_trace_fn_t fn);
+
+/* The processing half of readGesture, without the I2C side, so recorded
+ * FIFO data can be run through it: gestureBegin, gestureAddData per
+ * burst, then gestureFinish for the result */
+void gestureBegin();
+void gestureAddData(const uint8_t *fifo_data, int bytes_read);
+int gestureFinish();
+bool gestureWaitFifo(uint32_t ms);
+
+/*
+ * One APDS-9960 with everything the driver and classifier keep for it.
+ * The functions above work on the sensor bound to the calling task, and
+ * on gesture_sensor0 in a task that has not bound one or before the
+ * scheduler starts. A task per sensor binds its own, so sensors on
+ * different controllers are read at the same time.
+ */
+typedef struct gesture_sensor
+{
+    i2c_dev_t dev;
+    apds_regs_t regs;
+    gesture_data_type data;
+    gesture_tuning_t tuning;
+    int ud_delta;
+    int lr_delta;
+    int ud_count;
+    int lr_count;
+    int near_count;
+    int far_count;
+    int state;
+    int motion;
+    volatile TickType_t endTick;    /* last FIFO data of the latest gesture */
+    SemaphoreHandle_t fifoSem;      /* given by the INT line, FIFO above GFIFOTH */
+    gesture_stream_t stream;        /* early decisions of the gesture being read */
+    gesture_cb_t cb;
+    gesture_trace_fn_t trace;
+} gesture_sensor_t;
+
+#ifndef GESTURE_SENSOR_TLS_INDEX
+#define GESTURE_SENSOR_TLS_INDEX    (0)     /* thread local storage slot */
+#endif
+
+/* The first sensor, SLAVE_ADDRESS on I2C0 */
+extern gesture_sensor_t gesture_sensor0;
+
+/* Another sensor: its device, default tuning, an unused register shadow */
+void gesture_sensor_init(gesture_sensor_t *s, i2c_bus_t *bus, int8_t channel);
+
+/* Make s the calling task's sensor */
+void gesture_sensor_bind(gesture_sensor_t *s);
+gesture_sensor_t *gesture_sensor_current(void);
 
+/* The INT line of a sensor; gestureSignalFromISR is gesture_sensor0's */
+void gesture_sensor_signal_from_isr(gesture_sensor_t *s, BaseType_t *woken);
 
 #endif /* GESTURE_SENSOR_H_ */
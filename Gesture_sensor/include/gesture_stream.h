@@ -0,0 +1,57 @@
+/*
+ * gesture_stream.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Incremental swipe classifier. Each U/D/L/R dataset is folded in as it
+ *  is read from the FIFO: the U/D and L/R ratios of the first dataset over
+ *  the out threshold are kept and the latest ratios are compared with
+ *  them, the same first to last delta processGestureData works out per
+ *  batch. A direction is decided once one axis has moved by sensitivity1,
+ *  leads the other axis by sensitivity2 and has done so for GSTREAM_HOLD
+ *  datasets in a row, all three from the sensor's tuning. A different
+ *  direction that later meets the same test is a correction.
+ *
+ *  No FreeRTOS or driverlib calls, so traces can be replayed on the host.
+ */
+
+#ifndef INCLUDE_GESTURE_STREAM_H_
+#define INCLUDE_GESTURE_STREAM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef GSTREAM_HOLD
+#define GSTREAM_HOLD            (2)     /* datasets a candidate has to last */
+#endif
+
+enum
+{
+    GSTREAM_NONE,
+    GSTREAM_DECIDED,        /* first direction for this gesture */
+    GSTREAM_CORRECTED       /* a later, different direction */
+};
+
+struct gesture_tuning;
+
+typedef struct gesture_stream
+{
+    const struct gesture_tuning *tuning;
+    int16_t udFirst, lrFirst;       /* ratios x100 of the first dataset over threshold */
+    int16_t udDelta, lrDelta;       /* latest ratios minus the first */
+    uint16_t samples;               /* datasets pushed */
+    uint16_t valid;                 /* of those, over threshold */
+    uint16_t decidedAt;             /* samples when dir was first set */
+    uint8_t candidate, held;
+    uint8_t dir;                    /* DIR_NONE until decided */
+    uint8_t corrections;
+}gesture_stream_t;
+
+void gesture_stream_reset(gesture_stream_t *s, const struct gesture_tuning *tuning);
+
+/* Fold in one dataset, returns GSTREAM_DECIDED or GSTREAM_CORRECTED when
+ * s->dir changes, otherwise GSTREAM_NONE */
+int gesture_stream_push(gesture_stream_t *s, const uint8_t dataset[4]);
+
+#endif /* INCLUDE_GESTURE_STREAM_H_ */
@@ -0,0 +1,46 @@
+/*
+ * gesture_trace.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Raw gesture FIFO capture for FRAME_TYPE_GESTURE_TRACE frames. One frame
+ *  per FIFO burst, split when a burst has more datasets than fit:
+ *
+ *  | flags | gesture id | result | tick (4, little endian) | u d l r ... |
+ *
+ *  tick is the FreeRTOS tick (ms) the burst was read at. The first frame
+ *  of a gesture carries GESTURE_TRACE_START, and a frame with no datasets
+ *  and GESTURE_TRACE_END closes it with readGesture's result.
+ */
+
+#ifndef INCLUDE_GESTURE_TRACE_H_
+#define INCLUDE_GESTURE_TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/link_frame.h"
+
+#define GESTURE_TRACE_START     (0x01)
+#define GESTURE_TRACE_END       (0x02)
+
+#define GESTURE_TRACE_HEADER    (7)
+#define GESTURE_TRACE_MAX_SETS  ((FRAME_MAX_PAYLOAD - GESTURE_TRACE_HEADER) / 4)
+
+typedef struct gesture_trace
+{
+    uint8_t flags;
+    uint8_t id;                 /* gesture number, wraps at 256 */
+    uint8_t result;             /* DIR_* on GESTURE_TRACE_END */
+    uint8_t count;              /* datasets */
+    uint32_t tick;
+    const uint8_t *data;        /* count U/D/L/R datasets */
+} gesture_trace_t;
+
+/* Writes the payload to out (FRAME_MAX_PAYLOAD bytes), returns its size or 0 */
+uint8_t gesture_trace_encode(uint8_t *out, const gesture_trace_t *rec);
+
+/* rec->data points into payload, false if the payload is malformed */
+bool gesture_trace_decode(const uint8_t *payload, uint8_t len, gesture_trace_t *rec);
+
+#endif /* INCLUDE_GESTURE_TRACE_H_ */
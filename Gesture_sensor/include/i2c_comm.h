@@ -11,10 +11,62 @@
 #include "FreeRTOS.h"
 #include "semphr.h"
 #include <stdint.h>
+#include <stdbool.h>
 
 #define I2C_BASE I2C0_BASE
 /* APDS-9960 I2C address */
 #define SLAVE_ADDRESS       0x39
+/* TCA9548A, for sensors that share a controller: they all answer 0x39 */
+#define I2C_MUX_ADDRESS     0x70
+#define I2C_NO_MUX          (-1)
+
+/* a transaction that has not finished by then is aborted */
+#ifndef I2C_TIMEOUT_MS
+#define I2C_TIMEOUT_MS      (10)
+#endif
+/* busy polls per byte before the scheduler runs */
+#define I2C_POLL_SPINS      (100000)
+
+typedef struct i2c_stats
+{
+    uint32_t transactions;
+    uint32_t nacks;         /* address or data byte not acknowledged */
+    uint32_t arbLost;
+    uint32_t timeouts;
+    uint32_t errors;        /* any other controller error */
+}i2c_stats_t;
+
+struct i2c_xfer;
+
+/*
+ * One I2C controller. Each has its own mutex and interrupt, so
+ * transactions on different controllers run at the same time; its
+ * handler calls i2c_bus_isr. Behind a mux the controller remembers the
+ * channel it last selected.
+ */
+typedef struct i2c_bus
+{
+    uint32_t base;              /* I2Cn_BASE */
+    uint32_t periph;            /* SYSCTL_PERIPH_I2Cn */
+    uint32_t interrupt;         /* INT_I2Cn */
+    struct i2c_xfer * volatile current;
+    SemaphoreHandle_t sem;
+    int8_t muxChannel;          /* I2C_NO_MUX when not known */
+    i2c_stats_t stats;
+}i2c_bus_t;
+
+#define I2C_BUS_INIT(base, periph, interrupt)   { (base), (periph), (interrupt), NULL, NULL, I2C_NO_MUX, { 0 } }
+
+/* A device on a controller, directly or on one channel of a mux */
+typedef struct i2c_dev
+{
+    i2c_bus_t *bus;
+    uint8_t addr;
+    int8_t channel;             /* mux channel or I2C_NO_MUX */
+}i2c_dev_t;
+
+/* I2C0 on PB2/PB3, the first sensor, and I2C1 on PG0/PG1 */
+extern i2c_bus_t i2c_bus0, i2c_bus1;
 
 extern uint32_t g_ui32SysClock;
 //extern SemaphoreHandle_t i2cSem;
@@ -26,5 +78,22 @@ bool i2c_BBGReceive(char *ptr, uint8_t val);
 void i2c_BBGSetup();
 void i2c_setup();
 int ReadDataBlock(uint8_t reg, uint8_t *val, unsigned int len);
+int WriteDataBlock(uint8_t reg, const uint8_t *val, unsigned int len);
+void i2c_get_stats(i2c_stats_t *stats);
+void I2CIntHandler(void);
+void I2C1IntHandler(void);
+
+/* Enable a controller whose pins are configured, 400 kbps */
+void i2c_bus_init(i2c_bus_t *bus);
+void i2c_setup1();
+void i2c_bus_isr(i2c_bus_t *bus);
+void i2c_bus_get_stats(i2c_bus_t *bus, i2c_stats_t *stats);
+
+/* The same as i2c_read, i2c_write, ReadDataBlock and WriteDataBlock,
+ * which talk to SLAVE_ADDRESS on I2C0 */
+bool i2c_dev_read(const i2c_dev_t *dev, uint8_t reg, uint8_t *val);
+bool i2c_dev_write(const i2c_dev_t *dev, uint8_t reg, uint8_t val);
+int i2c_dev_read_block(const i2c_dev_t *dev, uint8_t reg, uint8_t *val, unsigned int len);
+int i2c_dev_write_block(const i2c_dev_t *dev, uint8_t reg, const uint8_t *val, unsigned int len);
 
 #endif /* I2C_COMM_H_ */
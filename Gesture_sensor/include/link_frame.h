@@ -0,0 +1,84 @@
+/*
+ * link_frame.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Link layer shared by the TIVA (BBGSend, vbbgReceive) and the BBG UART
+ *  reader and writer.
+ *
+ *  | 0xA5 | 0x5A | type | seq | len | payload[len] | crc16 lo | crc16 hi |
+ *
+ *  The CRC-16 (driverlib sw_crc) covers type, seq, len and the payload.
+ *  seq increments per frame, sent or dropped by the sender for want of
+ *  room, so the receiver can count lost frames.
+ */
+
+#ifndef INCLUDE_LINK_FRAME_H_
+#define INCLUDE_LINK_FRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FRAME_SYNC0             (0xA5)
+#define FRAME_SYNC1             (0x5A)
+#define FRAME_HEADER_SIZE       (5)
+#define FRAME_CRC_SIZE          (2)
+#define FRAME_OVERHEAD          (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)
+#define FRAME_MAX_PAYLOAD       (128)
+#define FRAME_MAX_SIZE          (FRAME_MAX_PAYLOAD + FRAME_OVERHEAD)
+
+/* Frame types */
+#define FRAME_TYPE_LOG          (0x01)  /* raw Logger_t */
+#define FRAME_TYPE_LOG_COMPACT  (0x02)  /* log_wire encoded record */
+#define FRAME_TYPE_GESTURE_TRACE (0x03) /* gesture_trace encoded FIFO capture */
+#define FRAME_TYPE_API_REQUEST  (0x04)  /* BBG to TIVA, api_wire request */
+#define FRAME_TYPE_API_REPLY    (0x05)  /* api_wire reply, echoes the request id */
+#define FRAME_TYPE_API_BATCH    (0x06)  /* BBG to TIVA, api_wire batch of commands */
+#define FRAME_TYPE_API_BATCH_REPLY (0x07) /* api_wire results, one per command */
+
+typedef struct frame
+{
+    uint8_t type;
+    uint8_t seq;
+    uint8_t len;
+    const uint8_t *payload;
+} frame_t;
+
+typedef struct frame_stats
+{
+    uint32_t frames;            /* frames delivered */
+    uint32_t crc_errors;        /* candidate frames rejected by the CRC */
+    uint32_t len_errors;        /* candidate frames with an impossible length */
+    uint32_t bytes_skipped;     /* bytes discarded while hunting for sync */
+    uint32_t lost;              /* frames missing according to seq */
+} frame_stats_t;
+
+typedef void (*frame_handler_t)(const frame_t *frame, void *arg);
+
+typedef struct frame_parser
+{
+    uint8_t buf[FRAME_MAX_SIZE];
+    uint16_t count;             /* bytes held in buf */
+    uint8_t next_seq;
+    bool synced;                /* next_seq is valid */
+    frame_stats_t stats;
+} frame_parser_t;
+
+/* Writes a complete frame to out (FRAME_MAX_SIZE bytes), returns its size or 0 */
+uint16_t frame_encode(uint8_t *out, uint8_t type, uint8_t seq,
+                      const void *payload, uint8_t len);
+
+void frame_parser_init(frame_parser_t *parser);
+
+/*
+ * Feeds received bytes to the parser. handler is called once per valid
+ * frame; the payload pointer is only valid during the call. After a bad
+ * CRC or length the parser rescans from the byte after the bad sync word,
+ * so the next intact frame is never lost. Returns frames delivered.
+ */
+uint32_t frame_parser_feed(frame_parser_t *parser, const uint8_t *data, size_t len,
+                           frame_handler_t handler, void *arg);
+
+#endif /* INCLUDE_LINK_FRAME_H_ */
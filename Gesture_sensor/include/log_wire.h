@@ -0,0 +1,50 @@
+/*
+ * log_wire.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Compact encoding of a log record for FRAME_TYPE_LOG_COMPACT frames:
+ *
+ *  | level:4 source:4 | varint msg | varint value | varint timestamp |
+ *
+ *  The text is replaced by its index in log_msg.def, which both sides
+ *  compile in, so a typical record is 4 to 8 bytes instead of a Logger_t.
+ */
+
+#ifndef INCLUDE_LOG_WIRE_H_
+#define INCLUDE_LOG_WIRE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum
+{
+#define LOG_MSG(id, text)   id,
+#include "include/log_msg.def"
+#undef LOG_MSG
+    LOG_MSG_COUNT
+} log_msg_t;
+
+/* 1 byte level/source, 3 byte msg, 5 byte value, 5 byte timestamp */
+#define LOG_WIRE_MAX_SIZE   (14)
+
+typedef struct log_wire
+{
+    uint32_t value;
+    uint32_t timestamp;
+    uint32_t log_level;
+    uint32_t log_source;
+    uint16_t msg;
+} log_wire_t;
+
+/* Returns the encoded size, or 0 if level or source has no compact code */
+uint8_t log_wire_encode(uint8_t *out, const log_wire_t *rec);
+
+/* Returns false on a truncated or malformed record */
+bool log_wire_decode(const uint8_t *in, uint8_t len, log_wire_t *rec);
+
+/* Text of a message index, NULL if the index is not in this build's table */
+const char *log_wire_text(uint16_t msg);
+
+#endif /* INCLUDE_LOG_WIRE_H_ */
@@ -0,0 +1,113 @@
+/*
+ * relay_queue.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: KiranHegde
+ *
+ *  Relay commands from the gesture tasks and the BBG client, kept in
+ *  order for the relay task. A notification with eSetBits ORs two quick
+ *  commands into one value that matches no action; here each command
+ *  is its own entry.
+ *
+ *  A command arriving within RELAY_DEBOUNCE_MS of the last one queued is
+ *  merged with it where the pair is redundant:
+ *
+ *      same on/off action      the second is dropped
+ *      opposite on/off action  on the same relays, the second replaces
+ *                              the first
+ *      same toggle             the two cancel and both are removed
+ *
+ *  A toggle is only carried out RELAY_DEBOUNCE_MS after it arrived, so a
+ *  repeated one has the chance to cancel it. On and off go at once.
+ *  A relay that has switched does not switch again for RELAY_DWELL_MS,
+ *  to spare the contacts; the command waits at the head of the queue,
+ *  and the ones behind it wait too. A command that leaves the relays as
+ *  they are is applied without switching anything.
+ *
+ *  A command from a gesture keeps the time the gesture ended, and a run
+ *  reports the latest one it applied, for the gesture to relay latency.
+ *
+ *  Times are free running milliseconds. No FreeRTOS or driverlib calls,
+ *  the caller keeps push and run apart, so it can be simulated on the
+ *  host.
+ */
+
+#ifndef INCLUDE_RELAY_QUEUE_H_
+#define INCLUDE_RELAY_QUEUE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Relay actions, one per command */
+#define RELAY0_ON       (0x01)
+#define RELAY1_ON       (0x02)
+#define RELAY0_OFF      (0x04)
+#define RELAY1_OFF      (0x08)
+#define RELAYS_ON       (0x10)
+#define RELAYS_OFF      (0x20)
+#define RELAY0_TOGGLE   (0x40)
+#define RELAY1_TOGGLE   (0x80)
+
+#define RELAY_COUNT         (2)
+#define RELAY_QUEUE_DEPTH   (8)
+#define RELAY_DEBOUNCE_MS   (300)
+#define RELAY_DWELL_MS      (1000)
+#define RELAY_IDLE          (0xFFFFFFFF)    /* nothing to wait for */
+
+typedef struct relay_cmd
+{
+    uint8_t action;
+    bool gesture;               /* from a gesture, not the BBG client */
+    uint32_t at;                /* ms it was queued */
+    uint32_t gestureEnd;        /* ms the gesture ended, gesture only */
+} relay_cmd_t;
+
+typedef struct relay_queue_stats
+{
+    uint32_t queued;
+    uint32_t applied;
+    uint32_t coalesced;         /* commands merged away */
+    uint32_t dropped;           /* queue full or not an action */
+    uint32_t deferred;          /* runs held back by the debounce or dwell */
+    uint32_t switches;          /* relay contacts moved */
+    uint8_t depth;
+    uint8_t highWater;
+} relay_queue_stats_t;
+
+typedef struct relay_queue
+{
+    relay_cmd_t cmd[RELAY_QUEUE_DEPTH];
+    uint8_t head;
+    uint8_t count;
+    uint8_t state;              /* bit n set when relay n is on */
+    uint8_t switched;           /* relays that have a changedAt */
+    uint32_t changedAt[RELAY_COUNT];
+    relay_queue_stats_t stats;
+} relay_queue_t;
+
+/* What one run did */
+typedef struct relay_cycle
+{
+    uint8_t state;              /* relays to drive, bit n for relay n */
+    uint8_t changed;            /* relays that switched */
+    uint8_t applied;            /* commands taken off the queue */
+    uint8_t gestures;           /* of those, commands from a gesture */
+    uint32_t gestureEnd;        /* ms the latest of their gestures ended */
+    uint32_t wait;              /* ms until the head can go, or RELAY_IDLE */
+} relay_cycle_t;
+
+/* empty queue, the relays as they are driven now */
+void relay_queue_init(relay_queue_t *q, uint8_t state);
+
+/* false when the command was dropped */
+bool relay_queue_push(relay_queue_t *q, uint8_t action, uint32_t now);
+
+/* the same for a command from a gesture that ended at gestureEnd ms */
+bool relay_queue_push_gesture(relay_queue_t *q, uint8_t action, uint32_t gestureEnd, uint32_t now);
+
+/* applies the commands that are due, in order; returns cycle->changed */
+uint8_t relay_queue_run(relay_queue_t *q, uint32_t now, relay_cycle_t *cycle);
+
+void relay_queue_get_stats(const relay_queue_t *q, relay_queue_stats_t *stats);
+
+#endif /* INCLUDE_RELAY_QUEUE_H_ */
@@ -10,16 +10,45 @@
 
 #include "FreeRTOS.h"
 #include "semphr.h"
+#include "include/console.h"
 
 #define UART_CLOCK (16000000U)
 
+/* BBG transmit queue, drained by the UART6 TX interrupt */
+#define BBG_TX_BUFFER_SIZE  (512)
+#define BBG_RX_BUFFER_SIZE  (128)   /* a full window of API request frames */
+#define BBG_TX_DROP         (0)     /* drop the new frame when full */
+#define BBG_TX_BLOCK        (1)     /* wait for room */
+#ifndef BBG_TX_POLICY
+#define BBG_TX_POLICY       BBG_TX_DROP
+#endif
+
+typedef struct bbg_tx_stats
+{
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t dropped;
+    uint32_t highWater;     /* most bytes ever queued */
+    uint32_t rxDropped;     /* bytes from the BBG lost to a full RX queue */
+} bbg_tx_stats_t;
+
 extern uint8_t uin8bbgSend;
 extern uint32_t g_ui32SysClock;
-extern SemaphoreHandle_t TermSem, bbgSocketSem;
 bool ConfigureUART_terminal(void);
 bool ConfigureUART_BBG(void);
 bool BBGSend(char *ptr, uint8_t len);
-bool BBGReceive(char *ptr);
+bool BBGSendFrame(uint8_t type, const void *payload, uint8_t len);
+void BBGSetTxPolicy(uint8_t policy);
+void BBGGetTxStats(bbg_tx_stats_t *stats);
+size_t BBGReceive(uint8_t *ptr, size_t len, TickType_t wait);
+#ifndef CONSOLE_DISABLE
 bool UART_TerminalSend(char *ptr);
+#else
+static inline bool UART_TerminalSend(char *ptr)
+{
+    (void)ptr;
+    return true;
+}
+#endif
 
 #endif /* INCLUDE_UART_COMM_H_ */
@@ -0,0 +1,273 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file apds_regs.c
+* @brief Shadow copy of the APDS-9960 configuration registers
+*
+* The gesture and BBG receive tasks both configure the sensor, so the
+* shadow is guarded by a mutex. A batch holds it from begin to commit;
+* calls made by the batch owner in between do not take it again.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "include/i2c_comm.h"
+#include "include/gesture_sensor.h"
+#include "include/apds_regs.h"
+
+#define REG_BIT(reg)    (1ULL << ((reg) - APDS_REG_FIRST))
+
+/* registers only the host changes */
+static const uint64_t cachedRegs =
+    REG_BIT(APDS9960_ENABLE)     | REG_BIT(APDS9960_ATIME)      | REG_BIT(APDS9960_WTIME)      |
+    REG_BIT(APDS9960_AILTL)      | REG_BIT(APDS9960_AILTH)      | REG_BIT(APDS9960_AIHTL)      |
+    REG_BIT(APDS9960_AIHTH)      | REG_BIT(APDS9960_PILT)       | REG_BIT(APDS9960_PIHT)       |
+    REG_BIT(APDS9960_PERS)       | REG_BIT(APDS9960_CONFIG1)    | REG_BIT(APDS9960_PPULSE)     |
+    REG_BIT(APDS9960_CONTROL)    | REG_BIT(APDS9960_CONFIG2)    | REG_BIT(APDS9960_ID)         |
+    REG_BIT(APDS9960_POFFSET_UR) | REG_BIT(APDS9960_POFFSET_DL) | REG_BIT(APDS9960_CONFIG3)    |
+    REG_BIT(APDS9960_GPENTH)     | REG_BIT(APDS9960_GEXTH)      | REG_BIT(APDS9960_GCONF1)     |
+    REG_BIT(APDS9960_GCONF2)     | REG_BIT(APDS9960_GOFFSET_U)  | REG_BIT(APDS9960_GOFFSET_D)  |
+    REG_BIT(APDS9960_GPULSE)     | REG_BIT(APDS9960_GOFFSET_L)  | REG_BIT(APDS9960_GOFFSET_R)  |
+    REG_BIT(APDS9960_GCONF3)     | REG_BIT(APDS9960_GCONF4);
+
+/* cached registers with bits the sensor changes itself */
+static const uint64_t liveRegs = REG_BIT(APDS9960_GCONF4);
+
+static bool regLock(apds_regs_t *r)
+{
+    if(!r->sem || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+        return false;
+    if(r->owner == xTaskGetCurrentTaskHandle())
+        return false;
+    xSemaphoreTake(r->sem, portMAX_DELAY);
+    r->owner = xTaskGetCurrentTaskHandle();
+    return true;
+}
+
+static void regUnlock(apds_regs_t *r, bool locked)
+{
+    if(!locked) return;
+    r->owner = NULL;
+    xSemaphoreGive(r->sem);
+}
+
+static bool isCached(uint8_t reg)
+{
+    return reg >= APDS_REG_FIRST && reg <= APDS_REG_LAST && (cachedRegs & REG_BIT(reg));
+}
+
+/* shadow value can be used without going to the bus */
+static bool isCurrent(const apds_regs_t *r, uint8_t reg)
+{
+    uint64_t bit = REG_BIT(reg);
+
+    if(!(r->valid & bit))  return false;
+    return !(liveRegs & bit) || (r->batching && (r->fresh & bit));
+}
+
+void apds_reg_init(apds_regs_t *r, const i2c_dev_t *dev)
+{
+    r->dev = dev;
+    if(!r->sem)
+        r->sem = xSemaphoreCreateMutex();
+    r->valid = r->fresh = r->dirty = 0;
+    r->dirtyCount = 0;
+    r->batching = false;
+}
+
+bool apds_reg_resync(apds_regs_t *r)
+{
+    bool locked = regLock(r);
+    bool ok;
+
+    r->valid = 0;
+    /* two bursts cover every cached register */
+    ok = i2c_dev_read_block(r->dev, APDS_REG_FIRST, r->shadow, APDS9960_ID - APDS_REG_FIRST + 1) != -1 &&
+         i2c_dev_read_block(r->dev, APDS9960_POFFSET_UR, &r->shadow[APDS9960_POFFSET_UR - APDS_REG_FIRST],
+                       APDS_REG_LAST - APDS9960_POFFSET_UR + 1) != -1;
+    if(ok)
+    {
+        r->valid = cachedRegs;
+        r->stats.busReads += 2;
+    }
+    regUnlock(r, locked);
+    return ok;
+}
+
+bool apds_reg_apply(apds_regs_t *r, const apds_reg_val_t *table, uint32_t count)
+{
+    uint8_t run[APDS_REG_COUNT];
+    uint32_t i, n;
+    bool locked = regLock(r);
+    bool ok = true;
+
+    /* the sensor's state is unknown until the read-back */
+    r->valid = 0;
+    for(i = 0; ok && i < count; i += n)
+    {
+        if(!isCached(table[i].reg) || (i && table[i].reg <= table[i - 1].reg))
+        {
+            ok = false;
+            break;
+        }
+        for(n = 0; i + n < count && table[i + n].reg == table[i].reg + n; n++)
+            run[n] = table[i + n].val;
+        ok = i2c_dev_write_block(r->dev, table[i].reg, run, n) != -1;
+        if(ok)
+            r->stats.busWrites++;
+    }
+
+    if(ok && i2c_dev_read_block(r->dev, APDS_REG_FIRST, r->shadow, APDS_REG_COUNT) != -1)
+    {
+        r->stats.busReads++;
+        r->valid = cachedRegs;
+        for(i = 0; i < count; i++)
+        {
+            /* bits the sensor owns may already differ */
+            if(!(liveRegs & REG_BIT(table[i].reg)) &&
+               r->shadow[table[i].reg - APDS_REG_FIRST] != table[i].val)
+            {
+                r->stats.mismatches++;
+                ok = false;
+            }
+        }
+    }
+    else
+        ok = false;
+    regUnlock(r, locked);
+    return ok;
+}
+
+bool apds_reg_read(apds_regs_t *r, uint8_t reg, uint8_t *val)
+{
+    bool locked;
+    bool ok = true;
+
+    if(!isCached(reg))
+        return i2c_dev_read(r->dev, reg, val);
+
+    locked = regLock(r);
+    if(isCurrent(r, reg))
+    {
+        r->stats.hits++;
+        *val = r->shadow[reg - APDS_REG_FIRST];
+    }
+    else if(i2c_dev_read(r->dev, reg, val))
+    {
+        r->stats.busReads++;
+        r->shadow[reg - APDS_REG_FIRST] = *val;
+        r->valid |= REG_BIT(reg);
+        if(r->batching)
+            r->fresh |= REG_BIT(reg);
+    }
+    else
+        ok = false;
+    regUnlock(r, locked);
+    return ok;
+}
+
+bool apds_reg_write(apds_regs_t *r, uint8_t reg, uint8_t val)
+{
+    uint64_t bit;
+    bool locked;
+    bool ok = true;
+
+    if(!isCached(reg))
+        return i2c_dev_write(r->dev, reg, val);
+
+    bit = REG_BIT(reg);
+    locked = regLock(r);
+    if(isCurrent(r, reg) && r->shadow[reg - APDS_REG_FIRST] == val && !(r->dirty & bit))
+        r->stats.skipped++;
+    else if(r->batching)
+    {
+        if(r->dirty & bit)
+            r->stats.coalesced++;
+        else
+        {
+            r->dirty |= bit;
+            r->order[r->dirtyCount++] = reg;
+        }
+        r->shadow[reg - APDS_REG_FIRST] = val;
+        r->valid |= bit;
+        r->fresh |= bit;
+    }
+    else if(i2c_dev_write(r->dev, reg, val))
+    {
+        r->stats.busWrites++;
+        r->shadow[reg - APDS_REG_FIRST] = val;
+        r->valid |= bit;
+    }
+    else
+    {
+        /* the sensor may or may not have taken it */
+        r->valid &= ~bit;
+        ok = false;
+    }
+    regUnlock(r, locked);
+    return ok;
+}
+
+bool apds_reg_update(apds_regs_t *r, uint8_t reg, uint8_t mask, uint8_t bits)
+{
+    uint8_t val;
+    bool locked = regLock(r);
+    bool ok = apds_reg_read(r, reg, &val) &&
+              apds_reg_write(r, reg, (val & ~mask) | (bits & mask));
+
+    regUnlock(r, locked);
+    return ok;
+}
+
+void apds_reg_begin(apds_regs_t *r)
+{
+    r->batchLocked = regLock(r);
+    r->batching = true;
+    r->fresh = r->dirty = 0;
+    r->dirtyCount = 0;
+}
+
+bool apds_reg_commit(apds_regs_t *r)
+{
+    uint8_t i, reg;
+    bool ok = true;
+
+    for(i = 0; i < r->dirtyCount; i++)
+    {
+        reg = r->order[i];
+        if(i2c_dev_write(r->dev, reg, r->shadow[reg - APDS_REG_FIRST]))
+            r->stats.busWrites++;
+        else
+        {
+            r->valid &= ~REG_BIT(reg);
+            ok = false;
+        }
+    }
+    r->batching = false;
+    r->fresh = r->dirty = 0;
+    r->dirtyCount = 0;
+    regUnlock(r, r->batchLocked);
+    return ok;
+}
+
+void apds_reg_get_stats(apds_regs_t *r, apds_reg_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = r->stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,142 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file api_wire.c
+* @brief Client API request and reply payloads for the TIVA - BBG link
+*
+* This file is built into both the TIVA image and the BBG application
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "include/log_wire.h"
+#include "include/api_wire.h"
+
+uint8_t api_wire_encode_request(uint8_t *out, const api_wire_request_t *req)
+{
+    out[0] = req->id & 0xFF;
+    out[1] = req->id >> 8;
+    out[2] = req->opcode;
+    return API_WIRE_REQUEST_SIZE;
+}
+
+bool api_wire_decode_request(const uint8_t *in, uint8_t len, api_wire_request_t *req)
+{
+    if(len != API_WIRE_REQUEST_SIZE)
+        return false;
+    req->id = in[0] | (uint16_t)in[1] << 8;
+    req->opcode = in[2];
+    return true;
+}
+
+uint8_t api_wire_encode_reply(uint8_t *out, const api_wire_request_t *req, const log_wire_t *rec)
+{
+    uint8_t len;
+
+    len = log_wire_encode(&out[API_WIRE_REQUEST_SIZE], rec);
+    if(!len)
+        return 0;
+    return api_wire_encode_request(out, req) + len;
+}
+
+bool api_wire_decode_reply(const uint8_t *in, uint8_t len, api_wire_request_t *req, log_wire_t *rec)
+{
+    if(len <= API_WIRE_REQUEST_SIZE)
+        return false;
+    api_wire_decode_request(in, API_WIRE_REQUEST_SIZE, req);
+    return log_wire_decode(&in[API_WIRE_REQUEST_SIZE], len - API_WIRE_REQUEST_SIZE, rec);
+}
+
+uint8_t api_wire_encode_batch(uint8_t *out, const api_wire_batch_t *batch)
+{
+    uint8_t *p = &out[API_WIRE_REQUEST_SIZE + 1];
+    uint8_t i;
+
+    if(!batch->count || batch->count > API_WIRE_BATCH_MAX)
+        return 0;
+    api_wire_encode_request(out, &batch->req);
+    out[API_WIRE_REQUEST_SIZE] = batch->count;
+    for(i = 0; i < batch->count; i++, p += API_WIRE_CMD_SIZE)
+    {
+        p[0] = batch->cmd[i].opcode;
+        p[1] = batch->cmd[i].arg & 0xFF;
+        p[2] = batch->cmd[i].arg >> 8;
+    }
+    return p - out;
+}
+
+bool api_wire_decode_batch(const uint8_t *in, uint8_t len, api_wire_batch_t *batch)
+{
+    const uint8_t *p = &in[API_WIRE_REQUEST_SIZE + 1];
+    uint8_t i;
+
+    if(len <= API_WIRE_REQUEST_SIZE)
+        return false;
+    batch->count = in[API_WIRE_REQUEST_SIZE];
+    if(!batch->count || batch->count > API_WIRE_BATCH_MAX ||
+       len != API_WIRE_REQUEST_SIZE + 1 + batch->count * API_WIRE_CMD_SIZE)
+        return false;
+    api_wire_decode_request(in, API_WIRE_REQUEST_SIZE, &batch->req);
+    for(i = 0; i < batch->count; i++, p += API_WIRE_CMD_SIZE)
+    {
+        batch->cmd[i].opcode = p[0];
+        batch->cmd[i].arg = p[1] | (uint16_t)p[2] << 8;
+    }
+    return true;
+}
+
+uint8_t api_wire_encode_batch_reply(uint8_t *out, const api_wire_request_t *req,
+                                    const api_wire_result_t *result, uint8_t count)
+{
+    uint8_t *p = &out[API_WIRE_REQUEST_SIZE + 1];
+    uint8_t i;
+
+    if(count > API_WIRE_BATCH_MAX)
+        return 0;
+    api_wire_encode_request(out, req);
+    out[API_WIRE_REQUEST_SIZE] = count;
+    for(i = 0; i < count; i++, p += API_WIRE_RESULT_SIZE)
+    {
+        p[0] = result[i].ok;
+        p[1] = result[i].msg & 0xFF;
+        p[2] = result[i].msg >> 8;
+        p[3] = result[i].value & 0xFF;
+        p[4] = result[i].value >> 8 & 0xFF;
+        p[5] = result[i].value >> 16 & 0xFF;
+        p[6] = result[i].value >> 24;
+    }
+    return p - out;
+}
+
+bool api_wire_decode_batch_reply(const uint8_t *in, uint8_t len, api_wire_request_t *req,
+                                 api_wire_result_t *result, uint8_t *count)
+{
+    const uint8_t *p = &in[API_WIRE_REQUEST_SIZE + 1];
+    uint8_t i;
+
+    if(len <= API_WIRE_REQUEST_SIZE)
+        return false;
+    *count = in[API_WIRE_REQUEST_SIZE];
+    if(*count > API_WIRE_BATCH_MAX || len != API_WIRE_REQUEST_SIZE + 1 + *count * API_WIRE_RESULT_SIZE)
+        return false;
+    api_wire_decode_request(in, API_WIRE_REQUEST_SIZE, req);
+    for(i = 0; i < *count; i++, p += API_WIRE_RESULT_SIZE)
+    {
+        result[i].ok = p[0] != 0;
+        result[i].msg = p[1] | (uint16_t)p[2] << 8;
+        result[i].value = p[3] | (uint32_t)p[4] << 8 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 24;
+    }
+    return true;
+}
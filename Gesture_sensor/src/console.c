@@ -0,0 +1,116 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file console.c
+* @brief Deferred debug console on UART0
+*
+* Tasks copy text into a ring buffer inside a short critical section and
+* return. The UART0 TX interrupt moves the buffer into the FIFO, so no
+* task waits for 115200 baud.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+#ifndef CONSOLE_DISABLE
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "driverlib/interrupt.h"
+#include "include/console.h"
+#include "include/fmt.h"
+
+#define CONSOLE_MASK    (CONSOLE_BUFFER_SIZE - 1)
+
+static char consoleBuf[CONSOLE_BUFFER_SIZE];
+static volatile uint32_t consoleHead, consoleTail;     /* free running */
+static console_stats_t consoleStats;
+
+/* Move buffered bytes into the TX FIFO, caller keeps the interrupt out */
+static void consoleFill(void)
+{
+    while(consoleTail != consoleHead && UARTSpaceAvail(UART0_BASE))
+    {
+        UARTCharPutNonBlocking(UART0_BASE, consoleBuf[consoleTail & CONSOLE_MASK]);
+        consoleTail++;
+    }
+}
+
+void ConsoleIntHandler(void)
+{
+    UARTIntClear(UART0_BASE, UARTIntStatus(UART0_BASE, true));
+    consoleFill();
+}
+
+void ConsoleInit(void)
+{
+    consoleHead = consoleTail = 0;
+    /* critical sections have to mask this interrupt */
+    IntPrioritySet(INT_UART0, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    IntEnable(INT_UART0);
+    UARTIntEnable(UART0_BASE, UART_INT_TX);
+}
+
+bool ConsoleWrite(const char *ptr, uint32_t len)
+{
+    uint32_t used;
+
+    if(!ptr)    return false;
+    taskENTER_CRITICAL();
+    used = consoleHead - consoleTail;
+    if(len > CONSOLE_BUFFER_SIZE - used)
+    {
+        consoleStats.dropped++;
+        taskEXIT_CRITICAL();
+        return false;
+    }
+    consoleStats.bytes += len;
+    used += len;
+    for(; len; len--)
+    {
+        consoleBuf[consoleHead & CONSOLE_MASK] = *ptr++;
+        consoleHead++;
+    }
+    if(used > consoleStats.highWater)
+        consoleStats.highWater = used;
+    consoleFill();
+    taskEXIT_CRITICAL();
+    return true;
+}
+
+bool ConsolePrintf(const char *fmt, ...)
+{
+    char line[CONSOLE_LINE_MAX];
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = fmt_vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if(len >= (int)sizeof(line))
+        len = sizeof(line) - 1;
+    return ConsoleWrite(line, len);
+}
+
+void ConsoleGetStats(console_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = consoleStats;
+    taskEXIT_CRITICAL();
+}
+
+#endif
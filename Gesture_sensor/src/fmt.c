@@ -0,0 +1,173 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file fmt.c
+* @brief Heapless printf formatter used by the deferred console
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include "include/fmt.h"
+
+typedef struct fmt_out
+{
+    char *buf;
+    size_t size;
+    size_t len;     /* characters produced, even past size */
+} fmt_out_t;
+
+static void putChar(fmt_out_t *out, char c)
+{
+    if(out->len + 1 < out->size)
+        out->buf[out->len] = c;
+    out->len++;
+}
+
+static void putPadded(fmt_out_t *out, const char *str, size_t len,
+                      unsigned int width, bool left, char pad)
+{
+    size_t fill = width > len ? width - len : 0;
+
+    /* a zero padded negative number keeps its sign in front */
+    if(pad == '0' && len && *str == '-')
+    {
+        putChar(out, *str++);
+        len--;
+    }
+    for(; !left && fill; fill--)
+        putChar(out, pad);
+    for(; len; len--)
+        putChar(out, *str++);
+    for(; fill; fill--)
+        putChar(out, ' ');
+}
+
+int fmt_vsnprintf(char *buf, size_t size, const char *fmt, va_list args)
+{
+    fmt_out_t out = {buf, size, 0};
+    char num[24], *p;
+    const char *str;
+    unsigned long value;
+    unsigned int width, base;
+    bool left, negative, upper, isLong;
+    char pad;
+    long svalue;
+    size_t len;
+
+    for(; *fmt; fmt++)
+    {
+        if(*fmt != '%')
+        {
+            putChar(&out, *fmt);
+            continue;
+        }
+
+        fmt++;
+        left = false;
+        pad = ' ';
+        width = 0;
+        for(; *fmt == '-' || *fmt == '0'; fmt++)
+        {
+            if(*fmt == '-')
+                left = true;
+            else
+                pad = '0';
+        }
+        if(left)
+            pad = ' ';
+        for(; *fmt >= '0' && *fmt <= '9'; fmt++)
+            width = width * 10 + (*fmt - '0');
+        isLong = (*fmt == 'l');
+        if(isLong)
+            fmt++;
+
+        base = 10;
+        upper = false;
+        negative = false;
+        switch(*fmt)
+        {
+            case 'd':
+            case 'i':
+                svalue = isLong ? va_arg(args, long) : va_arg(args, int);
+                negative = svalue < 0;
+                value = negative ? 0UL - (unsigned long)svalue : (unsigned long)svalue;
+                break;
+            case 'u':
+                value = isLong ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+                break;
+            case 'X':
+                upper = true;
+                /* fall through */
+            case 'x':
+                value = isLong ? va_arg(args, unsigned long) : va_arg(args, unsigned int);
+                base = 16;
+                break;
+            case 'p':
+                value = (unsigned long)(uintptr_t)va_arg(args, void *);
+                base = 16;
+                putPadded(&out, "0x", 2, 0, false, ' ');
+                break;
+            case 'c':
+                num[0] = (char)va_arg(args, int);
+                putPadded(&out, num, 1, width, left, ' ');
+                continue;
+            case 's':
+                str = va_arg(args, const char *);
+                if(!str)
+                    str = "(null)";
+                for(len = 0; str[len]; len++)
+                    ;
+                putPadded(&out, str, len, width, left, ' ');
+                continue;
+            case '%':
+                putChar(&out, '%');
+                continue;
+            case '\0':
+                fmt--;
+                continue;
+            default:
+                putChar(&out, '%');
+                putChar(&out, *fmt);
+                continue;
+        }
+
+        /* digits are produced backwards from the end of num */
+        p = &num[sizeof(num)];
+        do
+        {
+            *--p = (upper ? "0123456789ABCDEF" : "0123456789abcdef")[value % base];
+            value /= base;
+        } while(value);
+        if(negative)
+            *--p = '-';
+        putPadded(&out, p, &num[sizeof(num)] - p, width, left, pad);
+    }
+
+    if(size)
+        buf[out.len < size ? out.len : size - 1] = '\0';
+    return out.len;
+}
+
+int fmt_snprintf(char *out, size_t size, const char *fmt, ...)
+{
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = fmt_vsnprintf(out, size, fmt, args);
+    va_end(args);
+    return len;
+}
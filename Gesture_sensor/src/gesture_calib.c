@@ -0,0 +1,158 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gesture_calib.c
+* @brief Adaptive gesture gain, LED drive and thresholds from ambient light and the proximity baseline
+*
+* Fixed settings miss swipes in bright rooms, where the channels saturate
+* and the ratios flatten, and trigger on crosstalk noise in dark ones.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_calib.h"
+
+void gesture_calib_init(gesture_calib_t *c, const gesture_calib_setting_t *start)
+{
+    memset(c, 0, sizeof(*c));
+    c->cur = *start;
+    c->target = *start;
+}
+
+/* gesture counts with no hand at a gain and LED drive */
+static uint32_t floorAt(const gesture_calib_t *c, uint8_t gain, uint8_t ledDrive)
+{
+    uint32_t crosstalk = (c->proximity + 2 * c->deviation) / 16;
+    uint32_t ambient = c->ambient / 16 / GCALIB_AMBIENT_PER_COUNT;
+
+    return ((crosstalk << gain) >> (2 + ledDrive)) + ((ambient << gain) >> 1);
+}
+
+/* crosstalk alone at GGAIN_1X, what the LED drive is set from */
+static uint32_t crosstalkAt(const gesture_calib_t *c, uint8_t ledDrive)
+{
+    return ((c->proximity + 2 * c->deviation) / 16) >> (2 + ledDrive);
+}
+
+/* classifier parameters over the floor */
+static void tuningFor(const gesture_calib_t *c, uint32_t floor, gesture_tuning_t *t)
+{
+    uint32_t threshold = floor + GCALIB_MARGIN;
+
+    threshold = (threshold + GCALIB_THRESHOLD_STEP - 1) / GCALIB_THRESHOLD_STEP * GCALIB_THRESHOLD_STEP;
+    if( threshold < GESTURE_THRESHOLD_OUT )
+    {
+        threshold = GESTURE_THRESHOLD_OUT;
+    }
+    if( threshold > GCALIB_THRESHOLD_MAX )
+    {
+        threshold = GCALIB_THRESHOLD_MAX;
+    }
+    t->thresholdOut = threshold;
+    t->sensitivity1 = c->ambient / 16 >= GCALIB_BRIGHT ? GCALIB_SENS1_BRIGHT : GESTURE_SENSITIVITY_1;
+    t->sensitivity2 = c->deviation / 16 > GCALIB_NOISE_HIGH ? GCALIB_SENS2_NOISY : GESTURE_SENSITIVITY_2;
+}
+
+void gesture_calib_target(const gesture_calib_t *c, gesture_calib_setting_t *target)
+{
+    uint32_t ambient = c->ambient / 16;
+    uint8_t cap = GCALIB_GAIN_MAX;
+    uint8_t led = c->cur.ledDrive;
+    int gain;
+
+    if( ambient >= GCALIB_VERY_BRIGHT )
+    {
+        cap = GGAIN_1X;
+    }
+    else if( ambient >= GCALIB_BRIGHT && cap > GGAIN_2X )
+    {
+        cap = GGAIN_2X;
+    }
+
+    /* less LED current only when crosstalk is too much at the lowest
+     * gain, back up once the higher current would be quiet */
+    if( crosstalkAt(c, led) > GCALIB_NOISE_MAX && led < GCALIB_LED_MIN )
+    {
+        led++;
+    }
+    else if( led > LED_DRIVE_100MA && crosstalkAt(c, led - 1) <= GCALIB_NOISE_MAX / 2 )
+    {
+        led--;
+    }
+
+    for( gain = cap; gain > GGAIN_1X; gain-- )
+    {
+        if( floorAt(c, gain, led) <= GCALIB_NOISE_MAX )
+        {
+            break;
+        }
+    }
+
+    target->gain = gain;
+    target->ledDrive = led;
+    tuningFor(c, floorAt(c, gain, led), &target->tuning);
+}
+
+/* avg += (x - avg) / 4, all x16 */
+static void average(uint32_t *avg, uint32_t x)
+{
+    *avg = *avg + (int32_t)(x * 16 - *avg) / (1 << GCALIB_AVERAGE_SHIFT);
+}
+
+uint32_t gesture_calib_sample(gesture_calib_t *c, uint16_t ambient, uint8_t proximity)
+{
+    gesture_calib_setting_t target, next;
+    uint32_t changed = 0;
+
+    if( !c->samples++ )
+    {
+        c->ambient = ambient * 16;
+        c->proximity = proximity * 16;
+    }
+    average(&c->ambient, ambient);
+    average(&c->deviation, proximity * 16 > c->proximity ? proximity - c->proximity / 16 :
+                                                           c->proximity / 16 - proximity);
+    average(&c->proximity, proximity);
+
+    /* the averages have to stay away from the current setting for
+     * GCALIB_CONFIRM samples, the latest target is taken */
+    gesture_calib_target(c, &target);
+    c->target = target;
+    if( !memcmp(&target, &c->cur, sizeof(target)) )
+    {
+        c->agree = 0;
+        return 0;
+    }
+    if( ++c->agree < GCALIB_CONFIRM )
+    {
+        return 0;
+    }
+
+    /* one gain and LED step at a time, the thresholds for that step */
+    next.gain = c->cur.gain + (target.gain > c->cur.gain) - (target.gain < c->cur.gain);
+    next.ledDrive = c->cur.ledDrive + (target.ledDrive > c->cur.ledDrive) -
+                    (target.ledDrive < c->cur.ledDrive);
+    tuningFor(c, floorAt(c, next.gain, next.ledDrive), &next.tuning);
+
+    changed |= next.gain != c->cur.gain ? GCALIB_GAIN : 0;
+    changed |= next.ledDrive != c->cur.ledDrive ? GCALIB_LED_DRIVE : 0;
+    changed |= next.tuning.thresholdOut != c->cur.tuning.thresholdOut ? GCALIB_THRESHOLD : 0;
+    changed |= (next.tuning.sensitivity1 != c->cur.tuning.sensitivity1 ||
+                next.tuning.sensitivity2 != c->cur.tuning.sensitivity2) ? GCALIB_SENSITIVITY : 0;
+    c->cur = next;
+    c->agree = 0;
+    return changed;
+}
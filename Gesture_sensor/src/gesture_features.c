@@ -0,0 +1,203 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gesture_features.c
+* @brief One pass, division free feature extraction for processGestureData
+*
+* processGestureData scanned the four arrays forward and backward one
+* byte at a time and then did four divisions, each 2 to 12 cycles on the
+* M4. Here a dataset is one word and one packed compare.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_features.h"
+
+#if defined(__TI_ARM_V7M4__)
+#define SIMD_USUB8(a, b)    _usub8((a), (b))
+#define SIMD_SEL(a, b)      _sel((a), (b))
+#elif defined(__ARM_FEATURE_SIMD32)
+#include <arm_acle.h>
+#define SIMD_USUB8(a, b)    __usub8((a), (b))
+#define SIMD_SEL(a, b)      __sel((a), (b))
+#endif
+
+#define LANES               (0x01010101U)
+#define LANE_TOP            (0x80808080U)
+
+/* smallest U+D or L+R with both channels over the lowest threshold, and largest */
+#define RECIP_MIN           (2 * (GESTURE_THRESHOLD_OUT + 1))
+#define RECIP_MAX           (2 * 255)
+
+/*
+ * recip[s - RECIP_MIN] = ceil(2^32 / s). For n <= 100 * (s - RECIP_MIN)
+ * the rounding error times n stays under 2^32, so (n * recip) >> 32 is
+ * exactly n / s; checked for every s and n when the table was made.
+ */
+static const uint32_t recip[RECIP_MAX - RECIP_MIN + 1] =
+{
+    0x0BA2E8BBU, 0x0B21642DU, 0x0AAAAAABU, 0x0A3D70A4U, 0x09D89D8AU, 0x097B425FU,
+    0x0924924AU, 0x08D3DCB1U, 0x08888889U, 0x08421085U, 0x08000000U, 0x07C1F07DU,
+    0x07878788U, 0x07507508U, 0x071C71C8U, 0x06EB3E46U, 0x06BCA1B0U, 0x06906907U,
+    0x06666667U, 0x063E7064U, 0x06186187U, 0x05F417D1U, 0x05D1745EU, 0x05B05B06U,
+    0x0590B217U, 0x0572620BU, 0x05555556U, 0x0539782AU, 0x051EB852U, 0x05050506U,
+    0x04EC4EC5U, 0x04D4873FU, 0x04BDA130U, 0x04A7904BU, 0x04924925U, 0x047DC120U,
+    0x0469EE59U, 0x0456C798U, 0x04444445U, 0x04325C54U, 0x04210843U, 0x04104105U,
+    0x04000000U, 0x03F03F04U, 0x03E0F83FU, 0x03D22636U, 0x03C3C3C4U, 0x03B5CC0FU,
+    0x03A83A84U, 0x039B0AD2U, 0x038E38E4U, 0x0381C0E1U, 0x03759F23U, 0x0369D037U,
+    0x035E50D8U, 0x03531DEDU, 0x03483484U, 0x033D91D3U, 0x03333334U, 0x03291620U,
+    0x031F3832U, 0x03159722U, 0x030C30C4U, 0x03030304U, 0x02FA0BE9U, 0x02F14991U,
+    0x02E8BA2FU, 0x02E05C0CU, 0x02D82D83U, 0x02D02D03U, 0x02C8590CU, 0x02C0B02DU,
+    0x02B93106U, 0x02B1DA47U, 0x02AAAAABU, 0x02A3A0FEU, 0x029CBC15U, 0x0295FAD5U,
+    0x028F5C29U, 0x0288DF0DU, 0x02828283U, 0x027C4598U, 0x02762763U, 0x02702703U,
+    0x026A43A0U, 0x02647C6AU, 0x025ED098U, 0x02593F6AU, 0x0253C826U, 0x024E6A18U,
+    0x02492493U, 0x0243F6F1U, 0x023EE090U, 0x0239E0D6U, 0x0234F72DU, 0x02302303U,
+    0x022B63CCU, 0x0226B903U, 0x02222223U, 0x021D9EAEU, 0x02192E2AU, 0x0214D022U,
+    0x02108422U, 0x020C49BBU, 0x02082083U, 0x02040811U, 0x02000000U, 0x01FC07F1U,
+    0x01F81F82U, 0x01F4465AU, 0x01F07C20U, 0x01ECC07CU, 0x01E9131BU, 0x01E573ADU,
+    0x01E1E1E2U, 0x01DE5D6FU, 0x01DAE608U, 0x01D77B66U, 0x01D41D42U, 0x01D0CB59U,
+    0x01CD8569U, 0x01CA4B31U, 0x01C71C72U, 0x01C3F8F1U, 0x01C0E071U, 0x01BDD2B9U,
+    0x01BACF92U, 0x01B7D6C4U, 0x01B4E81CU, 0x01B20365U, 0x01AF286CU, 0x01AC5702U,
+    0x01A98EF7U, 0x01A6D01BU, 0x01A41A42U, 0x01A16D40U, 0x019EC8EAU, 0x019C2D15U,
+    0x0199999AU, 0x01970E50U, 0x01948B10U, 0x01920FB5U, 0x018F9C19U, 0x018D3019U,
+    0x018ACB91U, 0x01886E60U, 0x01861862U, 0x0183C978U, 0x01818182U, 0x017F4060U,
+    0x017D05F5U, 0x017AD221U, 0x0178A4C9U, 0x01767DCFU, 0x01745D18U, 0x01724288U,
+    0x01702E06U, 0x016E1F77U, 0x016C16C2U, 0x016A13CEU, 0x01681682U, 0x01661EC7U,
+    0x01642C86U, 0x01623FA8U, 0x01605817U, 0x015E75BCU, 0x015C9883U, 0x015AC057U,
+    0x0158ED24U, 0x01571ED4U, 0x01555556U, 0x01539095U, 0x0151D07FU, 0x01501502U,
+    0x014E5E0BU, 0x014CAB89U, 0x014AFD6BU, 0x0149539FU, 0x0147AE15U, 0x01460CBDU,
+    0x01446F87U, 0x0142D663U, 0x01414142U, 0x013FB014U, 0x013E22CCU, 0x013C995BU,
+    0x013B13B2U, 0x013991C3U, 0x01381382U, 0x013698E0U, 0x013521D0U, 0x0133AE46U,
+    0x01323E35U, 0x0130D191U, 0x012F684CU, 0x012E025DU, 0x012C9FB5U, 0x012B404BU,
+    0x0129E413U, 0x01288B02U, 0x0127350CU, 0x0125E228U, 0x0124924AU, 0x01234568U,
+    0x0121FB79U, 0x0120B471U, 0x011F7048U, 0x011E2EF4U, 0x011CF06BU, 0x011BB4A5U,
+    0x011A7B97U, 0x01194539U, 0x01181182U, 0x0116E069U, 0x0115B1E6U, 0x011485F1U,
+    0x01135C82U, 0x0112358FU, 0x01111112U, 0x010FEF02U, 0x010ECF57U, 0x010DB20BU,
+    0x010C9715U, 0x010B7E6FU, 0x010A6811U, 0x010953F4U, 0x01084211U, 0x01073261U,
+    0x010624DEU, 0x01051980U, 0x01041042U, 0x0103091CU, 0x01020409U, 0x01010102U,
+    0x01000000U, 0x00FF0100U, 0x00FE03F9U, 0x00FD08E6U, 0x00FC0FC1U, 0x00FB1886U,
+    0x00FA232DU, 0x00F92FB3U, 0x00F83E10U, 0x00F74E40U, 0x00F6603EU, 0x00F57404U,
+    0x00F4898EU, 0x00F3A0D6U, 0x00F2B9D7U, 0x00F1D48CU, 0x00F0F0F1U, 0x00F00F01U,
+    0x00EF2EB8U, 0x00EE500FU, 0x00ED7304U, 0x00EC9792U, 0x00EBBDB3U, 0x00EAE565U,
+    0x00EA0EA1U, 0x00E93966U, 0x00E865ADU, 0x00E79373U, 0x00E6C2B5U, 0x00E5F36DU,
+    0x00E52599U, 0x00E45933U, 0x00E38E39U, 0x00E2C4A7U, 0x00E1FC79U, 0x00E135AAU,
+    0x00E07039U, 0x00DFAC20U, 0x00DEE95DU, 0x00DE27ECU, 0x00DD67C9U, 0x00DCA8F2U,
+    0x00DBEB62U, 0x00DB2F18U, 0x00DA740EU, 0x00D9BA43U, 0x00D901B3U, 0x00D84A5AU,
+    0x00D79436U, 0x00D6DF44U, 0x00D62B81U, 0x00D578EAU, 0x00D4C77CU, 0x00D41733U,
+    0x00D3680EU, 0x00D2BA09U, 0x00D20D21U, 0x00D16155U, 0x00D0B6A0U, 0x00D00D01U,
+    0x00CF6475U, 0x00CEBCF9U, 0x00CE168BU, 0x00CD7128U, 0x00CCCCCDU, 0x00CC2979U,
+    0x00CB8728U, 0x00CAE5D9U, 0x00CA4588U, 0x00C9A634U, 0x00C907DBU, 0x00C86A79U,
+    0x00C7CE0DU, 0x00C73294U, 0x00C6980DU, 0x00C5FE75U, 0x00C565C9U, 0x00C4CE08U,
+    0x00C43730U, 0x00C3A13EU, 0x00C30C31U, 0x00C27807U, 0x00C1E4BCU, 0x00C15251U,
+    0x00C0C0C1U, 0x00C0300DU, 0x00BFA030U, 0x00BF112BU, 0x00BE82FBU, 0x00BDF59DU,
+    0x00BD6911U, 0x00BCDD54U, 0x00BC5265U, 0x00BBC841U, 0x00BB3EE8U, 0x00BAB657U,
+    0x00BA2E8CU, 0x00B9A787U, 0x00B92144U, 0x00B89BC4U, 0x00B81703U, 0x00B79301U,
+    0x00B70FBCU, 0x00B68D32U, 0x00B60B61U, 0x00B58A49U, 0x00B509E7U, 0x00B48A3AU,
+    0x00B40B41U, 0x00B38CFAU, 0x00B30F64U, 0x00B2927DU, 0x00B21643U, 0x00B19AB6U,
+    0x00B11FD4U, 0x00B0A59CU, 0x00B02C0CU, 0x00AFB322U, 0x00AF3ADEU, 0x00AEC33FU,
+    0x00AE4C42U, 0x00ADD5E7U, 0x00AD602CU, 0x00ACEB10U, 0x00AC7692U, 0x00AC02B1U,
+    0x00AB8F6AU, 0x00AB1CBEU, 0x00AAAAABU, 0x00AA3930U, 0x00A9C84BU, 0x00A957FBU,
+    0x00A8E840U, 0x00A87918U, 0x00A80A81U, 0x00A79C7CU, 0x00A72F06U, 0x00A6C21EU,
+    0x00A655C5U, 0x00A5E9F7U, 0x00A57EB6U, 0x00A513FEU, 0x00A4A9D0U, 0x00A4402AU,
+    0x00A3D70BU, 0x00A36E72U, 0x00A3065FU, 0x00A29ED0U, 0x00A237C4U, 0x00A1D13AU,
+    0x00A16B32U, 0x00A105AAU, 0x00A0A0A1U, 0x00A03C17U, 0x009FD80AU, 0x009F747BU,
+    0x009F1166U, 0x009EAECDU, 0x009E4CAEU, 0x009DEB07U, 0x009D89D9U, 0x009D2922U,
+    0x009CC8E2U, 0x009C6917U, 0x009C09C1U, 0x009BAADFU, 0x009B4C70U, 0x009AEE73U,
+    0x009A90E8U, 0x009A33CEU, 0x0099D723U, 0x00997AE8U, 0x00991F1BU, 0x0098C3BBU,
+    0x009868C9U, 0x00980E42U, 0x0097B426U, 0x00975A76U, 0x0097012FU, 0x0096A851U,
+    0x00964FDBU, 0x0095F7CDU, 0x0095A026U, 0x009548E5U, 0x0094F20AU, 0x00949B93U,
+    0x00944581U, 0x0093EFD2U, 0x00939A86U, 0x0093459CU, 0x0092F114U, 0x00929CECU,
+    0x00924925U, 0x0091F5BDU, 0x0091A2B4U, 0x0091500AU, 0x0090FDBDU, 0x0090ABCDU,
+    0x00905A39U, 0x00900901U, 0x008FB824U, 0x008F67A2U, 0x008F177AU, 0x008EC7ACU,
+    0x008E7836U, 0x008E2918U, 0x008DDA53U, 0x008D8BE4U, 0x008D3DCCU, 0x008CF009U,
+    0x008CA29DU, 0x008C5585U, 0x008C08C1U, 0x008BBC51U, 0x008B7035U, 0x008B246BU,
+    0x008AD8F3U, 0x008A8DCEU, 0x008A42F9U, 0x0089F875U, 0x0089AE41U, 0x0089645DU,
+    0x00891AC8U, 0x0088D181U, 0x00888889U, 0x00883FDEU, 0x0087F781U, 0x0087AF70U,
+    0x008767ACU, 0x00872033U, 0x0086D906U, 0x00869223U, 0x00864B8BU, 0x0086053DU,
+    0x0085BF38U, 0x0085797CU, 0x00853409U, 0x0084EEDEU, 0x0084A9FAU, 0x0084655EU,
+    0x00842109U, 0x0083DCFAU, 0x00839931U, 0x008355ADU, 0x0083126FU, 0x0082CF76U,
+    0x00828CC0U, 0x00824A4FU, 0x00820821U, 0x0081C636U, 0x0081848EU, 0x00814328U,
+    0x00810205U, 0x0080C122U, 0x00808081U,
+};
+
+/* The threshold in each byte, as overThreshold uses it. The threshold
+ * stays under 0x80, GCALIB_THRESHOLD_MAX. */
+static inline uint32_t thresholdLanes(uint8_t threshold)
+{
+#ifdef SIMD_USUB8
+    return (threshold + 1) * LANES;
+#else
+    return (0x80 - threshold - 1) * LANES;
+#endif
+}
+
+/* true when all four channels of a packed dataset are over the threshold */
+static inline bool overThreshold(uint32_t x, uint32_t lanes)
+{
+#ifdef SIMD_USUB8
+    /* GE set for each byte >= threshold + 1 */
+    SIMD_USUB8(x, lanes);
+    return SIMD_SEL(LANE_TOP, 0) == LANE_TOP;
+#else
+    /* low 7 bits plus (0x80 - threshold - 1) carry into bit 7, no byte overflows */
+    return ((((x & ~LANE_TOP) + lanes) | x) & LANE_TOP) == LANE_TOP;
+#endif
+}
+
+int16_t gesture_ratio(uint8_t a, uint8_t b)
+{
+    uint32_t n = (a > b ? a - b : b - a) * 100U;
+    int16_t q = ((uint64_t)n * recip[a + b - RECIP_MIN]) >> 32;
+
+    return a < b ? -q : q;
+}
+
+bool gesture_features(const gesture_window_t *w, uint8_t threshold, gesture_features_t *f)
+{
+    uint32_t lanes = thresholdLanes(threshold);
+    uint32_t first, last;
+    int32_t i;
+
+    /* forward to the first dataset over the threshold */
+    for( i = 0; i < (int32_t)w->count; i++ )
+    {
+        if( overThreshold(gesture_window_at(w, i), lanes) )
+        {
+            break;
+        }
+    }
+    if( i == (int32_t)w->count )
+    {
+        f->first = f->last = -1;
+        return false;
+    }
+    f->first = i;
+
+    /* back to the last one, the first stops it at the latest */
+    for( i = w->count - 1; !overThreshold(gesture_window_at(w, i), lanes); i-- )
+    {
+    }
+    f->last = i;
+
+    first = gesture_window_at(w, f->first);
+    last = gesture_window_at(w, f->last);
+    f->ud_first = gesture_ratio(GESTURE_U(first), GESTURE_D(first));
+    f->lr_first = gesture_ratio(GESTURE_L(first), GESTURE_R(first));
+    f->ud_last = gesture_ratio(GESTURE_U(last), GESTURE_D(last));
+    f->lr_last = gesture_ratio(GESTURE_L(last), GESTURE_R(last));
+    f->ud_delta = f->ud_last - f->ud_first;
+    f->lr_delta = f->lr_last - f->lr_first;
+    return true;
+}
@@ -0,0 +1,176 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gesture_grammar.c
+* @brief Gesture sequences (double swipe, U-turn, hold) mapped to actions by a rule table
+*
+* Two states, idle or one swipe pending, and every call is a fixed amount
+* of work plus one pass over the rule table.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_grammar.h"
+#include "include/relay_queue.h"
+
+/* Gesture sequences to relay actions */
+const gesture_rule_t gesture_grammar_rules[] =
+{
+    { GGRAMMAR_SWIPE,  DIR_UP,    RELAY0_ON },
+    { GGRAMMAR_SWIPE,  DIR_LEFT,  RELAY1_ON },
+    { GGRAMMAR_SWIPE,  DIR_DOWN,  RELAY0_OFF },
+    { GGRAMMAR_SWIPE,  DIR_RIGHT, RELAY1_OFF },
+    { GGRAMMAR_SWIPE,  DIR_NEAR,  RELAYS_ON },
+    { GGRAMMAR_SWIPE,  DIR_FAR,   RELAYS_OFF },
+    { GGRAMMAR_HOLD,   DIR_NEAR,  RELAYS_OFF },
+#ifdef GESTURE_PAIRS
+    { GGRAMMAR_DOUBLE, DIR_UP,    RELAYS_ON },
+    { GGRAMMAR_DOUBLE, DIR_DOWN,  RELAYS_OFF },
+    { GGRAMMAR_UTURN,  DIR_UP,    RELAY0_TOGGLE },
+    { GGRAMMAR_UTURN,  DIR_LEFT,  RELAY1_TOGGLE },
+#endif
+};
+const uint8_t gesture_grammar_rule_count = sizeof(gesture_grammar_rules) / sizeof(gesture_grammar_rules[0]);
+
+void gesture_grammar_init(gesture_grammar_t *g, const gesture_rule_t *rules, uint8_t ruleCount,
+                          uint32_t gapMs, uint32_t holdMs)
+{
+    g->rules = rules;
+    g->ruleCount = ruleCount;
+    g->pending = DIR_NONE;
+    g->gapMs = gapMs;
+    g->holdMs = holdMs;
+    g->deadline = 0;
+}
+
+static bool isSwipe(uint8_t dir)
+{
+    return dir >= DIR_LEFT && dir <= DIR_DOWN;
+}
+
+static uint8_t opposite(uint8_t dir)
+{
+    switch( dir )
+    {
+        case DIR_LEFT:  return DIR_RIGHT;
+        case DIR_RIGHT: return DIR_LEFT;
+        case DIR_UP:    return DIR_DOWN;
+        case DIR_DOWN:  return DIR_UP;
+        default:        return DIR_NONE;
+    }
+}
+
+void gesture_grammar_token(const gesture_grammar_t *g, uint8_t kind, uint8_t dir, gesture_token_t *out)
+{
+    uint8_t i;
+
+    out->kind = kind;
+    out->dir = dir;
+    out->action = 0;
+    for( i = 0; i < g->ruleCount; i++ )
+    {
+        if( g->rules[i].kind == kind && g->rules[i].dir == dir )
+        {
+            out->action = g->rules[i].action;
+            break;
+        }
+    }
+}
+
+bool gesture_grammar_immediate(const gesture_grammar_t *g, uint8_t dir)
+{
+    uint8_t i;
+
+    for( i = 0; i < g->ruleCount; i++ )
+    {
+        if( (g->rules[i].kind == GGRAMMAR_DOUBLE || g->rules[i].kind == GGRAMMAR_UTURN) &&
+            g->rules[i].dir == dir )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int gesture_grammar_push(gesture_grammar_t *g, uint8_t dir, uint32_t startMs, uint32_t endMs,
+                         gesture_token_t out[2])
+{
+    int n = 0;
+
+    /* nothing decoded, a pending swipe keeps waiting */
+    if( dir == DIR_NONE || dir >= DIR_ALL )
+    {
+        return 0;
+    }
+
+    if( g->pending != DIR_NONE )
+    {
+        if( (int32_t)(startMs - g->deadline) <= 0 )
+        {
+            /* a pair with no rule is two swipes, each with its own action */
+            if( dir == g->pending || dir == opposite(g->pending) )
+            {
+                gesture_grammar_token(g, dir == g->pending ? GGRAMMAR_DOUBLE : GGRAMMAR_UTURN,
+                                      g->pending, &out[0]);
+                if( out[0].action )
+                {
+                    g->pending = DIR_NONE;
+                    return 1;
+                }
+            }
+        }
+        gesture_grammar_token(g, GGRAMMAR_SWIPE, g->pending, &out[n++]);
+        g->pending = DIR_NONE;
+    }
+
+    if( isSwipe(dir) && !gesture_grammar_immediate(g, dir) )
+    {
+        g->pending = dir;
+        g->deadline = endMs + g->gapMs;
+    }
+    else if( dir == DIR_NEAR && endMs - startMs >= g->holdMs )
+    {
+        gesture_grammar_token(g, GGRAMMAR_HOLD, dir, &out[n++]);
+    }
+    else
+    {
+        gesture_grammar_token(g, GGRAMMAR_SWIPE, dir, &out[n++]);
+    }
+    return n;
+}
+
+int gesture_grammar_poll(gesture_grammar_t *g, uint32_t nowMs, gesture_token_t *out)
+{
+    if( g->pending == DIR_NONE || (int32_t)(nowMs - g->deadline) <= 0 )
+    {
+        return 0;
+    }
+    gesture_grammar_token(g, GGRAMMAR_SWIPE, g->pending, out);
+    g->pending = DIR_NONE;
+    return 1;
+}
+
+uint32_t gesture_grammar_wait(const gesture_grammar_t *g, uint32_t nowMs)
+{
+    if( g->pending == DIR_NONE )
+    {
+        return GGRAMMAR_NO_DEADLINE;
+    }
+    if( (int32_t)(g->deadline - nowMs) < 0 )
+    {
+        return 0;
+    }
+    return g->deadline - nowMs + 1;
+}
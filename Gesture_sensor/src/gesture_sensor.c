@@ -20,73 +20,113 @@
 ********************************************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include "include/i2c_comm.h"
 #include "driverlib/sysctl.h"
 #include "include/uart_comm.h"
 #include "include/gesture_sensor.h"
+#include "include/apds_regs.h"
+#include "include/gesture_stream.h"
+#include "include/gesture_features.h"
+#include "task.h"
+#include "semphr.h"
 
-bool setLEDDrive(uint8_t drive)
+gesture_sensor_t gesture_sensor0 =
 {
-    uint8_t val;
+    .dev = { &i2c_bus0, SLAVE_ADDRESS, I2C_NO_MUX },
+    .tuning = { GESTURE_THRESHOLD_OUT, GESTURE_SENSITIVITY_1, GESTURE_SENSITIVITY_2 },
+};
 
-    /* Read value from CONTROL register */
-    if( !i2c_read(APDS9960_CONTROL, &val) ) {
-        return false;
-    }
+void gesture_sensor_init(gesture_sensor_t *s, i2c_bus_t *bus, int8_t channel)
+{
+    s->dev.bus = bus;
+    s->dev.addr = SLAVE_ADDRESS;
+    s->dev.channel = channel;
+    s->tuning.thresholdOut = GESTURE_THRESHOLD_OUT;
+    s->tuning.sensitivity1 = GESTURE_SENSITIVITY_1;
+    s->tuning.sensitivity2 = GESTURE_SENSITIVITY_2;
+    apds_reg_init(&s->regs, &s->dev);
+}
 
-    /* Set bits in register to given value */
-    drive &= 0b00000011;
-    drive = drive << 6;
-    val &= 0b00111111;
-    val |= drive;
+void gesture_sensor_bind(gesture_sensor_t *s)
+{
+    vTaskSetThreadLocalStoragePointer(NULL, GESTURE_SENSOR_TLS_INDEX, s);
+}
 
-    /* Write register value back into CONTROL register */
-    if( !i2c_write(APDS9960_CONTROL, val) ) {
-        return false;
+gesture_sensor_t *gesture_sensor_current(void)
+{
+    gesture_sensor_t *s = NULL;
+
+    /* there is no calling task before the scheduler runs */
+    if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+    {
+        s = pvTaskGetThreadLocalStoragePointer(NULL, GESTURE_SENSOR_TLS_INDEX);
     }
+    return s ? s : &gesture_sensor0;
+}
 
-    return true;
+/* the calling task's register shadow */
+static apds_regs_t *regs(void)
+{
+    return &gesture_sensor_current()->regs;
 }
 
-bool setProximityGain(uint8_t drive)
+void setGestureCallback(gesture_cb_t cb)
 {
-    uint8_t val;
+    gesture_sensor_current()->cb = cb;
+}
 
-    /* Read value from CONTROL register */
-    if( !i2c_read(APDS9960_CONTROL, &val) ) {
-        return false;
-    }
+void setGestureTrace(gesture_trace_fn_t fn)
+{
+    gesture_sensor_current()->trace = fn;
+}
 
-    /* Set bits in register to given value */
-    drive &= 0b00000011;
-    drive = drive << 2;
-    val &= 0b11110011;
-    val |= drive;
+uint32_t gestureDecidedAt(void)
+{
+    return gesture_sensor_current()->stream.decidedAt;
+}
+
+void gesture_sensor_signal_from_isr(gesture_sensor_t *s, BaseType_t *woken)
+{
+    if(s->fifoSem)
+        xSemaphoreGiveFromISR(s->fifoSem, woken);
+}
+
+void gestureSignalFromISR(BaseType_t *woken)
+{
+    gesture_sensor_signal_from_isr(&gesture_sensor0, woken);
+}
 
-    /* Write register value back into CONTROL register */
-    if( !i2c_write(APDS9960_CONTROL, val) ) {
+/* Sleep until the sensor signals a FIFO fill, false after ms without one */
+bool gestureWaitFifo(uint32_t ms)
+{
+    return xSemaphoreTake(gesture_sensor_current()->fifoSem, pdMS_TO_TICKS(ms)) == pdTRUE;
+}
+
+bool setLEDDrive(uint8_t drive)
+{
+    /* Set LDRIVE bits in CONTROL, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_CONTROL, 0b11000000, drive << 6) ) {
         return false;
     }
 
     return true;
 }
 
-bool setAmbientLightGain(uint8_t drive)
+bool setProximityGain(uint8_t drive)
 {
-    uint8_t val;
-
-    /* Read value from CONTROL register */
-    if( !i2c_read(APDS9960_CONTROL, &val) ) {
+    /* Set PGAIN bits in CONTROL, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_CONTROL, 0b00001100, drive << 2) ) {
         return false;
     }
 
-    /* Set bits in register to given value */
-    drive &= 0b00000011;
-    val &= 0b11111100;
-    val |= drive;
+    return true;
+}
 
-    /* Write register value back into CONTROL register */
-    if( !i2c_write(APDS9960_CONTROL, val) ) {
+bool setAmbientLightGain(uint8_t drive)
+{
+    /* Set AGAIN bits in CONTROL, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_CONTROL, 0b00000011, drive) ) {
         return false;
     }
 
@@ -95,7 +135,7 @@ bool setAmbientLightGain(uint8_t drive)
 
 bool setProxIntLowThresh(uint8_t threshold)
 {
-    if( !i2c_write(APDS9960_PILT, threshold) ) {
+    if( !apds_reg_write(regs(), APDS9960_PILT, threshold) ) {
         return false;
     }
 
@@ -104,7 +144,7 @@ bool setProxIntLowThresh(uint8_t threshold)
 
 bool setProxIntHighThresh(uint8_t threshold)
 {
-    if( !i2c_write(APDS9960_PIHT, threshold) ) {
+    if( !apds_reg_write(regs(), APDS9960_PIHT, threshold) ) {
         return false;
     }
 
@@ -121,12 +161,12 @@ bool setLightIntLowThreshold(uint16_t threshold)
     val_high = (threshold & 0xFF00) >> 8;
 
     /* Write low byte */
-    if( !i2c_write(APDS9960_AILTL, val_low) ) {
+    if( !apds_reg_write(regs(), APDS9960_AILTL, val_low) ) {
         return false;
     }
 
     /* Write high byte */
-    if( !i2c_write(APDS9960_AILTH, val_high) ) {
+    if( !apds_reg_write(regs(), APDS9960_AILTH, val_high) ) {
         return false;
     }
 
@@ -143,12 +183,12 @@ bool setLightIntHighThreshold(uint16_t threshold)
     val_high = (threshold & 0xFF00) >> 8;
 
     /* Write low byte */
-    if( !i2c_write(APDS9960_AIHTL, val_low) ) {
+    if( !apds_reg_write(regs(), APDS9960_AIHTL, val_low) ) {
         return false;
     }
 
     /* Write high byte */
-    if( !i2c_write(APDS9960_AIHTH, val_high) ) {
+    if( !apds_reg_write(regs(), APDS9960_AIHTH, val_high) ) {
         return false;
     }
 
@@ -157,7 +197,7 @@ bool setLightIntHighThreshold(uint16_t threshold)
 
 bool setGestureEnterThresh(uint8_t threshold)
 {
-    if( !i2c_write(APDS9960_GPENTH, threshold) ) {
+    if( !apds_reg_write(regs(), APDS9960_GPENTH, threshold) ) {
         return false;
     }
 
@@ -166,7 +206,7 @@ bool setGestureEnterThresh(uint8_t threshold)
 
 bool setGestureExitThresh(uint8_t threshold)
 {
-    if( !i2c_write(APDS9960_GEXTH, threshold) ) {
+    if( !apds_reg_write(regs(), APDS9960_GEXTH, threshold) ) {
         return false;
     }
 
@@ -175,21 +215,8 @@ bool setGestureExitThresh(uint8_t threshold)
 
 bool setGestureLEDDrive(uint8_t drive)
 {
-    uint8_t val;
-
-    /* Read value from GCONF2 register */
-    if( !i2c_read(APDS9960_GCONF2, &val) ) {
-        return false;
-    }
-
-    /* Set bits in register to given value */
-    drive &= 0b00000011;
-    drive = drive << 3;
-    val &= 0b11100111;
-    val |= drive;
-
-    /* Write register value back into GCONF2 register */
-    if( !i2c_write(APDS9960_GCONF2, val) ) {
+    /* Set GLDRIVE bits in GCONF2, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_GCONF2, 0b00011000, drive << 3) ) {
         return false;
     }
 
@@ -198,20 +225,8 @@ bool setGestureLEDDrive(uint8_t drive)
 
 bool setGestureWaitTime(uint8_t time)
 {
-    uint8_t val;
-
-    /* Read value from GCONF2 register */
-    if( !i2c_read(APDS9960_GCONF2, &val) ) {
-        return false;
-    }
-
-    /* Set bits in register to given value */
-    time &= 0b00000111;
-    val &= 0b11111000;
-    val |= time;
-
-    /* Write register value back into GCONF2 register */
-    if( !i2c_write(APDS9960_GCONF2, val) ) {
+    /* Set GWTIME bits in GCONF2, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_GCONF2, 0b00000111, time) ) {
         return false;
     }
 
@@ -238,7 +253,7 @@ uint8_t getGestureWaitTime()
     uint8_t val;
 
     /* Read value from GCONF2 register */
-    if( !i2c_read(APDS9960_GCONF2, &val) )
+    if( !apds_reg_read(regs(), APDS9960_GCONF2, &val) )
     {
         return ERROR;
     }
@@ -249,12 +264,50 @@ uint8_t getGestureWaitTime()
     return val;
 }
 
+/*
+ * Power-on configuration, sorted by address. ENABLE goes first so every
+ * engine is off while the rest is written; the reserved addresses 0x82,
+ * 0x88, 0x8A and 0xA8 split the table into six burst writes.
+ */
+static const apds_reg_val_t initTable[] =
+{
+    { APDS9960_ENABLE,      0x00 },
+    { APDS9960_ATIME,       DEFAULT_ATIME },
+    { APDS9960_WTIME,       DEFAULT_WTIME },
+    { APDS9960_AILTL,       DEFAULT_AILT & 0xFF },
+    { APDS9960_AILTH,       DEFAULT_AILT >> 8 },
+    { APDS9960_AIHTL,       DEFAULT_AIHT & 0xFF },
+    { APDS9960_AIHTH,       DEFAULT_AIHT >> 8 },
+    { APDS9960_PILT,        DEFAULT_PILT },
+    { APDS9960_PIHT,        DEFAULT_PIHT },
+    { APDS9960_PERS,        DEFAULT_PERS },
+    { APDS9960_CONFIG1,     DEFAULT_CONFIG1 },
+    { APDS9960_PPULSE,      DEFAULT_PROX_PPULSE },
+    { APDS9960_CONTROL,     (DEFAULT_LDRIVE << 6) | (DEFAULT_PGAIN << 2) | DEFAULT_AGAIN },
+    { APDS9960_CONFIG2,     DEFAULT_CONFIG2 },
+    { APDS9960_POFFSET_UR,  DEFAULT_POFFSET_UR },
+    { APDS9960_POFFSET_DL,  DEFAULT_POFFSET_DL },
+    { APDS9960_CONFIG3,     DEFAULT_CONFIG3 },
+    { APDS9960_GPENTH,      DEFAULT_GPENTH },
+    { APDS9960_GEXTH,       DEFAULT_GEXTH },
+    { APDS9960_GCONF1,      DEFAULT_GCONF1 },
+    { APDS9960_GCONF2,      (DEFAULT_GGAIN << 5) | (DEFAULT_GLDRIVE << 3) | DEFAULT_GWTIME },
+    { APDS9960_GOFFSET_U,   DEFAULT_GOFFSET },
+    { APDS9960_GOFFSET_D,   DEFAULT_GOFFSET },
+    { APDS9960_GPULSE,      DEFAULT_GPULSE },
+    { APDS9960_GOFFSET_L,   DEFAULT_GOFFSET },
+    { APDS9960_GOFFSET_R,   DEFAULT_GOFFSET },
+    { APDS9960_GCONF3,      DEFAULT_GCONF3 },
+    { APDS9960_GCONF4,      DEFAULT_GIEN << 1 },
+};
+
 bool sensor_init()
 {
+    gesture_sensor_t *s = gesture_sensor_current();
     uint8_t id;
 
     /* Read ID register and check against known values for APDS-9960 */
-    if( !i2c_read(APDS9960_ID, &id) ) {
+    if( !i2c_dev_read(&s->dev, APDS9960_ID, &id) ) {
         return false;
     }
 
@@ -262,99 +315,12 @@ bool sensor_init()
         return false;
     }
 
-    /* Set ENABLE register to 0 (disable all features) */
-    if( !setMode(ALL, OFF) ) {
-            return false;
+    if( !s->fifoSem ) {
+        s->fifoSem = xSemaphoreCreateBinary();
     }
 
-    /* Set default values for ambient light and proximity registers */
-    if( !i2c_write(APDS9960_ATIME, DEFAULT_ATIME) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_WTIME, DEFAULT_WTIME) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_PPULSE, DEFAULT_PROX_PPULSE) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_POFFSET_UR, DEFAULT_POFFSET_UR) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_POFFSET_DL, DEFAULT_POFFSET_DL) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_CONFIG1, DEFAULT_CONFIG1) ) {
-        return false;
-    }
-    if( !setLEDDrive(DEFAULT_LDRIVE) ) {
-        return false;
-    }
-    if( !setProximityGain(DEFAULT_PGAIN) ) {
-        return false;
-    }
-    if( !setAmbientLightGain(DEFAULT_AGAIN) ) {
-        return false;
-    }
-    if( !setProxIntLowThresh(DEFAULT_PILT) ) {
-        return false;
-    }
-    if( !setProxIntHighThresh(DEFAULT_PIHT) ) {
-        return false;
-    }
-    if( !setLightIntLowThreshold(DEFAULT_AILT) ) {
-        return false;
-    }
-    if( !setLightIntHighThreshold(DEFAULT_AIHT) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_PERS, DEFAULT_PERS) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_CONFIG2, DEFAULT_CONFIG2) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_CONFIG3, DEFAULT_CONFIG3) ) {
-        return false;
-    }
-
-    /* Set default values for gesture sense registers */
-    if( !setGestureEnterThresh(DEFAULT_GPENTH) ) {
-        return false;
-    }
-    if( !setGestureExitThresh(DEFAULT_GEXTH) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GCONF1, DEFAULT_GCONF1) ) {
-        return false;
-    }
-    if( !setGestureGain(DEFAULT_GGAIN) ) {
-        return false;
-    }
-    if( !setGestureLEDDrive(DEFAULT_GLDRIVE) ) {
-        return false;
-    }
-    if( !setGestureWaitTime(DEFAULT_GWTIME) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GOFFSET_U, DEFAULT_GOFFSET) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GOFFSET_D, DEFAULT_GOFFSET) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GOFFSET_L, DEFAULT_GOFFSET) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GOFFSET_R, DEFAULT_GOFFSET) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GPULSE, DEFAULT_GPULSE) ) {
-        return false;
-    }
-    if( !i2c_write(APDS9960_GCONF3, DEFAULT_GCONF3) ) {
-        return false;
-    }
-    if( !setGestureIntEnable(DEFAULT_GIEN) ) {
+    /* Write the defaults and read them back */
+    if( !apds_reg_apply(regs(), initTable, sizeof(initTable) / sizeof(initTable[0])) ) {
         return false;
     }
     return true;
@@ -362,41 +328,26 @@ bool sensor_init()
 
 void resetGestureParameters()
 {
-    gesture_data_.index = 0;
-    gesture_data_.total_gestures = 0;
+    gesture_sensor_t *s = gesture_sensor_current();
+    s->data.next = s->data.ring.head;
 
-    gesture_ud_delta_ = 0;
-    gesture_lr_delta_ = 0;
+    s->ud_delta = 0;
+    s->lr_delta = 0;
 
-    gesture_ud_count_ = 0;
-    gesture_lr_count_ = 0;
+    s->ud_count = 0;
+    s->lr_count = 0;
 
-    gesture_near_count_ = 0;
-    gesture_far_count_ = 0;
+    s->near_count = 0;
+    s->far_count = 0;
 
-    gesture_state_ = 0;
-    gesture_motion_ = DIR_NONE;
+    s->state = 0;
+    s->motion = DIR_NONE;
 }
 
 bool setLEDBoost(uint8_t boost)
 {
-    uint8_t val;
-
-    /* Read value from CONFIG2 register */
-    if(!i2c_read(APDS9960_CONFIG2, &val))
-    {
-        return false;
-    }
-
-    /* Set bits in register to given value */
-    boost &= 0b00000011;
-    boost = boost << 4;
-    val &= 0b11001111;
-    val |= boost;
-
-    /* Write register value back into CONFIG2 register */
-    if(!i2c_write(APDS9960_CONFIG2, val))
-    {
+    /* Set LED_BOOST bits in CONFIG2, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_CONFIG2, 0b00110000, boost << 4) ) {
         return false;
     }
 
@@ -413,7 +364,7 @@ uint8_t getGestureMode()
     uint8_t val;
 
     /* Read value from GCONF4 register */
-    if( !i2c_read(APDS9960_GCONF4, &val) )
+    if( !apds_reg_read(regs(), APDS9960_GCONF4, &val) )
     {
         return ERROR;
     }
@@ -426,22 +377,8 @@ uint8_t getGestureMode()
 
 bool setGestureMode(uint8_t mode)
 {
-    uint8_t val;
-
-    /* Read value from GCONF4 register */
-    if(!i2c_read(APDS9960_GCONF4, &val))
-    {
-        return false;
-    }
-
-    /* Set bits in register to given value */
-    mode &= 0b00000001;
-    val &=  0b11111110;
-    val |= mode;
-
-    /* Write register value back into GCONF4 register */
-    if(!i2c_write(APDS9960_GCONF4, val))
-    {
+    /* Set GMODE bits in GCONF4, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_GCONF4, 0b00000001, mode) ) {
         return false;
     }
 
@@ -450,21 +387,8 @@ bool setGestureMode(uint8_t mode)
 
 bool setGestureGain(uint8_t gain)
 {
-    uint8_t val;
-
-    /* Read value from GCONF2 register */
-    if(!i2c_read(APDS9960_GCONF2, &val)) {
-        return false;
-    }
-
-    /* Set bits in register to given value */
-    gain &= 0b00000011;
-    gain = gain << 5;
-    val &= 0b10011111;
-    val |= gain;
-
-    /* Write register value back into GCONF2 register */
-    if(!i2c_write(APDS9960_GCONF2, val) ) {
+    /* Set GGAIN bits in GCONF2, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_GCONF2, 0b01100000, gain << 5) ) {
         return false;
     }
 
@@ -481,7 +405,7 @@ uint8_t getGestureIntEnable()
     uint8_t val;
 
     /* Read value from GCONF4 register */
-    if( !i2c_read(APDS9960_GCONF4, &val) )
+    if( !apds_reg_read(regs(), APDS9960_GCONF4, &val) )
     {
         return ERROR;
     }
@@ -494,21 +418,8 @@ uint8_t getGestureIntEnable()
 
 bool setGestureIntEnable(uint8_t enable)
 {
-    uint8_t val;
-
-    /* Read value from GCONF4 register */
-    if( !i2c_read(APDS9960_GCONF4, &val) ) {
-        return false;
-    }
-
-    /* Set bits in register to given value */
-    enable &= 0b00000001;
-    enable = enable << 1;
-    val &= 0b11111101;
-    val |= enable;
-
-    /* Write register value back into GCONF4 register */
-    if( !i2c_write(APDS9960_GCONF4, val) ) {
+    /* Set GIEN bits in GCONF4, the other fields come from the shadow */
+    if( !apds_reg_update(regs(), APDS9960_GCONF4, 0b00000010, enable << 1) ) {
         return false;
     }
 
@@ -519,7 +430,7 @@ uint8_t getMode()
 {
     uint8_t temp;
     /* Read current ENABLE register */
-    if(!i2c_read(APDS9960_ENABLE, &temp))
+    if(!apds_reg_read(regs(), APDS9960_ENABLE, &temp))
     {
         return ERROR;
     }
@@ -528,44 +439,29 @@ uint8_t getMode()
 
 bool setMode(uint8_t mode, uint8_t enable)
 {
-    uint8_t reg_val;
+    uint8_t mask;
 
-    /* Read current ENABLE register */
-    reg_val = getMode();
-    if( reg_val == ERROR ) {
-        return false;
-    }
-
-    /* Change bit(s) in ENABLE register */
-    enable = enable & 0x01;
-    if( mode >= 0 && mode <= 6 ) {
-        if (enable) {
-            reg_val |= (1 << mode);
-        } else {
-            reg_val &= ~(1 << mode);
-        }
+    /* Change bit(s) in ENABLE, read and written under the register lock */
+    if( mode <= 6 ) {
+        mask = 1 << mode;
     } else if( mode == ALL ) {
-        if (enable) {
-            reg_val = 0x7F;
-        } else {
-            reg_val = 0x00;
-        }
+        mask = 0xFF;
+    } else {
+        return true;
     }
-
-    /* Write value back to ENABLE register */
-    if( !i2c_write(APDS9960_ENABLE, reg_val) ) {
+    if( !apds_reg_update(regs(), APDS9960_ENABLE, mask, (enable & 0x01) ? 0x7F : 0x00) ) {
         return false;
     }
 
     return true;
 }
 
-bool enableGestureSensor(bool interrupts)
+/* Gesture engine start sequence, run inside a register batch */
+static bool startGesture(bool interrupts)
 {
-    resetGestureParameters();
-    if(!i2c_write(APDS9960_WTIME, 0xFF))
+    if(!apds_reg_write(regs(), APDS9960_WTIME, 0xFF))
         return false;
-    if(!i2c_write(APDS9960_PPULSE, DEFAULT_GESTURE_PPULSE))
+    if(!apds_reg_write(regs(), APDS9960_PPULSE, DEFAULT_GESTURE_PPULSE))
         return false;
     if(!setLEDBoost(LED_BOOST_300))
         return false;
@@ -612,6 +508,20 @@ bool enableGestureSensor(bool interrupts)
     return true;
 }
 
+bool enableGestureSensor(bool interrupts)
+{
+    bool ok;
+
+    resetGestureParameters();
+    apds_reg_begin(regs());
+    ok = startGesture(interrupts);
+    if( !apds_reg_commit(regs()) )
+    {
+        return false;
+    }
+    return ok;
+}
+
 /**
  * @brief Ends the gesture recognition engine on the APDS-9960
  *
@@ -619,21 +529,17 @@ bool enableGestureSensor(bool interrupts)
  */
 bool disableGestureSensor()
 {
+    bool ok;
+
     resetGestureParameters();
-    if( !setGestureIntEnable(0) )
-    {
-        return false;
-    }
-    if( !setGestureMode(0) )
-    {
-        return false;
-    }
-    if( !setMode(GESTURE, 0) )
+    apds_reg_begin(regs());
+    ok = setGestureIntEnable(0) && setGestureMode(0) && setMode(GESTURE, 0);
+    if( !apds_reg_commit(regs()) )
     {
         return false;
     }
 
-    return true;
+    return ok;
 }
 
 bool isGestureAvailable()
@@ -641,7 +547,7 @@ bool isGestureAvailable()
     uint8_t val;
 
     /* Read value from GSTATUS register */
-    if(!i2c_read(APDS9960_GSTATUS, &val))
+    if(!i2c_dev_read(&gesture_sensor_current()->dev, APDS9960_GSTATUS, &val))
     {
         return false;
     }
@@ -663,143 +569,94 @@ bool isGestureAvailable()
 
 bool processGestureData()
 {
-    uint8_t u_first = 0;
-    uint8_t d_first = 0;
-    uint8_t l_first = 0;
-    uint8_t r_first = 0;
-    uint8_t u_last = 0;
-    uint8_t d_last = 0;
-    uint8_t l_last = 0;
-    uint8_t r_last = 0;
-    int ud_ratio_first;
-    int lr_ratio_first;
-    int ud_ratio_last;
-    int lr_ratio_last;
+    gesture_sensor_t *s = gesture_sensor_current();
+    gesture_window_t w;
+    gesture_features_t f;
     int ud_delta;
     int lr_delta;
-    int i;
+
+    /* The datasets since the last call, the newest GESTURE_RING_DEPTH
+     * if it has been longer than that */
+    w = gesture_ring_window(&s->data.ring, s->data.next);
 
     /* If we have less than 4 total gestures, that's not enough */
-    if( gesture_data_.total_gestures <= 4 )
+    if( w.count <= 4 )
     {
         return false;
     }
 
-    /* Check to make sure our data isn't out of bounds */
-    if( (gesture_data_.total_gestures <= 32) && \
-        (gesture_data_.total_gestures > 0) )
+    /* First and last values in U/D/L/R above the threshold, their
+     * ratios and the difference between them, in one pass */
+    if( !gesture_features(&w, s->tuning.thresholdOut, &f) )
     {
-
-        /* Find the first value in U/D/L/R above the threshold */
-        for( i = 0; i < gesture_data_.total_gestures; i++ )
-        {
-            if( (gesture_data_.u_data[i] > GESTURE_THRESHOLD_OUT) &&
-                (gesture_data_.d_data[i] > GESTURE_THRESHOLD_OUT) &&
-                (gesture_data_.l_data[i] > GESTURE_THRESHOLD_OUT) &&
-                (gesture_data_.r_data[i] > GESTURE_THRESHOLD_OUT) )
-            {
-
-                u_first = gesture_data_.u_data[i];
-                d_first = gesture_data_.d_data[i];
-                l_first = gesture_data_.l_data[i];
-                r_first = gesture_data_.r_data[i];
-                break;
-            }
-        }
-
-        /* If one of the _first values is 0, then there is no good data */
-        if( (u_first == 0) || (d_first == 0) || \
-            (l_first == 0) || (r_first == 0) )
-        {
-
-            return false;
-        }
-        /* Find the last value in U/D/L/R above the threshold */
-        for( i = gesture_data_.total_gestures - 1; i >= 0; i-- )
-        {
-
-            if( (gesture_data_.u_data[i] > GESTURE_THRESHOLD_OUT) &&
-                (gesture_data_.d_data[i] > GESTURE_THRESHOLD_OUT) &&
-                (gesture_data_.l_data[i] > GESTURE_THRESHOLD_OUT) &&
-                (gesture_data_.r_data[i] > GESTURE_THRESHOLD_OUT) )
-            {
-
-                u_last = gesture_data_.u_data[i];
-                d_last = gesture_data_.d_data[i];
-                l_last = gesture_data_.l_data[i];
-                r_last = gesture_data_.r_data[i];
-                break;
-            }
-        }
+        s->data.next = s->data.ring.head;
+        return false;
     }
 
-    /* Calculate the first vs. last ratio of up/down and left/right */
-    ud_ratio_first = ((u_first - d_first) * 100) / (u_first + d_first);
-    lr_ratio_first = ((l_first - r_first) * 100) / (l_first + r_first);
-    ud_ratio_last = ((u_last - d_last) * 100) / (u_last + d_last);
-    lr_ratio_last = ((l_last - r_last) * 100) / (l_last + r_last);
-
-    /* Determine the difference between the first and last ratios */
-    ud_delta = ud_ratio_last - ud_ratio_first;
-    lr_delta = lr_ratio_last - lr_ratio_first;
+    /* The next window starts at this one's last valid dataset, so the
+     * deltas add up to the first to last change over the whole gesture
+     * instead of losing the step between two FIFO reads */
+    s->data.next = w.first + f.last;
+    ud_delta = f.ud_delta;
+    lr_delta = f.lr_delta;
 
     /* Accumulate the UD and LR delta values */
-    gesture_ud_delta_ += ud_delta;
-    gesture_lr_delta_ += lr_delta;
+    s->ud_delta += ud_delta;
+    s->lr_delta += lr_delta;
 
     /* Determine U/D gesture */
-    if( gesture_ud_delta_ >= GESTURE_SENSITIVITY_1 )
+    if( s->ud_delta >= s->tuning.sensitivity1 )
     {
-        gesture_ud_count_ = 1;
+        s->ud_count = 1;
     }
-    else if( gesture_ud_delta_ <= -GESTURE_SENSITIVITY_1 )
+    else if( s->ud_delta <= -s->tuning.sensitivity1 )
     {
-        gesture_ud_count_ = -1;
+        s->ud_count = -1;
     }
     else
     {
-        gesture_ud_count_ = 0;
+        s->ud_count = 0;
     }
 
     /* Determine L/R gesture */
-    if( gesture_lr_delta_ >= GESTURE_SENSITIVITY_1 )
+    if( s->lr_delta >= s->tuning.sensitivity1 )
     {
-        gesture_lr_count_ = 1;
+        s->lr_count = 1;
     }
-    else if( gesture_lr_delta_ <= -GESTURE_SENSITIVITY_1 )
+    else if( s->lr_delta <= -s->tuning.sensitivity1 )
     {
-        gesture_lr_count_ = -1;
+        s->lr_count = -1;
     }
     else
     {
-        gesture_lr_count_ = 0;
+        s->lr_count = 0;
     }
 
     /* Determine Near/Far gesture */
-    if( (gesture_ud_count_ == 0) && (gesture_lr_count_ == 0) )
+    if( (s->ud_count == 0) && (s->lr_count == 0) )
     {
-        if( (abs(ud_delta) < GESTURE_SENSITIVITY_2) && \
-            (abs(lr_delta) < GESTURE_SENSITIVITY_2) )
+        if( (abs(ud_delta) < s->tuning.sensitivity2) && \
+            (abs(lr_delta) < s->tuning.sensitivity2) )
         {
 
             if( (ud_delta == 0) && (lr_delta == 0) )
             {
-                gesture_near_count_++;
+                s->near_count++;
             }
             else if( (ud_delta != 0) || (lr_delta != 0) )
             {
-                gesture_far_count_++;
+                s->far_count++;
             }
 
-            if( (gesture_near_count_ >= 10) && (gesture_far_count_ >= 2) )
+            if( (s->near_count >= 10) && (s->far_count >= 2) )
             {
                 if( (ud_delta == 0) && (lr_delta == 0) )
                 {
-                    gesture_state_ = NEAR_STATE;
+                    s->state = NEAR_STATE;
                 }
                 else if( (ud_delta != 0) && (lr_delta != 0) )
                 {
-                    gesture_state_ = FAR_STATE;
+                    s->state = FAR_STATE;
                 }
                 return true;
             }
@@ -807,21 +664,21 @@ bool processGestureData()
     }
     else
     {
-        if( (abs(ud_delta) < GESTURE_SENSITIVITY_2) && \
-            (abs(lr_delta) < GESTURE_SENSITIVITY_2) )
+        if( (abs(ud_delta) < s->tuning.sensitivity2) && \
+            (abs(lr_delta) < s->tuning.sensitivity2) )
         {
 
             if( (ud_delta == 0) && (lr_delta == 0) )
             {
-                gesture_near_count_++;
+                s->near_count++;
             }
 
-            if( gesture_near_count_ >= 10 )
+            if( s->near_count >= 10 )
             {
-                gesture_ud_count_ = 0;
-                gesture_lr_count_ = 0;
-                gesture_ud_delta_ = 0;
-                gesture_lr_delta_ = 0;
+                s->ud_count = 0;
+                s->lr_count = 0;
+                s->ud_delta = 0;
+                s->lr_delta = 0;
             }
         }
     }
@@ -831,77 +688,78 @@ bool processGestureData()
 
 bool decodeGesture()
 {
+    gesture_sensor_t *s = gesture_sensor_current();
     /* Return if near or far event is detected */
-    if( gesture_state_ == NEAR_STATE )
+    if( s->state == NEAR_STATE )
     {
-        gesture_motion_ = DIR_NEAR;
+        s->motion = DIR_NEAR;
         return true;
     }
-    else if ( gesture_state_ == FAR_STATE )
+    else if ( s->state == FAR_STATE )
     {
-        gesture_motion_ = DIR_FAR;
+        s->motion = DIR_FAR;
         return true;
     }
 
     /* Determine swipe direction */
-    if( (gesture_ud_count_ == -1) && (gesture_lr_count_ == 0) )
+    if( (s->ud_count == -1) && (s->lr_count == 0) )
     {
-        gesture_motion_ = DIR_UP;
+        s->motion = DIR_UP;
     }
-    else if( (gesture_ud_count_ == 1) && (gesture_lr_count_ == 0) )
+    else if( (s->ud_count == 1) && (s->lr_count == 0) )
     {
-        gesture_motion_ = DIR_DOWN;
+        s->motion = DIR_DOWN;
     }
-    else if( (gesture_ud_count_ == 0) && (gesture_lr_count_ == 1) )
+    else if( (s->ud_count == 0) && (s->lr_count == 1) )
     {
-        gesture_motion_ = DIR_RIGHT;
+        s->motion = DIR_RIGHT;
     }
-    else if( (gesture_ud_count_ == 0) && (gesture_lr_count_ == -1) )
+    else if( (s->ud_count == 0) && (s->lr_count == -1) )
     {
-        gesture_motion_ = DIR_LEFT;
+        s->motion = DIR_LEFT;
     }
-    else if( (gesture_ud_count_ == -1) && (gesture_lr_count_ == 1) )
+    else if( (s->ud_count == -1) && (s->lr_count == 1) )
     {
-        if( abs(gesture_ud_delta_) > abs(gesture_lr_delta_) )
+        if( abs(s->ud_delta) > abs(s->lr_delta) )
         {
-            gesture_motion_ = DIR_UP;
+            s->motion = DIR_UP;
         }
         else
         {
-            gesture_motion_ = DIR_RIGHT;
+            s->motion = DIR_RIGHT;
         }
     }
-    else if( (gesture_ud_count_ == 1) && (gesture_lr_count_ == -1) )
+    else if( (s->ud_count == 1) && (s->lr_count == -1) )
     {
-        if( abs(gesture_ud_delta_) > abs(gesture_lr_delta_) )
+        if( abs(s->ud_delta) > abs(s->lr_delta) )
         {
-            gesture_motion_ = DIR_DOWN;
+            s->motion = DIR_DOWN;
         }
         else
         {
-            gesture_motion_ = DIR_LEFT;
+            s->motion = DIR_LEFT;
         }
     }
-    else if( (gesture_ud_count_ == -1) && (gesture_lr_count_ == -1) )
+    else if( (s->ud_count == -1) && (s->lr_count == -1) )
     {
-        if( abs(gesture_ud_delta_) > abs(gesture_lr_delta_) )
+        if( abs(s->ud_delta) > abs(s->lr_delta) )
         {
-            gesture_motion_ = DIR_UP;
+            s->motion = DIR_UP;
         }
         else
         {
-            gesture_motion_ = DIR_LEFT;
+            s->motion = DIR_LEFT;
         }
     }
-    else if( (gesture_ud_count_ == 1) && (gesture_lr_count_ == 1) )
+    else if( (s->ud_count == 1) && (s->lr_count == 1) )
     {
-        if( abs(gesture_ud_delta_) > abs(gesture_lr_delta_) )
+        if( abs(s->ud_delta) > abs(s->lr_delta) )
         {
-            gesture_motion_ = DIR_DOWN;
+            s->motion = DIR_DOWN;
         }
         else
         {
-            gesture_motion_ = DIR_RIGHT;
+            s->motion = DIR_RIGHT;
         }
     }
     else
@@ -958,7 +816,7 @@ uint8_t getGestureGain()
     uint8_t val;
 
     /* Read value from GCONF2 register */
-    if( !i2c_read(APDS9960_GCONF2, &val) )
+    if( !apds_reg_read(regs(), APDS9960_GCONF2, &val) )
     {
         return ERROR;
     }
@@ -985,7 +843,7 @@ uint8_t getGestureLEDDrive()
     uint8_t val;
 
     /* Read value from GCONF2 register */
-    if( !i2c_read(APDS9960_GCONF2, &val) )
+    if( !apds_reg_read(regs(), APDS9960_GCONF2, &val) )
     {
         return ERROR;
     }
@@ -996,28 +854,91 @@ uint8_t getGestureLEDDrive()
     return val;
 }
 
+void gestureBegin()
+{
+    gesture_sensor_t *s = gesture_sensor_current();
+    gesture_stream_reset(&s->stream, &s->tuning);
+}
+
+// Take n datasets already written at the ring's head
+static void gestureCommit(uint32_t n)
+{
+    gesture_sensor_t *s = gesture_sensor_current();
+    gesture_ring_t *ring = &s->data.ring;
+    int event;
+
+    for( ; n; n-- )
+    {
+        // Report a direction as soon as the stream is sure
+        event = gesture_stream_push(&s->stream,
+                    (const uint8_t *)&ring->sample[ring->head & GESTURE_RING_MASK]);
+        gesture_ring_commit(ring, 1);
+        if( event != GSTREAM_NONE && s->cb )
+        {
+            s->cb(s->stream.dir, event);
+        }
+    }
+
+    // processGestureData needs more than 4 datasets, a short
+    // batch waits in the ring for the next one.
+    // Filter and process gesture data. Decode near/far state
+    // U-turns and other sequences are put together from the
+    // results by gesture_grammar
+    if( processGestureData() )
+    {
+        decodeGesture();
+    }
+}
+
+void gestureAddData(const uint8_t *fifo_data, int bytes_read)
+{
+    gesture_sensor_t *s = gesture_sensor_current();
+    uint8_t *dst;
+    uint32_t n, i;
+
+    for( ; bytes_read >= 4; bytes_read -= n * 4, fifo_data += n * 4 )
+    {
+        dst = gesture_ring_space(&s->data.ring, bytes_read / 4, &n);
+        for( i = 0; i < n * 4; i++ )
+        {
+            dst[i] = fifo_data[i];
+        }
+        gestureCommit(n);
+    }
+}
+
+int gestureFinish()
+{
+    gesture_sensor_t *s = gesture_sensor_current();
+    int motion;
+
+    // Determine best guessed gesture and clean up
+    decodeGesture();
+    motion = s->motion;
+    resetGestureParameters();
+    return motion;
+}
+
 int readGesture()
 {
+    gesture_sensor_t *s = gesture_sensor_current();
     uint8_t fifo_level = 0;
     int bytes_read = 0;
-    uint8_t fifo_data[128];
+    uint8_t *fifo_data;
+    uint32_t n;
     uint8_t gstatus;
-    int motion;
-    int i;
 
-        // Make sure that power and gesture is on and data is valid
-        if( !isGestureAvailable() || !(getMode() & 0b01000001) )
-        {
-            return DIR_NONE;
+    // Make sure that power and gesture is on and data is valid
+    if( !isGestureAvailable() || !(getMode() & 0b01000001) )
+    {
+        return DIR_NONE;
     }
+    gestureBegin();
 
     while(1)
     {
-        // Wait some time to collect next batch of FIFO data
-        __delay_cycles(FIFO_PAUSE_TIME*500);
-
         // Get the contents of the STATUS register. Is data still valid?
-        if(!i2c_read(APDS9960_GSTATUS, &gstatus))
+        if(!i2c_dev_read(&s->dev, APDS9960_GSTATUS, &gstatus))
         {
             return ERROR;
         }
@@ -1026,58 +947,40 @@ int readGesture()
         if( (gstatus & APDS9960_GVALID) == APDS9960_GVALID )
         {
             // Read the current FIFO level
-            if(!i2c_read(APDS9960_GFLVL, &fifo_level))
+            if(!i2c_dev_read(&s->dev, APDS9960_GFLVL, &fifo_level))
             {
                 return ERROR;
             }
 
-             // If there's stuff in the FIFO, read it into our data block
-             if( fifo_level > 0)
-             {
-                 bytes_read = ReadDataBlock(  APDS9960_GFIFO_U,
-                                                  (uint8_t*)fifo_data,
-                                                  (fifo_level * 4) );
-                 if( bytes_read == -1 )
-                 {
-                     return ERROR;
-                 }
-                 SysCtlDelay(500000);
-
-                 // If at least 1 set of data, sort the data into U/D/L/R
-                 if( bytes_read >= 4 )
-                 {
-                     for( i = 0; i < bytes_read; i += 4 )
-                     {
-                         gesture_data_.u_data[gesture_data_.index] = fifo_data[i + 0];
-                         gesture_data_.d_data[gesture_data_.index] = fifo_data[i + 1];
-                         gesture_data_.l_data[gesture_data_.index] = fifo_data[i + 2];
-                         gesture_data_.r_data[gesture_data_.index] = fifo_data[i + 3];
-                         gesture_data_.index += 1;
-                         gesture_data_.total_gestures +=1;
-                     }
-
-                     // Filter and process gesture data. Decode near/far state
-                     if( processGestureData() )
-                     {
-                         if( decodeGesture() )
-                         {
-                             // TODO U-Turn Gestures
-                         }
-                     }
-                     // Reset data
-                     gesture_data_.index = 0;
-                     gesture_data_.total_gestures = 0;
-                 }
-             }
+            // If there's stuff in the FIFO, read it straight into the
+            // ring, in two bursts when it wraps
+            while( fifo_level > 0 )
+            {
+                fifo_data = gesture_ring_space(&s->data.ring, fifo_level, &n);
+                bytes_read = i2c_dev_read_block( &s->dev,
+                                                 APDS9960_GFIFO_U,
+                                                 fifo_data,
+                                                 (n * 4) );
+                if( bytes_read == -1 )
+                {
+                    return ERROR;
+                }
+                s->endTick = xTaskGetTickCount();
+                if( s->trace )
+                {
+                    s->trace(fifo_data, bytes_read, s->endTick);
+                }
+                gestureCommit(n);
+                fifo_level -= n;
+            }
+
+            // Sleep until the next FIFO fill; a gesture that ends before
+            // the threshold is reached is picked up after the pause
+            gestureWaitFifo(FIFO_PAUSE_TIME);
         }
         else
         {
-            // Determine best guessed gesture and clean up
-            __delay_cycles(500*FIFO_PAUSE_TIME);
-            decodeGesture();
-            motion = gesture_motion_;
-            resetGestureParameters();
-            return motion;
+            return gestureFinish();
         }
     }
 }
@@ -0,0 +1,93 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gesture_stream.c
+* @brief Incremental swipe classifier fed one FIFO dataset at a time
+*
+* readGesture used to reach a direction only after the hand had left the
+* sensor. Here the decision is made while the FIFO is still filling, so the
+* relay can switch before the gesture ends.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "include/gesture_sensor.h"
+#include "include/gesture_stream.h"
+
+void gesture_stream_reset(gesture_stream_t *s, const gesture_tuning_t *tuning)
+{
+    memset(s, 0, sizeof(*s));
+    s->tuning = tuning;
+    s->dir = DIR_NONE;
+    s->candidate = DIR_NONE;
+}
+
+/* Direction the deltas point at, DIR_NONE while neither axis is clear */
+static uint8_t classify(const gesture_tuning_t *t, int ud, int lr)
+{
+    if( abs(ud) >= abs(lr) )
+    {
+        if( abs(ud) < t->sensitivity1 || abs(ud) - abs(lr) < t->sensitivity2 )
+            return DIR_NONE;
+        return ud < 0 ? DIR_UP : DIR_DOWN;
+    }
+    if( abs(lr) < t->sensitivity1 || abs(lr) - abs(ud) < t->sensitivity2 )
+        return DIR_NONE;
+    return lr > 0 ? DIR_RIGHT : DIR_LEFT;
+}
+
+int gesture_stream_push(gesture_stream_t *s, const uint8_t dataset[4])
+{
+    int u = dataset[0], d = dataset[1], l = dataset[2], r = dataset[3];
+    int threshold = s->tuning->thresholdOut;
+    uint8_t dir;
+
+    s->samples++;
+    if( u <= threshold || d <= threshold || l <= threshold || r <= threshold )
+    {
+        return GSTREAM_NONE;
+    }
+
+    if( !s->valid++ )
+    {
+        s->udFirst = ((u - d) * 100) / (u + d);
+        s->lrFirst = ((l - r) * 100) / (l + r);
+        return GSTREAM_NONE;
+    }
+    s->udDelta = ((u - d) * 100) / (u + d) - s->udFirst;
+    s->lrDelta = ((l - r) * 100) / (l + r) - s->lrFirst;
+
+    dir = classify(s->tuning, s->udDelta, s->lrDelta);
+    if( dir != s->candidate )
+    {
+        s->candidate = dir;
+        s->held = 0;
+    }
+    if( dir == DIR_NONE || dir == s->dir || ++s->held < GSTREAM_HOLD )
+    {
+        return GSTREAM_NONE;
+    }
+
+    if( s->dir == DIR_NONE )
+    {
+        s->dir = dir;
+        s->decidedAt = s->samples;
+        return GSTREAM_DECIDED;
+    }
+    s->dir = dir;
+    s->corrections++;
+    return GSTREAM_CORRECTED;
+}
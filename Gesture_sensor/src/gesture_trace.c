@@ -0,0 +1,55 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file gesture_trace.c
+* @brief Wire encoding of captured gesture FIFO data for the TIVA - BBG link
+*
+* This file is built into both the TIVA image and the BBG application
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "include/gesture_trace.h"
+
+uint8_t gesture_trace_encode(uint8_t *out, const gesture_trace_t *rec)
+{
+    if(rec->count > GESTURE_TRACE_MAX_SETS || (rec->count && !rec->data))
+        return 0;
+
+    out[0] = rec->flags;
+    out[1] = rec->id;
+    out[2] = rec->result;
+    out[3] = rec->tick;
+    out[4] = rec->tick >> 8;
+    out[5] = rec->tick >> 16;
+    out[6] = rec->tick >> 24;
+    memcpy(&out[GESTURE_TRACE_HEADER], rec->data, rec->count * 4);
+    return GESTURE_TRACE_HEADER + rec->count * 4;
+}
+
+bool gesture_trace_decode(const uint8_t *payload, uint8_t len, gesture_trace_t *rec)
+{
+    if(len < GESTURE_TRACE_HEADER || (len - GESTURE_TRACE_HEADER) % 4)
+        return false;
+
+    rec->flags = payload[0];
+    rec->id = payload[1];
+    rec->result = payload[2];
+    rec->tick = payload[3] | (uint32_t)payload[4] << 8 |
+                (uint32_t)payload[5] << 16 | (uint32_t)payload[6] << 24;
+    rec->count = (len - GESTURE_TRACE_HEADER) / 4;
+    rec->data = &payload[GESTURE_TRACE_HEADER];
+    return true;
+}
@@ -7,6 +7,16 @@
 *
 * This file implements functions for i2c communication with GESTURE SENSOR
 *
+* Transactions on the sensor bus are driven by the I2C0 interrupt: the
+* caller starts one, blocks on a task notification and the interrupt
+* advances it byte by byte. Before the scheduler starts the same state
+* machine is polled. NACKs, lost arbitration and timeouts are counted.
+*
+* Every controller has its own transaction, mutex and counters, so a
+* task reading one sensor's FIFO does not hold up one on another bus.
+* Sensors behind a mux share their controller; the mux is switched,
+* under the controller's mutex, only when the channel changes.
+*
 * @author Kiran Hegde
 * @date  4/29/2018
 * @tools Code Composer Studio
@@ -20,117 +30,310 @@
 ********************************************************************************************************/
 #include <stdint.h>
 #include <stdbool.h>
+#include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "driverlib/gpio.h"
 #include "driverlib/i2c.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/sysctl.h"
 #include "include/i2c_comm.h"
 #include "FreeRTOS.h"
+#include "task.h"
 #include "semphr.h"
 
-bool i2c_read(uint8_t reg, uint8_t *temp)
+#define I2C_NOTIFY_BIT      (1UL << 31)     /* notification bit the driver owns */
+
+typedef enum
 {
-        //xSemaphoreTake(i2cSem, portMAX_DELAY);
-        I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, false);
-        //
-        // Place the character to be sent in the data register
-        //
-        I2CMasterDataPut(I2C_BASE, reg);
-        //
-        // Initiate send of character from Master to Slave
-        //
-        I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_SINGLE_SEND);
-        //
-        // Delay until transmission completes
-        //
-        while(I2CMasterBusy(I2C_BASE));
+    XFER_REG,       /* register address going out */
+    XFER_TX,        /* data bytes going out */
+    XFER_RX,        /* data bytes coming in */
+    XFER_DONE
+}i2c_state_t;
 
-        I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, true);
+/* One transaction, owned by the calling task and advanced by the bus interrupt */
+typedef struct i2c_xfer
+{
+    i2c_bus_t *bus;
+    uint8_t addr;
+    uint8_t reg;        /* the only byte of a mux select */
+    uint8_t *buf;
+    uint32_t len;
+    uint32_t pos;
+    bool read;
+    volatile i2c_state_t state;
+    uint32_t error;
+    TaskHandle_t task;
+}i2c_xfer_t;
 
-        I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_SINGLE_RECEIVE);
-        //
-        // Delay until transmission completes
-        //
-        while(I2CMasterBusy(I2C_BASE));
-        *temp = (uint8_t)I2CMasterDataGet(I2C_BASE);
-        while(I2CMasterBusy(I2C_BASE));
-        //xSemaphoreGive(i2cSem);
-        return true;
+i2c_bus_t i2c_bus0 = I2C_BUS_INIT(I2C0_BASE, SYSCTL_PERIPH_I2C0, INT_I2C0);
+i2c_bus_t i2c_bus1 = I2C_BUS_INIT(I2C1_BASE, SYSCTL_PERIPH_I2C1, INT_I2C1);
+
+/* what the single sensor calls talk to */
+static const i2c_dev_t i2cSensor = { &i2c_bus0, SLAVE_ADDRESS, I2C_NO_MUX };
+
+/* Address the device and send the register pointer */
+static void i2cStart(i2c_xfer_t *x)
+{
+    uint32_t base = x->bus->base;
+
+    x->pos = 0;
+    x->error = I2C_MASTER_ERR_NONE;
+    x->state = XFER_REG;
+    I2CMasterSlaveAddrSet(base, x->addr, false);
+    I2CMasterDataPut(base, x->reg);
+    /* a write without data is a single byte, as the mux takes it */
+    I2CMasterControl(base, (!x->read && !x->len) ? I2C_MASTER_CMD_SINGLE_SEND :
+                                                   I2C_MASTER_CMD_BURST_SEND_START);
 }
 
-bool i2c_readID()
+/*
+ * Advance the transaction after the controller finished the last command.
+ * Returns true when the transaction is over, successfully or not.
+ */
+static bool i2cStep(i2c_xfer_t *x)
 {
-        //xSemaphoreTake(i2cSem, portMAX_DELAY);
-        I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, false);
-        //
-        // Place the character to be sent in the data register
-        //
-        I2CMasterDataPut(I2C_BASE, 0x92);
-        //
-        // Initiate send of character from Master to Slave
-        //
-        I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_SINGLE_SEND);
-        //
-        // Delay until transmission completes
-        //
-        //while(I2CMasterBusBusy(I2C_BASE));
-        SysCtlDelay(1000000);
-        if(I2CMasterBusy(I2C_BASE))
-        {
-            //SemaphoreGive(i2cSem);
+    uint32_t base = x->bus->base;
+    uint32_t err = I2CMasterErr(base);
+
+    if(err != I2C_MASTER_ERR_NONE)
+    {
+        x->error = err;
+        /* after a lost arbitration the bus belongs to the other master */
+        if(!(err & I2C_MASTER_ERR_ARB_LOST))
+            I2CMasterControl(base, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+        x->state = XFER_DONE;
+        return true;
+    }
+
+    switch(x->state)
+    {
+        case XFER_REG:
+            if(!x->read && !x->len)
+                break;
+            if(x->read)
+            {
+                /* repeated start, the last byte gets NACK and STOP */
+                I2CMasterSlaveAddrSet(base, x->addr, true);
+                I2CMasterControl(base, (x->len == 1) ? I2C_MASTER_CMD_SINGLE_RECEIVE :
+                                                           I2C_MASTER_CMD_BURST_RECEIVE_START);
+                x->state = XFER_RX;
+            }
+            else
+            {
+                I2CMasterDataPut(base, x->buf[x->pos++]);
+                I2CMasterControl(base, (x->pos == x->len) ? I2C_MASTER_CMD_BURST_SEND_FINISH :
+                                                                I2C_MASTER_CMD_BURST_SEND_CONT);
+                x->state = XFER_TX;
+            }
             return false;
-        }
-        I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, true);
 
-        I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_SINGLE_RECEIVE);
-        //
-        // Delay until transmission completes
-        //
-        //while(I2CMasterBusBusy(I2C_BASE));
-        SysCtlDelay(1000000);
-        if(I2CMasterBusy(I2C_BASE))
-        {
-            //SemaphoreGive(i2cSem);
+        case XFER_TX:
+            if(x->pos == x->len)
+                break;
+            I2CMasterDataPut(base, x->buf[x->pos++]);
+            I2CMasterControl(base, (x->pos == x->len) ? I2C_MASTER_CMD_BURST_SEND_FINISH :
+                                                            I2C_MASTER_CMD_BURST_SEND_CONT);
             return false;
+
+        case XFER_RX:
+            x->buf[x->pos++] = (uint8_t)I2CMasterDataGet(base);
+            if(x->pos == x->len)
+                break;
+            I2CMasterControl(base, (x->pos + 1 == x->len) ? I2C_MASTER_CMD_BURST_RECEIVE_FINISH :
+                                                                I2C_MASTER_CMD_BURST_RECEIVE_CONT);
+            return false;
+
+        default:
+            break;
+    }
+    x->state = XFER_DONE;
+    return true;
+}
+
+void i2c_bus_isr(i2c_bus_t *bus)
+{
+    BaseType_t woken = pdFALSE;
+    i2c_xfer_t *x = bus->current;
+
+    I2CMasterIntClear(bus->base);
+    if(x && x->state != XFER_DONE && i2cStep(x))
+        xTaskNotifyFromISR(x->task, I2C_NOTIFY_BIT, eSetBits, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+void I2CIntHandler(void)
+{
+    i2c_bus_isr(&i2c_bus0);
+}
+
+void I2C1IntHandler(void)
+{
+    i2c_bus_isr(&i2c_bus1);
+}
+
+/* Before the scheduler runs interrupts stay masked, so spin on the controller */
+static void i2cPoll(i2c_xfer_t *x)
+{
+    uint32_t spins;
+
+    i2cStart(x);
+    do
+    {
+        for(spins = I2C_POLL_SPINS; I2CMasterBusy(x->bus->base); spins--)
+        {
+            if(!spins)  return;
         }
-        uint8_t temp = (uint8_t)I2CMasterDataGet(I2C_BASE);
-        //SemaphoreGive(i2cSem);
-        //while(I2CMasterBusBusy(I2C_BASE));
-        if(temp!=0xAB)  return false;
-        return true;
+        I2CMasterIntClear(x->bus->base);
+    }while(!i2cStep(x));
+}
+
+/* Start the transaction and block until the interrupt finishes it */
+static void i2cWait(i2c_xfer_t *x)
+{
+    TickType_t start, elapsed;
+    uint32_t bits;
+
+    x->task = xTaskGetCurrentTaskHandle();
+    taskENTER_CRITICAL();
+    x->bus->current = x;
+    i2cStart(x);
+    taskEXIT_CRITICAL();
+
+    /* only this driver's bit is cleared, the task may be notified for other reasons */
+    start = xTaskGetTickCount();
+    while(x->state != XFER_DONE)
+    {
+        elapsed = xTaskGetTickCount() - start;
+        if(elapsed >= pdMS_TO_TICKS(I2C_TIMEOUT_MS))
+            break;
+        xTaskNotifyWait(0, I2C_NOTIFY_BIT, &bits, pdMS_TO_TICKS(I2C_TIMEOUT_MS) - elapsed);
+    }
+
+    taskENTER_CRITICAL();
+    x->bus->current = NULL;
+    taskEXIT_CRITICAL();
+}
+
+/* Run one transaction with the controller's mutex held or before the scheduler */
+static bool i2cRun(i2c_bus_t *bus, uint8_t addr, uint8_t reg, uint8_t *buf, uint32_t len, bool read,
+                   bool running)
+{
+    i2c_xfer_t x;
+
+    x.bus = bus;
+    x.addr = addr;
+    x.reg = reg;
+    x.buf = buf;
+    x.len = len;
+    x.read = read;
+    if(running)
+        i2cWait(&x);
+    else
+        i2cPoll(&x);
+
+    bus->stats.transactions++;
+    if(x.state != XFER_DONE)
+    {
+        /* controller hung, release the bus */
+        I2CMasterControl(bus->base, I2C_MASTER_CMD_BURST_SEND_ERROR_STOP);
+        bus->stats.timeouts++;
+        x.error = I2C_MASTER_ERR_CLK_TOUT;
+    }
+    else if(x.error & (I2C_MASTER_ERR_ADDR_ACK | I2C_MASTER_ERR_DATA_ACK))
+        bus->stats.nacks++;
+    else if(x.error & I2C_MASTER_ERR_ARB_LOST)
+        bus->stats.arbLost++;
+    else if(x.error != I2C_MASTER_ERR_NONE)
+        bus->stats.errors++;
+    return x.error == I2C_MASTER_ERR_NONE;
+}
+
+/* Run one transaction with a device, true when every byte was acknowledged */
+static bool i2cTransfer(const i2c_dev_t *dev, uint8_t reg, uint8_t *buf, uint32_t len, bool read)
+{
+    i2c_bus_t *bus = dev->bus;
+    bool running = (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING);
+    bool ok = true;
+
+    if(running)
+        xSemaphoreTake(bus->sem, portMAX_DELAY);
+
+    /* switch the mux first, a failed switch leaves it unknown */
+    if(dev->channel != I2C_NO_MUX && bus->muxChannel != dev->channel)
+    {
+        ok = i2cRun(bus, I2C_MUX_ADDRESS, 1 << dev->channel, NULL, 0, false, running);
+        bus->muxChannel = ok ? dev->channel : I2C_NO_MUX;
+    }
+    if(ok)
+        ok = i2cRun(bus, dev->addr, reg, buf, len, read, running);
+
+    if(running)
+        xSemaphoreGive(bus->sem);
+    return ok;
+}
+
+bool i2c_dev_read(const i2c_dev_t *dev, uint8_t reg, uint8_t *val)
+{
+    return i2cTransfer(dev, reg, val, 1, true);
+}
+
+bool i2c_dev_write(const i2c_dev_t *dev, uint8_t reg, uint8_t val)
+{
+    return i2cTransfer(dev, reg, &val, 1, false);
+}
+
+bool i2c_read(uint8_t reg, uint8_t *temp)
+{
+    return i2c_dev_read(&i2cSensor, reg, temp);
+}
+
+bool i2c_readID()
+{
+    uint8_t temp;
+
+    if(!i2c_read(0x92, &temp))   return false;
+    if(temp!=0xAB)  return false;
+    return true;
 }
 
 bool i2c_write(uint8_t reg, uint8_t val)
 {
-        //SemaphoreTake(i2cSem, portMAX_DELAY);
-        I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, false);
-        //
-        // Place the character to be sent in the data register
-        //
-        I2CMasterDataPut(I2C_BASE, reg);
-        //
-        // Initiate send of character from Master to Slave
-        //
-        I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_BURST_SEND_START);
-        //
-        // Delay until transmission completes
-        //
-        while(I2CMasterBusy(I2C_BASE));
+    return i2c_dev_write(&i2cSensor, reg, val);
+}
 
-        //I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, false);
-        I2CMasterDataPut(I2C_BASE, val);
-        //I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_BURST_SEND_CONT);
-        //
-        // Initiate send of character from Master to Slave
-        //
-        I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_BURST_SEND_FINISH);
-        //
-        // Delay until transmission completes
-        //
-        while(I2CMasterBusy(I2C_BASE));
-        //xSemaphoreGive(i2cSem);
-        return true;
+void i2c_bus_get_stats(i2c_bus_t *bus, i2c_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = bus->stats;
+    taskEXIT_CRITICAL();
+}
+
+void i2c_get_stats(i2c_stats_t *stats)
+{
+    i2c_bus_get_stats(&i2c_bus0, stats);
+}
+
+void i2c_bus_init(i2c_bus_t *bus)
+{
+    SysCtlPeripheralDisable(bus->periph);
+    SysCtlPeripheralReset(bus->periph);
+    SysCtlPeripheralEnable(bus->periph);
+    while(!SysCtlPeripheralReady(bus->periph));
+
+    /* Enable and initialize the Master module
+     * data transfer rate 400kbps */
+    I2CMasterInitExpClk(bus->base, g_ui32SysClock, true);
+
+    /* the interrupt advances transactions once the scheduler runs */
+    if(!bus->sem)
+        bus->sem = xSemaphoreCreateMutex();
+    bus->muxChannel = I2C_NO_MUX;
+    I2CMasterIntClear(bus->base);
+    I2CMasterIntEnable(bus->base);
+    IntPrioritySet(bus->interrupt, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    IntEnable(bus->interrupt);
 }
 
 void i2c_setup()
@@ -149,14 +352,23 @@ void i2c_setup()
         GPIOPinTypeI2C(GPIO_PORTB_BASE, GPIO_PIN_3);
 
         // Enable I2C0 peripheral
-        SysCtlPeripheralDisable(SYSCTL_PERIPH_I2C0);
-        SysCtlPeripheralReset(SYSCTL_PERIPH_I2C0);
-        SysCtlPeripheralEnable(SYSCTL_PERIPH_I2C0);
-        while(!SysCtlPeripheralReady(SYSCTL_PERIPH_I2C0));
+        i2c_bus_init(&i2c_bus0);
+}
 
-        /* Enable and initialize I2C0 Master module
-         * data transfer rate 400kbps */
-        I2CMasterInitExpClk(I2C0_BASE, g_ui32SysClock, true);
+/* A second sensor on its own controller */
+void i2c_setup1()
+{
+        // Enable GPIOG peripheral
+        SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOG);
+        while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOG));
+
+        // Set PG0 to SCL, PG1 to SDA
+        GPIOPinConfigure(GPIO_PG0_I2C1SCL);
+        GPIOPinConfigure(GPIO_PG1_I2C1SDA);
+        GPIOPinTypeI2CSCL(GPIO_PORTG_BASE, GPIO_PIN_0);
+        GPIOPinTypeI2C(GPIO_PORTG_BASE, GPIO_PIN_1);
+
+        i2c_bus_init(&i2c_bus1);
 }
 
 void i2c_BBGSetup()
@@ -186,44 +398,38 @@ void i2c_BBGSetup()
         I2CSlaveInit(I2C2_BASE, 0x69);
 }
 
+/*
+ * Read len bytes starting at reg in one transaction: register write,
+ * repeated start, then a burst receive. Reading the gesture FIFO this way
+ * returns consecutive U/D/L/R datasets. Returns len or -1 on a bus error.
+ */
 int ReadDataBlock(uint8_t reg, uint8_t *val, unsigned int len)
 {
-    unsigned char i = 0, j=0;
-    //xSemaphoreTake(i2cSem, portMAX_DELAY);
-    while(i<len)
-    {
-        for(j=0; j<4; j++)
-        {
-                // Indicate which register we want to read from
-                I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, false);
-                //
-                // Place the character to be sent in the data register
-                //
-                I2CMasterDataPut(I2C_BASE, (0xFC+j));
-                //
-                // Initiate send of character from Master to Slave
-                //
-                I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_SINGLE_SEND);
-                //
-                // Delay until transmission completes
-                //
-                while(I2CMasterBusy(I2C_BASE));
-
-                I2CMasterSlaveAddrSet(I2C_BASE, SLAVE_ADDRESS, true);
-
-                I2CMasterControl(I2C_BASE, I2C_MASTER_CMD_SINGLE_RECEIVE);
-                //
-                // Delay until transmission completes
-                //
-                while(I2CMasterBusy(I2C_BASE));
-                val[i] = (uint8_t)I2CMasterDataGet(I2C_BASE);
-                while(I2CMasterBusy(I2C_BASE));
-                i++;
-        }
-        j=0;
-    }
-    //SemaphoreGive(i2cSem);
-    return i;
+    return i2c_dev_read_block(&i2cSensor, reg, val, len);
+}
+
+int i2c_dev_read_block(const i2c_dev_t *dev, uint8_t reg, uint8_t *val, unsigned int len)
+{
+    if(!len)    return 0;
+    if(!i2cTransfer(dev, reg, val, len, true))   return -1;
+    return len;
+}
+
+/*
+ * Write len bytes to consecutive registers starting at reg in one
+ * transaction, relying on the sensor's address auto-increment.
+ * Returns len or -1 on a bus error.
+ */
+int WriteDataBlock(uint8_t reg, const uint8_t *val, unsigned int len)
+{
+    return i2c_dev_write_block(&i2cSensor, reg, val, len);
+}
+
+int i2c_dev_write_block(const i2c_dev_t *dev, uint8_t reg, const uint8_t *val, unsigned int len)
+{
+    if(!len)    return 0;
+    if(!i2cTransfer(dev, reg, (uint8_t *)val, len, false))   return -1;
+    return len;
 }
 
 bool i2c_BBGSend(char *ptr, uint8_t len)
@@ -0,0 +1,143 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file link_frame.c
+* @brief Framing, checksum and resynchronisation for the TIVA - BBG link
+*
+* This file is built into both the TIVA image and the BBG application
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "driverlib/sw_crc.h"
+#include "include/link_frame.h"
+
+#define FRAME_CRC_INIT  (0xFFFF)
+
+uint16_t frame_encode(uint8_t *out, uint8_t type, uint8_t seq,
+                      const void *payload, uint8_t len)
+{
+    uint16_t crc;
+
+    if(len > FRAME_MAX_PAYLOAD)
+        return 0;
+
+    out[0] = FRAME_SYNC0;
+    out[1] = FRAME_SYNC1;
+    out[2] = type;
+    out[3] = seq;
+    out[4] = len;
+    if(len)
+        memcpy(&out[FRAME_HEADER_SIZE], payload, len);
+
+    crc = Crc16(FRAME_CRC_INIT, &out[2], len + 3);
+    out[FRAME_HEADER_SIZE + len] = crc & 0xFF;
+    out[FRAME_HEADER_SIZE + len + 1] = crc >> 8;
+
+    return len + FRAME_OVERHEAD;
+}
+
+void frame_parser_init(frame_parser_t *parser)
+{
+    memset(parser, 0, sizeof(*parser));
+}
+
+/* Drop n bytes from the front of the buffer */
+static void consume(frame_parser_t *parser, uint16_t n)
+{
+    parser->count -= n;
+    memmove(parser->buf, &parser->buf[n], parser->count);
+}
+
+/* Discard bytes up to the next possible sync word, starting at offset from */
+static void hunt(frame_parser_t *parser, uint16_t from)
+{
+    uint16_t i;
+
+    for(i = from; i < parser->count; i++)
+    {
+        if(parser->buf[i] == FRAME_SYNC0 &&
+           (i + 1 == parser->count || parser->buf[i + 1] == FRAME_SYNC1))
+        {
+            break;
+        }
+    }
+    parser->stats.bytes_skipped += i;
+    consume(parser, i);
+}
+
+uint32_t frame_parser_feed(frame_parser_t *parser, const uint8_t *data, size_t len,
+                           frame_handler_t handler, void *arg)
+{
+    uint32_t delivered = 0;
+    uint16_t size, crc;
+    size_t space;
+    frame_t frame;
+
+    while(len)
+    {
+        /* Take as much input as fits */
+        space = sizeof(parser->buf) - parser->count;
+        if(space > len)
+            space = len;
+        memcpy(&parser->buf[parser->count], data, space);
+        parser->count += space;
+        data += space;
+        len -= space;
+
+        for(;;)
+        {
+            hunt(parser, 0);
+            if(parser->count < FRAME_HEADER_SIZE)
+                break;
+
+            frame.len = parser->buf[4];
+            if(frame.len > FRAME_MAX_PAYLOAD)
+            {
+                parser->stats.len_errors++;
+                hunt(parser, 1);
+                continue;
+            }
+
+            size = frame.len + FRAME_OVERHEAD;
+            if(parser->count < size)
+                break;
+
+            crc = parser->buf[size - 2] | (parser->buf[size - 1] << 8);
+            if(Crc16(FRAME_CRC_INIT, &parser->buf[2], frame.len + 3) != crc)
+            {
+                /* The real frame may start inside this one: rescan from here */
+                parser->stats.crc_errors++;
+                hunt(parser, 1);
+                continue;
+            }
+
+            frame.type = parser->buf[2];
+            frame.seq = parser->buf[3];
+            frame.payload = &parser->buf[FRAME_HEADER_SIZE];
+            if(parser->synced)
+                parser->stats.lost += (uint8_t)(frame.seq - parser->next_seq);
+            parser->next_seq = frame.seq + 1;
+            parser->synced = true;
+            parser->stats.frames++;
+            delivered++;
+
+            if(handler)
+                handler(&frame, arg);
+            consume(parser, size);
+        }
+    }
+    return delivered;
+}
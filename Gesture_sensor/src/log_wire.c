@@ -0,0 +1,116 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file log_wire.c
+* @brief Compact wire encoding of log records for the TIVA - BBG link
+*
+* This file is built into both the TIVA image and the BBG application
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "include/logger.h"
+#include "include/log_wire.h"
+
+/* level - LOG_LEVEL_INIT in the high nibble, source in the low nibble */
+#define WIRE_LEVEL_MAX      (0xF)
+#define WIRE_SOURCE_CLIENT  (0xF)
+
+static const char * const msgText[LOG_MSG_COUNT] =
+{
+#define LOG_MSG(id, text)   text,
+#include "include/log_msg.def"
+#undef LOG_MSG
+};
+
+static uint8_t putVarint(uint8_t *out, uint32_t value)
+{
+    uint8_t n = 0;
+
+    while(value >= 0x80)
+    {
+        out[n++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = value;
+    return n;
+}
+
+static bool getVarint(const uint8_t **in, const uint8_t *end, uint32_t *value)
+{
+    uint32_t result = 0;
+    uint8_t shift;
+
+    for(shift = 0; shift < 35; shift += 7)
+    {
+        if(*in == end)
+            return false;
+        result |= (uint32_t)(**in & 0x7F) << shift;
+        if(!(*(*in)++ & 0x80))
+        {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint8_t log_wire_encode(uint8_t *out, const log_wire_t *rec)
+{
+    uint8_t n = 0, source;
+
+    if(rec->log_level < LOG_LEVEL_INIT || rec->log_level - LOG_LEVEL_INIT > WIRE_LEVEL_MAX)
+        return 0;
+    if(rec->log_source == LOG_SOURCE_CLIENT)
+        source = WIRE_SOURCE_CLIENT;
+    else if(rec->log_source < WIRE_SOURCE_CLIENT)
+        source = rec->log_source;
+    else
+        return 0;
+
+    out[n++] = ((rec->log_level - LOG_LEVEL_INIT) << 4) | source;
+    n += putVarint(&out[n], rec->msg);
+    n += putVarint(&out[n], rec->value);
+    n += putVarint(&out[n], rec->timestamp);
+    return n;
+}
+
+bool log_wire_decode(const uint8_t *in, uint8_t len, log_wire_t *rec)
+{
+    const uint8_t *end = in + len;
+    uint32_t msg;
+
+    if(!len)
+        return false;
+    rec->log_level = (*in >> 4) + LOG_LEVEL_INIT;
+    rec->log_source = *in & 0x0F;
+    if(rec->log_source == WIRE_SOURCE_CLIENT)
+        rec->log_source = LOG_SOURCE_CLIENT;
+    in++;
+
+    if(!getVarint(&in, end, &msg) || msg > UINT16_MAX)
+        return false;
+    rec->msg = msg;
+    if(!getVarint(&in, end, &rec->value) || !getVarint(&in, end, &rec->timestamp))
+        return false;
+    return in == end;
+}
+
+const char *log_wire_text(uint16_t msg)
+{
+    if(msg >= LOG_MSG_COUNT)
+        return NULL;
+    return msgText[msg];
+}
@@ -26,15 +26,26 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
 #include "driverlib/sysctl.h"
 #include "include/gesture_sensor.h"
 #include "driverlib/uart.h"
 #include "driverlib/rom.h"
 #include "include/i2c_comm.h"
+#include "include/apds_regs.h"
+#include "include/gesture_stream.h"
+#include "include/gesture_grammar.h"
+#include "include/gesture_calib.h"
+#include "include/gesture_trace.h"
+#include "include/relay_queue.h"
 #include "include/uart_comm.h"
 #include "include/logger.h"
+#include "include/log_wire.h"
+#include "include/link_frame.h"
+#include "include/api_wire.h"
 #include "driverlib/timer.h"
 #include "driverlib/hibernate.h"
 #include "task.h"
@@ -46,43 +57,135 @@
 ********************************************************************************************************/
 #define STACK_SIZE (1024)
 #define SYSTEM_CLOCK (32000000U)
+#define GESTURE_IDLE_MS (500)      /* gesture task wake up for the heartbeat */
+#define RELAY_IDLE_MS   (500)      /* relay task wake up for the heartbeat */
+/* LOG_MSG_RELAY_CYCLE: gesture ms << 20 | commands << 16 | changed << 8 | state,
+ * with the ms from the gesture's last FIFO data when a gesture's command went */
+#define RELAY_CYCLE_GESTURE     (0x80000000U)
+#define RELAY_CYCLE_MS_MAX      (0x7FF)
+/* LOG_MSG_I2C_NACKS, LOG_MSG_I2C_BUS_ERRORS: room << 24 | count on its bus */
+#define I2C_STATS_ROOM_SHIFT    (24)
+#define I2C_STATS_COUNT_MASK    (0xFFFFFF)
+#ifndef GESTURE_ROOMS
+#define GESTURE_ROOMS   (1)        /* sensors, each with its own gesture task */
+#endif
+#if GESTURE_ROOMS > 2
+#error "rooms table has two entries"
+#endif
+/* gesture_room_t.modeRequest */
+#define GESTURE_REQ_ENABLE      (1)
+#define GESTURE_REQ_DISABLE     (2)
+
+
+/* Where the calibration starts, as enableGestureSensor leaves the sensor */
+static const gesture_calib_setting_t calibStart =
+{
+    GGAIN_2X, DEFAULT_GLDRIVE,
+    { GESTURE_THRESHOLD_OUT, GESTURE_SENSITIVITY_1, GESTURE_SENSITIVITY_2 }
+};
+
+/* One sensor, its INT pin on port A and what its gesture task keeps */
+typedef struct gesture_room
+{
+    gesture_sensor_t *sensor;
+    uint8_t intPin;
+    gesture_grammar_t grammar;
+    gesture_calib_t calib;
+    int sent;                       /* last direction given to the relay task */
+    volatile uint8_t gainRequest;   /* GGAIN_ + 1 asked for by the BBG, 0 if none */
+    volatile uint8_t modeRequest;   /* GESTURE_REQ_ asked for by the BBG, 0 if none */
+}gesture_room_t;
+
+static gesture_sensor_t sensor1;
+static gesture_room_t rooms[GESTURE_ROOMS] =
+{
+    { &gesture_sensor0, GPIO_PIN_6 },
+#if GESTURE_ROOMS > 1
+    { &sensor1,         GPIO_PIN_7 },   /* I2C1 on PG0/PG1 */
+#endif
+};
+static relay_queue_t relayQueue;    /* commands for the relay task */
+static volatile bool traceOn;       /* stream FIFO bursts to BBG */
+static uint8_t traceId, traceFlags;
+static uint32_t traceDropped;
 
-volatile uint8_t int_status;
 uint32_t g_ui32SysClock;
 char ui8PrintBuffer[32];
 TaskHandle_t MainTask, GestureTask, RelayTask, taskNotify1, HeartBeatTask, bbgReceiveTask;
 uint8_t uin8bbgSend;
-SemaphoreHandle_t TermSem, HBGesture, HBRelay, bbgSendSem, bbgSocketSem;// i2cSem;
+SemaphoreHandle_t HBGesture, HBRelay, bbgSendSem;// i2cSem;
+
+/* Queue relay actions in one go, so the relay task finds them all at its
+ * next wake up; queued[i] is false when action i was dropped */
+static void relayCommands(const uint8_t *action, uint8_t count, bool *queued)
+{
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+    uint8_t i;
+
+    taskENTER_CRITICAL();
+    for(i = 0; i < count; i++)
+        queued[i] = relay_queue_push(&relayQueue, action[i], now);
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(taskNotify1);
+}
+
+/* Queue a relay action for a gesture that ended at endTick and wake the relay task */
+static void relayGestureCommand(uint8_t action, TickType_t endTick)
+{
+    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
+
+    taskENTER_CRITICAL();
+    relay_queue_push_gesture(&relayQueue, action, endTick * portTICK_PERIOD_MS, now);
+    taskEXIT_CRITICAL();
+    xTaskNotifyGive(taskNotify1);
+}
 
 /********************************************************************************************************
 *
 * @name LOG
 * @brief send data to BBG
 *
-* This function sends the structure LOGGER_T
-* data to BBG
+* This function sends the record to BBG in the
+* compact encoding, msg is an index in log_msg.def.
+* The terminal gets the full LOGGER_T text.
 *
 * @param SOURCE, LEVEL, MSG, VALUE
 *
 * @return true on success and false on failure
 *
 ********************************************************************************************************/
-bool LOG(uint32_t source, uint32_t level, char *ptr, uint32_t data)
+bool LOG(uint32_t source, uint32_t level, log_msg_t msg, uint32_t data)
 {
-    if(!ptr)    return false;
-    xSemaphoreTake(bbgSendSem, portMAX_DELAY);
+    log_wire_t rec;
     Logger_t logging;
-    memcpy(&logging, '\0', sizeof(Logger_t));
-    logging.timestamp = HibernateRTCGet();
-    logging.log_level = level;
-    logging.log_source = source;
-    logging.value = data;
-    memcpy(logging.msg, '\0', MSG_SIZE);
-    memcpy(logging.msg, ptr, MSG_SIZE);
-    BBGSend((char *)&logging, sizeof(Logger_t));
-    memcpy(logging.msg, '\0', MSG_SIZE);
+    uint8_t wire[LOG_WIRE_MAX_SIZE], len;
+    bool status;
+
+    if(msg >= LOG_MSG_COUNT)    return false;
+    rec.timestamp = HibernateRTCGet();
+    rec.log_level = level;
+    rec.log_source = source;
+    rec.value = data;
+    rec.msg = msg;
+
+    xSemaphoreTake(bbgSendSem, portMAX_DELAY);
+    len = log_wire_encode(wire, &rec);
+    if(uin8bbgSend && len)
+    {
+        status = BBGSendFrame(FRAME_TYPE_LOG_COMPACT, wire, len);
+    }
+    else
+    {
+        memset(&logging, 0, sizeof(Logger_t));
+        logging.timestamp = rec.timestamp;
+        logging.log_level = level;
+        logging.log_source = source;
+        logging.value = data;
+        strncpy(logging.msg, log_wire_text(msg), MSG_SIZE);
+        status = BBGSend((char *)&logging, sizeof(Logger_t));
+    }
     xSemaphoreGive(bbgSendSem);
-    return true;
+    return status;
 }
 
 /* Configure Timer as RTC for timestamp*/
@@ -95,16 +198,28 @@ void TimerConfig(void)
     HibernateRTCEnable();
 }
 
-/* GPIO Interrupt Handler */
+/* GPIO Interrupt Handler, the APDS-9960 INT lines on port A */
 void PortAIntHandler(void)
 {
-    GPIOIntDisable(GPIO_PORTA_BASE, GPIO_INT_PIN_6);
-    int_status = 1;
+    BaseType_t woken = pdFALSE;
+    uint32_t status = GPIOIntStatus(GPIO_PORTA_BASE, true);
+    int i;
+
+    GPIOIntClear(GPIO_PORTA_BASE, status);
+    for(i = 0; i < GESTURE_ROOMS; i++)
+    {
+        if(status & rooms[i].intPin)
+            gesture_sensor_signal_from_isr(rooms[i].sensor, &woken);
+    }
+    portYIELD_FROM_ISR(woken);
 }
 
-/*Enable the GPIO Interrupt*/
-void interruptEnable()
+/*Enable the GPIO Interrupt of one sensor's INT pin. Each room's gesture
+ * task arms its own pin, and the port A writes are read-modify-write, so
+ * they run in a critical section*/
+void interruptEnable(uint8_t pins)
 {
+    taskENTER_CRITICAL();
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     //
     // Wait for the GPIOA module to be ready.
@@ -113,9 +228,13 @@ void interruptEnable()
     {
     }
     GPIOIntRegister(GPIO_PORTA_BASE, PortAIntHandler);
-    GPIOPinTypeGPIOInput(GPIO_PORTA_BASE, GPIO_PIN_6);
-    GPIOIntTypeSet(GPIO_PORTA_BASE, GPIO_PIN_6, GPIO_FALLING_EDGE);
-    GPIOIntEnable(GPIO_PORTA_BASE, GPIO_PIN_6);
+    GPIOPinTypeGPIOInput(GPIO_PORTA_BASE, pins);
+    GPIOIntTypeSet(GPIO_PORTA_BASE, pins, GPIO_FALLING_EDGE);
+    /* the handler gives a semaphore, critical sections have to mask it */
+    IntPrioritySet(INT_GPIOA, configMAX_SYSCALL_INTERRUPT_PRIORITY);
+    GPIOIntClear(GPIO_PORTA_BASE, pins);
+    GPIOIntEnable(GPIO_PORTA_BASE, pins);
+    taskEXIT_CRITICAL();
 }
 
 /* Enable the GPIO for Relay */
@@ -175,9 +294,14 @@ bool StartupTest()
 {
     TimerConfig();
     i2c_setup();
+    apds_reg_init(&gesture_sensor0.regs, &gesture_sensor0.dev);
+#if GESTURE_ROOMS > 1
+    i2c_setup1();
+    gesture_sensor_init(&sensor1, &i2c_bus1, I2C_NO_MUX);
+#endif
     if(!i2c_readID())
     {
-            LOG(LOG_SOURCE_MAIN, LOG_LEVEL_ERROR, "[TIVA] SensorNotConnected", NULL);
+            LOG(LOG_SOURCE_MAIN, LOG_LEVEL_ERROR, LOG_MSG_SENSOR_NOT_CONNECTED, NULL);
             return false;
     }
     /*if(!i2c_read(APDS9960_ID, &value))
@@ -208,72 +332,39 @@ bool StartupTest()
 void vRelayTask(void *parameters)
 {
     RelayGPIOEnable();
-    uint32_t temp;
+    relay_cycle_t cycle;
+    TickType_t woken, wait = pdMS_TO_TICKS(RELAY_IDLE_MS);
+    uint32_t value, ms;
     for(;;)
     {
-        /* Wait for notification from Gesture Task */
-        xTaskNotifyWait(0xFFFFFFFF, 0xFFFFFFFF, &temp, pdMS_TO_TICKS(500));
-        if(temp != 0xFFFFFFFF)
+        /* Wait for a command, or for the head of the queue to be due */
+        ulTaskNotifyTake(pdTRUE, wait);
+        woken = xTaskGetTickCount();
+        taskENTER_CRITICAL();
+        relay_queue_run(&relayQueue, woken * portTICK_PERIOD_MS, &cycle);
+        taskEXIT_CRITICAL();
+        if(cycle.changed & 0x01)
+            GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, (cycle.state & 0x01) ? GPIO_PIN_0 : 0);
+        if(cycle.changed & 0x02)
+            GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, (cycle.state & 0x02) ? GPIO_PIN_0 : 0);
+        if(cycle.applied)
         {
-            /*Relay 0 operation ON */
-            if(temp == 0x01)
-            {
-                if((GPIOPinRead(GPIO_PORTK_BASE, GPIO_PIN_0)&GPIO_PIN_0))
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay0 is Already on", NULL);
-                else
-                {
-                    GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, 1);
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay0 : turned on", NULL);
-                }
-            }
-            /* Relay 1 control ON */
-            else if(temp == 0x02)
+            /* One entry for everything this wake up did, with the time from
+             * the gesture's last FIFO data when a gesture started it; an
+             * early decision can switch before the gesture is over */
+            value = cycle.applied << 16 | cycle.changed << 8 | cycle.state;
+            if(cycle.gestures)
             {
-                if((GPIOPinRead(GPIO_PORTM_BASE, GPIO_PIN_0)&GPIO_PIN_0))
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO,"[TIVA] Relay1 is Already on", NULL);
-                else
-                {
-                    GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, 1);
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay1 : turned on", NULL);
-                }
-            }
-            /* Relay 0 off */
-            else if(temp == 0x04)
-            {
-                if(!(GPIOPinRead(GPIO_PORTK_BASE, GPIO_PIN_0)&GPIO_PIN_0))
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay0 is Already off", NULL);
-                else
-                {
-                    GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, 0);
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay0 : turned off", NULL);
-                }
-            }
-            /* Relay 1 off */
-            else if(temp == 0x08)
-            {
-                if(!(GPIOPinRead(GPIO_PORTM_BASE, GPIO_PIN_0)&GPIO_PIN_0))
-                LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay1 is Already off", NULL);
-                else
-                {
-                    GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, 0);
-                    LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Relay1 : turned off", NULL);
-                }
-            }
-            /* Both relay ON*/
-            else if(temp == 0x10)
-            {
-                GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, 1);
-                GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, 1);
-                LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Both Relays : turned on", NULL);
-            }
-            /* Both Relay off */
-            else if(temp == 0x20)
-            {
-                GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, 0);
-                GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, 0);
-                LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, "[TIVA] Both Relays : turned off", NULL);
+                ms = woken * portTICK_PERIOD_MS - cycle.gestureEnd;
+                if((int32_t)ms < 0)
+                    ms = 0;
+                value |= RELAY_CYCLE_GESTURE | (ms < RELAY_CYCLE_MS_MAX ? ms : RELAY_CYCLE_MS_MAX) << 20;
             }
+            LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, LOG_MSG_RELAY_CYCLE, value);
         }
+        wait = pdMS_TO_TICKS(RELAY_IDLE_MS);
+        if(cycle.wait < RELAY_IDLE_MS)
+            wait = pdMS_TO_TICKS(cycle.wait) + 1;
         /* give the semaphore to heartbeat task*/
         xSemaphoreGive(HBRelay);
     }
@@ -294,14 +385,75 @@ void vRelayTask(void *parameters)
 void vHeartBeatTask(void *parameters)
 {
     SysCtlDelay(100000);
-    LOG(LOG_SOURCE_COMM, LOG_LEVEL_HEARTBEAT, "[TIVA] HB Task Initialised", NULL);
+    LOG(LOG_SOURCE_COMM, LOG_LEVEL_HEARTBEAT, LOG_MSG_HB_TASK_INITIALISED, NULL);
     uint32_t hbGestCount = 0;
     uint32_t hbRelayCount = 0;
+    bbg_tx_stats_t txStats;
+    uint32_t txDropped = 0, txHighWater = 0;
+    i2c_stats_t i2cStats;
+    uint32_t i2cNacks[GESTURE_ROOMS] = { 0 }, i2cBusErrors[GESTURE_ROOMS] = { 0 }, errors, i;
+    relay_queue_stats_t relayStats;
+    uint32_t relayHighWater = 0, relayDropped = 0, relayCoalesced = 0;
+    uint32_t traceReported = 0;
     for(;;)
     {
         SysCtlDelay(100000);
         /* Log the HeartBeat */
-        LOG(LOG_SOURCE_COMM, LOG_LEVEL_HEARTBEAT, "[TIVA] Heart beat from TIVA", NULL);
+        LOG(LOG_SOURCE_COMM, LOG_LEVEL_HEARTBEAT, LOG_MSG_HEART_BEAT_FROM_TIVA, NULL);
+        /* Report the BBG TX queue when it got fuller or dropped frames */
+        BBGGetTxStats(&txStats);
+        if(txStats.highWater != txHighWater)
+        {
+            txHighWater = txStats.highWater;
+            LOG(LOG_SOURCE_COMM, LOG_LEVEL_INFO, LOG_MSG_TX_HIGH_WATER, txHighWater);
+        }
+        if(txStats.dropped != txDropped)
+        {
+            txDropped = txStats.dropped;
+            LOG(LOG_SOURCE_COMM, LOG_LEVEL_WARNING, LOG_MSG_TX_FRAMES_DROPPED, txDropped);
+        }
+        /* Report new errors on each room's sensor bus */
+        for(i = 0; i < GESTURE_ROOMS; i++)
+        {
+            i2c_bus_get_stats(rooms[i].sensor->dev.bus, &i2cStats);
+            if(i2cStats.nacks != i2cNacks[i])
+            {
+                i2cNacks[i] = i2cStats.nacks;
+                LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_I2C_NACKS,
+                    i << I2C_STATS_ROOM_SHIFT | (i2cNacks[i] & I2C_STATS_COUNT_MASK));
+            }
+            errors = i2cStats.arbLost + i2cStats.timeouts + i2cStats.errors;
+            if(errors != i2cBusErrors[i])
+            {
+                i2cBusErrors[i] = errors;
+                LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_ERROR, LOG_MSG_I2C_BUS_ERRORS,
+                    i << I2C_STATS_ROOM_SHIFT | (errors & I2C_STATS_COUNT_MASK));
+            }
+        }
+        /* Report the relay queue when it got fuller, dropped or merged commands */
+        taskENTER_CRITICAL();
+        relay_queue_get_stats(&relayQueue, &relayStats);
+        taskEXIT_CRITICAL();
+        if(relayStats.highWater != relayHighWater)
+        {
+            relayHighWater = relayStats.highWater;
+            LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, LOG_MSG_RELAY_QUEUE_HIGH_WATER, relayHighWater);
+        }
+        if(relayStats.dropped != relayDropped)
+        {
+            relayDropped = relayStats.dropped;
+            LOG(LOG_SOURCE_RELAY, LOG_LEVEL_WARNING, LOG_MSG_RELAY_COMMANDS_DROPPED, relayDropped);
+        }
+        if(relayStats.coalesced != relayCoalesced)
+        {
+            relayCoalesced = relayStats.coalesced;
+            LOG(LOG_SOURCE_RELAY, LOG_LEVEL_INFO, LOG_MSG_RELAY_COMMANDS_COALESCED, relayCoalesced);
+        }
+        if(traceDropped != traceReported)
+        {
+            traceReported = traceDropped;
+            LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_TRACE_FRAMES_DROPPED, traceReported);
+        }
         SysCtlDelay(100000);
         UART_TerminalSend("[Heartbeat]\n\r");
         if(xSemaphoreTake(HBGesture, pdMS_TO_TICKS(1000))==pdTRUE)
@@ -313,7 +465,7 @@ void vHeartBeatTask(void *parameters)
             hbGestCount++;
             if(hbGestCount > 5)
             {
-                LOG(LOG_SOURCE_COMM, LOG_LEVEL_ERROR, "[TIVA] No HB from Gesture", NULL);
+                LOG(LOG_SOURCE_COMM, LOG_LEVEL_ERROR, LOG_MSG_NO_HB_FROM_GESTURE, NULL);
                 hbGestCount--;
             }
         }
@@ -326,19 +478,249 @@ void vHeartBeatTask(void *parameters)
             hbRelayCount++;
             if(hbRelayCount > 5)
             {
-                LOG(LOG_SOURCE_COMM, LOG_LEVEL_ERROR, "[TIVA] No HB from Relay", NULL);
+                LOG(LOG_SOURCE_COMM, LOG_LEVEL_ERROR, LOG_MSG_NO_HB_FROM_RELAY, NULL);
                 hbRelayCount--;
             }
         }
     }
 }
 
+/* Answer an API request with the record logged for it, echoing its id;
+ * a command that could not be carried out is logged as an error */
+static bool apiReply(const api_wire_request_t *req, bool ok, log_msg_t msg, uint32_t data)
+{
+    log_wire_t rec;
+    uint8_t payload[API_WIRE_REPLY_MAX_SIZE], len;
+    bool status;
+
+    if(!uin8bbgSend || !req->id)
+        return LOG(LOG_SOURCE_CLIENT, ok ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR, msg, data);
+
+    rec.timestamp = HibernateRTCGet();
+    rec.log_level = ok ? LOG_LEVEL_INFO : LOG_LEVEL_ERROR;
+    rec.log_source = LOG_SOURCE_CLIENT;
+    rec.value = data;
+    rec.msg = msg;
+    len = api_wire_encode_reply(payload, req, &rec);
+    xSemaphoreTake(bbgSendSem, portMAX_DELAY);
+    status = len && BBGSendFrame(FRAME_TYPE_API_REPLY, payload, len);
+    xSemaphoreGive(bbgSendSem);
+    return status;
+}
+
+static void apiResult(api_wire_result_t *result, bool ok, log_msg_t msg, uint32_t data)
+{
+    result->ok = ok;
+    result->msg = msg;
+    result->value = data;
+}
+
+/* Answer a batch with the result of each command, echoing its id */
+static bool apiBatchReply(const api_wire_request_t *req, const api_wire_result_t *result, uint8_t count)
+{
+    uint8_t payload[API_WIRE_BATCH_REPLY_MAX_SIZE], len;
+    bool status;
+
+    len = api_wire_encode_batch_reply(payload, req, result, count);
+    xSemaphoreTake(bbgSendSem, portMAX_DELAY);
+    status = len && BBGSendFrame(FRAME_TYPE_API_BATCH_REPLY, payload, len);
+    xSemaphoreGive(bbgSendSem);
+    return status;
+}
+
+/* Carry out one API command into result; a relay action is left in
+ * *relay for the caller to queue, 0 when there is none */
+static void apiCommand(uint8_t opcode, uint16_t arg, api_wire_result_t *result, uint8_t *relay)
+{
+    uint8_t status;
+
+    *relay = 0;
+    switch(opcode)
+    {
+        /* Relay 0 Status */
+        case 0x01:
+            if((GPIOPinRead(GPIO_PORTK_BASE, GPIO_PIN_0)&GPIO_PIN_0))
+            {
+                apiResult(result, true, LOG_MSG_STATUS_RELAY0_ON, 1);
+                UART_TerminalSend("API CALL 1\n\r");
+            }
+            else
+            {
+                apiResult(result, true, LOG_MSG_STATUS_RELAY0_TURNED_OFF, 0);
+                UART_TerminalSend("API CALL 2\n\r");
+            }
+            break;
+            /* Relay 1 status*/
+        case 0x02:
+            if((GPIOPinRead(GPIO_PORTM_BASE, GPIO_PIN_0)&GPIO_PIN_0))
+            {
+                apiResult(result, true, LOG_MSG_STATUS_RELAY1_ON, 1);
+                //UART_TerminalSend("API CALL 3\n\r");
+            }
+            else
+            {
+                apiResult(result, true, LOG_MSG_STATUS_RELAY1_TURNED_OFF, 0);
+                //UART_TerminalSend("API CALL 4\n\r");
+            }
+            break;
+            /* Read Gesture Sensor ID, of room arg */
+        case 0x03:
+            if(arg >= GESTURE_ROOMS || !i2c_dev_read(&rooms[arg].sensor->dev, APDS9960_ID, &status))
+            {
+                apiResult(result, false, LOG_MSG_READING_ID_FAILED, 0);
+                //UART_TerminalSend("API CALL 5\n\r");
+            }
+            else
+            {
+                apiResult(result, true, LOG_MSG_READING_ID_SUCCESS, status);
+                //UART_TerminalSend("API CALL 6\n\r");
+            }
+            break;
+            /* Disable gesture sensor of room arg, by its gesture task */
+        case 0x05:
+            if(arg >= GESTURE_ROOMS)
+            {
+                apiResult(result, false, LOG_MSG_GESTURE_DISABLE_FAILED, 0);
+                //UART_TerminalSend("API CALL 7\n\r");
+            }
+            else
+            {
+                rooms[arg].modeRequest = GESTURE_REQ_DISABLE;
+                apiResult(result, true, LOG_MSG_SENSOR_REQUEST_QUEUED, 1);
+                //UART_TerminalSend("API CALL 8\n\r");
+            }
+            break;
+            /* set gesture gain, on room arg; its gesture task owns the
+             * sensor and the calibration, so this only answers that the
+             * request is queued and the task logs how the write went */
+        case 0x06:
+            if(arg >= GESTURE_ROOMS)
+            {
+                //UART_TerminalSend("API CALL 9\n\r");
+                apiResult(result, false, LOG_MSG_SETTING_GAIN_FAILED, 0);
+            }
+            else
+            {
+                rooms[arg].gainRequest = GGAIN_4X + 1;
+                apiResult(result, true, LOG_MSG_SENSOR_REQUEST_QUEUED, 1);
+                //UART_TerminalSend("API CALL 10\n\r");
+            }
+            break;
+            /* enable gesture mode of room arg, by its gesture task */
+        case 0x04:
+            if(arg >= GESTURE_ROOMS)
+            {
+                apiResult(result, false, LOG_MSG_ENABLE_GESTURE_FAILED, 0);
+                //UART_TerminalSend("API CALL 11\n\r");
+            }
+            else
+            {
+                rooms[arg].modeRequest = GESTURE_REQ_ENABLE;
+                apiResult(result, true, LOG_MSG_SENSOR_REQUEST_QUEUED, 1);
+                //UART_TerminalSend("API CALL 12\n\r");
+            }
+            break;
+            /* turn on both relays */
+        case 0x07:
+            *relay = RELAYS_ON;
+            apiResult(result, true, LOG_MSG_BOTH_RELAYS_TURNED_ON, 1);
+            //UART_TerminalSend("API CALL 13\n\r");
+            break;
+        case 0x08:
+            /* turn off both relays */
+            *relay = RELAYS_OFF;
+            apiResult(result, true, LOG_MSG_BOTH_RELAYS_TURNED_OFF, 1);
+            //UART_TerminalSend("API CALL 14\n\r");
+            break;
+            /* start capturing gesture FIFO data */
+        case 0x09:
+            traceOn = true;
+            apiResult(result, true, LOG_MSG_TRACE_STARTED, 1);
+            break;
+            /* stop capturing gesture FIFO data */
+        case 0x0A:
+            traceOn = false;
+            apiResult(result, true, LOG_MSG_TRACE_STOPPED, 1);
+            break;
+            /* switch relay 0 on (arg 1) or off (arg 0) */
+        case 0x0B:
+            *relay = arg ? RELAY0_ON : RELAY0_OFF;
+            apiResult(result, true, arg ? LOG_MSG_RELAY0_TURNED_ON : LOG_MSG_RELAY0_TURNED_OFF, arg ? 1 : 0);
+            break;
+            /* switch relay 1 on (arg 1) or off (arg 0) */
+        case 0x0C:
+            *relay = arg ? RELAY1_ON : RELAY1_OFF;
+            apiResult(result, true, arg ? LOG_MSG_RELAY1_TURNED_ON : LOG_MSG_RELAY1_TURNED_OFF, arg ? 1 : 0);
+            break;
+        default:
+            /* answered, so the client is not left to time out */
+            apiResult(result, false, LOG_MSG_NO_RESPONSE, 0);
+            UART_TerminalSend("[BBG] No response\n\r");
+            break;
+    }
+}
+
+/* Run the commands of one request back to back and answer it, a batch
+ * with every result. Relay actions are queued together once all have
+ * run, so a scene switches in one relay task wake up. */
+static void apiRun(const api_wire_batch_t *batch, bool isBatch)
+{
+    api_wire_result_t result[API_WIRE_BATCH_MAX];
+    uint8_t action[API_WIRE_BATCH_MAX], which[API_WIRE_BATCH_MAX], relays = 0, i;
+    bool queued[API_WIRE_BATCH_MAX];
+
+    for(i = 0; i < batch->count; i++)
+    {
+        apiCommand(batch->cmd[i].opcode, batch->cmd[i].arg, &result[i], &action[relays]);
+        if(action[relays])
+            which[relays++] = i;
+    }
+    if(relays)
+    {
+        relayCommands(action, relays, queued);
+        for(i = 0; i < relays; i++)
+            if(!queued[i])
+                apiResult(&result[which[i]], false, LOG_MSG_RELAY_COMMANDS_DROPPED, 0);
+    }
+
+    if(isBatch)
+        apiBatchReply(&batch->req, result, batch->count);
+    else
+        apiReply(&batch->req, result[0].ok, (log_msg_t)result[0].msg, result[0].value);
+}
+
+/* One API request or batch frame from the BBG */
+static void bbgRequest(const frame_t *frame, void *arg)
+{
+    api_wire_batch_t batch;
+
+    if(frame->type == FRAME_TYPE_API_REQUEST &&
+       api_wire_decode_request(frame->payload, frame->len, &batch.req))
+    {
+        batch.count = 1;
+        batch.cmd[0].opcode = batch.req.opcode;
+        batch.cmd[0].arg = 0;
+    }
+    else if(frame->type != FRAME_TYPE_API_BATCH ||
+            !api_wire_decode_batch(frame->payload, frame->len, &batch))
+        return;
+    /* the BBG is listening again */
+    uin8bbgSend = 1;
+
+    if(frame->type == FRAME_TYPE_API_REQUEST && batch.req.opcode == API_OP_HEARTBEAT)
+        UART_TerminalSend("[BBG] HeartBeat from BBG\n\r");
+    else
+        apiRun(&batch, frame->type == FRAME_TYPE_API_BATCH);
+}
+
 /********************************************************************************************************
 *
 * @name vbbgReceive
 * @brief receive from BBG
 *
-* This task receives characters from BBG and also handles socket APIs
+* This task receives request frames from BBG and handles the socket APIs;
+* the replies echo each request's id, so the BBG may send several at once.
+* A batch frame runs all its commands before anything else is read
 *
 * @param None
 *
@@ -347,118 +729,16 @@ void vHeartBeatTask(void *parameters)
 ********************************************************************************************************/
 void vbbgReceive(void *parameters)
 {
+    static frame_parser_t parser;
+    uint8_t rx[16];
+    size_t count;
+
+    frame_parser_init(&parser);
     for(;;)
     {
-        if(xSemaphoreTake(bbgSocketSem, pdMS_TO_TICKS(5000)) == pdTRUE)
-        {
-            char recBuffer;
-            /* receive from BBG */
-            BBGReceive(&recBuffer);
-            uint8_t status;
-            switch((uint8_t)recBuffer)
-            {
-                /* Relay 0 Status */
-                case 0x01:
-                    if((GPIOPinRead(GPIO_PORTK_BASE, GPIO_PIN_0)&GPIO_PIN_0))
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Status Relay0 : on", 1);
-                        UART_TerminalSend("API CALL 1\n\r");
-                    }
-                    else
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Status Relay0 : turned off", 0);
-                        UART_TerminalSend("API CALL 2\n\r");
-                    }
-                    break;
-                    /* Relay 1 status*/
-                case 0x02:
-                    if((GPIOPinRead(GPIO_PORTM_BASE, GPIO_PIN_0)&GPIO_PIN_0))
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO,"[TIVA] Status Relay1 : on", 1);
-                        //UART_TerminalSend("API CALL 3\n\r");
-                    }
-                    else
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Status Relay1 : turned off", 0);
-                        //UART_TerminalSend("API CALL 4\n\r");
-                    }
-                    break;
-                    /* Read Gesture Sensor ID */
-                case 0x03:
-                    if( !i2c_read(APDS9960_ID, &status) )
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Reading ID Failed", 0);
-                        //UART_TerminalSend("API CALL 5\n\r");
-                    }
-                    else
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Reading ID Success", status);
-                        //UART_TerminalSend("API CALL 6\n\r");
-                    }
-                    break;
-                    /* Disable gesture sensor */
-                case 0x05:
-                    if(!disableGestureSensor())
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Gesture Disable Failed", 0);
-                        //UART_TerminalSend("API CALL 7\n\r");
-                    }
-                    else
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] GestureDisableSuccess", 1);
-                        //UART_TerminalSend("API CALL 8\n\r");
-                    }
-                    break;
-                    /* set gesture gain */
-                case 0x06:
-                    if(!setGestureGain(GGAIN_4X))
-                    {
-                        //UART_TerminalSend("API CALL 9\n\r");
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Setting Gain Failed", 0);
-                    }
-                    else
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] SettingGainSuccess", 1);
-                        //UART_TerminalSend("API CALL 10\n\r");
-                    }
-                    break;
-                    /* enable gesture mode */
-                case 0x04:
-                    if( !setMode(GESTURE, 1) )
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] EnableGestureFailed", 0);
-                        //UART_TerminalSend("API CALL 11\n\r");
-                    }
-                    else
-                    {
-                        LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Setting Gain Success", 1);
-                        //UART_TerminalSend("API CALL 12\n\r");
-                    }
-                    break;
-                    /* turn on both relays */
-                case 0x07:
-                    GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, 1);
-                    GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, 1);
-                    LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Both Relays: turned on", 1);
-                    //UART_TerminalSend("API CALL 13\n\r");
-                    break;
-                case 0x08:
-                    /* turn off both relays */
-                    GPIOPinWrite(GPIO_PORTK_BASE, GPIO_PIN_0, 0);
-                    GPIOPinWrite(GPIO_PORTM_BASE, GPIO_PIN_0, 0);
-                    LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] Both Relays: turned off", 1);
-                    //UART_TerminalSend("API CALL 14\n\r");
-                    break;
-                case 0x4D:
-                    UART_TerminalSend("[BBG] HeartBeat from BBG\n\r");
-                    break;
-                default:
-                    //LOG(LOG_SOURCE_CLIENT, LOG_LEVEL_INFO, "[TIVA] No response", 0);
-                    UART_TerminalSend("[BBG] No response\n\r");
-                    break;
-            }
-        SysCtlDelay(10000);
-        }
+        count = BBGReceive(rx, sizeof(rx), pdMS_TO_TICKS(5000));
+        if(count)
+            frame_parser_feed(&parser, rx, count, bbgRequest, NULL);
         else
             uin8bbgSend = 0;
     }
@@ -476,66 +756,275 @@ void vbbgReceive(void *parameters)
 * @return None
 *
 ********************************************************************************************************/
+/* Send one captured frame, a full TX queue drops it */
+static void traceSend(gesture_trace_t *rec)
+{
+    uint8_t payload[FRAME_MAX_PAYLOAD], len;
+
+    len = gesture_trace_encode(payload, rec);
+    xSemaphoreTake(bbgSendSem, portMAX_DELAY);
+    if(!len || !BBGSendFrame(FRAME_TYPE_GESTURE_TRACE, payload, len))
+        traceDropped++;
+    xSemaphoreGive(bbgSendSem);
+}
+
+/* FIFO bursts from readGesture while capture is on */
+static void gestureTraceBurst(const uint8_t *data, int bytes, TickType_t tick)
+{
+    gesture_trace_t rec;
+    int sets = bytes / 4;
+
+    if(!traceOn)
+        return;
+    rec.id = traceId;
+    rec.result = DIR_NONE;
+    rec.tick = tick;
+    while(sets)
+    {
+        rec.flags = traceFlags;
+        rec.count = sets > GESTURE_TRACE_MAX_SETS ? GESTURE_TRACE_MAX_SETS : sets;
+        rec.data = data;
+        traceSend(&rec);
+        traceFlags = 0;
+        data += rec.count * 4;
+        sets -= rec.count;
+    }
+}
+
+/* Close the captured gesture with the decision readGesture made */
+static void gestureTraceEnd(int dir)
+{
+    gesture_trace_t rec;
+
+    if(!traceOn || traceFlags)
+        return;
+    rec.flags = GESTURE_TRACE_END;
+    rec.id = traceId++;
+    rec.result = dir;
+    rec.tick = xTaskGetTickCount();
+    rec.count = 0;
+    rec.data = NULL;
+    traceSend(&rec);
+}
+
+/* The room of the calling gesture task */
+static gesture_room_t *gestureRoom(void)
+{
+    gesture_sensor_t *s = gesture_sensor_current();
+    int i;
+
+    for(i = 1; i < GESTURE_ROOMS; i++)
+    {
+        if(rooms[i].sensor == s)
+            return &rooms[i];
+    }
+    return &rooms[0];
+}
+
+/* Pass a gesture sequence's action to the relay task */
+static void gestureAct(gesture_room_t *room, const gesture_token_t *t)
+{
+#ifndef CONSOLE_DISABLE
+    static char *kindText[] = { "", "", "DOUBLE ", "U-TURN ", "HOLD " };
+    static char *dirText[] = { "No Gesture\n\r", "LEFT\n\r", "RIGHT\n\r", "UP\n\r",
+                               "DOWN\n\r", "NEAR\n\r", "FAR\n\r" };
+#endif
+
+    if(t->action)
+        relayGestureCommand(t->action, room->sensor->endTick);
+    if(t->kind != GGRAMMAR_SWIPE)
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_GESTURE_SEQUENCE, t->kind << 8 | t->dir);
+#ifndef CONSOLE_DISABLE
+    UART_TerminalSend(kindText[t->kind]);
+    UART_TerminalSend(dirText[t->dir]);
+#endif
+}
+
+/* Pass a single direction to the relay task */
+static void gestureNotify(gesture_room_t *room, int dir)
+{
+    gesture_token_t t;
+
+    gesture_grammar_token(&room->grammar, GGRAMMAR_SWIPE, dir, &t);
+    gestureAct(room, &t);
+    room->sent = dir;
+}
+
+/* Decisions made while the hand is still over the sensor, called from
+ * readGesture. The relay states are absolute, so a correction just sends
+ * the new direction. A direction that may start a sequence waits for
+ * the grammar. */
+static void gestureEarly(int dir, int event)
+{
+    gesture_room_t *room = gestureRoom();
+
+    if(!gesture_grammar_immediate(&room->grammar, dir))
+        return;
+    if(event == GSTREAM_DECIDED)
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_GESTURE_EARLY_SAMPLES, gestureDecidedAt());
+    else
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_GESTURE_CORRECTED, dir);
+    gestureNotify(room, dir);
+}
+
+/* Sample the room with no hand over the sensor and apply what the
+ * calibration settles on. A failed write keeps the old setting. */
+static void gestureCalibrate(gesture_room_t *room)
+{
+    gesture_calib_t *calib = &room->calib;
+    gesture_calib_t before = *calib;
+    uint8_t cdata[2], pdata;
+    uint32_t changed;
+
+    if(i2c_dev_read_block(&room->sensor->dev, APDS9960_CDATAL, cdata, 2) != 2 ||
+       !i2c_dev_read(&room->sensor->dev, APDS9960_PDATA, &pdata))
+    {
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_CALIB_FAILED, 0);
+        return;
+    }
+    changed = gesture_calib_sample(calib, cdata[0] | cdata[1] << 8, pdata);
+    if(((changed & GCALIB_GAIN) && !setGestureGain(calib->cur.gain)) ||
+       ((changed & GCALIB_LED_DRIVE) && !setGestureLEDDrive(calib->cur.ledDrive)))
+    {
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_CALIB_FAILED, changed);
+        *calib = before;
+        return;
+    }
+    room->sensor->tuning = calib->cur.tuning;
+    if(changed & GCALIB_GAIN)
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_CALIB_GAIN, 1 << calib->cur.gain);
+    if(changed & GCALIB_LED_DRIVE)
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_CALIB_LED_DRIVE, 100 >> calib->cur.ledDrive);
+    if(changed & GCALIB_THRESHOLD)
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_CALIB_THRESHOLD, calib->cur.tuning.thresholdOut);
+    if(changed & GCALIB_SENSITIVITY)
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_CALIB_SENSITIVITY,
+            calib->cur.tuning.sensitivity1 << 8 | calib->cur.tuning.sensitivity2);
+}
+
+/* Apply the gain the BBG asked for; calibration steps on from it */
+static void gestureSetGain(gesture_room_t *room)
+{
+    uint8_t gain = room->gainRequest - 1;
+
+    room->gainRequest = 0;
+    if(!setGestureGain(gain))
+    {
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_SETTING_GAIN_FAILED, gain);
+        return;
+    }
+    room->calib.cur.gain = gain;
+    LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_SETTING_GAIN_SUCCESS, 1 << gain);
+}
+
+/* Enable or disable gesture mode as the BBG asked */
+static void gestureSetMode(gesture_room_t *room)
+{
+    uint8_t request = room->modeRequest;
+
+    room->modeRequest = 0;
+    if(request == GESTURE_REQ_ENABLE)
+    {
+        if(!setMode(GESTURE, 1))
+            LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_ENABLE_GESTURE_FAILED, 0);
+        else
+            LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_SENSOR_ENABLED, 0);
+    }
+    else if(!disableGestureSensor())
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_GESTURE_DISABLE_FAILED, 0);
+    else
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_GESTURE_DISABLE_SUCCESS, 0);
+}
+
 void vGestureTask(void *parameters)
 {
+    gesture_room_t *room = parameters;
+    TickType_t calibrated;
+    gesture_token_t tokens[2];
+    TickType_t start, end;
+    uint32_t wait;
+    int dir, n, i;
+
     UART_TerminalSend("GestureTaskCreated\n\r");
-    LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INIT, "[TIVA] Gesture Task Created", NULL);
+    LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INIT, LOG_MSG_GESTURE_TASK_CREATED, NULL);
+    /* the driver calls below work on this room's sensor */
+    gesture_sensor_bind(room->sensor);
     if(!sensor_init())
     {
-        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_ERROR, "[TIVA] Sensor Init Failed", NULL);
-        vTaskDelete(GestureTask);
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_ERROR, LOG_MSG_SENSOR_INIT_FAILED, NULL);
+        vTaskDelete(NULL);
     }
     else
     {
-        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INIT, "[TIVA] Sensor Initialized", NULL);
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INIT, LOG_MSG_SENSOR_INITIALIZED, NULL);
+        /* armed before GIEN is set, so the first INT edge is not missed */
+        interruptEnable(room->intPin);
         if(!enableGestureSensor(true))
         {
-            LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_ERROR, "[TIVA] Sensor Enable Failed", NULL);
+            LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_ERROR, LOG_MSG_SENSOR_ENABLE_FAILED, NULL);
             while(1);
         }
-        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INIT, "[TIVA] Sensor Enabled", NULL);
-        interruptEnable();
+        LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INIT, LOG_MSG_SENSOR_ENABLED, NULL);
+        /* CDATA for the calibration, ALS runs between gesture cycles */
+        if(!setMode(AMBIENT_LIGHT, 1))
+            LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_WARNING, LOG_MSG_CALIB_FAILED, 0);
+        gesture_calib_init(&room->calib, &calibStart);
+        calibrated = xTaskGetTickCount();
+        gesture_grammar_init(&room->grammar, gesture_grammar_rules, gesture_grammar_rule_count,
+                             GGRAMMAR_GAP_MS, GGRAMMAR_HOLD_MS);
+        setGestureCallback(gestureEarly);
+        /* capture follows the first room */
+        if(room == rooms)
+            setGestureTrace(gestureTraceBurst);
         while(1)
         {
-            if(int_status)
+            /* Sleep until the sensor raises INT, or a pending swipe is due. GVALID
+             * is checked on a timeout too: INT stays low after a missed edge until
+             * the FIFO is read. */
+            wait = gesture_grammar_wait(&room->grammar, xTaskGetTickCount() * portTICK_PERIOD_MS);
+            gestureWaitFifo(wait < GESTURE_IDLE_MS ? wait : GESTURE_IDLE_MS);
+            if(isGestureAvailable())
             {
-                if(isGestureAvailable())
+                room->sent = DIR_NONE;
+                if(room == rooms)
+                    traceFlags = GESTURE_TRACE_START;
+                start = xTaskGetTickCount();
+                dir = readGesture();
+                if(room == rooms)
+                    gestureTraceEnd(dir);
+                /* the early decision stands unless the whole gesture disagrees */
+                if(room->sent != DIR_NONE && !(dir > DIR_NONE && dir < DIR_ALL))
+                    dir = room->sent;
+                else if(room->sent != DIR_NONE && dir != room->sent)
+                    LOG(LOG_SOURCE_GESTURE, LOG_LEVEL_INFO, LOG_MSG_GESTURE_CORRECTED, dir);
+                if(dir == DIR_NONE)
+                    UART_TerminalSend("No Gesture\n\r");
+                /* from the INT to the last FIFO read */
+                end = (int32_t)(room->sensor->endTick - start) > 0 ? room->sensor->endTick : start;
+                n = gesture_grammar_push(&room->grammar, dir, start * portTICK_PERIOD_MS,
+                                         end * portTICK_PERIOD_MS, tokens);
+                for(i = 0; i < n; i++)
                 {
-                    switch ( readGesture() )
-                    {
-                        case DIR_UP:
-                                UART_TerminalSend("UP\n\r");
-                                xTaskNotify(taskNotify1, 0x01, eSetBits);
-                                break;
-                        case DIR_DOWN:
-                                xTaskNotify(taskNotify1, 0x04, eSetBits);
-                                UART_TerminalSend("DOWN\n\r");
-                                break;
-                        case DIR_LEFT:
-                                xTaskNotify(taskNotify1, 0x02, eSetBits);
-                                UART_TerminalSend("LEFT\n\r");
-                                break;
-                        case DIR_RIGHT:
-                                xTaskNotify(taskNotify1, 0x08, eSetBits);
-                                UART_TerminalSend("RIGHT\n\r");
-                                break;
-                        case DIR_NEAR:
-                                xTaskNotify(taskNotify1, 0x10, eSetBits);
-                                UART_TerminalSend("NEAR\n\r");
-                                break;
-                        case DIR_FAR:
-                                xTaskNotify(taskNotify1, 0x20, eSetBits);
-                                UART_TerminalSend("FAR\n\r");
-                                break;
-                        default:
-                                UART_TerminalSend("No Gesture\n\r");
-                                break;
-                    }
+                    /* already sent while the hand was over the sensor */
+                    if(tokens[i].kind == GGRAMMAR_SWIPE && tokens[i].dir == room->sent)
+                        continue;
+                    gestureAct(room, &tokens[i]);
                 }
-                int_status = 0;
-                GPIOIntEnable(GPIO_PORTA_BASE, GPIO_PIN_6);
             }
-            SysCtlDelay(1000000);
+            /* at most GESTURE_IDLE_MS after the request */
+            if(room->gainRequest)
+                gestureSetGain(room);
+            if(room->modeRequest)
+                gestureSetMode(room);
+            if(gesture_grammar_poll(&room->grammar, xTaskGetTickCount() * portTICK_PERIOD_MS, tokens))
+                gestureAct(room, &tokens[0]);
+            /* only between gestures, when PDATA is the bare baseline */
+            else if(xTaskGetTickCount() - calibrated >= pdMS_TO_TICKS(GCALIB_PERIOD_MS) &&
+                    !isGestureAvailable())
+            {
+                calibrated = xTaskGetTickCount();
+                gestureCalibrate(room);
+            }
             xSemaphoreGive(HBGesture);
         }
     }
@@ -544,10 +1033,19 @@ void vGestureTask(void *parameters)
 /* Create all tasks */
 bool CreateTasks()
 {
-    if(xTaskCreate(vGestureTask, "GestureTask", STACK_SIZE, NULL, 1, &GestureTask) == pdFALSE)
+    int i;
+
+    /* RelayGPIOEnable starts with both relays off */
+    relay_queue_init(&relayQueue, 0);
+    /* one task per sensor, each blocks on its own bus and INT line */
+    for(i = 0; i < GESTURE_ROOMS; i++)
     {
-        UART_TerminalSend("Gesture Task creation failed\r\n");
-        return false;
+        if(xTaskCreate(vGestureTask, "GestureTask", STACK_SIZE, &rooms[i], 1,
+                       i ? NULL : &GestureTask) == pdFALSE)
+        {
+            UART_TerminalSend("Gesture Task creation failed\r\n");
+            return false;
+        }
     }
     if(xTaskCreate(vRelayTask, "RelayTask", STACK_SIZE, NULL, 1, &taskNotify1) == pdFALSE)
     {
@@ -570,9 +1068,6 @@ bool CreateTasks()
 /* Initialize all the semaphores used for sync and mutual exclusion */
 bool SemaphoreInit()
 {
-    TermSem = xSemaphoreCreateBinary();
-    xSemaphoreGive(TermSem);
-    bbgSocketSem = xSemaphoreCreateBinary();
     HBGesture = xSemaphoreCreateBinary();
     HBRelay = xSemaphoreCreateBinary();
     bbgSendSem = xSemaphoreCreateMutex();
@@ -595,7 +1090,6 @@ bool SemaphoreInit()
 int main(void)
 {
     uin8bbgSend = 1;
-    int_status=0;
     g_ui32SysClock = SysCtlClockFreqSet((SYSCTL_OSC_MAIN | SYSCTL_XTAL_25MHZ | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480), SYSTEM_CLOCK);
     if(!ConfigureUART_terminal()) return -1;
     SemaphoreInit();
@@ -605,21 +1099,19 @@ int main(void)
         UART_TerminalSend("BBG UART failed\r\n");
         while(1);
     }
-    char ii[2];
-    ltoa(sizeof(Logger_t), ii);
-    UART_TerminalSend(ii);
-    LOG(LOG_SOURCE_MAIN, LOG_LEVEL_INIT, "[TIVA] Gesture Application", NULL);
+    ConsolePrintf("Logger_t %u bytes\n\r", (unsigned int)sizeof(Logger_t));
+    LOG(LOG_SOURCE_MAIN, LOG_LEVEL_INIT, LOG_MSG_GESTURE_APPLICATION, NULL);
     if(!StartupTest())
     {
-        LOG(LOG_SOURCE_MAIN, LOG_LEVEL_ERROR, "[TIVA] StartUp test failed", NULL);
+        LOG(LOG_SOURCE_MAIN, LOG_LEVEL_ERROR, LOG_MSG_START_UP_TEST_FAILED, NULL);
         return -1;
     }
-    LOG(LOG_SOURCE_MAIN, LOG_LEVEL_INIT, "[TIVA] StartUp Test Done", NULL);
+    LOG(LOG_SOURCE_MAIN, LOG_LEVEL_INIT, LOG_MSG_START_UP_TEST_DONE, NULL);
     if(!CreateTasks())
     {
         UART_TerminalSend("Task Creation Failed\n\r");
     }
-    LOG(LOG_SOURCE_MAIN, LOG_LEVEL_INFO, "[TIVA] Created tasks", NULL);
+    LOG(LOG_SOURCE_MAIN, LOG_LEVEL_INFO, LOG_MSG_CREATED_TASKS, NULL);
     vTaskStartScheduler();
     for(;;);
 }
@@ -0,0 +1,213 @@
+/*******************************************************************************************************
+*
+* UNIVERSITY OF COLORADO BOULDER
+*
+* @file relay_queue.c
+* @brief Ordered relay commands with debounce, coalescing and a minimum contact dwell
+*
+* The relay task used to take one notification value per wake up, so
+* commands that arrived together were merged into a value it ignored.
+*
+* @author Kiran Hegde
+* @date  10/16/2026
+* @tools Code Composer Studio
+*
+********************************************************************************************************/
+
+/********************************************************************************************************
+*
+* Header Files
+*
+********************************************************************************************************/
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "include/relay_queue.h"
+
+#define RELAY_ALL       ((1 << RELAY_COUNT) - 1)
+#define RELAY_TOGGLES   (RELAY0_TOGGLE | RELAY1_TOGGLE)
+
+/* relays an action sets on, sets off and toggles */
+static void actionMasks(uint8_t action, uint8_t *on, uint8_t *off, uint8_t *toggle)
+{
+    *on = (action & RELAY0_ON ? 1 : 0) | (action & RELAY1_ON ? 2 : 0) |
+          (action & RELAYS_ON ? RELAY_ALL : 0);
+    *off = (action & RELAY0_OFF ? 1 : 0) | (action & RELAY1_OFF ? 2 : 0) |
+           (action & RELAYS_OFF ? RELAY_ALL : 0);
+    *toggle = (action & RELAY0_TOGGLE ? 1 : 0) | (action & RELAY1_TOGGLE ? 2 : 0);
+}
+
+/* relays an action touches */
+static uint8_t actionRelays(uint8_t action)
+{
+    uint8_t on, off, toggle;
+
+    actionMasks(action, &on, &off, &toggle);
+    return on | off | toggle;
+}
+
+static uint8_t nextState(uint8_t state, uint8_t action)
+{
+    uint8_t on, off, toggle;
+
+    actionMasks(action, &on, &off, &toggle);
+    return ((state | on) & ~off) ^ toggle;
+}
+
+void relay_queue_init(relay_queue_t *q, uint8_t state)
+{
+    memset(q, 0, sizeof(*q));
+    q->state = state & RELAY_ALL;
+}
+
+static bool push(relay_queue_t *q, uint8_t action, bool gesture, uint32_t gestureEnd, uint32_t now)
+{
+    relay_cmd_t *tail;
+
+    /* exactly one action per command */
+    if( !action || (action & (action - 1)) )
+    {
+        q->stats.dropped++;
+        return false;
+    }
+
+    if( q->count )
+    {
+        tail = &q->cmd[(q->head + q->count - 1) % RELAY_QUEUE_DEPTH];
+        if( now - tail->at < RELAY_DEBOUNCE_MS )
+        {
+            if( tail->action == action && (action & RELAY_TOGGLES) )
+            {
+                /* two toggles leave the relay where it was */
+                q->count--;
+                q->stats.coalesced += 2;
+                return true;
+            }
+            if( tail->action == action )
+            {
+                q->stats.coalesced++;
+                return true;
+            }
+            if( !((tail->action | action) & RELAY_TOGGLES) &&
+                actionRelays(tail->action) == actionRelays(action) )
+            {
+                /* the later of on and off wins */
+                tail->action = action;
+                tail->gesture = gesture;
+                tail->gestureEnd = gestureEnd;
+                tail->at = now;
+                q->stats.coalesced++;
+                return true;
+            }
+        }
+    }
+
+    if( q->count == RELAY_QUEUE_DEPTH )
+    {
+        q->stats.dropped++;
+        return false;
+    }
+    tail = &q->cmd[(q->head + q->count) % RELAY_QUEUE_DEPTH];
+    tail->action = action;
+    tail->gesture = gesture;
+    tail->gestureEnd = gestureEnd;
+    tail->at = now;
+    q->count++;
+    q->stats.queued++;
+    if( q->count > q->stats.highWater )
+    {
+        q->stats.highWater = q->count;
+    }
+    return true;
+}
+
+bool relay_queue_push(relay_queue_t *q, uint8_t action, uint32_t now)
+{
+    return push(q, action, false, 0, now);
+}
+
+bool relay_queue_push_gesture(relay_queue_t *q, uint8_t action, uint32_t gestureEnd, uint32_t now)
+{
+    return push(q, action, true, gestureEnd, now);
+}
+
+/* ms before cmd can be carried out, 0 when it is due */
+static uint32_t holdFor(const relay_queue_t *q, const relay_cmd_t *cmd, uint32_t now)
+{
+    uint8_t diff = nextState(q->state, cmd->action) ^ q->state;
+    uint32_t hold = 0, since;
+    int i;
+
+    if( (cmd->action & RELAY_TOGGLES) && now - cmd->at < RELAY_DEBOUNCE_MS )
+    {
+        hold = RELAY_DEBOUNCE_MS - (now - cmd->at);
+    }
+    for( i = 0; i < RELAY_COUNT; i++ )
+    {
+        if( !(diff & q->switched & 1 << i) )
+        {
+            continue;
+        }
+        since = now - q->changedAt[i];
+        if( since < RELAY_DWELL_MS && RELAY_DWELL_MS - since > hold )
+        {
+            hold = RELAY_DWELL_MS - since;
+        }
+    }
+    return hold;
+}
+
+uint8_t relay_queue_run(relay_queue_t *q, uint32_t now, relay_cycle_t *cycle)
+{
+    relay_cmd_t *cmd;
+    uint8_t next, diff;
+    int i;
+
+    cycle->changed = 0;
+    cycle->applied = 0;
+    cycle->gestures = 0;
+    cycle->gestureEnd = 0;
+    cycle->wait = RELAY_IDLE;
+    while( q->count )
+    {
+        cmd = &q->cmd[q->head];
+        cycle->wait = holdFor(q, cmd, now);
+        if( cycle->wait )
+        {
+            q->stats.deferred++;
+            break;
+        }
+        cycle->wait = RELAY_IDLE;
+
+        next = nextState(q->state, cmd->action);
+        diff = next ^ q->state;
+        for( i = 0; i < RELAY_COUNT; i++ )
+        {
+            if( diff & 1 << i )
+            {
+                q->changedAt[i] = now;
+                q->stats.switches++;
+            }
+        }
+        q->switched |= diff;
+        q->state = next;
+        cycle->changed |= diff;
+        cycle->applied++;
+        if( cmd->gesture )
+        {
+            cycle->gestureEnd = cmd->gestureEnd;
+            cycle->gestures++;
+        }
+        q->head = (q->head + 1) % RELAY_QUEUE_DEPTH;
+        q->count--;
+    }
+    q->stats.applied += cycle->applied;
+    cycle->state = q->state;
+    return cycle->changed;
+}
+
+void relay_queue_get_stats(const relay_queue_t *q, relay_queue_stats_t *stats)
+{
+    *stats = q->stats;
+    stats->depth = q->count;
+}
@@ -33,16 +33,55 @@
 #include "include/uart_comm.h"
 #include "include/i2c_comm.h"
 #include "include/logger.h"
+#include "include/link_frame.h"
+#include "include/console.h"
 #include <string.h>
 #include "semphr.h"
+#include "stream_buffer.h"
 #include <stdlib.h>
 #define UART
 
+/* sequence number of the next frame to the BBG */
+static uint8_t frameSeq;
+
+/* frames waiting for the UART6 TX interrupt */
+static StreamBufferHandle_t bbgTxStream;
+/* bytes from the BBG, filled by the UART6 RX interrupt */
+static StreamBufferHandle_t bbgRxStream;
+static bbg_tx_stats_t bbgTxStats;
+static uint8_t bbgTxPolicy = BBG_TX_POLICY;
+
+/* Move queued bytes into the TX FIFO until it is full or the queue is empty */
+static void bbgTxFill(BaseType_t *woken)
+{
+    uint8_t byte;
+
+    while(UARTSpaceAvail(UART6_BASE) &&
+          xStreamBufferReceiveFromISR(bbgTxStream, &byte, 1, woken))
+    {
+        UARTCharPutNonBlocking(UART6_BASE, byte);
+    }
+}
+
+/* Empty the RX FIFO into the queue, several requests can arrive back to back */
+static void bbgRxDrain(BaseType_t *woken)
+{
+    uint8_t byte;
+
+    while(UARTCharsAvail(UART6_BASE))
+    {
+        byte = UARTCharGetNonBlocking(UART6_BASE);
+        if(!xStreamBufferSendFromISR(bbgRxStream, &byte, 1, woken))
+            bbgTxStats.rxDropped++;
+    }
+}
+
 /* Interrupt Handler */
 void
 UARTIntHandler(void)
 {
     uint32_t ui32Status;
+    BaseType_t woken = pdFALSE;
     //
     // Get the interrrupt status.
     //
@@ -53,16 +92,25 @@ UARTIntHandler(void)
     //
     UARTIntClear(UART6_BASE, ui32Status);
 
+    //
+    // Refill the transmit FIFO from the queue.
+    //
+    if(ui32Status & UART_INT_TX)
+        bbgTxFill(&woken);
+
     //
     // Loop while there are characters in the receive FIFO.
     //
-    //if((ui32Status & UART_INT_RX)==UART_INT_RX)
-    xSemaphoreGiveFromISR(bbgSocketSem, NULL);
+    if(ui32Status & (UART_INT_RX | UART_INT_RT))
+        bbgRxDrain(&woken);
+
+    portYIELD_FROM_ISR(woken);
 }
 
 /* Configure the terminal */
 bool ConfigureUART_terminal(void)
 {
+#ifndef CONSOLE_DISABLE
     //
     // Enable the GPIO Peripheral used by the UART.
     //
@@ -86,6 +134,8 @@ bool ConfigureUART_terminal(void)
     UARTConfigSetExpClk(UART0_BASE, g_ui32SysClock, 115200,
                                 (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
                                  UART_CONFIG_PAR_NONE));
+    ConsoleInit();
+#endif
     return true;
 }
 
@@ -124,50 +174,54 @@ bool ConfigureUART_BBG(void)
                                 (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
                                  UART_CONFIG_PAR_NONE));
 
+    bbgTxStream = xStreamBufferCreate(BBG_TX_BUFFER_SIZE, 1);
+    bbgRxStream = xStreamBufferCreate(BBG_RX_BUFFER_SIZE, 1);
+    if(!bbgTxStream || !bbgRxStream)
+        return false;
+
+    /* the handler uses FreeRTOS FromISR calls */
+    IntPrioritySet(INT_UART6, configMAX_SYSCALL_INTERRUPT_PRIORITY);
     IntEnable(INT_UART6);
-    UARTIntEnable(UART6_BASE, UART_INT_RX);
+    /* RT picks up the tail of a request that does not fill the FIFO to its level */
+    UARTIntEnable(UART6_BASE, UART_INT_RX | UART_INT_RT | UART_INT_TX);
 
     return true;
 }
 
+/* Select what BBGSendFrame does when the TX queue is full */
+void BBGSetTxPolicy(uint8_t policy)
+{
+    bbgTxPolicy = policy;
+}
+
+/* Copy of the TX queue counters */
+void BBGGetTxStats(bbg_tx_stats_t *stats)
+{
+    *stats = bbgTxStats;
+}
+
 /* Send to BBG */
 bool BBGSend(char *ptr, uint8_t len)
 {
     if(!ptr)    return false;
     uint8_t status;
-    while(UARTBusy(UART6_BASE));
     /* if BBG connection */
     if(!uin8bbgSend)
     {
         Logger_t temp = *(Logger_t *)ptr;
-        char i32send[2];
-        ltoa(temp.timestamp, i32send);
-        UART_TerminalSend(i32send);
-        UART_TerminalSend("\t");
-        ltoa(temp.log_source, i32send);
-        UART_TerminalSend(i32send);
-        UART_TerminalSend("\t");
-        ltoa(temp.log_level, i32send);
-        UART_TerminalSend(i32send);
-        UART_TerminalSend("\t");
-        UART_TerminalSend(temp.msg);
-        UART_TerminalSend("\t");
+        temp.msg[MSG_SIZE - 1] = '\0';
         if(temp.value)
-        {
-            ltoa(temp.value, i32send);
-            UART_TerminalSend(i32send);
-        }
-        UART_TerminalSend("\n\r");
+            ConsolePrintf("%u\t%u\t%u\t%s\t%u\n\r", temp.timestamp, temp.log_source,
+                          temp.log_level, temp.msg, temp.value);
+        else
+            ConsolePrintf("%u\t%u\t%u\t%s\t\n\r", temp.timestamp, temp.log_source,
+                          temp.log_level, temp.msg);
         status = true;
     }
     else
     {
 #ifdef UART
-        while(len--)
-        {
-            UARTCharPut(UART6_BASE, *ptr++);
-        }
-        status = true;
+        status = BBGSendFrame(FRAME_TYPE_LOG, ptr, len);
 #endif
         /* Compile time switch for I2C communication */
 #ifdef I2C
@@ -180,34 +234,71 @@ bool BBGSend(char *ptr, uint8_t len)
     return status;
 }
 
-/* Receive from BBG */
-bool BBGReceive(char *ptr)
+/*
+ * Queue one framed payload for BBG and return without waiting for the
+ * wire. Callers serialise on bbgSendSem: the stream buffer has a single
+ * writer, so a frame is never interleaved with another one.
+ */
+bool BBGSendFrame(uint8_t type, const void *payload, uint8_t len)
 {
-    if(!ptr)    return false;
-    bool status;
+    uint8_t frame[FRAME_MAX_SIZE];
+    uint16_t size;
+    size_t used;
+
+    size = frame_encode(frame, type, frameSeq, payload, len);
+    if(!size)   return false;
+
+    if(bbgTxPolicy == BBG_TX_DROP)
+    {
+        /* whole frames only, a partial one would cost the next frame too */
+        if(xStreamBufferSpacesAvailable(bbgTxStream) < size)
+        {
+            /* the gap in seq tells the BBG a frame is missing */
+            frameSeq++;
+            bbgTxStats.dropped++;
+            return false;
+        }
+        xStreamBufferSend(bbgTxStream, frame, size, 0);
+    }
+    else
+    {
+        xStreamBufferSend(bbgTxStream, frame, size, portMAX_DELAY);
+    }
+    frameSeq++;
+    bbgTxStats.frames++;
+    bbgTxStats.bytes += size;
+    used = BBG_TX_BUFFER_SIZE - xStreamBufferSpacesAvailable(bbgTxStream);
+    if(used > bbgTxStats.highWater)
+        bbgTxStats.highWater = used;
+
+    /* start the transmitter if the FIFO ran dry, the interrupt does the rest */
+    UARTIntDisable(UART6_BASE, UART_INT_TX);
+    bbgTxFill(NULL);
+    UARTIntEnable(UART6_BASE, UART_INT_TX);
+    return true;
+}
+
+/* Receive from BBG, up to len bytes; waits up to wait ticks for the first */
+size_t BBGReceive(uint8_t *ptr, size_t len, TickType_t wait)
+{
+    if(!ptr)    return 0;
+    size_t count = 0;
 #ifdef UART
-    *ptr = UARTCharGetNonBlocking(UART6_BASE);
-    status = true;
+    count = xStreamBufferReceive(bbgRxStream, ptr, len, wait);
 #endif
 #ifdef I2C
-    i2c_BBGReceive(ptr, 1);
-    status = true;
+    i2c_BBGReceive((char *)ptr, 1);
+    count = 1;
 #endif
-    return status;
+    return count;
 
 }
 
-/* Send the data to terminal */
+#ifndef CONSOLE_DISABLE
+/* Send the data to terminal, returns once it is buffered */
 bool UART_TerminalSend(char *ptr)
 {
     if(!ptr)    return false;
-    /* take semaphore */
-    xSemaphoreTake(TermSem, portMAX_DELAY);
-    uint32_t size = strlen(ptr);
-    while(size--)
-    {
-        UARTCharPut(UART0_BASE, *ptr++);
-    }
-    xSemaphoreGive(TermSem);
-    return true;
+    return ConsoleWrite(ptr, strlen(ptr));
 }
+#endif
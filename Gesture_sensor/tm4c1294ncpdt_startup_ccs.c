@@ -35,6 +35,13 @@ static void FaultISR(void);
 static void IntDefaultHandler(void);
 extern void PortAIntHandler(void);
 extern void UARTIntHandler(void);
+extern void I2CIntHandler(void);
+extern void I2C1IntHandler(void);
+#ifndef CONSOLE_DISABLE
+extern void ConsoleIntHandler(void);
+#else
+#define ConsoleIntHandler IntDefaultHandler
+#endif
 
 extern void xPortSysTickHandler(void);
 extern void xPortPendSVHandler(void);
@@ -93,10 +100,10 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // GPIO Port C
     IntDefaultHandler,                      // GPIO Port D
     IntDefaultHandler,                      // GPIO Port E
-    IntDefaultHandler,                      // UART0 Rx and Tx
+    ConsoleIntHandler,                      // UART0 Rx and Tx
     IntDefaultHandler,                      // UART1 Rx and Tx
     IntDefaultHandler,                      // SSI0 Rx and Tx
-    IntDefaultHandler,                      // I2C0 Master and Slave
+    I2CIntHandler,                          // I2C0 Master and Slave
     IntDefaultHandler,                      // PWM Fault
     IntDefaultHandler,                      // PWM Generator 0
     IntDefaultHandler,                      // PWM Generator 1
@@ -125,7 +132,7 @@ void (* const g_pfnVectors[])(void) =
     IntDefaultHandler,                      // SSI1 Rx and Tx
     IntDefaultHandler,                      // Timer 3 subtimer A
     IntDefaultHandler,                      // Timer 3 subtimer B
-    IntDefaultHandler,                      // I2C1 Master and Slave
+    I2C1IntHandler,                         // I2C1 Master and Slave
     IntDefaultHandler,                      // CAN0
     IntDefaultHandler,                      // CAN1
     IntDefaultHandler,                      // Ethernet